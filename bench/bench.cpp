@@ -0,0 +1,1629 @@
+#include "benchmark/benchmark.h"
+#include "datetime.h"
+#include "sniffing_parser.h"
+#include "resampler.h"
+#include "datetime_range.h"
+#include "business_calendar.h"
+#include "cron_schedule.h"
+#include "datetime_sort.h"
+#include "stream_merger.h"
+#include "time_index.h"
+#include "interval.h"
+#include "compressed_times.h"
+#include "datetime_binary.h"
+#include "packed_times.h"
+#include "timer_wheel.h"
+#include "alloc_counter.h"
+#include "perf_counter.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+// Benchmarks for Easy Datetime.
+// Build "bench" target and run it like: ./bench --benchmark_out=bench_output.txt
+
+using namespace EZ;
+
+namespace MyBench
+{
+    // {timestamp, format} pairs of each supported input format.
+    const std::vector<std::pair<std::string, std::string>> INPUTS = {
+        {"2021/3/8 0:00:15", "%Y/%m/%d %H:%M:%S"},
+        {"2021-03-08 00:00:15", "%Y-%m-%d %H:%M:%S"},
+        {"2021/03/08", "%Y/%m/%d"},
+        {"2021", "%Y"},
+        {"00:00:15 2021/03/08", "%H:%M:%S %Y/%m/%d"},
+        {"12345/3/8 0:00:15", "%Y/%m/%d %H:%M:%S"},
+        {"Mon, 08 Mar 2021 09:00:15 +0900", "%a, %d %b %Y %H:%M:%S %z"},
+        {"March 8, 2021 12:00:15 AM", "%B %d, %Y %I:%M:%S %p"},
+        {"2021-067 00:00:15", "%Y-%j %H:%M:%S"},
+        {"1615161615", "%s"},
+    };
+
+    // Timestamps with different values (to avoid measuring the same input repeatedly).
+    std::vector<std::string> makeTimestamps(const size_t &size)
+    {
+        std::vector<std::string> ret;
+        ret.reserve(size);
+        Datetime base(2021, 1, 1, 0, 0, 0, true);
+        for (size_t i = 0; i < size; i++)
+        {
+            ret.push_back((base + (long long)i * 3671).str("%Y/%m/%d %H:%M:%S"));
+        }
+        return ret;
+    }
+
+    /**
+    * Report heap allocations and hardware counters (if available) per iteration.
+    * Construct it just before the benchmark loop and call finish() just after it.
+    */
+    class Probe
+    {
+        benchmark::State &m_state;
+        MyHelper::AllocationCounter m_allocs;
+        MyHelper::PerfCounters m_perf;
+
+    public:
+        Probe(benchmark::State &state) : m_state(state)
+        {
+            m_perf.start();
+            m_allocs.reset();
+        }
+
+        void finish()
+        {
+            const long long allocs = m_allocs.count();
+            m_perf.stop();
+            m_state.counters["allocs/iter"] = perIteration(allocs);
+            if (m_perf.available())
+            {
+                m_state.counters["cycles/iter"] = perIteration(m_perf.cycles());
+                m_state.counters["instr/iter"] = perIteration(m_perf.instructions());
+                m_state.counters["cache-miss/iter"] = perIteration(m_perf.cacheMisses());
+            }
+        }
+
+    private:
+        // Counters of each thread are averaged over threads.
+        benchmark::Counter perIteration(const long long &value) const
+        {
+            return benchmark::Counter(double(value) / double(m_state.iterations()), benchmark::Counter::kAvgThreads);
+        }
+    };
+
+    std::vector<Datetime> makeDatetimes(const size_t &size, const bool &isUTC)
+    {
+        std::vector<Datetime> ret;
+        ret.reserve(size);
+        Datetime base(2021, 1, 1, 0, 0, 0, isUTC);
+        for (size_t i = 0; i < size; i++)
+        {
+            ret.push_back(base + (long long)i * 3671);
+        }
+        return ret;
+    }
+}
+
+// --------------------- Construction from strings --------------------- //
+
+static void BM_ParseFormat(benchmark::State &state)
+{
+    const auto &input = MyBench::INPUTS[state.range(0)];
+    state.SetLabel(input.second);
+    MyBench::Probe probe(state);
+    for (auto _ : state)
+    {
+        Datetime time(input.first, input.second, true);
+        benchmark::DoNotOptimize(time);
+    }
+    probe.finish();
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ParseFormat)->DenseRange(0, int(MyBench::INPUTS.size()) - 1);
+
+static void BM_ParseDefaultFormat(benchmark::State &state)
+{
+    MyBench::Probe probe(state);
+    for (auto _ : state)
+    {
+        Datetime time("2021/3/8 0:00:15", true);
+        benchmark::DoNotOptimize(time);
+    }
+    probe.finish();
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ParseDefaultFormat)->ThreadRange(1, 8);
+
+static void BM_ParseBatch(benchmark::State &state)
+{
+    auto timestamps = MyBench::makeTimestamps(state.range(0));
+    for (auto _ : state)
+    {
+        for (const auto &ts : timestamps)
+        {
+            Datetime time(ts, true);
+            benchmark::DoNotOptimize(time);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ParseBatch)->RangeMultiplier(8)->Range(1, 1 << 12);
+
+static void BM_ParseCompiled(benchmark::State &state)
+{
+    const auto &input = MyBench::INPUTS[state.range(0)];
+    state.SetLabel(input.second);
+    const auto format = CompiledFormat::compile(input.second);
+    MyBench::Probe probe(state);
+    for (auto _ : state)
+    {
+        Datetime time(input.first, format, true);
+        benchmark::DoNotOptimize(time);
+    }
+    probe.finish();
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ParseCompiled)->DenseRange(0, int(MyBench::INPUTS.size()) - 1);
+
+static void BM_SniffingParserBatch(benchmark::State &state)
+{
+    auto timestamps = MyBench::makeTimestamps(state.range(0));
+    for (auto _ : state)
+    {
+        SniffingParser parser(true);
+        for (const auto &ts : timestamps)
+        {
+            long long unixTime;
+            benchmark::DoNotOptimize(parser.tryParse(ts, unixTime));
+            benchmark::DoNotOptimize(unixTime);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SniffingParserBatch)->RangeMultiplier(8)->Range(1, 1 << 12);
+
+static void BM_ConstructFromFields(benchmark::State &state)
+{
+    const bool isUTC = state.range(0);
+    state.SetLabel(isUTC ? "UTC" : "local");
+    for (auto _ : state)
+    {
+        Datetime time(2021, 3, 8, 0, 0, 15, isUTC);
+        benchmark::DoNotOptimize(time);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ConstructFromFields)->Arg(1)->Arg(0);
+
+// --------------------- Formatting --------------------- //
+
+static void BM_Str(benchmark::State &state)
+{
+    const bool isUTC = state.range(0);
+    state.SetLabel(isUTC ? "UTC" : "local");
+    Datetime time(2021, 3, 8, 0, 0, 15, isUTC);
+    MyBench::Probe probe(state);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(time.str());
+    }
+    probe.finish();
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Str)->Arg(1)->Arg(0)->ThreadRange(1, 8);
+
+static void BM_StrFormat(benchmark::State &state)
+{
+    const auto &format = MyBench::INPUTS[state.range(0)].second;
+    state.SetLabel(format);
+    Datetime time(2021, 3, 8, 0, 0, 15, true);
+    MyBench::Probe probe(state);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(time.str(format));
+    }
+    probe.finish();
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_StrFormat)->DenseRange(0, int(MyBench::INPUTS.size()) - 1);
+
+static void BM_StrBatch(benchmark::State &state)
+{
+    auto times = MyBench::makeDatetimes(state.range(0), true);
+    for (auto _ : state)
+    {
+        for (const auto &time : times)
+        {
+            benchmark::DoNotOptimize(time.str("%Y/%m/%d %H:%M:%S"));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_StrBatch)->RangeMultiplier(8)->Range(1, 1 << 12);
+
+// --------------------- RFC 3339 --------------------- //
+
+// Compare with BM_Rfc3339Generic* (the same layout through str2time()/time2str()).
+static void BM_Rfc3339Parse(benchmark::State &state)
+{
+    const std::string timestamp = "2021-03-08T09:00:15.123+09:00";
+    MyBench::Probe probe(state);
+    for (auto _ : state)
+    {
+        long long unixTime;
+        long nanoseconds;
+        benchmark::DoNotOptimize(FixedFormat::parseRfc3339(timestamp.c_str(), timestamp.size(), unixTime, nanoseconds));
+        benchmark::DoNotOptimize(unixTime);
+    }
+    probe.finish();
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Rfc3339Parse);
+
+static void BM_Rfc3339GenericParse(benchmark::State &state)
+{
+    const std::string timestamp = "2021-03-08T09:00:15+09:00";
+    MyBench::Probe probe(state);
+    for (auto _ : state)
+    {
+        Datetime time(timestamp, "%Y-%m-%dT%H:%M:%S%z", true);
+        benchmark::DoNotOptimize(time);
+    }
+    probe.finish();
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Rfc3339GenericParse);
+
+static void BM_Rfc3339Format(benchmark::State &state)
+{
+    Datetime time(2021, 3, 8, 0, 0, 15, true);
+    MyBench::Probe probe(state);
+    for (auto _ : state)
+    {
+        char buf[FixedFormat::RFC3339_BUFFER_SIZE];
+        benchmark::DoNotOptimize(time.toRfc3339(buf));
+        benchmark::ClobberMemory();
+    }
+    probe.finish();
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Rfc3339Format);
+
+static void BM_Rfc3339GenericFormat(benchmark::State &state)
+{
+    Datetime time(2021, 3, 8, 0, 0, 15, true);
+    MyBench::Probe probe(state);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(time.str("%Y-%m-%dT%H:%M:%SZ"));
+    }
+    probe.finish();
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Rfc3339GenericFormat);
+
+// --------------------- HTTP-date --------------------- //
+
+static void BM_HttpDateFormat(benchmark::State &state)
+{
+    MyBench::Probe probe(state);
+    long long unixTime = 784111777;
+    for (auto _ : state)
+    {
+        char buf[FixedFormat::HTTP_DATE_BUFFER_SIZE];
+        benchmark::DoNotOptimize(FixedFormat::writeHttpDate(buf, unixTime++));
+        benchmark::ClobberMemory();
+    }
+    probe.finish();
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_HttpDateFormat);
+
+// Response headers: the string is rebuilt once per second.
+static void BM_HttpDateCached(benchmark::State &state)
+{
+    MyBench::Probe probe(state);
+    for (auto _ : state)
+    {
+        size_t length;
+        benchmark::DoNotOptimize(FixedFormat::httpDateNow(length));
+    }
+    probe.finish();
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_HttpDateCached)->ThreadRange(1, 8);
+
+static void BM_HttpDateParse(benchmark::State &state)
+{
+    const std::vector<std::string> inputs = {
+        "Sun, 06 Nov 1994 08:49:37 GMT",
+        "Sunday, 06-Nov-94 08:49:37 GMT",
+        "Sun Nov  6 08:49:37 1994",
+    };
+    const auto &timestamp = inputs[state.range(0)];
+    state.SetLabel(timestamp);
+    MyBench::Probe probe(state);
+    for (auto _ : state)
+    {
+        long long unixTime;
+        benchmark::DoNotOptimize(FixedFormat::parseHttpDate(timestamp.c_str(), timestamp.size(), unixTime));
+        benchmark::DoNotOptimize(unixTime);
+    }
+    probe.finish();
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_HttpDateParse)->DenseRange(0, 2);
+
+static void BM_Rfc2822Parse(benchmark::State &state)
+{
+    const std::string timestamp = "Mon, 08 Mar 2021 09:00:15 +0900";
+    MyBench::Probe probe(state);
+    for (auto _ : state)
+    {
+        long long unixTime;
+        benchmark::DoNotOptimize(FixedFormat::parseRfc2822(timestamp.c_str(), timestamp.size(), unixTime));
+        benchmark::DoNotOptimize(unixTime);
+    }
+    probe.finish();
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Rfc2822Parse);
+
+// --------------------- Accessors --------------------- //
+
+static void BM_Accessors(benchmark::State &state)
+{
+    const bool isUTC = state.range(0);
+    state.SetLabel(isUTC ? "UTC" : "local");
+    Datetime time(2021, 3, 8, 0, 0, 15, isUTC);
+    MyBench::Probe probe(state);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(time.year());
+        benchmark::DoNotOptimize(time.month());
+        benchmark::DoNotOptimize(time.day());
+        benchmark::DoNotOptimize(time.hour());
+        benchmark::DoNotOptimize(time.minute());
+        benchmark::DoNotOptimize(time.sec());
+        benchmark::DoNotOptimize(time.daysOfWeek());
+    }
+    probe.finish();
+    state.SetItemsProcessed(state.iterations() * 7);
+}
+BENCHMARK(BM_Accessors)->Arg(1)->Arg(0)->ThreadRange(1, 8);
+
+static void BM_ToVector(benchmark::State &state)
+{
+    Datetime time(2021, 3, 8, 0, 0, 15, true);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(time.toVector());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ToVector);
+
+static void BM_StructTm(benchmark::State &state)
+{
+    const bool isUTC = state.range(0);
+    state.SetLabel(isUTC ? "UTC" : "local");
+    auto times = MyBench::makeDatetimes(state.range(1), isUTC);
+    for (auto _ : state)
+    {
+        for (const auto &time : times)
+        {
+            benchmark::DoNotOptimize(time.structTm());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(1));
+}
+BENCHMARK(BM_StructTm)->ArgsProduct({{1, 0}, {1, 64, 4096}});
+
+// --------------------- Comparisons --------------------- //
+
+static void BM_Compare(benchmark::State &state)
+{
+    auto times = MyBench::makeDatetimes(state.range(0), true);
+    for (auto _ : state)
+    {
+        size_t count = 0;
+        for (size_t i = 1; i < times.size(); i++)
+        {
+            count += (times[i - 1] < times[i]);
+            count += (times[i - 1] == times[i]);
+        }
+        benchmark::DoNotOptimize(count);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Compare)->RangeMultiplier(8)->Range(8, 1 << 15);
+
+static void BM_Subtract(benchmark::State &state)
+{
+    Datetime a(2021, 3, 8, 0, 0, 15, true);
+    Datetime b(2020, 1, 1, 0, 0, 0, true);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(a - b);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Subtract);
+
+// --------------------- TimeDelta --------------------- //
+
+static void BM_TimeDeltaArithmetic(benchmark::State &state)
+{
+    TimeDelta delta(1, 2, 3, 4);
+    TimeDelta step(0, 0, 0, 1);
+    for (auto _ : state)
+    {
+        auto sum = delta + step;
+        auto diff = delta - step;
+        auto mul = delta * 2.5;
+        auto div = delta / 3.0;
+        benchmark::DoNotOptimize(sum);
+        benchmark::DoNotOptimize(diff);
+        benchmark::DoNotOptimize(mul);
+        benchmark::DoNotOptimize(div);
+        benchmark::DoNotOptimize(delta / step);
+    }
+    state.SetItemsProcessed(state.iterations() * 5);
+}
+BENCHMARK(BM_TimeDeltaArithmetic);
+
+static void BM_DatetimePlusTimeDelta(benchmark::State &state)
+{
+    Datetime time(2021, 3, 8, 0, 0, 15, true);
+    TimeDelta step(0, 0, 1, 0);
+    for (auto _ : state)
+    {
+        time += step;
+        benchmark::DoNotOptimize(time + step);
+    }
+    state.SetItemsProcessed(state.iterations() * 2);
+}
+BENCHMARK(BM_DatetimePlusTimeDelta);
+
+// --------------------- Calendar --------------------- //
+
+static void BM_AddMonths(benchmark::State &state)
+{
+    const bool isUTC = state.range(0);
+    state.SetLabel(isUTC ? "UTC" : "local");
+    Datetime time(2021, 1, 31, 12, 0, 0, isUTC);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(time.addMonths(1));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AddMonths)->Arg(1)->Arg(0);
+
+// Compare with BM_AddMonths (the same calculation through struct tm and my_mktime()).
+static void BM_AddMonthsStructTm(benchmark::State &state)
+{
+    const bool isUTC = state.range(0);
+    state.SetLabel(isUTC ? "UTC" : "local");
+    Datetime time(2021, 1, 31, 12, 0, 0, isUTC);
+    for (auto _ : state)
+    {
+        struct tm tmpTm = time.structTm();
+        tmpTm.tm_mon++;
+        const int lastDay = MyTM::daysInMonth(tmpTm.tm_year + DatetimeConstants::TM_BASE_YEAR, tmpTm.tm_mon + 1);
+        tmpTm.tm_mday = tmpTm.tm_mday < lastDay ? tmpTm.tm_mday : lastDay;
+        benchmark::DoNotOptimize(Datetime(tmpTm, isUTC));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AddMonthsStructTm)->Arg(1)->Arg(0);
+
+static void BM_AddMonthsBulk(benchmark::State &state)
+{
+    std::vector<long long> times;
+    for (const auto &time : MyBench::makeDatetimes(state.range(0), true))
+    {
+        times.push_back(time.unixTime() * 29);
+    }
+    std::vector<long long> out(times.size());
+    for (auto _ : state)
+    {
+        Calendar::addMonths(times.data(), times.size(), 1, out.data(), Calendar::KEEP_END_OF_MONTH);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_AddMonthsBulk)->RangeMultiplier(8)->Range(8, 1 << 15);
+
+// Compare with BM_IsoWeekAccessor (weeksOfYear() and isoYear() of each Datetime).
+static void BM_IsoWeekBulk(benchmark::State &state)
+{
+    std::vector<long long> times;
+    for (const auto &time : MyBench::makeDatetimes(state.range(0), true))
+    {
+        times.push_back(time.unixTime() * 29);
+    }
+    std::vector<long long> isoYears(times.size());
+    std::vector<int> weeks(times.size());
+    for (auto _ : state)
+    {
+        Calendar::isoWeeks(times.data(), times.size(), isoYears.data(), weeks.data());
+        benchmark::DoNotOptimize(weeks.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_IsoWeekBulk)->RangeMultiplier(8)->Range(8, 1 << 15);
+
+static void BM_IsoWeekAccessor(benchmark::State &state)
+{
+    auto times = MyBench::makeDatetimes(state.range(0), true);
+    for (auto _ : state)
+    {
+        for (const auto &time : times)
+        {
+            benchmark::DoNotOptimize(time.weeksOfYear());
+            benchmark::DoNotOptimize(time.isoYear());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_IsoWeekAccessor)->RangeMultiplier(8)->Range(8, 1 << 12);
+
+// Compare with BM_FloorByFormat (bucketing by str("%Y/%m/%d %H") and parsing it again).
+static void BM_FloorBulk(benchmark::State &state)
+{
+    const std::vector<std::pair<Calendar::Unit, long long>> units = {
+        {Calendar::MINUTE, 5}, {Calendar::HOUR, 1}, {Calendar::DAY, 1}, {Calendar::MONTH, 1}};
+    const char *labels[] = {"5 minutes", "hour", "day", "month"};
+    const auto &unit = units[state.range(0)];
+    state.SetLabel(labels[state.range(0)]);
+    std::vector<long long> times;
+    for (const auto &time : MyBench::makeDatetimes(4096, true))
+    {
+        times.push_back(time.unixTime());
+    }
+    std::vector<long long> out(times.size());
+    for (auto _ : state)
+    {
+        Calendar::floorTo(times.data(), times.size(), out.data(), unit.first, unit.second);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * times.size());
+}
+BENCHMARK(BM_FloorBulk)->DenseRange(0, 3);
+
+static void BM_FloorDatetime(benchmark::State &state)
+{
+    const bool isUTC = state.range(0);
+    state.SetLabel(isUTC ? "UTC" : "local");
+    auto times = MyBench::makeDatetimes(64, isUTC);
+    for (auto _ : state)
+    {
+        for (const auto &time : times)
+        {
+            benchmark::DoNotOptimize(time.floor(Calendar::HOUR));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * times.size());
+}
+BENCHMARK(BM_FloorDatetime)->Arg(1)->Arg(0);
+
+static void BM_FloorByFormat(benchmark::State &state)
+{
+    auto times = MyBench::makeDatetimes(64, true);
+    for (auto _ : state)
+    {
+        for (const auto &time : times)
+        {
+            benchmark::DoNotOptimize(Datetime(time.str("%Y/%m/%d %H"), "%Y/%m/%d %H", true));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * times.size());
+}
+BENCHMARK(BM_FloorByFormat);
+
+// --------------------- Resampling --------------------- //
+
+namespace MyBench
+{
+    // Ticks of irregular intervals (0 ~ 4 seconds) and their prices.
+    void makeTicks(const size_t &size, std::vector<long long> &times, std::vector<double> &prices)
+    {
+        long long t = Datetime(2021, 1, 1, 0, 0, 0, true).unixTime();
+        for (size_t i = 0; i < size; i++)
+        {
+            t += (long long)(i * 7919 % 5);
+            times.push_back(t);
+            prices.push_back(100.0 + double(i * 104729 % 1000) / 100.0);
+        }
+    }
+}
+
+// 1-minute OHLC bars. Arg: number of threads.
+static void BM_Resample(benchmark::State &state)
+{
+    std::vector<long long> times;
+    std::vector<double> prices;
+    MyBench::makeTicks(1 << 18, times, prices);
+    Resampler resampler(Calendar::MINUTE, 1, true);
+    for (auto _ : state)
+    {
+        auto result = resampler.resample(times.data(), times.size(), {prices.data()}, size_t(state.range(0)));
+        benchmark::DoNotOptimize(result.starts.data());
+    }
+    state.SetItemsProcessed(state.iterations() * times.size());
+}
+BENCHMARK(BM_Resample)->RangeMultiplier(2)->Range(1, 8)->UseRealTime();
+
+// Compare with BM_Resample (group keys made by Datetime::str()).
+static void BM_ResampleByStr(benchmark::State &state)
+{
+    std::vector<long long> times;
+    std::vector<double> prices;
+    MyBench::makeTicks(1 << 12, times, prices);
+    for (auto _ : state)
+    {
+        std::vector<std::string> keys;
+        std::vector<double> highs;
+        for (size_t i = 0; i < times.size(); i++)
+        {
+            std::string key = Datetime(time_t(times[i]), true).str("%Y/%m/%d %H:%M");
+            if (keys.empty() || keys.back() != key)
+            {
+                keys.push_back(key);
+                highs.push_back(prices[i]);
+            }
+            highs.back() = prices[i] > highs.back() ? prices[i] : highs.back();
+        }
+        benchmark::DoNotOptimize(highs.data());
+    }
+    state.SetItemsProcessed(state.iterations() * times.size());
+}
+BENCHMARK(BM_ResampleByStr);
+
+// --------------------- Range --------------------- //
+
+// One year of minutes, generated lazily.
+static void BM_RangeIterate(benchmark::State &state)
+{
+    const Datetime start(2021, 1, 1, 0, 0, 0, true);
+    const Datetime end(2022, 1, 1, 0, 0, 0, true);
+    for (auto _ : state)
+    {
+        long long sum = 0;
+        for (const auto &t : range(start, end, TimeDelta(0, 0, 1, 0)))
+        {
+            sum += t.unixTime();
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * 525600);
+}
+BENCHMARK(BM_RangeIterate);
+
+// Compare with BM_RangeIterate (a vector filled by +=).
+static void BM_RangeVector(benchmark::State &state)
+{
+    const Datetime start(2021, 1, 1, 0, 0, 0, true);
+    const Datetime end(2022, 1, 1, 0, 0, 0, true);
+    for (auto _ : state)
+    {
+        std::vector<Datetime> grid;
+        for (Datetime t = start; t < end; t += TimeDelta(0, 0, 1, 0))
+        {
+            grid.push_back(t);
+        }
+        long long sum = 0;
+        for (const auto &t : grid)
+        {
+            sum += t.unixTime();
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * 525600);
+}
+BENCHMARK(BM_RangeVector);
+
+// Random access to a monthly range (calendar step).
+static void BM_RangeMonthsAt(benchmark::State &state)
+{
+    auto months = range(Datetime(1970, 1, 31, 0, 0, 0, true), Datetime(2070, 1, 1, 0, 0, 0, true), Calendar::MONTH);
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(months[i]);
+        i = (i + 577) % months.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RangeMonthsAt);
+
+// --------------------- Business days --------------------- //
+
+namespace MyBench
+{
+    // 10 holidays a year for 2000 ~ 2039 and trade times in 2020 ~ 2021.
+    void makeSettlement(const size_t &size, BusinessCalendar &calendar, std::vector<long long> &trades)
+    {
+        std::vector<Datetime> holidays;
+        for (int year = 2000; year < 2040; year++)
+        {
+            for (int i = 0; i < 10; i++)
+            {
+                holidays.push_back(Datetime(year, i + 1, (i * 7) % 28 + 1, 0, 0, 0, true));
+            }
+        }
+        calendar.addHolidays(holidays);
+        trades.clear();
+        for (size_t i = 0; i < size; i++)
+        {
+            trades.push_back(Datetime(2020, 1, 1, 0, 0, 0, true).unixTime() + (long long)(i * 7919 % 63072000));
+        }
+    }
+}
+
+// T+2 settlement dates of trades.
+static void BM_AddBusinessDaysBulk(benchmark::State &state)
+{
+    BusinessCalendar calendar;
+    std::vector<long long> trades;
+    MyBench::makeSettlement(1 << 16, calendar, trades);
+    std::vector<long long> settled(trades.size());
+    for (auto _ : state)
+    {
+        calendar.addBusinessDays(trades.data(), trades.size(), 2, settled.data());
+        benchmark::DoNotOptimize(settled.data());
+    }
+    state.SetItemsProcessed(state.iterations() * trades.size());
+}
+BENCHMARK(BM_AddBusinessDaysBulk);
+
+// Compare with BM_AddBusinessDaysBulk (stepping one day at a time with +=).
+static void BM_AddBusinessDaysByStep(benchmark::State &state)
+{
+    BusinessCalendar calendar;
+    std::vector<long long> trades;
+    MyBench::makeSettlement(1 << 12, calendar, trades);
+    for (auto _ : state)
+    {
+        for (const auto &trade : trades)
+        {
+            Datetime date(time_t(trade), true);
+            for (int n = 0; n < 2;)
+            {
+                date += 86400;
+                const int wday = date.daysOfWeek();
+                n += (wday != 0 && wday != 6 && !calendar.isHoliday(date)) ? 1 : 0;
+            }
+            benchmark::DoNotOptimize(date);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * trades.size());
+}
+BENCHMARK(BM_AddBusinessDaysByStep);
+
+// Business days between pairs of dates years apart.
+static void BM_BusinessDaysBetween(benchmark::State &state)
+{
+    BusinessCalendar calendar;
+    std::vector<long long> trades;
+    MyBench::makeSettlement(1 << 16, calendar, trades);
+    std::vector<long long> later(trades.size());
+    std::vector<long long> counts(trades.size());
+    for (size_t i = 0; i < trades.size(); i++)
+    {
+        later[i] = trades[i] + (long long)(i % 3650) * 86400;
+    }
+    for (auto _ : state)
+    {
+        calendar.businessDaysBetween(trades.data(), later.data(), trades.size(), counts.data());
+        benchmark::DoNotOptimize(counts.data());
+    }
+    state.SetItemsProcessed(state.iterations() * trades.size());
+}
+BENCHMARK(BM_BusinessDaysBetween);
+
+// --------------------- Cron schedules --------------------- //
+
+namespace MyBench
+{
+    std::vector<CronSchedule> makeSchedules()
+    {
+        const std::vector<std::string> expressions = {
+            "*/5 * * * *", "0 * * * *", "30 2 * * *", "0 9-17 * * MON-FRI", "15 10 1 * *",
+            "0 0 * * 0", "0 12 1,15 * *", "45 23 * * 5", "0 0 1 1 *", "*/20 8-18 * * 1-5",
+        };
+        std::vector<CronSchedule> schedules;
+        for (const auto &expression : expressions)
+        {
+            schedules.push_back(CronSchedule(expression));
+        }
+        return schedules;
+    }
+}
+
+// Next fire times of schedules after a time.
+static void BM_CronNext(benchmark::State &state)
+{
+    const auto schedules = MyBench::makeSchedules();
+    const long long after = Datetime(2021, 3, 8, 10, 7, 0, true).unixTime();
+    for (auto _ : state)
+    {
+        for (const auto &schedule : schedules)
+        {
+            long long fire;
+            benchmark::DoNotOptimize(schedule.next(after, fire));
+            benchmark::DoNotOptimize(fire);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * schedules.size());
+}
+BENCHMARK(BM_CronNext);
+
+// Compare with BM_CronNext (stepping one minute at a time with +=).
+static void BM_CronNextByScan(benchmark::State &state)
+{
+    const auto schedules = MyBench::makeSchedules();
+    const Datetime after(2021, 3, 8, 10, 7, 0, true);
+    for (auto _ : state)
+    {
+        for (const auto &schedule : schedules)
+        {
+            Datetime fire = after + 60;
+            while (!schedule.matches(fire))
+            {
+                fire += 60;
+            }
+            benchmark::DoNotOptimize(fire);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * schedules.size());
+}
+BENCHMARK(BM_CronNextByScan);
+
+// All fire times in a week.
+static void BM_CronFireTimes(benchmark::State &state)
+{
+    CronSchedule schedule("*/5 9-17 * * MON-FRI");
+    const long long from = Datetime(2021, 3, 8, 0, 0, 0, true).unixTime();
+    std::vector<long long> fires;
+    for (auto _ : state)
+    {
+        fires.clear();
+        schedule.fireTimes(from, from + 7 * 86400, fires);
+        benchmark::DoNotOptimize(fires.data());
+    }
+    state.SetItemsProcessed(state.iterations() * fires.size());
+}
+BENCHMARK(BM_CronFireTimes);
+
+// --------------------- Sorting --------------------- //
+
+namespace MyBench
+{
+    // Random unix times within a year (Arg 0) or in the whole range of Datetime (Arg 1).
+    std::vector<long long> makeUnsortedTimes(const size_t &size, const bool &whole)
+    {
+        std::vector<long long> times(size);
+        const long long start = whole ? DatetimeConstants::MINIMUM_SEC : Datetime(2021, 1, 1, 0, 0, 0, true).unixTime();
+        const unsigned long long width = whole ? (unsigned long long)(DatetimeConstants::MAXIMUM_SEC - DatetimeConstants::MINIMUM_SEC) : 365 * 86400ULL;
+        unsigned long long x = 88172645463325252ULL;
+        for (auto &time : times)
+        {
+            x ^= x << 13;
+            x ^= x >> 7;
+            x ^= x << 17;
+            time = start + (long long)(x % width);
+        }
+        return times;
+    }
+}
+
+static void BM_SortRadix(benchmark::State &state)
+{
+    const auto times = MyBench::makeUnsortedTimes(1 << 20, state.range(0) != 0);
+    std::vector<long long> sorted;
+    for (auto _ : state)
+    {
+        sorted = times;
+        sort(sorted);
+        benchmark::DoNotOptimize(sorted.data());
+    }
+    state.SetItemsProcessed(state.iterations() * times.size());
+}
+BENCHMARK(BM_SortRadix)->Arg(0)->Arg(1);
+
+// Compare with BM_SortRadix.
+static void BM_SortStd(benchmark::State &state)
+{
+    const auto times = MyBench::makeUnsortedTimes(1 << 20, state.range(0) != 0);
+    std::vector<long long> sorted;
+    for (auto _ : state)
+    {
+        sorted = times;
+        std::sort(sorted.begin(), sorted.end());
+        benchmark::DoNotOptimize(sorted.data());
+    }
+    state.SetItemsProcessed(state.iterations() * times.size());
+}
+BENCHMARK(BM_SortStd)->Arg(0)->Arg(1);
+
+// Arg: number of threads.
+static void BM_ParallelSort(benchmark::State &state)
+{
+    const auto times = MyBench::makeUnsortedTimes(1 << 22, false);
+    std::vector<long long> sorted;
+    for (auto _ : state)
+    {
+        sorted = times;
+        parallelSort(sorted, size_t(state.range(0)));
+        benchmark::DoNotOptimize(sorted.data());
+    }
+    state.SetItemsProcessed(state.iterations() * times.size());
+}
+BENCHMARK(BM_ParallelSort)->RangeMultiplier(2)->Range(1, 8)->UseRealTime();
+
+static void BM_SortDatetimes(benchmark::State &state)
+{
+    std::vector<Datetime> times;
+    for (const auto &time : MyBench::makeUnsortedTimes(1 << 18, false))
+    {
+        times.push_back(Datetime(time_t(time), true));
+    }
+    std::vector<Datetime> sorted;
+    for (auto _ : state)
+    {
+        sorted = times;
+        if (state.range(0) != 0)
+        {
+            sort(sorted);
+        }
+        else
+        {
+            // Compare with std::sort() and Datetime::operator<.
+            std::sort(sorted.begin(), sorted.end());
+        }
+        benchmark::DoNotOptimize(sorted.data());
+    }
+    state.SetItemsProcessed(state.iterations() * times.size());
+}
+BENCHMARK(BM_SortDatetimes)->Arg(1)->Arg(0);
+
+// Five sorted logs concatenated (merged instead of the radix sort).
+static void BM_SortRuns(benchmark::State &state)
+{
+    std::vector<long long> times;
+    for (int file = 0; file < 5; file++)
+    {
+        auto log = MyBench::makeUnsortedTimes(1 << 18, false);
+        std::sort(log.begin(), log.end());
+        times.insert(times.end(), log.begin(), log.end());
+    }
+    std::vector<long long> sorted;
+    for (auto _ : state)
+    {
+        sorted = times;
+        sort(sorted);
+        benchmark::DoNotOptimize(sorted.data());
+    }
+    state.SetItemsProcessed(state.iterations() * times.size());
+}
+BENCHMARK(BM_SortRuns);
+
+// Row indices sorted by times.
+static void BM_SortedIndices(benchmark::State &state)
+{
+    const auto times = MyBench::makeUnsortedTimes(1 << 20, false);
+    for (auto _ : state)
+    {
+        auto indices = sortedIndices(times);
+        benchmark::DoNotOptimize(indices.data());
+    }
+    state.SetItemsProcessed(state.iterations() * times.size());
+}
+BENCHMARK(BM_SortedIndices);
+
+// --------------------- Merging streams --------------------- //
+
+namespace MyBench
+{
+    // Sorted logs of hosts.
+    std::vector<std::vector<long long>> makeHostLogs(const size_t &numHosts, const size_t &size)
+    {
+        std::vector<std::vector<long long>> logs(numHosts);
+        for (size_t h = 0; h < numHosts; h++)
+        {
+            long long t = Datetime(2021, 1, 1, 0, 0, 0, true).unixTime() + (long long)(h * 7919 % 60);
+            for (size_t i = 0; i < size; i++)
+            {
+                t += (long long)((i * 104729 + h) % 11);
+                logs[h].push_back(t);
+            }
+        }
+        return logs;
+    }
+}
+
+// Arg: number of hosts (4096 records each).
+static void BM_MergeStreams(benchmark::State &state)
+{
+    const auto logs = MyBench::makeHostLogs(size_t(state.range(0)), 4096);
+    for (auto _ : state)
+    {
+        std::vector<std::function<bool(long long &)>> sources;
+        for (const auto &log : logs)
+        {
+            sources.push_back(rangeSource(log.begin(), log.end()));
+        }
+        StreamMerger<long long> merger(sources);
+        long long time, sum = 0;
+        while (merger.next(time))
+        {
+            sum += time;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * logs.size() * 4096);
+}
+BENCHMARK(BM_MergeStreams)->RangeMultiplier(4)->Range(4, 256);
+
+// Compare with BM_MergeStreams (all records in a vector and std::sort()).
+static void BM_MergeStreamsBySort(benchmark::State &state)
+{
+    const auto logs = MyBench::makeHostLogs(size_t(state.range(0)), 4096);
+    for (auto _ : state)
+    {
+        std::vector<long long> all;
+        for (const auto &log : logs)
+        {
+            all.insert(all.end(), log.begin(), log.end());
+        }
+        std::sort(all.begin(), all.end());
+        long long sum = 0;
+        for (const auto &time : all)
+        {
+            sum += time;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * logs.size() * 4096);
+}
+BENCHMARK(BM_MergeStreamsBySort)->RangeMultiplier(4)->Range(4, 256);
+
+// --------------------- Time index --------------------- //
+
+namespace MyBench
+{
+    // Sorted times of irregular intervals (0 ~ 4 seconds), and random times in their range.
+    void makeColumn(const size_t &size, std::vector<long long> &times, std::vector<long long> &queries)
+    {
+        long long t = Datetime(2021, 1, 1, 0, 0, 0, true).unixTime();
+        for (size_t i = 0; i < size; i++)
+        {
+            t += (long long)(i * 7919 % 5);
+            times.push_back(t);
+        }
+        unsigned long long x = 88172645463325252ULL;
+        for (size_t i = 0; i < 4096; i++)
+        {
+            x ^= x << 13;
+            x ^= x >> 7;
+            x ^= x << 17;
+            queries.push_back(times.front() + (long long)(x % (unsigned long long)(times.back() - times.front())));
+        }
+    }
+}
+
+// As-of lookups of random times. Arg: number of rows.
+static void BM_TimeIndexAsOf(benchmark::State &state)
+{
+    std::vector<long long> times, queries;
+    MyBench::makeColumn(size_t(state.range(0)), times, queries);
+    TimeIndex index(times);
+    std::vector<size_t> rows(queries.size());
+    for (auto _ : state)
+    {
+        index.asOf(queries.data(), queries.size(), rows.data());
+        benchmark::DoNotOptimize(rows.data());
+    }
+    state.SetItemsProcessed(state.iterations() * queries.size());
+}
+BENCHMARK(BM_TimeIndexAsOf)->RangeMultiplier(64)->Range(1 << 10, 1 << 22);
+
+// Compare with BM_TimeIndexAsOf (std::upper_bound() over std::vector<Datetime>).
+static void BM_TimeIndexAsOfByUpperBound(benchmark::State &state)
+{
+    std::vector<long long> times, queries;
+    MyBench::makeColumn(size_t(state.range(0)), times, queries);
+    std::vector<Datetime> datetimes;
+    for (const auto &time : times)
+    {
+        datetimes.push_back(Datetime(time_t(time), true));
+    }
+    std::vector<Datetime> targets;
+    for (const auto &query : queries)
+    {
+        targets.push_back(Datetime(time_t(query), true));
+    }
+    std::vector<size_t> rows(queries.size());
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < targets.size(); i++)
+        {
+            rows[i] = size_t(std::upper_bound(datetimes.begin(), datetimes.end(), targets[i]) - datetimes.begin()) - 1;
+        }
+        benchmark::DoNotOptimize(rows.data());
+    }
+    state.SetItemsProcessed(state.iterations() * queries.size());
+}
+BENCHMARK(BM_TimeIndexAsOfByUpperBound)->RangeMultiplier(64)->Range(1 << 10, 1 << 22);
+
+// --------------------- Intervals --------------------- //
+
+namespace MyBench
+{
+    // Reservations of 10 ~ 120 minutes over a year.
+    std::vector<Interval> makeReservations(const size_t &size)
+    {
+        const long long origin = Datetime(2021, 1, 1, 0, 0, 0, true).unixTime();
+        std::vector<Interval> intervals;
+        for (size_t i = 0; i < size; i++)
+        {
+            const long long start = origin + (long long)(i * 104729 % (365 * 86400));
+            const long long length = 600 + (long long)(i * 7919 % 6600);
+            intervals.push_back(Interval(Datetime(time_t(start), true), Datetime(time_t(start + length), true)));
+        }
+        return intervals;
+    }
+}
+
+// Reservations overlapping each request. Arg: number of reservations.
+static void BM_IntervalTreeOverlapping(benchmark::State &state)
+{
+    const IntervalTree tree(MyBench::makeReservations(size_t(state.range(0))));
+    const auto requests = MyBench::makeReservations(1024);
+    std::vector<size_t> found;
+    for (auto _ : state)
+    {
+        size_t count = 0;
+        for (const auto &request : requests)
+        {
+            found.clear();
+            tree.overlapping(request, found);
+            count += found.size();
+        }
+        benchmark::DoNotOptimize(count);
+    }
+    state.SetItemsProcessed(state.iterations() * requests.size());
+}
+BENCHMARK(BM_IntervalTreeOverlapping)->RangeMultiplier(8)->Range(1 << 8, 1 << 17);
+
+// Compare with BM_IntervalTreeOverlapping (checking every reservation with Datetime comparisons).
+static void BM_IntervalOverlappingByScan(benchmark::State &state)
+{
+    const auto reservations = MyBench::makeReservations(size_t(state.range(0)));
+    const auto requests = MyBench::makeReservations(1024);
+    for (auto _ : state)
+    {
+        size_t count = 0;
+        for (const auto &request : requests)
+        {
+            for (const auto &reservation : reservations)
+            {
+                count += (reservation.start() < request.end() && request.start() < reservation.end()) ? 1 : 0;
+            }
+        }
+        benchmark::DoNotOptimize(count);
+    }
+    state.SetItemsProcessed(state.iterations() * requests.size());
+}
+BENCHMARK(BM_IntervalOverlappingByScan)->RangeMultiplier(8)->Range(1 << 8, 1 << 17);
+
+// Coalesce sorted reservations.
+static void BM_Coalesce(benchmark::State &state)
+{
+    auto reservations = MyBench::makeReservations(1 << 16);
+    std::sort(reservations.begin(), reservations.end(), [](const Interval &a, const Interval &b) { return a.start() < b.start(); });
+    for (auto _ : state)
+    {
+        auto coalesced = coalesce(reservations);
+        benchmark::DoNotOptimize(coalesced.data());
+    }
+    state.SetItemsProcessed(state.iterations() * reservations.size());
+}
+BENCHMARK(BM_Coalesce);
+
+// --------------------- Compressed times --------------------- //
+
+namespace MyBench
+{
+    // Every 10 seconds, with a second of jitter in 1% of the times and a gap now and then.
+    std::vector<long long> makeRegularTimes(const size_t &size)
+    {
+        std::vector<long long> times;
+        long long t = Datetime(2021, 1, 1, 0, 0, 0, true).unixTime();
+        for (size_t i = 0; i < size; i++)
+        {
+            t += 10 + (i * 7919 % 100 == 0 ? 1 : 0) + (i * 104729 % 10000 == 0 ? 3600 : 0);
+            times.push_back(t);
+        }
+        return times;
+    }
+}
+
+static void BM_CompressTimes(benchmark::State &state)
+{
+    const auto times = MyBench::makeRegularTimes(1 << 20);
+    double bits = 0;
+    for (auto _ : state)
+    {
+        CompressedTimes compressed(times);
+        bits = compressed.bitsPerTime();
+        benchmark::DoNotOptimize(bits);
+    }
+    state.counters["bits/time"] = bits;
+    state.SetItemsProcessed(state.iterations() * times.size());
+}
+BENCHMARK(BM_CompressTimes);
+
+static void BM_DecompressTimes(benchmark::State &state)
+{
+    const CompressedTimes compressed(MyBench::makeRegularTimes(1 << 20));
+    std::vector<long long> times(compressed.size());
+    for (auto _ : state)
+    {
+        compressed.decode(times.data());
+        benchmark::DoNotOptimize(times.data());
+    }
+    state.SetItemsProcessed(state.iterations() * times.size());
+}
+BENCHMARK(BM_DecompressTimes);
+
+// Compare with BM_DecompressTimes (copying the unix times of std::vector<Datetime>).
+static void BM_DecompressTimesByDatetimes(benchmark::State &state)
+{
+    std::vector<Datetime> datetimes;
+    for (const auto &time : MyBench::makeRegularTimes(1 << 20))
+    {
+        datetimes.push_back(Datetime(time_t(time), true));
+    }
+    std::vector<long long> times(datetimes.size());
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < datetimes.size(); i++)
+        {
+            times[i] = datetimes[i].unixTime();
+        }
+        benchmark::DoNotOptimize(times.data());
+    }
+    state.SetItemsProcessed(state.iterations() * times.size());
+}
+BENCHMARK(BM_DecompressTimesByDatetimes);
+
+// Random access (a block is decoded for each time).
+static void BM_CompressedTimesAt(benchmark::State &state)
+{
+    const CompressedTimes compressed(MyBench::makeRegularTimes(1 << 20));
+    size_t index = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(compressed.at(index));
+        index = (index + 104729) % compressed.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CompressedTimesAt);
+
+// --------------------- Binary serialization --------------------- //
+
+static void BM_BinaryRoundTrip(benchmark::State &state)
+{
+    const Binary::Mode mode = Binary::Mode(state.range(0));
+    std::vector<Datetime> times;
+    for (const auto &time : MyBench::makeRegularTimes(1 << 16))
+    {
+        times.push_back(Datetime(time_t(time), true));
+    }
+    std::vector<unsigned char> buffer;
+    for (auto _ : state)
+    {
+        buffer.clear();
+        Binary::write(buffer, times, mode);
+        Binary::Reader reader(buffer);
+        benchmark::DoNotOptimize(reader.readDatetimes(mode).data());
+    }
+    state.counters["bytes/time"] = double(buffer.size()) / double(times.size());
+    state.SetItemsProcessed(state.iterations() * times.size());
+}
+BENCHMARK(BM_BinaryRoundTrip)->Arg(Binary::FIXED)->Arg(Binary::VARINT);
+
+// Reading a memory-mapped buffer in place.
+static void BM_BinaryView(benchmark::State &state)
+{
+    std::vector<unsigned char> buffer;
+    std::vector<Datetime> times;
+    for (const auto &time : MyBench::makeRegularTimes(1 << 16))
+    {
+        times.push_back(Datetime(time_t(time), true));
+    }
+    Binary::write(buffer, times);
+    for (auto _ : state)
+    {
+        Binary::Reader reader(buffer);
+        const Binary::DatetimeView view = reader.viewDatetimes();
+        long long sum = 0;
+        for (size_t i = 0; i < view.size(); i++)
+        {
+            sum += view.unixTime(i);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * times.size());
+}
+BENCHMARK(BM_BinaryView);
+
+// Compare with BM_BinaryRoundTrip (RFC 3339 text).
+static void BM_BinaryRoundTripByText(benchmark::State &state)
+{
+    const auto times = MyBench::makeRegularTimes(1 << 16);
+    std::string text(times.size() * 32, ' ');
+    std::vector<long long> parsed(times.size());
+    std::vector<size_t> lengths(times.size());
+    for (auto _ : state)
+    {
+        size_t position = 0;
+        for (size_t i = 0; i < times.size(); i++)
+        {
+            lengths[i] = FixedFormat::writeRfc3339(&text[position], times[i]);
+            position += 32;
+        }
+        long nanoseconds = 0;
+        for (size_t i = 0; i < times.size(); i++)
+        {
+            FixedFormat::parseRfc3339(&text[i * 32], lengths[i], parsed[i], nanoseconds);
+        }
+        benchmark::DoNotOptimize(parsed.data());
+    }
+    state.SetItemsProcessed(state.iterations() * times.size());
+}
+BENCHMARK(BM_BinaryRoundTripByText);
+
+// --------------------- Packed times --------------------- //
+
+namespace MyBench
+{
+    // makeRegularTimes() in the order of i * 7919 (size: a power of 2).
+    std::vector<long long> makeShuffledTimes(const size_t &size)
+    {
+        const auto regular = makeRegularTimes(size);
+        std::vector<long long> times(size);
+        for (size_t i = 0; i < size; i++)
+        {
+            times[i * 7919 % size] = regular[i];
+        }
+        return times;
+    }
+}
+
+static void BM_PackTimes(benchmark::State &state)
+{
+    const auto times = MyBench::makeRegularTimes(1 << 20);
+    double bits = 0;
+    for (auto _ : state)
+    {
+        PackedTimes packed(times);
+        bits = packed.bitsPerTime();
+        benchmark::DoNotOptimize(bits);
+    }
+    state.counters["bits/time"] = bits;
+    state.SetItemsProcessed(state.iterations() * times.size());
+}
+BENCHMARK(BM_PackTimes);
+
+static void BM_UnpackTimes(benchmark::State &state)
+{
+    const PackedTimes packed(MyBench::makeRegularTimes(1 << 20));
+    std::vector<long long> times(packed.size());
+    for (auto _ : state)
+    {
+        packed.decode(times.data());
+        benchmark::DoNotOptimize(times.data());
+    }
+    state.SetItemsProcessed(state.iterations() * times.size());
+}
+BENCHMARK(BM_UnpackTimes);
+
+// Rows in [from, to): range(0) per mille of the times.
+static void BM_PackedTimesCount(benchmark::State &state)
+{
+    const auto times = MyBench::makeRegularTimes(1 << 20);
+    const PackedTimes packed(times);
+    const long long from = times[times.size() / 3];
+    const long long to = times[times.size() / 3 + times.size() * size_t(state.range(0)) / 1000];
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(packed.count(from, to));
+    }
+    state.SetItemsProcessed(state.iterations() * times.size());
+}
+BENCHMARK(BM_PackedTimesCount)->Arg(1)->Arg(100);
+
+// Unsorted times: every block is compared on the packed offsets.
+static void BM_PackedTimesFilterUnsorted(benchmark::State &state)
+{
+    const auto times = MyBench::makeShuffledTimes(1 << 20);
+    const PackedTimes packed(times);
+    const long long from = Datetime(2021, 2, 1, 0, 0, 0, true).unixTime();
+    const long long to = from + 86400;
+    std::vector<size_t> rows;
+    for (auto _ : state)
+    {
+        rows.clear();
+        packed.filter(from, to, rows);
+        benchmark::DoNotOptimize(rows.data());
+    }
+    state.counters["rows"] = double(rows.size());
+    state.SetItemsProcessed(state.iterations() * times.size());
+}
+BENCHMARK(BM_PackedTimesFilterUnsorted);
+
+// Compare with BM_PackedTimesFilterUnsorted (scanning std::vector<Datetime>).
+static void BM_PackedTimesFilterByDatetimes(benchmark::State &state)
+{
+    const auto times = MyBench::makeShuffledTimes(1 << 20);
+    std::vector<Datetime> datetimes;
+    for (const auto &time : times)
+    {
+        datetimes.push_back(Datetime(time_t(time), true));
+    }
+    const Datetime from(2021, 2, 1, 0, 0, 0, true);
+    const Datetime to = from + 86400;
+    std::vector<size_t> rows;
+    for (auto _ : state)
+    {
+        rows.clear();
+        for (size_t i = 0; i < datetimes.size(); i++)
+        {
+            if (datetimes[i] >= from && datetimes[i] < to)
+            {
+                rows.push_back(i);
+            }
+        }
+        benchmark::DoNotOptimize(rows.data());
+    }
+    state.counters["rows"] = double(rows.size());
+    state.SetItemsProcessed(state.iterations() * times.size());
+}
+BENCHMARK(BM_PackedTimesFilterByDatetimes);
+
+// --------------------- Timer wheel --------------------- //
+
+// Session timeouts: each second, 1000 sessions start with a timeout of up to an hour, and 900 of the previous ones are cancelled (renewed).
+static void BM_TimerWheel(benchmark::State &state)
+{
+    const long long start = Datetime(2021, 1, 1, 0, 0, 0, true).unixTime();
+    TimerWheel<size_t> wheel(start);
+    std::vector<TimerWheel<size_t>::Id> ids;
+    std::vector<size_t> expired;
+    long long now = start;
+    size_t session = 0;
+    for (auto _ : state)
+    {
+        now++;
+        ids.clear();
+        for (size_t i = 0; i < 1000; i++, session++)
+        {
+            ids.push_back(wheel.insert(now + 60 + (long long)(session * 7919 % 3600), session));
+        }
+        for (size_t i = 0; i < 900; i++)
+        {
+            wheel.cancel(ids[i]);
+        }
+        expired.clear();
+        wheel.advance(now, expired);
+        benchmark::DoNotOptimize(expired.data());
+    }
+    state.counters["timers"] = double(wheel.size());
+    state.SetItemsProcessed(state.iterations() * 1000);
+}
+BENCHMARK(BM_TimerWheel);
+
+// Compare with BM_TimerWheel.
+static void BM_TimerWheelByMultimap(benchmark::State &state)
+{
+    const Datetime start(2021, 1, 1, 0, 0, 0, true);
+    std::multimap<Datetime, size_t> timers;
+    std::vector<std::multimap<Datetime, size_t>::iterator> ids;
+    std::vector<size_t> expired;
+    Datetime now = start;
+    size_t session = 0;
+    for (auto _ : state)
+    {
+        now = now + 1;
+        ids.clear();
+        for (size_t i = 0; i < 1000; i++, session++)
+        {
+            ids.push_back(timers.insert({now + 60 + (long long)(session * 7919 % 3600), session}));
+        }
+        for (size_t i = 0; i < 900; i++)
+        {
+            timers.erase(ids[i]);
+        }
+        expired.clear();
+        while (!timers.empty() && timers.begin()->first <= now)
+        {
+            expired.push_back(timers.begin()->second);
+            timers.erase(timers.begin());
+        }
+        benchmark::DoNotOptimize(expired.data());
+    }
+    state.counters["timers"] = double(timers.size());
+    state.SetItemsProcessed(state.iterations() * 1000);
+}
+BENCHMARK(BM_TimerWheelByMultimap);
+
+// --------------------- Current time --------------------- //
+
+static void BM_Now(benchmark::State &state)
+{
+    const bool isUTC = state.range(0);
+    state.SetLabel(isUTC ? "UTC" : "local");
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(Datetime::now(isUTC));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Now)->Arg(1)->Arg(0)->ThreadRange(1, 8);
+
+// Compare with BM_Now (UTC): the clocks of datetime_clock.h.
+template <class Clock>
+static void BM_NowByClock(benchmark::State &state)
+{
+    const Clock clock;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(Datetime::now(clock, true));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_NowByClock, SystemClock);
+BENCHMARK_TEMPLATE(BM_NowByClock, CoarseClock);
+BENCHMARK_TEMPLATE(BM_NowByClock, AnchoredClock);
+BENCHMARK_TEMPLATE(BM_NowByClock, ManualClock);
+
+// Timestamps of spans: unix nanoseconds.
+static void BM_NanosecondsBySystemClock(benchmark::State &state)
+{
+    const SystemClock clock;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(clock.unixNanoseconds());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_NanosecondsBySystemClock)->ThreadRange(1, 4);
+
+// Arg: 1 => the time stamp counter, 0 => std::chrono::steady_clock.
+static void BM_NanosecondsByAnchoredClock(benchmark::State &state)
+{
+    static AnchoredClock *clock = nullptr;
+    if (state.thread_index() == 0)
+    {
+        clock = new AnchoredClock(100000, 1000000000, state.range(0) != 0);
+    }
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(clock->unixNanoseconds());
+    }
+    if (state.thread_index() == 0)
+    {
+        state.counters["anchors"] = double(clock->numAnchors());
+        delete clock;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_NanosecondsByAnchoredClock)->Arg(1)->Arg(0)->ThreadRange(1, 4);
+
+BENCHMARK_MAIN();
@@ -56,14 +56,14 @@ int main()
 	// Example of exception.
 	try
 	{
-		// Year is Negative.
-		EZ::Datetime err = EZ::Datetime(-2000, -1, -1, 0, 0, 0);
+		// Month is Negative.
+		EZ::Datetime err = EZ::Datetime(2000, -1, -1, 0, 0, 0);
 	}
 	catch (EZ::DatetimeException e)
 	{
 		std::cout << "Error message: " << e.what() << std::endl;
 	}
-	// >> Error message: Input time is out of range. minimum datetime is 1970/01/01 09:00:00 JST
+	// >> Error message: Invalid input to mktime() !. Check input args.
 
 	return 0;
 }
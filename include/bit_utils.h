@@ -0,0 +1,126 @@
+#ifndef _MY_BIT_UTILS_
+#define _MY_BIT_UTILS_
+
+#include <stdint.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// 64ビット語のビット演算 (コンパイラの組み込み関数を使う)
+
+namespace EZ
+{
+    namespace Bits
+    {
+        /**
+        * 立っているビットの数 \n
+        * Number of set bits.
+        */
+        inline int popcount(const uint64_t &word)
+        {
+#if defined(_MSC_VER) && defined(_M_X64)
+            return int(__popcnt64(word));
+#elif (defined(__GNUC__) || defined(__clang__)) && defined(__POPCNT__)
+            return __builtin_popcountll(word);
+#else
+            // Without the POPCNT instruction, __builtin_popcountll() is a library call. Count by SWAR instead.
+            uint64_t x = word - ((word >> 1) & 0x5555555555555555ULL);
+            x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+            x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+            return int((x * 0x0101010101010101ULL) >> 56);
+#endif
+        }
+
+        /**
+        * 最下位の立っているビットの位置 (word が 0 なら 64) \n
+        * Position of the lowest set bit. 64 if word is 0.
+        */
+        inline int countTrailingZeros(const uint64_t &word)
+        {
+            if (word == 0)
+            {
+                return 64;
+            }
+#if defined(_MSC_VER) && defined(_M_X64)
+            unsigned long index;
+            _BitScanForward64(&index, word);
+            return int(index);
+#elif defined(__GNUC__) || defined(__clang__)
+            return __builtin_ctzll(word);
+#else
+            return popcount((word & (0 - word)) - 1);
+#endif
+        }
+
+        /**
+        * 最上位の立っているビットの位置 (word が 0 なら -1) \n
+        * Position of the highest set bit. -1 if word is 0.
+        */
+        inline int highestBit(const uint64_t &word)
+        {
+            if (word == 0)
+            {
+                return -1;
+            }
+#if defined(_MSC_VER) && defined(_M_X64)
+            unsigned long index;
+            _BitScanReverse64(&index, word);
+            return int(index);
+#elif defined(__GNUC__) || defined(__clang__)
+            return 63 - __builtin_clzll(word);
+#else
+            int position = 0;
+            for (uint64_t x = word; x > 1; x >>= 1)
+            {
+                position++;
+            }
+            return position;
+#endif
+        }
+
+        /**
+        * 下から rank 番目 (0 始まり) の立っているビットの位置 (なければ 64) \n
+        * Position of the rank-th (0-based) set bit from the bottom. 64 if there is none.
+        */
+        inline int selectBit(const uint64_t &word, int rank)
+        {
+            // Without branches (broadword selection):
+            // prefix sums of the popcounts of the bytes find the byte, then halves of the byte find the bit.
+            const uint64_t ONES = 0x0101010101010101ULL;
+            const uint64_t HIGHS = 0x8080808080808080ULL;
+            uint64_t x = word - ((word >> 1) & 0x5555555555555555ULL);
+            x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+            x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+            const uint64_t prefix = x * ONES; // byte i: count in bytes 0 ~ i (<= 64)
+            if (rank < 0 || rank >= int(prefix >> 56))
+            {
+                return 64;
+            }
+            // Bytes whose prefix is <= rank precede the byte of the bit.
+            const uint64_t before = (((uint64_t(rank) * ONES) | HIGHS) - prefix) & HIGHS;
+            int shift = int((((before >> 7) * ONES) >> 56) * 8);
+            rank -= int(((prefix << 8) >> shift) & 0xFF);
+            uint64_t bits = word >> shift;
+            const int nibble = int((0x4332322132212110ULL >> ((bits & 0xF) * 4)) & 0xF);
+            const int high4 = rank >= nibble ? 4 : 0;
+            rank -= rank >= nibble ? nibble : 0;
+            bits >>= high4;
+            const int pair = int((bits & 1) + ((bits >> 1) & 1));
+            const int high2 = rank >= pair ? 2 : 0;
+            rank -= rank >= pair ? pair : 0;
+            bits >>= high2;
+            const int high1 = rank >= int(bits & 1) ? 1 : 0;
+            return shift + high4 + high2 + high1;
+        }
+
+        /**
+        * 下位 n ビット (0 ~ 64) が立った語 \n
+        * Word with the lowest n bits (0 ~ 64) set.
+        */
+        inline uint64_t lowMask(const int &n)
+        {
+            return n >= 64 ? ~uint64_t(0) : (uint64_t(1) << n) - 1;
+        }
+    }
+}
+#endif
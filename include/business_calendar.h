@@ -0,0 +1,354 @@
+#ifndef _MY_BUSINESS_CALENDAR_
+#define _MY_BUSINESS_CALENDAR_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <set>
+#include <vector>
+#include <algorithm>
+
+#include "datetime.h"
+#include "calendar.h"
+#include "bit_utils.h"
+#include "datetime_exceptions.h"
+
+// 営業日の暦。週末 (曜日のマスク) と休日 (日付の集合) から営業日を判定し、営業日を数える。
+// 仕様: 休日のある年の範囲は営業日を1日1ビットで持ち、64日ごとの累積数 (rank) と popcount で O(1) で数える。
+// 範囲の外は週末だけなので、週の周期から計算する。n 営業日後は、およその日から累積数を指数探索と二分探索で求め、ビットを選択する。
+
+namespace EZ
+{
+    /**
+    * @brief Business-day calendar
+    * @details Weekends (a mask of weekdays) and holidays (dates on the local calendar). \n
+    * Days are counted with bitmaps and popcount, not by stepping one day at a time. \n
+    * ex: \n
+    * EZ::BusinessCalendar calendar; \n
+    * calendar.addHoliday(2021, 1, 1); \n
+    * calendar.addBusinessDays(tradeDate, 2); // T+2
+    */
+    class BusinessCalendar
+    {
+    public:
+        /**
+        * 週末の曜日のビット (Datetime::daysOfWeek() の値 w のビットは 1 << w) \n
+        * Bits of weekdays for the weekend mask. The bit of Datetime::daysOfWeek() == w is 1 << w.
+        */
+        enum Weekday
+        {
+            SUNDAY = 1 << 0,
+            MONDAY = 1 << 1,
+            TUESDAY = 1 << 2,
+            WEDNESDAY = 1 << 3,
+            THURSDAY = 1 << 4,
+            FRIDAY = 1 << 5,
+            SATURDAY = 1 << 6,
+        };
+
+        // 休日を置ける年の幅 (ビットマップの大きさの上限)
+        static const long long MAXIMUM_HOLIDAY_YEARS = 10000;
+
+        /**
+        * @param[in] weekendMask=SATURDAY|SUNDAY	ex: Friday and Saturday => BusinessCalendar::FRIDAY | BusinessCalendar::SATURDAY
+        * @details Throw DatetimeException if every day of the week is in the weekend.
+        */
+        BusinessCalendar(const int &weekendMask = SATURDAY | SUNDAY)
+            : m_weekendMask(weekendMask & 0x7F), m_businessPerWeek(0), m_spanFirst(0), m_spanRank(0),
+              m_spanBusinessDays(0), m_holidayWeekdays(0)
+        {
+            for (int i = 0; i < 7; i++)
+            {
+                // Day 0 (1970/1/1) is Thursday.
+                m_weekRank[i] = m_businessPerWeek;
+                if (!isWeekendDay(i))
+                {
+                    m_weekSelect[m_businessPerWeek++] = i;
+                }
+            }
+            m_weekRank[7] = m_businessPerWeek;
+            if (m_businessPerWeek == 0)
+            {
+                throw DatetimeException("ERROR: A week must have a business day.");
+            }
+        }
+
+        int weekendMask() const
+        {
+            return m_weekendMask;
+        }
+
+        /**
+        * 休日を追加する (日付は現地時刻の暦) \n
+        * Add a holiday. A holiday on the weekend changes nothing.
+        */
+        void addHoliday(const long long &year, const int &mon, const int &day)
+        {
+            auto holidays = m_holidays;
+            holidays.insert(daysOf(year, mon, day));
+            rebuild(holidays);
+        }
+        void addHoliday(const Datetime &date)
+        {
+            addHolidays({date});
+        }
+        /**
+        * 休日をまとめて追加する (ビットマップの作り直しは1回) \n
+        * Add holidays at once. The bitmaps are rebuilt only once.
+        */
+        void addHolidays(const std::vector<Datetime> &dates)
+        {
+            auto holidays = m_holidays;
+            for (const auto &date : dates)
+            {
+                holidays.insert(localDays(date));
+            }
+            rebuild(holidays);
+        }
+        void removeHoliday(const Datetime &date)
+        {
+            auto holidays = m_holidays;
+            holidays.erase(localDays(date));
+            rebuild(holidays);
+        }
+        bool isHoliday(const Datetime &date) const
+        {
+            return m_holidays.count(localDays(date)) > 0;
+        }
+
+        /**
+        * 営業日 (週末でも休日でもない日) なら true \n
+        * true if the local date is neither a weekend nor a holiday.
+        */
+        bool isBusinessDay(const Datetime &date) const
+        {
+            return isBusinessDayOf(localDays(date));
+        }
+
+        /**
+        * n 営業日後 (n < 0 なら前) の日時を返却する。時刻は保たれる。 \n
+        * Return the Datetime n business days after date (before if n < 0). The time of day is kept.
+        * @details A date that is not a business day is first moved forward to the next business day. \n
+        * ex: (Saturday, 0) => Monday, (Saturday, 1) => Tuesday, (Saturday, -1) => Friday
+        */
+        Datetime addBusinessDays(const Datetime &date, const long long &n) const
+        {
+            Calendar::Detail::checkDays(n);
+            const long long days = localDays(date);
+            return date.addDays(selectDay(rankOf(days) + n, days + n * 7 / m_businessPerWeek) - days);
+        }
+
+        /**
+        * from の日付から to の日付の前日までの営業日数 (to < from なら負) \n
+        * Number of business days in [from, to) by local dates. Negative if to is before from.
+        */
+        long long businessDaysBetween(const Datetime &from, const Datetime &to) const
+        {
+            return rankOf(localDays(to)) - rankOf(localDays(from));
+        }
+
+        /**
+        * Unix秒の配列が営業日か判定する (日付は utcOffset の暦) \n
+        * Judge if each of an array of unix seconds is on a business day of the calendar with a fixed UTC offset.
+        */
+        void isBusinessDay(const long long *unixTimes, const size_t &count, bool *out, const long long &utcOffset = 0) const
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                out[i] = isBusinessDayOf(MyTM::floorDiv(unixTimes[i] + utcOffset, DatetimeConstants::SECONDS_PER_DAY));
+            }
+        }
+        /**
+        * Unix秒の配列に n 営業日を加算する。out は unixTimes と同じでもよい。 \n
+        * Add n business days to an array of unix seconds. out may be the same array as unixTimes.
+        * @details Throw DatetimeException if a result is out of range.
+        */
+        void addBusinessDays(const long long *unixTimes, const size_t &count, const long long &n, long long *out,
+                             const long long &utcOffset = 0) const
+        {
+            Calendar::Detail::checkDays(n);
+            const long long distance = n * 7 / m_businessPerWeek;
+            Calendar::Detail::transform(unixTimes, count, out, [&](const long long &unixTime) {
+                const long long local = unixTime + utcOffset;
+                const long long days = MyTM::floorDiv(local, DatetimeConstants::SECONDS_PER_DAY);
+                return unixTime + (selectDay(rankOf(days) + n, days + distance) - days) * DatetimeConstants::SECONDS_PER_DAY;
+            });
+        }
+        /**
+        * 営業日数の配列版 (out[i] は [from[i], to[i]) の営業日数) \n
+        * Array version of businessDaysBetween().
+        */
+        void businessDaysBetween(const long long *from, const long long *to, const size_t &count, long long *out,
+                                 const long long &utcOffset = 0) const
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                out[i] = rankOf(MyTM::floorDiv(to[i] + utcOffset, DatetimeConstants::SECONDS_PER_DAY)) -
+                         rankOf(MyTM::floorDiv(from[i] + utcOffset, DatetimeConstants::SECONDS_PER_DAY));
+            }
+        }
+
+    private:
+        int m_weekendMask;
+        // 1970/1/1 (木曜) から始まる7日間の、先頭から i 日前までの営業日数と、r 番目の営業日の位置
+        long long m_businessPerWeek;
+        long long m_weekRank[8];
+        int m_weekSelect[7];
+
+        std::set<long long> m_holidays; // 1970/1/1 からの通算日数
+        // 休日のある年の範囲 [m_spanFirst, m_spanFirst + 64 * m_bits.size())
+        long long m_spanFirst;
+        std::vector<uint64_t> m_bits;   // 営業日なら 1
+        std::vector<long long> m_ranks; // m_bits[w] より前の営業日数
+        long long m_spanRank;           // m_spanFirst より前の営業日数
+        long long m_spanBusinessDays;
+        long long m_holidayWeekdays; // 週末でない休日の数
+
+        static long long localDays(const Datetime &date)
+        {
+            const auto tmpTm = date.structTm();
+            return MyTM::daysFromCivil((long long)tmpTm.tm_year + DatetimeConstants::TM_BASE_YEAR,
+                                       tmpTm.tm_mon + DatetimeConstants::MONTH_OFFSET, tmpTm.tm_mday);
+        }
+
+        static long long daysOf(const long long &year, const int &mon, const int &day)
+        {
+            if (year < DatetimeConstants::MINIMUM_YEAR || year > DatetimeConstants::MAXIMUM_YEAR ||
+                mon < 1 || mon > 12 || day < 1 || day > MyTM::daysInMonth(year, mon))
+            {
+                throw DatetimeException("ERROR: The holiday is not a valid date.");
+            }
+            return MyTM::daysFromCivil(year, mon, day);
+        }
+
+        // offset は 1970/1/1 を起点とする曜日の位置 (0 = 木曜)
+        bool isWeekendDay(const long long &offset) const
+        {
+            return (m_weekendMask >> ((offset + 4) % 7)) & 1;
+        }
+
+        // 休日を考えない、[0, days) の営業日数
+        long long weekRank(const long long &days) const
+        {
+            const long long weeks = MyTM::floorDiv(days, 7);
+            return weeks * m_businessPerWeek + m_weekRank[days - weeks * 7];
+        }
+        // 休日を考えない、rank 番目の営業日
+        long long weekSelect(const long long &rank) const
+        {
+            const long long weeks = MyTM::floorDiv(rank, m_businessPerWeek);
+            return weeks * 7 + m_weekSelect[rank - weeks * m_businessPerWeek];
+        }
+
+        long long spanEnd() const
+        {
+            return m_spanFirst + 64 * (long long)m_bits.size();
+        }
+
+        bool isBusinessDayOf(const long long &days) const
+        {
+            if (days >= m_spanFirst && days < spanEnd())
+            {
+                const long long offset = days - m_spanFirst;
+                return (m_bits[offset >> 6] >> (offset & 63)) & 1;
+            }
+            return !isWeekendDay(days - MyTM::floorDiv(days, 7) * 7);
+        }
+
+        // [0, days) の営業日数 (days < 0 なら負)。営業日 d は rankOf(d) 番目の営業日。
+        long long rankOf(const long long &days) const
+        {
+            if (days <= m_spanFirst)
+            {
+                return weekRank(days);
+            }
+            if (days >= spanEnd())
+            {
+                return weekRank(days) - m_holidayWeekdays;
+            }
+            const long long offset = days - m_spanFirst;
+            const size_t word = size_t(offset >> 6);
+            return m_spanRank + m_ranks[word] + Bits::popcount(m_bits[word] & Bits::lowMask(int(offset & 63)));
+        }
+
+        // rank 番目の営業日。hint はその近くの日 (ビットマップを探し始める位置)。
+        long long selectDay(const long long &rank, const long long &hint) const
+        {
+            if (rank < m_spanRank)
+            {
+                return weekSelect(rank);
+            }
+            if (rank >= m_spanRank + m_spanBusinessDays)
+            {
+                return weekSelect(rank + m_holidayWeekdays);
+            }
+            const long long inSpan = rank - m_spanRank;
+            // Gallop from the word of the hint, then binary search the bracket: O(1) when the hint is
+            // close, O(log distance) otherwise. word is the last one with m_ranks[word] <= inSpan.
+            const long long last = (long long)m_ranks.size() - 1;
+            const long long guess = std::min(std::max((hint - m_spanFirst) >> 6, 0LL), last);
+            long long low = guess, high = guess + 1; // m_ranks[low] <= inSpan < m_ranks[high] (high may be last + 1)
+            for (long long step = 1; high <= last && m_ranks[size_t(high)] <= inSpan; step *= 2)
+            {
+                low = high;
+                high = std::min(high + step, last + 1);
+            }
+            for (long long step = 1; m_ranks[size_t(low)] > inSpan; step *= 2)
+            {
+                high = low;
+                low = std::max(low - step, 0LL);
+            }
+            const size_t word = size_t(std::upper_bound(m_ranks.begin() + low + 1, m_ranks.begin() + high, inSpan) - m_ranks.begin() - 1);
+            return m_spanFirst + 64 * (long long)word + Bits::selectBit(m_bits[word], int(inSpan - m_ranks[word]));
+        }
+
+        // 休日を置き換え、休日のある年の範囲のビットマップと累積数を作り直す
+        void rebuild(const std::set<long long> &holidays)
+        {
+            long long firstYear = 0, lastYear = 0;
+            int mon, day;
+            if (!holidays.empty())
+            {
+                MyTM::civilFromDays(*holidays.begin(), firstYear, mon, day);
+                MyTM::civilFromDays(*holidays.rbegin(), lastYear, mon, day);
+                if (lastYear - firstYear >= MAXIMUM_HOLIDAY_YEARS)
+                {
+                    throw DatetimeException("ERROR: The holidays span too many years.");
+                }
+            }
+            m_holidays = holidays;
+            m_bits.clear();
+            m_ranks.clear();
+            m_spanFirst = m_spanRank = m_spanBusinessDays = m_holidayWeekdays = 0;
+            if (m_holidays.empty())
+            {
+                return;
+            }
+            // Whole years, so that the bitmap of a year does not change when a holiday is added to it.
+            m_spanFirst = MyTM::daysFromCivil(firstYear, 1, 1);
+            const long long spanDays = MyTM::daysFromCivil(lastYear + 1, 1, 1) - m_spanFirst;
+            m_bits.assign(size_t((spanDays + 63) / 64), 0);
+            // The padding of the last word follows the weekends.
+            for (long long offset = 0; offset < 64 * (long long)m_bits.size(); offset++)
+            {
+                const long long days = m_spanFirst + offset;
+                const bool business = !isWeekendDay(days - MyTM::floorDiv(days, 7) * 7);
+                m_bits[size_t(offset >> 6)] |= uint64_t(business) << (offset & 63);
+            }
+            for (const auto &holiday : m_holidays)
+            {
+                const long long offset = holiday - m_spanFirst;
+                const uint64_t bit = uint64_t(1) << (offset & 63);
+                m_holidayWeekdays += (m_bits[size_t(offset >> 6)] & bit) ? 1 : 0;
+                m_bits[size_t(offset >> 6)] &= ~bit;
+            }
+            m_ranks.resize(m_bits.size());
+            for (size_t w = 0; w < m_bits.size(); w++)
+            {
+                m_ranks[w] = m_spanBusinessDays;
+                m_spanBusinessDays += Bits::popcount(m_bits[w]);
+            }
+            m_spanRank = weekRank(m_spanFirst);
+        }
+    };
+}
+#endif
@@ -0,0 +1,541 @@
+#ifndef _MY_CALENDAR_
+#define _MY_CALENDAR_
+
+#include <stddef.h>
+
+#include "datetime_constants.h"
+#include "datetime_exceptions.h"
+#include "unix_time.h"
+
+// 暦に基づく演算 (月・年の加算、月初・月末、ISO週番号、暦の単位への丸め) を整数演算だけで行う。mktime() は使わない。
+// 仕様: 配列版は固定のUTCオフセット (秒、東が正) の暦で計算する。現地時刻のサマータイムは Datetime 側で扱う。
+
+namespace EZ
+{
+    namespace Calendar
+    {
+        /**
+        * 加算後の月にその日が存在しない場合の扱い \n
+        * How to handle a day that does not exist in the resulting month.
+        */
+        enum MonthPolicy
+        {
+            // 月末に丸める ex: 1/31 + 1 month => 2/28
+            // Clamp to the last day of the month.
+            CLAMP,
+            // 翌月に繰り越す ex: 1/31 + 1 month => 3/3
+            // Carry the excess days into the next month.
+            CARRY_OVER,
+            // 月末は月末のまま、それ以外は CLAMP ex: 2/28 + 1 month => 3/31
+            // The last day of a month stays the last day of the month, otherwise CLAMP.
+            KEEP_END_OF_MONTH,
+        };
+
+        // 加算できる月数の上限 (扱える年の範囲)
+        const long long MAXIMUM_MONTHS = (DatetimeConstants::MAXIMUM_YEAR - DatetimeConstants::MINIMUM_YEAR) * 12;
+        // 加算できる日数の上限 (扱える日時の範囲)
+        const long long MAXIMUM_DAYS = (DatetimeConstants::MAXIMUM_SEC - DatetimeConstants::MINIMUM_SEC) / DatetimeConstants::SECONDS_PER_DAY + 1;
+
+        /**
+        * 1970/1/1 からの通算日数に月数を加算する \n
+        * Add months to the number of days since 1970/1/1.
+        */
+        inline long long addMonthsToDays(const long long &days, const long long &months, const MonthPolicy &policy = CLAMP)
+        {
+            long long year;
+            int mon, day;
+            MyTM::civilFromDays(days, year, mon, day);
+            const long long totalMonths = year * 12 + (mon - 1) + months;
+            const long long newYear = MyTM::floorDiv(totalMonths, 12);
+            const int newMon = int(totalMonths - newYear * 12) + 1;
+            const int lastDay = MyTM::daysInMonth(newYear, newMon);
+            int newDay = day < lastDay ? day : lastDay;
+            if (policy == CARRY_OVER)
+            {
+                newDay = day;
+            }
+            else if (policy == KEEP_END_OF_MONTH && day == MyTM::daysInMonth(year, mon))
+            {
+                newDay = lastDay;
+            }
+            // daysFromCivil() accepts days beyond the end of the month. (CARRY_OVER)
+            return MyTM::daysFromCivil(newYear, newMon, 1) + newDay - 1;
+        }
+
+        /**
+        * 月初 (1日) の通算日数を返す \n
+        * Return the first day of the month as the number of days since 1970/1/1.
+        */
+        inline long long startOfMonthDays(const long long &days)
+        {
+            long long year;
+            int mon, day;
+            MyTM::civilFromDays(days, year, mon, day);
+            return days - (day - 1);
+        }
+
+        /**
+        * 月末の通算日数を返す \n
+        * Return the last day of the month as the number of days since 1970/1/1.
+        */
+        inline long long endOfMonthDays(const long long &days)
+        {
+            long long year;
+            int mon, day;
+            MyTM::civilFromDays(days, year, mon, day);
+            return days + (MyTM::daysInMonth(year, mon) - day);
+        }
+
+        /**
+        * Unix秒 (utcOffset の暦) に月数を加算する。時刻は保たれる。 \n
+        * Add months to unix seconds on the calendar of utcOffset. The time of day is kept.
+        */
+        inline long long addMonths(const long long &unixTime, const long long &months,
+                                   const MonthPolicy &policy = CLAMP, const long long &utcOffset = 0)
+        {
+            const long long local = unixTime + utcOffset;
+            const long long days = MyTM::floorDiv(local, DatetimeConstants::SECONDS_PER_DAY);
+            const long long secOfDay = local - days * DatetimeConstants::SECONDS_PER_DAY;
+            return addMonthsToDays(days, months, policy) * DatetimeConstants::SECONDS_PER_DAY + secOfDay - utcOffset;
+        }
+
+        /**
+        * 月初 0:00:00 のUnix秒を返す \n
+        * Return unix seconds at 00:00:00 on the first day of the month.
+        */
+        inline long long startOfMonth(const long long &unixTime, const long long &utcOffset = 0)
+        {
+            const long long days = MyTM::floorDiv(unixTime + utcOffset, DatetimeConstants::SECONDS_PER_DAY);
+            return startOfMonthDays(days) * DatetimeConstants::SECONDS_PER_DAY - utcOffset;
+        }
+
+        /**
+        * 月末 23:59:59 のUnix秒を返す \n
+        * Return unix seconds at 23:59:59 on the last day of the month.
+        */
+        inline long long endOfMonth(const long long &unixTime, const long long &utcOffset = 0)
+        {
+            const long long days = MyTM::floorDiv(unixTime + utcOffset, DatetimeConstants::SECONDS_PER_DAY);
+            return (endOfMonthDays(days) + 1) * DatetimeConstants::SECONDS_PER_DAY - 1 - utcOffset;
+        }
+
+        namespace Detail
+        {
+            // 400年周期 (146097日 = 20871週) の整数倍だけずらし、除算を非負の範囲で行う (負の数の補正が不要になる)
+            // Shift by whole 400-year cycles (also whole weeks) so that divisions work on non-negative values.
+            const long long SHIFT_CYCLES = 5400000;
+            const long long SHIFT_DAYS = SHIFT_CYCLES * DatetimeConstants::DAYS_PER_400_YEARS;
+            const long long SHIFT_SECONDS = SHIFT_DAYS * DatetimeConstants::SECONDS_PER_DAY;
+
+            // Unix秒を通算日数 (SHIFT_DAYS だけずらした値) にする
+            inline long long shiftedDays(const long long &unixTime, const long long &utcOffset)
+            {
+                return (unixTime + utcOffset + SHIFT_SECONDS) / DatetimeConstants::SECONDS_PER_DAY;
+            }
+
+            // 分岐なしのISO週日付。shifted は SHIFT_DAYS だけずらした通算日数 (非負)。
+            // The ISO week belongs to the year of its Thursday. (civil_from_days for the Thursday)
+            inline void isoWeekDateOfShifted(const long long &shifted, long long &isoYear, int &week, int &weekday)
+            {
+                // 1970/1/1 is Thursday.
+                weekday = int((shifted + 3) % 7) + 1;
+                const long long z = shifted + 4 - weekday + 719468;
+                const long long era = z / DatetimeConstants::DAYS_PER_400_YEARS;
+                const long long doe = z - era * DatetimeConstants::DAYS_PER_400_YEARS;
+                const long long yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+                const long long doy = doe - (365 * yoe + yoe / 4 - yoe / 100); // [0, 365] from March 1
+                const long long leap = (yoe % 4 == 0) & ((yoe % 100 != 0) | (yoe == 0));
+                const long long janFeb = (doy >= 306);
+                const long long dayOfYear = janFeb ? doy - 306 : doy + 59 + leap; // [0, 365] from January 1
+                isoYear = yoe + era * 400 + janFeb - SHIFT_CYCLES * 400;
+                week = int(dayOfYear / 7) + 1;
+            }
+        }
+
+        /**
+        * 1970/1/1 からの通算日数をISO週日付 (ISO 8601) に変換する \n
+        * Convert the number of days since 1970/1/1 to the ISO 8601 week date.
+        * @param[out] isoYear ISO week-year (differs from the calendar year around January 1)
+        * @param[out] week 1 ~ 53
+        * @param[out] weekday 1 => Monday, ..., 7 => Sunday
+        */
+        inline void isoWeekDate(const long long &days, long long &isoYear, int &week, int &weekday)
+        {
+            Detail::isoWeekDateOfShifted(days + Detail::SHIFT_DAYS, isoYear, week, weekday);
+        }
+
+        /**
+        * ISO週年の週数 (52 または 53) を返す \n
+        * Return the number of weeks in the ISO week-year. (52 or 53)
+        */
+        inline int isoWeeksInYear(const long long &isoYear)
+        {
+            // December 28 is always in the last week.
+            long long year;
+            int week, weekday;
+            isoWeekDate(MyTM::daysFromCivil(isoYear, 12, 28), year, week, weekday);
+            return week;
+        }
+
+        /**
+        * ISO週日付を 1970/1/1 からの通算日数に変換する (範囲は検証しない) \n
+        * Convert the ISO 8601 week date to the number of days since 1970/1/1. (No range check)
+        */
+        inline long long daysFromIsoWeekDate(const long long &isoYear, const int &week, const int &weekday)
+        {
+            // Week 1 contains January 4.
+            const long long jan4 = MyTM::daysFromCivil(isoYear, 1, 4);
+            const long long monday = jan4 - (jan4 + 3 - MyTM::floorDiv(jan4 + 3, 7) * 7);
+            return monday + (week - 1) * 7LL + (weekday - 1);
+        }
+
+        namespace Detail
+        {
+            inline void checkMonths(const long long &months)
+            {
+                if (months < -MAXIMUM_MONTHS || months > MAXIMUM_MONTHS)
+                {
+                    throw DatetimeException("ERROR: The number of months is out of range.");
+                }
+            }
+
+            inline void checkDays(const long long &days)
+            {
+                if (days < -MAXIMUM_DAYS || days > MAXIMUM_DAYS)
+                {
+                    throw DatetimeException("ERROR: The number of days is out of range.");
+                }
+            }
+
+            // 配列版の結果の範囲を確認する (ループ内では分岐せず、最小値と最大値だけを見る)
+            inline void checkRange(const long long &minimum, const long long &maximum)
+            {
+                if (minimum < DatetimeConstants::MINIMUM_SEC || maximum > DatetimeConstants::MAXIMUM_SEC)
+                {
+                    throw DatetimeException("ERROR: The result is out of range.");
+                }
+            }
+
+            template <class F>
+            inline void transform(const long long *unixTimes, const size_t &count, long long *out, F f)
+            {
+                long long minimum = DatetimeConstants::MAXIMUM_SEC;
+                long long maximum = DatetimeConstants::MINIMUM_SEC;
+                for (size_t i = 0; i < count; i++)
+                {
+                    const long long value = f(unixTimes[i]);
+                    out[i] = value;
+                    minimum = value < minimum ? value : minimum;
+                    maximum = value > maximum ? value : maximum;
+                }
+                checkRange(minimum, maximum);
+            }
+        }
+
+        /**
+        * Unix秒の配列に月数を加算する。out は unixTimes と同じでもよい。 \n
+        * Add months to an array of unix seconds. out may be the same array as unixTimes.
+        * @details Throw DatetimeException if a result is out of range.
+        */
+        inline void addMonths(const long long *unixTimes, const size_t &count, const long long &months, long long *out,
+                              const MonthPolicy &policy = CLAMP, const long long &utcOffset = 0)
+        {
+            Detail::checkMonths(months);
+            Detail::transform(unixTimes, count, out, [&](const long long &unixTime) {
+                return addMonths(unixTime, months, policy, utcOffset);
+            });
+        }
+
+        /**
+        * Unix秒の配列に年数を加算する (2/29 は policy に従う) \n
+        * Add years to an array of unix seconds. (Feb 29 follows the policy)
+        */
+        inline void addYears(const long long *unixTimes, const size_t &count, const long long &years, long long *out,
+                             const MonthPolicy &policy = CLAMP, const long long &utcOffset = 0)
+        {
+            Detail::checkMonths(years);
+            addMonths(unixTimes, count, years * 12, out, policy, utcOffset);
+        }
+
+        /**
+        * Unix秒の配列をそれぞれ月初 0:00:00 にする \n
+        * Set each element to 00:00:00 on the first day of its month.
+        */
+        inline void startOfMonth(const long long *unixTimes, const size_t &count, long long *out, const long long &utcOffset = 0)
+        {
+            Detail::transform(unixTimes, count, out, [&](const long long &unixTime) {
+                return startOfMonth(unixTime, utcOffset);
+            });
+        }
+
+        /**
+        * Unix秒の配列をそれぞれ月末 23:59:59 にする \n
+        * Set each element to 23:59:59 on the last day of its month.
+        */
+        inline void endOfMonth(const long long *unixTimes, const size_t &count, long long *out, const long long &utcOffset = 0)
+        {
+            Detail::transform(unixTimes, count, out, [&](const long long &unixTime) {
+                return endOfMonth(unixTime, utcOffset);
+            });
+        }
+
+        /**
+        * Unix秒の配列をISO週年と週番号に変換する (分岐なし) \n
+        * Convert an array of unix seconds to ISO week-years and week numbers. (Branch-free)
+        * @param[out] isoYears, weeks arrays of count elements
+        */
+        inline void isoWeeks(const long long *unixTimes, const size_t &count, long long *isoYears, int *weeks, const long long &utcOffset = 0)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                int weekday;
+                Detail::isoWeekDateOfShifted(Detail::shiftedDays(unixTimes[i], utcOffset), isoYears[i], weeks[i], weekday);
+            }
+        }
+
+        /**
+        * Unix秒の配列をそれぞれISO週の始まり (月曜 0:00:00) にする。週単位の集計のキーになる。 \n
+        * Set each element to 00:00:00 on Monday of its ISO week. Useful as the key of weekly rollups.
+        */
+        inline void isoWeekStarts(const long long *unixTimes, const size_t &count, long long *out, const long long &utcOffset = 0)
+        {
+            Detail::transform(unixTimes, count, out, [&](const long long &unixTime) {
+                const long long shifted = Detail::shiftedDays(unixTime, utcOffset);
+                const long long monday = shifted - (shifted + 3) % 7 - Detail::SHIFT_DAYS;
+                return monday * DatetimeConstants::SECONDS_PER_DAY - utcOffset;
+            });
+        }
+
+        /**
+        * 丸めの単位 \n
+        * Calendar unit of floorTo(), ceilTo() and roundTo().
+        */
+        enum Unit
+        {
+            SECOND,
+            MINUTE,
+            HOUR,
+            DAY,
+            // 月曜始まり (ISO 8601)
+            // Weeks start on Monday. (ISO 8601)
+            WEEK,
+            MONTH,
+            YEAR,
+        };
+
+        namespace Detail
+        {
+            // 月曜 1969/12/29 を週の起点にする
+            const long long WEEK_ORIGIN = -3 * DatetimeConstants::SECONDS_PER_DAY;
+
+            // 固定長の単位の秒数。MONTH, YEAR は 0 を返す。
+            inline long long unitSeconds(const Unit &unit)
+            {
+                switch (unit)
+                {
+                case SECOND:
+                    return 1;
+                case MINUTE:
+                    return 60;
+                case HOUR:
+                    return 3600;
+                case DAY:
+                    return DatetimeConstants::SECONDS_PER_DAY;
+                case WEEK:
+                    return 7 * DatetimeConstants::SECONDS_PER_DAY;
+                default:
+                    return 0;
+                }
+            }
+
+            inline void checkUnit(const Unit &unit, const long long &multiple)
+            {
+                if (unit < SECOND || unit > YEAR)
+                {
+                    throw DatetimeException("ERROR: Invalid calendar unit.");
+                }
+                // Multiples of weeks/days beyond the range would overflow the number of seconds.
+                if (multiple < 1 || multiple > MAXIMUM_MONTHS)
+                {
+                    throw DatetimeException("ERROR: The multiple of the unit must be positive.");
+                }
+            }
+
+            // unixTime を含む区間 [lower, upper) を求める (multiple 単位の境界)
+            inline void unitBounds(const long long &unixTime, const Unit &unit, const long long &multiple, const long long &utcOffset,
+                                   long long &lower, long long &upper)
+            {
+                const long long local = unixTime + utcOffset;
+                const long long step = unitSeconds(unit) * multiple;
+                if (step > 0)
+                {
+                    const long long origin = (unit == WEEK) ? WEEK_ORIGIN : 0;
+                    lower = origin + MyTM::floorDiv(local - origin, step) * step - utcOffset;
+                    upper = lower + step;
+                    return;
+                }
+                long long year;
+                int mon, day;
+                MyTM::civilFromDays(MyTM::floorDiv(local, DatetimeConstants::SECONDS_PER_DAY), year, mon, day);
+                // Months since 0000/01 (a multiple of 12 months is aligned to years).
+                const long long months = (unit == YEAR) ? multiple * 12 : multiple;
+                const long long index = (unit == YEAR) ? MyTM::floorDiv(year, multiple) * months
+                                                       : MyTM::floorDiv(year * 12 + (mon - 1), months) * months;
+                const long long lowerYear = MyTM::floorDiv(index, 12);
+                const long long upperYear = MyTM::floorDiv(index + months, 12);
+                lower = MyTM::daysFromCivil(lowerYear, int(index - lowerYear * 12) + 1, 1) * DatetimeConstants::SECONDS_PER_DAY - utcOffset;
+                upper = MyTM::daysFromCivil(upperYear, int(index + months - upperYear * 12) + 1, 1) * DatetimeConstants::SECONDS_PER_DAY - utcOffset;
+            }
+
+            enum RoundMode
+            {
+                ROUND_FLOOR,
+                ROUND_CEIL,
+                ROUND_NEAREST,
+            };
+
+            inline long long roundToUnit(const long long &unixTime, const Unit &unit, const long long &multiple, const long long &utcOffset, const RoundMode &mode)
+            {
+                long long lower, upper;
+                unitBounds(unixTime, unit, multiple, utcOffset, lower, upper);
+                if (mode == ROUND_FLOOR || unixTime == lower)
+                {
+                    return lower;
+                }
+                if (mode == ROUND_CEIL)
+                {
+                    return upper;
+                }
+                // Half way rounds up.
+                return (unixTime - lower >= upper - unixTime) ? upper : lower;
+            }
+
+            // 固定長の単位の配列版 (分岐なし)。STEP が 0 でなければコンパイル時定数で割る。
+            // Values are shifted by a multiple of step so that % works on non-negative values.
+            template <RoundMode MODE, long long STEP>
+            inline void roundFixed(const long long *unixTimes, const size_t &count, long long *out,
+                                   const long long &runtimeStep, const long long &origin, const long long &utcOffset)
+            {
+                const long long step = STEP ? STEP : runtimeStep;
+                const long long shift = (SHIFT_SECONDS / step + 1) * step;
+                const long long base = utcOffset - origin + shift;
+                long long minimum = DatetimeConstants::MAXIMUM_SEC;
+                long long maximum = DatetimeConstants::MINIMUM_SEC;
+                for (size_t i = 0; i < count; i++)
+                {
+                    const long long x = unixTimes[i] + base;
+                    const long long r = x % step;
+                    long long value = x - r - base;
+                    if (MODE == ROUND_CEIL)
+                    {
+                        value += (r != 0) * step;
+                    }
+                    else if (MODE == ROUND_NEAREST)
+                    {
+                        value += (2 * r >= step) * step;
+                    }
+                    out[i] = value;
+                    minimum = value < minimum ? value : minimum;
+                    maximum = value > maximum ? value : maximum;
+                }
+                checkRange(minimum, maximum);
+            }
+
+            template <RoundMode MODE>
+            inline void roundArray(const long long *unixTimes, const size_t &count, long long *out,
+                                   const Unit &unit, const long long &multiple, const long long &utcOffset)
+            {
+                checkUnit(unit, multiple);
+                const long long step = unitSeconds(unit) * multiple;
+                if (step == 0)
+                {
+                    transform(unixTimes, count, out, [&](const long long &unixTime) {
+                        return roundToUnit(unixTime, unit, multiple, utcOffset, MODE);
+                    });
+                    return;
+                }
+                const long long origin = (unit == WEEK) ? WEEK_ORIGIN : 0;
+                if (multiple > 1)
+                {
+                    roundFixed<MODE, 0>(unixTimes, count, out, step, origin, utcOffset);
+                    return;
+                }
+                switch (unit)
+                {
+                case SECOND:
+                    roundFixed<MODE, 1>(unixTimes, count, out, step, origin, utcOffset);
+                    return;
+                case MINUTE:
+                    roundFixed<MODE, 60>(unixTimes, count, out, step, origin, utcOffset);
+                    return;
+                case HOUR:
+                    roundFixed<MODE, 3600>(unixTimes, count, out, step, origin, utcOffset);
+                    return;
+                case DAY:
+                    roundFixed<MODE, 86400>(unixTimes, count, out, step, origin, utcOffset);
+                    return;
+                default:
+                    roundFixed<MODE, 604800>(unixTimes, count, out, step, origin, utcOffset);
+                    return;
+                }
+            }
+        }
+
+        /**
+        * Unix秒を暦の単位 (の multiple 倍) に切り捨てる \n
+        * Floor unix seconds to the calendar unit (or its multiple) on the calendar of utcOffset.
+        * @param[in] multiple=1	ex: 5 minutes => (MINUTE, 5), quarters => (MONTH, 3)
+        * @details Multiples are aligned to 1970/1/1 00:00:00 for SECOND ~ DAY, Monday 1969/12/29 for WEEK,
+        * and to year 0 for MONTH and YEAR. (ex: (MONTH, 3) starts on Jan, Apr, Jul and Oct)
+        */
+        inline long long floorTo(const long long &unixTime, const Unit &unit, const long long &multiple = 1, const long long &utcOffset = 0)
+        {
+            Detail::checkUnit(unit, multiple);
+            return Detail::roundToUnit(unixTime, unit, multiple, utcOffset, Detail::ROUND_FLOOR);
+        }
+
+        /**
+        * Unix秒を暦の単位 (の multiple 倍) に切り上げる \n
+        * Ceil unix seconds to the calendar unit (or its multiple). A time on a boundary is not changed.
+        */
+        inline long long ceilTo(const long long &unixTime, const Unit &unit, const long long &multiple = 1, const long long &utcOffset = 0)
+        {
+            Detail::checkUnit(unit, multiple);
+            return Detail::roundToUnit(unixTime, unit, multiple, utcOffset, Detail::ROUND_CEIL);
+        }
+
+        /**
+        * Unix秒を最も近い暦の単位 (の multiple 倍) に丸める。ちょうど中間なら切り上げる。 \n
+        * Round unix seconds to the nearest calendar unit (or its multiple). Half way rounds up.
+        */
+        inline long long roundTo(const long long &unixTime, const Unit &unit, const long long &multiple = 1, const long long &utcOffset = 0)
+        {
+            Detail::checkUnit(unit, multiple);
+            return Detail::roundToUnit(unixTime, unit, multiple, utcOffset, Detail::ROUND_NEAREST);
+        }
+
+        /**
+        * Unix秒の配列を切り捨てる。SECOND ~ WEEK は分岐なしで計算する。out は unixTimes と同じでもよい。 \n
+        * Floor an array of unix seconds. SECOND ~ WEEK are branch-free. out may be the same array as unixTimes.
+        * @details Throw DatetimeException if a result is out of range.
+        */
+        inline void floorTo(const long long *unixTimes, const size_t &count, long long *out,
+                            const Unit &unit, const long long &multiple = 1, const long long &utcOffset = 0)
+        {
+            Detail::roundArray<Detail::ROUND_FLOOR>(unixTimes, count, out, unit, multiple, utcOffset);
+        }
+
+        inline void ceilTo(const long long *unixTimes, const size_t &count, long long *out,
+                           const Unit &unit, const long long &multiple = 1, const long long &utcOffset = 0)
+        {
+            Detail::roundArray<Detail::ROUND_CEIL>(unixTimes, count, out, unit, multiple, utcOffset);
+        }
+
+        inline void roundTo(const long long *unixTimes, const size_t &count, long long *out,
+                            const Unit &unit, const long long &multiple = 1, const long long &utcOffset = 0)
+        {
+            Detail::roundArray<Detail::ROUND_NEAREST>(unixTimes, count, out, unit, multiple, utcOffset);
+        }
+    }
+}
+#endif
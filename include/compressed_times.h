@@ -0,0 +1,287 @@
+#ifndef _MY_COMPRESSED_TIMES_
+#define _MY_COMPRESSED_TIMES_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "datetime.h"
+#include "bit_utils.h"
+#include "datetime_exceptions.h"
+
+// 時刻の列 (Unix秒) の圧縮 (Gorilla 方式の delta-of-delta 符号)。
+// 仕様: 1024個ごとのブロックに分け、ブロックの先頭は生の値、以降は差分の差分 (dod) を可変長のビット列で持つ。
+//   0 => dod = 0 (1ビット) / 10 + 7ビット / 110 + 9ビット / 1110 + 12ビット / 1111 + 64ビット (値は zigzag 符号)
+// 一定間隔の時刻は1個あたり約1ビット。ブロック単位で先頭から復号できる (ランダムアクセスはブロックの先頭から)。
+// ビットは各64ビット語の下位から詰める。
+
+namespace EZ
+{
+    /**
+    * @brief Compressed column of unix times
+    * @details Delta-of-delta encoding (Gorilla): about 1 bit per regularly spaced time.
+    * Times are split into blocks of 1024, each starting with the raw time, so a block can be decoded independently. \n
+    * ex: \n
+    * EZ::CompressedTimes compressed(times); \n
+    * std::vector<long long> decoded = compressed.decode();
+    */
+    class CompressedTimes
+    {
+    public:
+        /**
+        * 1ブロックの時刻の数 \n
+        * Number of times in a block.
+        */
+        enum
+        {
+            BLOCK_SIZE = 1024
+        };
+
+        CompressedTimes() : m_count(0), m_bitPosition(0), m_last(0), m_lastDelta(0), m_words(1, 0)
+        {
+        }
+        CompressedTimes(const long long *times, const size_t &count) : CompressedTimes()
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                append(times[i]);
+            }
+        }
+        CompressedTimes(const std::vector<long long> &times) : CompressedTimes(times.data(), times.size())
+        {
+        }
+        /**
+        * Datetime の列 (Unix秒を保存する。タイムゾーンの設定は保存しない) \n
+        * Column of Datetimes. Their unix times are stored, but not their timezone settings.
+        */
+        CompressedTimes(const std::vector<Datetime> &times) : CompressedTimes()
+        {
+            for (const auto &time : times)
+            {
+                append(time.unixTime());
+            }
+        }
+
+        /**
+        * 末尾に追加する \n
+        * Append a time.
+        */
+        void append(const long long &unixTime)
+        {
+            if (m_count % BLOCK_SIZE == 0)
+            {
+                m_blocks.push_back({unixTime, m_bitPosition});
+                m_lastDelta = 0;
+            }
+            else
+            {
+                // Wrapping arithmetic: exact for any pair of times.
+                const uint64_t delta = uint64_t(unixTime) - uint64_t(m_last);
+                const int64_t dod = int64_t(delta - m_lastDelta);
+                const uint64_t zigzag = (uint64_t(dod) << 1) ^ uint64_t(dod >> 63);
+                if (zigzag == 0)
+                {
+                    write(0, 1);
+                }
+                else if (zigzag < (1u << 7))
+                {
+                    write(0x1 | (zigzag << 2), 2 + 7);
+                }
+                else if (zigzag < (1u << 9))
+                {
+                    write(0x3 | (zigzag << 3), 3 + 9);
+                }
+                else if (zigzag < (1u << 12))
+                {
+                    write(0x7 | (zigzag << 4), 4 + 12);
+                }
+                else
+                {
+                    write(0xF, 4);
+                    write(zigzag, 64);
+                }
+                m_lastDelta = delta;
+            }
+            m_last = unixTime;
+            m_count++;
+        }
+        void append(const Datetime &time)
+        {
+            append(time.unixTime());
+        }
+
+        /**
+        * 時刻の数 \n
+        * Number of times.
+        */
+        size_t size() const
+        {
+            return m_count;
+        }
+        /**
+        * ブロックの数 \n
+        * Number of blocks.
+        */
+        size_t numBlocks() const
+        {
+            return m_blocks.size();
+        }
+        /**
+        * 圧縮後の大きさ (ブロックの先頭の値と位置を含む) \n
+        * Compressed size in bytes, including the first time and the position of each block.
+        */
+        size_t sizeInBytes() const
+        {
+            return (m_bitPosition + 63) / 64 * 8 + m_blocks.size() * sizeof(Block);
+        }
+        /**
+        * 1個あたりのビット数 \n
+        * Bits per time.
+        */
+        double bitsPerTime() const
+        {
+            return m_count == 0 ? 0.0 : double(m_bitPosition + m_blocks.size() * sizeof(Block) * 8) / double(m_count);
+        }
+
+        /**
+        * index 番目の時刻 (ブロックの先頭から復号する) \n
+        * Time at the index. Decoded from the start of its block.
+        */
+        long long at(const size_t &index) const
+        {
+            if (index >= m_count)
+            {
+                throw DatetimeException("ERROR: The index is out of range.");
+            }
+            long long times[BLOCK_SIZE];
+            decodeBlock(index / BLOCK_SIZE, times, index % BLOCK_SIZE + 1);
+            return times[index % BLOCK_SIZE];
+        }
+
+        /**
+        * ブロックの時刻を復号する (最大 BLOCK_SIZE 個) \n
+        * Decode the times of the block (up to BLOCK_SIZE) into out, and return the number of times.
+        */
+        size_t decodeBlock(const size_t &block, long long *out) const
+        {
+            if (block >= m_blocks.size())
+            {
+                throw DatetimeException("ERROR: The block is out of range.");
+            }
+            const size_t count = (block + 1 < m_blocks.size()) ? size_t(BLOCK_SIZE) : m_count - block * BLOCK_SIZE;
+            decodeBlock(block, out, count);
+            return count;
+        }
+        /**
+        * すべての時刻を復号する (out には size() 個の領域が必要) \n
+        * Decode all times into out, which must have size() elements.
+        */
+        void decode(long long *out) const
+        {
+            for (size_t block = 0; block < m_blocks.size(); block++)
+            {
+                out += decodeBlock(block, out);
+            }
+        }
+        std::vector<long long> decode() const
+        {
+            std::vector<long long> times(m_count);
+            decode(times.data());
+            return times;
+        }
+
+    private:
+        struct Block
+        {
+            long long first;
+            uint64_t bitPosition;
+        };
+
+        size_t m_count;
+        uint64_t m_bitPosition;
+        long long m_last;
+        uint64_t m_lastDelta;
+        std::vector<Block> m_blocks;
+        // Bits from the lowest of each word, followed by a zero word (so that 64 bits can be read anywhere).
+        std::vector<uint64_t> m_words;
+
+        void write(const uint64_t &bits, const int &length)
+        {
+            const size_t word = size_t(m_bitPosition / 64);
+            const int offset = int(m_bitPosition % 64);
+            m_words[word] |= bits << offset;
+            const bool spills = offset + length > 64;
+            m_bitPosition += uint64_t(length);
+            while (m_words.size() < size_t(m_bitPosition / 64) + 2)
+            {
+                m_words.push_back(0);
+            }
+            if (spills)
+            {
+                m_words[word + 1] |= bits >> (64 - offset);
+            }
+        }
+
+        uint64_t peek(const uint64_t &position) const
+        {
+            const size_t word = size_t(position / 64);
+            const int offset = int(position % 64);
+            return offset == 0 ? m_words[word] : (m_words[word] >> offset) | (m_words[word + 1] << (64 - offset));
+        }
+
+        // Decode the first count times of the block.
+        void decodeBlock(const size_t &block, long long *out, const size_t &count) const
+        {
+            uint64_t position = m_blocks[block].bitPosition;
+            uint64_t value = uint64_t(m_blocks[block].first);
+            uint64_t delta = 0;
+            out[0] = (long long)value;
+            size_t i = 1;
+            while (i < count)
+            {
+                const uint64_t bits = peek(position);
+                if ((bits & 1) == 0)
+                {
+                    // A run of zero bits: the same delta. Arithmetic progression (vectorized by compilers).
+                    size_t run = size_t(Bits::countTrailingZeros(bits));
+                    run = run < count - i ? run : count - i;
+                    long long *dst = out + i;
+                    for (size_t k = 0; k < run; k++)
+                    {
+                        dst[k] = (long long)(value + delta * (k + 1));
+                    }
+                    value += delta * run;
+                    i += run;
+                    position += run;
+                    continue;
+                }
+                const int ones = Bits::countTrailingZeros(~bits);
+                uint64_t zigzag;
+                if (ones == 1)
+                {
+                    zigzag = (bits >> 2) & 0x7F;
+                    position += 2 + 7;
+                }
+                else if (ones == 2)
+                {
+                    zigzag = (bits >> 3) & 0x1FF;
+                    position += 3 + 9;
+                }
+                else if (ones == 3)
+                {
+                    zigzag = (bits >> 4) & 0xFFF;
+                    position += 4 + 12;
+                }
+                else
+                {
+                    zigzag = peek(position + 4);
+                    position += 4 + 64;
+                }
+                delta += (zigzag >> 1) ^ (0 - (zigzag & 1));
+                value += delta;
+                out[i++] = (long long)value;
+            }
+        }
+    };
+}
+#endif
@@ -0,0 +1,539 @@
+#ifndef _MY_CRON_SCHEDULE_
+#define _MY_CRON_SCHEDULE_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <cctype>
+#include <algorithm>
+
+#include "datetime.h"
+#include "calendar.h"
+#include "bit_utils.h"
+#include "datetime_exceptions.h"
+
+// cron 式の予定。各フィールド (秒・分・時・日・月・曜日) の許される値をビットマスクで持ち、
+// 次 (前) の実行時刻を上位のフィールドから順にビット演算で飛び移って求める (1分ずつは調べない)。
+// 仕様: 日と曜日が両方とも * でなければ、どちらかに一致する日 (Vixie cron と同じ)。
+// 現地時刻の予定では、存在しない時刻 (サマータイムの開始) は飛ばし、繰り返す時刻 (終了) は1回だけ実行する。
+
+namespace EZ
+{
+    /**
+    * @brief cron schedule
+    * @details "minute hour day-of-month month day-of-week", or with seconds in front (6 fields). \n
+    * Each field is *, a value, a range (a-b), a step (*\/n, a-b/n, a/n) or a list of them (,). \n
+    * Months and days of week may be names (JAN ~ DEC, SUN ~ SAT). Sunday is 0 or 7. \n
+    * Macros: @yearly (@annually), @monthly, @weekly, @daily (@midnight), @hourly. \n
+    * ex: \n
+    * EZ::CronSchedule schedule("*\/15 9-17 * * MON-FRI"); \n
+    * EZ::Datetime fire = schedule.next(EZ::Datetime::now());
+    */
+    class CronSchedule
+    {
+    public:
+        /**
+        * @param[in] expression cron expression
+        * @details Throw DatetimeException if the expression is invalid.
+        */
+        CronSchedule(const std::string &expression)
+            : m_expression(expression)
+        {
+            parse(expression);
+        }
+
+        const std::string &expression() const
+        {
+            return m_expression;
+        }
+
+        /**
+        * unixTime (utcOffset の暦) が予定に一致すれば true \n
+        * true if unixTime on the calendar of utcOffset matches the schedule.
+        */
+        bool matches(const long long &unixTime, const long long &utcOffset = 0) const
+        {
+            long long year;
+            int mon, day, hour, min, sec;
+            fieldsOf(unixTime + utcOffset, year, mon, day, hour, min, sec);
+            return ((m_months >> mon) & 1) && ((dayMask(year, mon) >> day) & 1) && ((m_hours >> hour) & 1) &&
+                   ((m_minutes >> min) & 1) && ((m_seconds >> sec) & 1);
+        }
+        bool matches(const Datetime &time) const
+        {
+            const auto tmpTm = time.structTm();
+            return matches(time.unixTime(), MyTM::utcOffsetOf(tmpTm));
+        }
+
+        /**
+        * unixTime より後の最初の実行時刻 (utcOffset の暦)。なければ false。 \n
+        * The first fire time after unixTime on the calendar of utcOffset. false if there is none.
+        */
+        bool next(const long long &unixTime, long long &result, const long long &utcOffset = 0) const
+        {
+            long long wall;
+            if (unixTime >= DatetimeConstants::MAXIMUM_SEC || !nextWall(unixTime + utcOffset + 1, wall))
+            {
+                return false;
+            }
+            result = wall - utcOffset;
+            return result <= DatetimeConstants::MAXIMUM_SEC;
+        }
+        /**
+        * unixTime より前の最後の実行時刻 (utcOffset の暦)。なければ false。 \n
+        * The last fire time before unixTime on the calendar of utcOffset. false if there is none.
+        */
+        bool prev(const long long &unixTime, long long &result, const long long &utcOffset = 0) const
+        {
+            long long wall;
+            if (unixTime <= DatetimeConstants::MINIMUM_SEC || !prevWall(unixTime + utcOffset - 1, wall))
+            {
+                return false;
+            }
+            result = wall - utcOffset;
+            return result >= DatetimeConstants::MINIMUM_SEC;
+        }
+
+        /**
+        * after より後の最初の実行時刻。現地時刻なら現地時刻の暦 (サマータイムに従う)。 \n
+        * The first fire time after the Datetime. Local time follows the local calendar including summer time.
+        * @details Throw DatetimeException if the schedule never fires after it.
+        */
+        Datetime next(const Datetime &after) const
+        {
+            long long result;
+            if (!nextOf(after.unixTime(), after.isUTC(), result))
+            {
+                throw DatetimeException("ERROR: The schedule \"" + m_expression + "\" never fires after " + after.str() + ".");
+            }
+            return Datetime(time_t(result), after.isUTC());
+        }
+        /**
+        * before より前の最後の実行時刻 \n
+        * The last fire time before the Datetime.
+        * @details Throw DatetimeException if the schedule never fired before it.
+        */
+        Datetime prev(const Datetime &before) const
+        {
+            long long result;
+            if (!prevOf(before.unixTime(), before.isUTC(), result))
+            {
+                throw DatetimeException("ERROR: The schedule \"" + m_expression + "\" never fires before " + before.str() + ".");
+            }
+            return Datetime(time_t(result), before.isUTC());
+        }
+
+        /**
+        * [from, to) の実行時刻をすべて out に追加する (utcOffset の暦)。追加した数を返す。 \n
+        * Append all fire times in [from, to) on the calendar of utcOffset to out. Return the number of them.
+        */
+        size_t fireTimes(const long long &from, const long long &to, std::vector<long long> &out, const long long &utcOffset = 0) const
+        {
+            const size_t size = out.size();
+            long long wall = from + utcOffset;
+            long long fire;
+            while (wall < to + utcOffset && nextWall(wall, fire) && fire < to + utcOffset)
+            {
+                out.push_back(fire - utcOffset);
+                wall = fire + 1;
+            }
+            return out.size() - size;
+        }
+        /**
+        * [from, to) の実行時刻 (from のタイムゾーン) \n
+        * Fire times in [from, to) in the timezone of from.
+        */
+        std::vector<Datetime> fireTimes(const Datetime &from, const Datetime &to) const
+        {
+            std::vector<Datetime> out;
+            long long after = from.unixTime();
+            long long fire;
+            if (from < to && matches(from))
+            {
+                out.push_back(from);
+            }
+            while (nextOf(after, from.isUTC(), fire) && fire < to.unixTime())
+            {
+                out.push_back(Datetime(time_t(fire), from.isUTC()));
+                after = fire;
+            }
+            return out;
+        }
+
+    private:
+        std::string m_expression;
+        // 許される値のビット (秒: 0 ~ 59, 分: 0 ~ 59, 時: 0 ~ 23, 日: 1 ~ 31, 月: 1 ~ 12, 曜日: 0 ~ 6 (日曜 = 0))
+        uint64_t m_seconds = 0;
+        uint64_t m_minutes = 0;
+        uint64_t m_hours = 0;
+        uint64_t m_days = 0;
+        uint64_t m_months = 0;
+        uint64_t m_weekdays = 0;
+        bool m_anyDay = true;
+        bool m_anyWeekday = true;
+
+        // 探す年数の上限。暦は400年で繰り返すので、それを超えて見つからなければ実行されない。
+        static const long long SEARCH_YEARS = 401;
+
+        // x 以上のビット
+        static uint64_t bitsFrom(const int &x)
+        {
+            return x >= 64 ? 0 : (~uint64_t(0) << (x < 0 ? 0 : x));
+        }
+
+        static void fieldsOf(const long long &wall, long long &year, int &mon, int &day, int &hour, int &min, int &sec)
+        {
+            const long long days = MyTM::floorDiv(wall, DatetimeConstants::SECONDS_PER_DAY);
+            const long long secOfDay = wall - days * DatetimeConstants::SECONDS_PER_DAY;
+            MyTM::civilFromDays(days, year, mon, day);
+            hour = int(secOfDay / 3600);
+            min = int(secOfDay / 60 % 60);
+            sec = int(secOfDay % 60);
+        }
+
+        // year 年 mon 月の、実行する日のビット (1 ~ 末日)
+        uint64_t dayMask(const long long &year, const int &mon) const
+        {
+            const uint64_t valid = Bits::lowMask(MyTM::daysInMonth(year, mon) + 1) & ~uint64_t(1);
+            if (m_anyWeekday)
+            {
+                return m_days & valid;
+            }
+            // Weekdays of the month: bit i of the pattern is the weekday of the (i + 1)-th day.
+            const long long first = MyTM::daysFromCivil(year, mon, 1);
+            const int weekday = int(first + 4 - MyTM::floorDiv(first + 4, 7) * 7);
+            const uint64_t pattern = ((m_weekdays >> weekday) | (m_weekdays << (7 - weekday))) & 0x7F;
+            const uint64_t weekdays = (pattern | (pattern << 7) | (pattern << 14) | (pattern << 21) | (pattern << 28)) << 1;
+            return (m_anyDay ? weekdays : (m_days | weekdays)) & valid;
+        }
+
+        // wall (utcOffset の暦の秒) 以上の最初の実行時刻
+        bool nextWall(const long long &wall, long long &result) const
+        {
+            long long year;
+            int mon, day, hour, min, sec;
+            fieldsOf(wall, year, mon, day, hour, min, sec);
+            const long long lastYear = year + SEARCH_YEARS;
+            while (year <= lastYear && year <= DatetimeConstants::MAXIMUM_YEAR)
+            {
+                // Jump to the next allowed value of each field from the top. If there is none, carry to the upper field.
+                const int nextMon = Bits::countTrailingZeros(m_months & bitsFrom(mon));
+                if (nextMon > 12)
+                {
+                    year++;
+                    mon = 1, day = 1, hour = 0, min = 0, sec = 0;
+                    continue;
+                }
+                if (nextMon != mon)
+                {
+                    mon = nextMon, day = 1, hour = 0, min = 0, sec = 0;
+                }
+                const int nextDay = Bits::countTrailingZeros(dayMask(year, mon) & bitsFrom(day));
+                if (nextDay >= 64)
+                {
+                    mon++, day = 1, hour = 0, min = 0, sec = 0;
+                    continue;
+                }
+                if (nextDay != day)
+                {
+                    day = nextDay, hour = 0, min = 0, sec = 0;
+                }
+                const int nextHour = Bits::countTrailingZeros(m_hours & bitsFrom(hour));
+                if (nextHour >= 64)
+                {
+                    day++, hour = 0, min = 0, sec = 0;
+                    continue;
+                }
+                if (nextHour != hour)
+                {
+                    hour = nextHour, min = 0, sec = 0;
+                }
+                const int nextMin = Bits::countTrailingZeros(m_minutes & bitsFrom(min));
+                if (nextMin >= 64)
+                {
+                    hour++, min = 0, sec = 0;
+                    continue;
+                }
+                if (nextMin != min)
+                {
+                    min = nextMin, sec = 0;
+                }
+                const int nextSec = Bits::countTrailingZeros(m_seconds & bitsFrom(sec));
+                if (nextSec >= 64)
+                {
+                    min++, sec = 0;
+                    continue;
+                }
+                result = MyTM::daysFromCivil(year, mon, day) * DatetimeConstants::SECONDS_PER_DAY + hour * 3600LL + min * 60LL + nextSec;
+                return true;
+            }
+            return false;
+        }
+
+        // wall (utcOffset の暦の秒) 以下の最後の実行時刻
+        bool prevWall(const long long &wall, long long &result) const
+        {
+            long long year;
+            int mon, day, hour, min, sec;
+            fieldsOf(wall, year, mon, day, hour, min, sec);
+            const long long firstYear = year - SEARCH_YEARS;
+            while (year >= firstYear && year >= DatetimeConstants::MINIMUM_YEAR)
+            {
+                // Jump to the previous allowed value of each field. If there is none, borrow from the upper field.
+                const int prevMon = Bits::highestBit(m_months & Bits::lowMask(mon + 1));
+                if (prevMon < 1)
+                {
+                    year--;
+                    mon = 12, day = 31, hour = 23, min = 59, sec = 59;
+                    continue;
+                }
+                if (prevMon != mon)
+                {
+                    mon = prevMon, day = 31, hour = 23, min = 59, sec = 59;
+                }
+                const int prevDay = Bits::highestBit(dayMask(year, mon) & Bits::lowMask(day + 1));
+                if (prevDay < 1)
+                {
+                    mon--, day = 31, hour = 23, min = 59, sec = 59;
+                    continue;
+                }
+                if (prevDay != day)
+                {
+                    day = prevDay, hour = 23, min = 59, sec = 59;
+                }
+                const int prevHour = Bits::highestBit(m_hours & Bits::lowMask(hour + 1));
+                if (prevHour < 0)
+                {
+                    day--, hour = 23, min = 59, sec = 59;
+                    continue;
+                }
+                if (prevHour != hour)
+                {
+                    hour = prevHour, min = 59, sec = 59;
+                }
+                const int prevMin = Bits::highestBit(m_minutes & Bits::lowMask(min + 1));
+                if (prevMin < 0)
+                {
+                    hour--, min = 59, sec = 59;
+                    continue;
+                }
+                if (prevMin != min)
+                {
+                    min = prevMin, sec = 59;
+                }
+                const int prevSec = Bits::highestBit(m_seconds & Bits::lowMask(sec + 1));
+                if (prevSec < 0)
+                {
+                    min--, sec = 59;
+                    continue;
+                }
+                result = MyTM::daysFromCivil(year, mon, day) * DatetimeConstants::SECONDS_PER_DAY + hour * 3600LL + min * 60LL + prevSec;
+                return true;
+            }
+            return false;
+        }
+
+        // 現地時刻の秒 wall を Unix秒にする。存在しない時刻 (サマータイムの開始) なら false。
+        // 繰り返す時刻 (終了) は早い方 (変わる前のオフセット) にする。
+        static bool unixTimeOfLocal(const long long &wall, const long long &guess, long long &unixTime)
+        {
+            // The offsets a day before and after cover both sides of a change near wall.
+            const long long candidates[] = {guess, offsetAt(wall - guess - DatetimeConstants::SECONDS_PER_DAY), offsetAt(wall - guess + DatetimeConstants::SECONDS_PER_DAY)};
+            unixTime = DatetimeConstants::MAXIMUM_SEC + 1;
+            for (const long long &offset : candidates)
+            {
+                const long long time = wall - offset;
+                if (time >= DatetimeConstants::MINIMUM_SEC && time < unixTime && offsetAt(time) == offset)
+                {
+                    unixTime = time;
+                }
+            }
+            return unixTime <= DatetimeConstants::MAXIMUM_SEC;
+        }
+        static long long offsetAt(long long unixTime)
+        {
+            unixTime = std::min(std::max(unixTime, (long long)DatetimeConstants::MINIMUM_SEC), (long long)DatetimeConstants::MAXIMUM_SEC);
+            return MyTM::utcOffsetOf(MyTM::my_mkStructTm(time_t(unixTime), false));
+        }
+
+        bool nextOf(const long long &after, const bool &isUTC, long long &result) const
+        {
+            if (isUTC)
+            {
+                return next(after, result);
+            }
+            if (after >= DatetimeConstants::MAXIMUM_SEC)
+            {
+                return false;
+            }
+            const long long offset = MyTM::utcOffsetOf(MyTM::my_mkStructTm(time_t(after), false));
+            long long wall = after + offset + 1;
+            long long fire;
+            // Skip local times in the gap. A repeated local time fires at its first occurrence only,
+            // so it is skipped from inside the second pass.
+            while (nextWall(wall, fire))
+            {
+                if (unixTimeOfLocal(fire, offset, result) && result > after)
+                {
+                    return true;
+                }
+                wall = fire + 1;
+            }
+            return false;
+        }
+
+        bool prevOf(const long long &before, const bool &isUTC, long long &result) const
+        {
+            if (isUTC)
+            {
+                return prev(before, result);
+            }
+            if (before <= DatetimeConstants::MINIMUM_SEC)
+            {
+                return false;
+            }
+            const long long offset = MyTM::utcOffsetOf(MyTM::my_mkStructTm(time_t(before), false));
+            long long wall = before + offset - 1;
+            long long fire;
+            while (prevWall(wall, fire))
+            {
+                if (unixTimeOfLocal(fire, offset, result) && result < before)
+                {
+                    return true;
+                }
+                wall = fire - 1;
+            }
+            return false;
+        }
+
+        void parse(const std::string &expression)
+        {
+            std::string text = expression;
+            if (expression == "@yearly" || expression == "@annually")
+            {
+                text = "0 0 1 1 *";
+            }
+            else if (expression == "@monthly")
+            {
+                text = "0 0 1 * *";
+            }
+            else if (expression == "@weekly")
+            {
+                text = "0 0 * * 0";
+            }
+            else if (expression == "@daily" || expression == "@midnight")
+            {
+                text = "0 0 * * *";
+            }
+            else if (expression == "@hourly")
+            {
+                text = "0 * * * *";
+            }
+            std::vector<std::string> fields;
+            std::stringstream ss(text);
+            std::string field;
+            while (ss >> field)
+            {
+                fields.push_back(field);
+            }
+            if (fields.size() != 5 && fields.size() != 6)
+            {
+                throwInvalid("it must have 5 or 6 fields");
+            }
+            size_t i = 0;
+            m_seconds = (fields.size() == 6) ? parseField(fields[i++], 0, 59, nullptr) : 1;
+            m_minutes = parseField(fields[i++], 0, 59, nullptr);
+            m_hours = parseField(fields[i++], 0, 23, nullptr);
+            m_anyDay = fields[i][0] == '*';
+            m_days = parseField(fields[i++], 1, 31, nullptr);
+            m_months = parseField(fields[i++], 1, 12, DatetimeConstants::MONTH_NAMES);
+            m_anyWeekday = fields[i][0] == '*';
+            m_weekdays = parseField(fields[i++], 0, 7, DatetimeConstants::WEEKDAY_NAMES);
+            // Sunday is 0 or 7.
+            m_weekdays = (m_weekdays | (m_weekdays >> 7)) & 0x7F;
+        }
+
+        void throwInvalid(const std::string &reason) const
+        {
+            throw DatetimeException("ERROR: \"" + m_expression + "\" is not a valid cron expression (" + reason + ").");
+        }
+
+        // 数または名前 (先頭3文字、大文字小文字を問わない) を読む
+        int parseValue(const std::string &text, const int &minimum, const int &maximum, const char *const *names) const
+        {
+            if (text.empty())
+            {
+                throwInvalid("empty value");
+            }
+            int value = 0;
+            if (names != nullptr && text.size() == 3 && !isdigit((unsigned char)text[0]))
+            {
+                const int count = maximum - minimum + 1 - (maximum == 7 ? 1 : 0);
+                for (int i = 0; i < count; i++)
+                {
+                    if (tolower((unsigned char)text[0]) == tolower((unsigned char)names[i][0]) &&
+                        tolower((unsigned char)text[1]) == tolower((unsigned char)names[i][1]) &&
+                        tolower((unsigned char)text[2]) == tolower((unsigned char)names[i][2]))
+                    {
+                        return i + minimum;
+                    }
+                }
+                throwInvalid("unknown name " + text);
+            }
+            for (const char &c : text)
+            {
+                if (!isdigit((unsigned char)c) || value > 1000)
+                {
+                    throwInvalid("invalid value " + text);
+                }
+                value = value * 10 + (c - '0');
+            }
+            if (value < minimum || value > maximum)
+            {
+                throwInvalid("value out of range " + text);
+            }
+            return value;
+        }
+
+        // フィールド (リスト・範囲・間隔) を値のビットにする
+        uint64_t parseField(const std::string &field, const int &minimum, const int &maximum, const char *const *names) const
+        {
+            uint64_t mask = 0;
+            size_t begin = 0;
+            while (begin <= field.size())
+            {
+                size_t end = field.find(',', begin);
+                end = (end == std::string::npos) ? field.size() : end;
+                const std::string item = field.substr(begin, end - begin);
+                const size_t slash = item.find('/');
+                const std::string range = item.substr(0, slash);
+                int low = minimum, high = maximum, step = 1;
+                if (slash != std::string::npos)
+                {
+                    step = parseValue(item.substr(slash + 1), 1, maximum + 1, nullptr);
+                }
+                if (range != "*")
+                {
+                    const size_t dash = range.find('-');
+                    low = parseValue(range.substr(0, dash), minimum, maximum, names);
+                    // "a/n" is from a to the maximum.
+                    high = (dash != std::string::npos) ? parseValue(range.substr(dash + 1), minimum, maximum, names)
+                                                       : (slash != std::string::npos ? maximum : low);
+                    if (low > high)
+                    {
+                        throwInvalid("invalid range " + range);
+                    }
+                }
+                for (int value = low; value <= high; value += step)
+                {
+                    mask |= uint64_t(1) << value;
+                }
+                begin = end + 1;
+            }
+            return mask;
+        }
+    };
+}
+#endif
@@ -32,22 +32,29 @@ SOFTWARE.
 #define _MY_DATETIME_
 
 #include <string>
+#include <string.h>
 #include <sstream>
 #include <iomanip>
 #include <time.h>
 #include <regex>
 #include <vector>
 #include <limits>
+#include <utility>
 
 #if defined(_WIN32) || defined(_WIN64)
 #include <windows.h>
 #endif
 
 #include "time_delta.h"
+#include "datetime_clock.h"
 #include "unix_time.h"
 #include "datetime_parser.h"
+#include "datetime_format.h"
+#include "fixed_format.h"
+#include "calendar.h"
 #include "datetime_constants.h"
 #include "datetime_exceptions.h"
+#include "datetime_metrics.h"
 
 namespace EZ
 {
@@ -71,25 +78,25 @@ namespace EZ
 		Datetime(const std::string &timestamp, const std::string &format, const bool &isUTC = false)
 		{
 			m_isUTC = isUTC;
-			setDateTime(timestamp, format);
+			setDateTime(timestamp.c_str(), timestamp.size(), format.c_str(), format.size());
 		}
 
 		Datetime(const std::string &timestamp, const char *format, const bool &isUTC = false)
 		{
 			m_isUTC = isUTC;
-			setDateTime(timestamp, format);
+			setDateTime(timestamp.c_str(), timestamp.size(), format, strlen(format));
 		}
 
 		Datetime(const char *timestamp, const std::string &format, const bool &isUTC = false)
 		{
 			m_isUTC = isUTC;
-			setDateTime(timestamp, format);
+			setDateTime(timestamp, strlen(timestamp), format.c_str(), format.size());
 		}
 
 		Datetime(const char *timestamp, const char *format, const bool &isUTC = false)
 		{
 			m_isUTC = isUTC;
-			setDateTime(timestamp, format);
+			setDateTime(timestamp, strlen(timestamp), format, strlen(format));
 		}
 
 		/**
@@ -100,13 +107,34 @@ namespace EZ
 		Datetime(const std::string &timestamp, const bool &isUTC = false)
 		{
 			m_isUTC = isUTC;
-			setDateTime(timestamp, DatetimeConstants::DEFAULT_INPUT_FORMAT);
+			const std::string &format = DatetimeConstants::DEFAULT_INPUT_FORMAT;
+			setDateTime(timestamp.c_str(), timestamp.size(), format.c_str(), format.size());
 		}
 
 		Datetime(const char *timestamp, const bool &isUTC = false)
 		{
 			m_isUTC = isUTC;
-			setDateTime(timestamp, DatetimeConstants::DEFAULT_INPUT_FORMAT);
+			const std::string &format = DatetimeConstants::DEFAULT_INPUT_FORMAT;
+			setDateTime(timestamp, strlen(timestamp), format.c_str(), format.size());
+		}
+
+		/**
+		* 事前にコンパイルした書式で文字列を解析する (書式の検証を省略する) \n
+		* Parse the timestamp with the compiled format. The format is not validated again.
+		* @param[in] timestamp ex: 2021-03-08T00:00:15
+		* @param[in] format compiled format. ex: EZ::CompiledFormat::compile("%Y-%m-%dT%H:%M:%S") or EZ::detectFormat(sample)
+		* @param[in] isUTC=false	if true, UTC is set to timezone.\n if false, local time is applied.
+		*/
+		Datetime(const std::string &timestamp, const CompiledFormat &format, const bool &isUTC = false)
+		{
+			m_isUTC = isUTC;
+			setDateTime(timestamp.c_str(), timestamp.size(), format);
+		}
+
+		Datetime(const char *timestamp, const CompiledFormat &format, const bool &isUTC = false)
+		{
+			m_isUTC = isUTC;
+			setDateTime(timestamp, strlen(timestamp), format);
 		}
 
 		/**
@@ -136,7 +164,7 @@ namespace EZ
 			m_unixTime = original.m_unixTime;
 		}
 		/**
-		* @param[in] year (1970 ~ 2999)
+		* @param[in] year (-2147481747 ~ 2147483646)
 		* @param[in] mon (1 ~ 12)
 		* @param[in] day (1 ~ 31)
 		* @param[in] hour (0 ~ 23)
@@ -265,6 +293,51 @@ namespace EZ
 			return str("%H:%M:%S");
 		}
 		/**
+		* RFC 3339 の文字列を返却する。UTCなら "Z"、現地時刻ならUTCからのオフセットを付ける。 \n
+		* Return the timestamp as an RFC 3339 string. "Z" for UTC, the UTC offset for local time.
+		* @details ex: 2021-03-08T00:00:15Z, 2021-03-08T09:00:15+09:00
+		*/
+		std::string toRfc3339() const
+		{
+			char buf[FixedFormat::RFC3339_BUFFER_SIZE];
+			return std::string(buf, toRfc3339(buf));
+		}
+		/**
+		* RFC 3339 の文字列を out に書き込み、長さを返す (ヒープ確保なし、終端文字なし)。 \n
+		* Write the RFC 3339 string to out and return the length. (No allocation, no terminating null)
+		* @param[out] out buffer of at least FixedFormat::RFC3339_BUFFER_SIZE bytes
+		*/
+		size_t toRfc3339(char *out) const
+		{
+			validateInput(m_unixTime);
+			const long long utcOffset = m_isUTC ? 0 : MyTM::utcOffsetOf(MyTM::my_mkStructTm(m_unixTime, false));
+			return FixedFormat::writeRfc3339(out, m_unixTime, utcOffset);
+		}
+		/**
+		* HTTP-date (IMF-fixdate) の文字列を返却する。タイムゾーンの設定によらずGMTで出力する。 \n
+		* Return the timestamp as an HTTP-date (IMF-fixdate). Always GMT regardless of the timezone of the instance.
+		* @details ex: Sun, 06 Nov 1994 08:49:37 GMT \n
+		* For the "Date" header of every response, EZ::FixedFormat::httpDateNow() formats at most once per second.
+		*/
+		std::string toHttpDate() const
+		{
+			validateInput(m_unixTime);
+			char buf[FixedFormat::HTTP_DATE_BUFFER_SIZE];
+			return std::string(buf, FixedFormat::writeHttpDate(buf, m_unixTime));
+		}
+		/**
+		* RFC 2822 の文字列を返却する。UTCなら +0000、現地時刻ならUTCからのオフセットを付ける。 \n
+		* Return the timestamp as an RFC 2822 string. +0000 for UTC, the UTC offset for local time.
+		* @details ex: Mon, 08 Mar 2021 09:00:15 +0900
+		*/
+		std::string toRfc2822() const
+		{
+			validateInput(m_unixTime);
+			const long long utcOffset = m_isUTC ? 0 : MyTM::utcOffsetOf(MyTM::my_mkStructTm(m_unixTime, false));
+			char buf[FixedFormat::RFC2822_BUFFER_SIZE];
+			return std::string(buf, FixedFormat::writeRfc2822(buf, m_unixTime, utcOffset));
+		}
+		/**
 		* 秒数を整数値で返却する \n
 		* Return the number of seconds as an integer value.
 		*/
@@ -336,16 +409,41 @@ namespace EZ
 			auto tmpTm = structTm();
 			return tmpTm.tm_wday;
 		}
-		// TODO: ISO
 		/**
-		* 週番号を返却する \n
-		* Return the week number as an integer value. \n
+		* ISO 8601 の週番号を返却する \n
+		* Return the ISO 8601 week number as an integer value.
+		* @returns 1 ~ 53. The week containing Thursday belongs to the year. (ex: 2021/1/1 => 53)
+		* @details See also isoYear()
+		*/
+		int weeksOfYear() const
+		{
+			long long isoYear;
+			int week, weekday;
+			Calendar::isoWeekDate(localDays(), isoYear, week, weekday);
+			return week;
+		}
+		/**
+		* ISO 8601 の週年 (週番号が属する年) を返却する \n
+		* Return the ISO 8601 week-year, the year the week number belongs to.
+		* @details ex: 2021/1/1 => 2020 (week 53), 2024/12/30 => 2025 (week 1)
 		*/
-		// int weeksOfYear() const
-		// {
-		// 	auto tmpTm = structTm();
-		// 	return (tmpTm.tm_yday / 7) + 1;
-		// }
+		long isoYear() const
+		{
+			long long isoYear;
+			int week, weekday;
+			Calendar::isoWeekDate(localDays(), isoYear, week, weekday);
+			return long(isoYear);
+		}
+		/**
+		* 年内の通算日 (1月1日 => 1) を返却する \n
+		* Return the day of the year as an integer value.
+		* @returns 1 ~ 366
+		*/
+		int daysOfYear() const
+		{
+			auto tmpTm = structTm();
+			return tmpTm.tm_yday + 1;
+		}
 
 		/**
 		* タイムゾーンを返却する \n
@@ -395,8 +493,89 @@ namespace EZ
 		*/
 		static Datetime now(const bool &isUTC = false)
 		{
-			time_t unixTime = time(NULL);
-			return Datetime(unixTime, isUTC);
+			return now(SystemClock(), isUTC);
+		}
+		/**
+		* 時計 clock の現在時刻を取得する \n
+		* Get the current time of the clock.
+		* @param[in] clock	a clock such as EZ::CoarseClock or EZ::ManualClock (see datetime_clock.h)
+		* @details ex: EZ::ManualClock clock(1615161615); auto now = EZ::Datetime::now(clock, true);
+		*/
+		template <class Clock, class = decltype(std::declval<const Clock &>().now())>
+		static Datetime now(const Clock &clock, const bool &isUTC = false)
+		{
+			return Datetime(time_t(clock.now()), isUTC);
+		}
+		/**
+		* 時計 clock の現在時刻を取得し、秒未満を nanoseconds に返す \n
+		* Get the current time of the clock, and return the fraction of the second by nanoseconds.
+		* @param[in] clock	a clock with unixNanoseconds() such as EZ::AnchoredClock (see datetime_clock.h)
+		* @details ex: EZ::AnchoredClock clock; long ns; auto now = EZ::Datetime::now(clock, ns);
+		*/
+		template <class Clock, class = decltype(std::declval<const Clock &>().unixNanoseconds())>
+		static Datetime now(const Clock &clock, long &nanoseconds, const bool &isUTC = false)
+		{
+			const long long total = clock.unixNanoseconds();
+			const long long seconds = Detail::floorSeconds(total);
+			nanoseconds = long(total - seconds * Detail::NANOSECONDS_PER_SECOND);
+			return Datetime(time_t(seconds), isUTC);
+		}
+
+		/**
+		* RFC 3339 の文字列から生成する。秒未満は切り捨てる。 \n
+		* Create from an RFC 3339 timestamp. The fraction of the second is truncated.
+		* @param[in] timestamp ex: 2021-03-08T09:00:15.123+09:00
+		* @param[in] isUTC=false	timezone of the instance. The offset in the timestamp designates the instant.
+		* @details Throw DatetimeException if the timestamp is not RFC 3339.
+		*/
+		static Datetime fromRfc3339(const std::string &timestamp, const bool &isUTC = false)
+		{
+			long nanoseconds;
+			return Datetime(time_t(parseRfc3339(timestamp.c_str(), timestamp.size(), nanoseconds)), isUTC);
+		}
+		static Datetime fromRfc3339(const char *timestamp, const bool &isUTC = false)
+		{
+			long nanoseconds;
+			return Datetime(time_t(parseRfc3339(timestamp, strlen(timestamp), nanoseconds)), isUTC);
+		}
+		/**
+		* RFC 3339 の文字列から生成し、秒未満を nanoseconds に返す。 \n
+		* Create from an RFC 3339 timestamp and return the fraction of the second by nanoseconds.
+		*/
+		static Datetime fromRfc3339(const std::string &timestamp, long &nanoseconds, const bool &isUTC = false)
+		{
+			return Datetime(time_t(parseRfc3339(timestamp.c_str(), timestamp.size(), nanoseconds)), isUTC);
+		}
+		static Datetime fromRfc3339(const char *timestamp, long &nanoseconds, const bool &isUTC = false)
+		{
+			return Datetime(time_t(parseRfc3339(timestamp, strlen(timestamp), nanoseconds)), isUTC);
+		}
+
+		/**
+		* HTTP-date の文字列から生成する (IMF-fixdate, RFC 850, asctime の3形式)。 \n
+		* Create from an HTTP-date (IMF-fixdate, RFC 850 or asctime format).
+		* @param[in] timestamp ex: Sun, 06 Nov 1994 08:49:37 GMT
+		* @param[in] isUTC=false	timezone of the instance.
+		* @details Throw DatetimeException if the timestamp is not an HTTP-date.
+		*/
+		static Datetime fromHttpDate(const std::string &timestamp, const bool &isUTC = false)
+		{
+			long long unixTime = 0;
+			throwIfNotParsed(FixedFormat::parseHttpDate(timestamp.c_str(), timestamp.size(), unixTime), timestamp.c_str(), timestamp.size(), "HTTP-date");
+			return Datetime(time_t(unixTime), isUTC);
+		}
+		/**
+		* RFC 2822 の文字列から生成する。 \n
+		* Create from an RFC 2822 timestamp.
+		* @param[in] timestamp ex: Mon, 08 Mar 2021 09:00:15 +0900
+		* @param[in] isUTC=false	timezone of the instance. The zone in the timestamp designates the instant.
+		* @details Throw DatetimeException if the timestamp is not RFC 2822.
+		*/
+		static Datetime fromRfc2822(const std::string &timestamp, const bool &isUTC = false)
+		{
+			long long unixTime = 0;
+			throwIfNotParsed(FixedFormat::parseRfc2822(timestamp.c_str(), timestamp.size(), unixTime), timestamp.c_str(), timestamp.size(), "RFC 2822");
+			return Datetime(time_t(unixTime), isUTC);
 		}
 
 		/**
@@ -415,7 +594,7 @@ namespace EZ
 		//https://cpprefjp.github.io/reference/limits/numeric_limits/max.html
 		static Datetime maximum(const bool &isUTC = false)
 		{
-			return Datetime(DatetimeConstants::MAXIMUM_SEC, isUTC);
+			return Datetime(time_t(DatetimeConstants::MAXIMUM_SEC), isUTC);
 		}
 
 		/**
@@ -435,6 +614,101 @@ namespace EZ
 				tmpTm.tm_sec};
 		}
 
+		/**
+		* 月数を加算した日時を返却する。時刻は保たれる。mktime() を使わず整数演算で計算する。 \n
+		* Return the Datetime after adding months. The time of day is kept. Calculated by integer arithmetic without mktime().
+		* @param[in] months number of months (negative to go back)
+		* @param[in] policy=Calendar::CLAMP	how to handle a day that does not exist in the resulting month. \n
+		* ex: 2021/1/31 + 1 month => 2021/2/28 (CLAMP), 2021/3/3 (CARRY_OVER)
+		* @details For local time, a time in the gap of summer time is moved forward by the length of the gap.
+		*/
+		Datetime addMonths(const long long &months, const Calendar::MonthPolicy &policy = Calendar::CLAMP) const
+		{
+			Calendar::Detail::checkMonths(months);
+			return onLocalCalendar([&](const long long &unixTime, const long long &utcOffset) {
+				return Calendar::addMonths(unixTime, months, policy, utcOffset);
+			});
+		}
+		/**
+		* 年数を加算した日時を返却する。2/29 は policy に従う。 \n
+		* Return the Datetime after adding years. Feb 29 follows the policy.
+		*/
+		Datetime addYears(const long long &years, const Calendar::MonthPolicy &policy = Calendar::CLAMP) const
+		{
+			Calendar::Detail::checkMonths(years);
+			return addMonths(years * 12, policy);
+		}
+		/**
+		* 日数を加算した日時を返却する。現地時刻ならサマータイムをまたいでも時刻は保たれる。 \n
+		* Return the Datetime after adding calendar days. For local time, the time of day is kept across summer time.
+		* @param[in] days number of days (negative to go back)
+		* @details ex: 2021/3/13 12:00:00 EST + 1 day => 2021/3/14 12:00:00 EDT (23 hours later)
+		*/
+		Datetime addDays(const long long &days) const
+		{
+			Calendar::Detail::checkDays(days);
+			return onLocalCalendar([&](const long long &unixTime, const long long &) {
+				return unixTime + days * DatetimeConstants::SECONDS_PER_DAY;
+			});
+		}
+		/**
+		* 暦の単位 (の multiple 倍) に切り捨てた日時を返却する。現地時刻なら現地時刻の暦で丸める。 \n
+		* Return the Datetime floored to the calendar unit (or its multiple). Local time is floored on the local calendar.
+		* @param[in] unit Calendar::SECOND, MINUTE, HOUR, DAY, WEEK (Monday), MONTH or YEAR
+		* @param[in] multiple=1	ex: 5 minutes => floor(Calendar::MINUTE, 5)
+		* @details ex: 2021/3/8 13:47:15 => floor(Calendar::HOUR) => 2021/3/8 13:00:00 \n
+		* See Calendar::floorTo() for the alignment of multiples.
+		*/
+		Datetime floor(const Calendar::Unit &unit, const long long &multiple = 1) const
+		{
+			Calendar::Detail::checkUnit(unit, multiple);
+			return onLocalCalendar([&](const long long &unixTime, const long long &utcOffset) {
+				return Calendar::Detail::roundToUnit(unixTime, unit, multiple, utcOffset, Calendar::Detail::ROUND_FLOOR);
+			});
+		}
+		/**
+		* 暦の単位 (の multiple 倍) に切り上げた日時を返却する。境界上の日時はそのまま。 \n
+		* Return the Datetime ceiled to the calendar unit (or its multiple). A Datetime on a boundary is not changed.
+		*/
+		Datetime ceil(const Calendar::Unit &unit, const long long &multiple = 1) const
+		{
+			Calendar::Detail::checkUnit(unit, multiple);
+			return onLocalCalendar([&](const long long &unixTime, const long long &utcOffset) {
+				return Calendar::Detail::roundToUnit(unixTime, unit, multiple, utcOffset, Calendar::Detail::ROUND_CEIL);
+			});
+		}
+		/**
+		* 最も近い暦の単位 (の multiple 倍) に丸めた日時を返却する。ちょうど中間なら切り上げる。 \n
+		* Return the Datetime rounded to the nearest calendar unit (or its multiple). Half way rounds up.
+		*/
+		Datetime round(const Calendar::Unit &unit, const long long &multiple = 1) const
+		{
+			Calendar::Detail::checkUnit(unit, multiple);
+			return onLocalCalendar([&](const long long &unixTime, const long long &utcOffset) {
+				return Calendar::Detail::roundToUnit(unixTime, unit, multiple, utcOffset, Calendar::Detail::ROUND_NEAREST);
+			});
+		}
+		/**
+		* 月初 (1日 0:00:00) の日時を返却する \n
+		* Return the Datetime at 00:00:00 on the first day of the month.
+		*/
+		Datetime startOfMonth() const
+		{
+			return onLocalCalendar([](const long long &unixTime, const long long &utcOffset) {
+				return Calendar::startOfMonth(unixTime, utcOffset);
+			});
+		}
+		/**
+		* 月末 (最終日 23:59:59) の日時を返却する \n
+		* Return the Datetime at 23:59:59 on the last day of the month.
+		*/
+		Datetime endOfMonth() const
+		{
+			return onLocalCalendar([](const long long &unixTime, const long long &utcOffset) {
+				return Calendar::endOfMonth(unixTime, utcOffset);
+			});
+		}
+
 	private:
 		/**
 		* 入力値のチェックをする
@@ -466,19 +740,91 @@ namespace EZ
 		/**
 		* std::string を struct tm に変換する
 		*/
-		void setDateTime(const std::string &timestamp, const std::string &format)
+		// 固定レイアウトの解析に失敗したら例外を投げる
+		static void throwIfNotParsed(const bool &parsed, const char *timestamp, const size_t &timestampLen, const char *layout)
+		{
+			if (!parsed)
+			{
+				Metrics::increment(Metrics::PARSE_FAILURE_MISMATCH);
+				throw DatetimeException("ERROR: \"" + std::string(timestamp, timestampLen) + "\" is not " + layout + ".");
+			}
+		}
+
+		// タイムゾーンの暦での 1970/1/1 からの通算日数
+		long long localDays() const
+		{
+			auto tmpTm = structTm();
+			return MyTM::daysFromCivil((long long)tmpTm.tm_year + DatetimeConstants::TM_BASE_YEAR, tmpTm.tm_mon + DatetimeConstants::MONTH_OFFSET, tmpTm.tm_mday);
+		}
+
+		// 暦の演算を現地時刻 (またはUTC) の暦で行う。f(unixTime, utcOffset) はそのオフセットの暦で計算する。
+		// 結果のオフセットが異なる (サマータイムをまたぐ) 場合は、結果のオフセットで計算し直す。
+		template <class F>
+		Datetime onLocalCalendar(F f) const
+		{
+			validateInput(m_unixTime);
+			if (m_isUTC)
+			{
+				return Datetime(time_t(f(m_unixTime, 0)), true);
+			}
+			const long long utcOffset = MyTM::utcOffsetOf(MyTM::my_mkStructTm(m_unixTime, false));
+			long long unixTime = f(m_unixTime, utcOffset);
+			validateInput(unixTime);
+			const long long newOffset = MyTM::utcOffsetOf(MyTM::my_mkStructTm(unixTime, false));
+			if (newOffset != utcOffset)
+			{
+				const long long retry = unixTime + utcOffset - newOffset;
+				// In the gap of summer time, the retry has another offset. Keep the first result then.
+				if (retry >= DatetimeConstants::MINIMUM_SEC && retry <= DatetimeConstants::MAXIMUM_SEC &&
+					MyTM::utcOffsetOf(MyTM::my_mkStructTm(retry, false)) == newOffset)
+				{
+					unixTime = retry;
+				}
+			}
+			return Datetime(time_t(unixTime), false);
+		}
+
+		static long long parseRfc3339(const char *timestamp, const size_t &timestampLen, long &nanoseconds)
+		{
+			long long unixTime = 0;
+			throwIfNotParsed(FixedFormat::parseRfc3339(timestamp, timestampLen, unixTime, nanoseconds), timestamp, timestampLen, "RFC 3339");
+			return unixTime;
+		}
+
+		void setDateTime(const char *timestamp, const size_t &timestampLen, const CompiledFormat &format)
+		{
+			long long unixTime;
+			if (format.tryParse(timestamp, timestampLen, m_isUTC, unixTime))
+			{
+				m_unixTime = time_t(unixTime);
+				return;
+			}
+			if (format.kind() == CompiledFormat::PATTERN)
+			{
+				// The generic parser reports the reason of the failure.
+				setDateTime(timestamp, timestampLen, format.format().c_str(), format.format().size());
+				return;
+			}
+			Metrics::increment(Metrics::PARSE_FAILURE_MISMATCH);
+			throw DatetimeException("ERROR: \"" + std::string(timestamp, timestampLen) + "\" is not a unix time or out of range.");
+		}
+
+		void setDateTime(const char *timestamp, const size_t &timestampLen, const char *format, const size_t &formatLen)
 		{
-			struct tm tmpTm = m_parser.str2time(timestamp, format);
+			MyParser::Offset utcOffset;
+			struct tm tmpTm = m_parser.str2time(timestamp, timestampLen, format, formatLen, utcOffset);
 			try
 			{
-				m_unixTime = MyTM::my_mktime(tmpTm, m_isUTC);
+				// With "%z" or "%s", the timestamp designates the instant regardless of isUTC.
+				m_unixTime = utcOffset.designated ? MyTM::my_mktime(tmpTm, true) - utcOffset.seconds : MyTM::my_mktime(tmpTm, m_isUTC);
 				validateInput(m_unixTime);
 			}
 			catch (...)
 			{
+				Metrics::increment(Metrics::PARSE_FAILURE_OUT_OF_RANGE);
 				std::stringstream ss;
 				ss << "ERROR: "
-				   << "\"" << timestamp << "\""
+				   << "\"" << std::string(timestamp, timestampLen) << "\""
 				   << " is in illegal time range." << std::endl;
 				throw DatetimeException(ss.str());
 			}
@@ -571,8 +917,7 @@ namespace EZ
 	*/
 	bool operator==(const Datetime &left, const Datetime &right)
 	{
-		auto diffSec = left - right;
-		return diffSec == 0;
+		return left.unixTime() == right.unixTime();
 	}
 
 	bool operator!=(const Datetime &left, const Datetime &right)
@@ -582,24 +927,22 @@ namespace EZ
 
 	bool operator<(const Datetime &left, const Datetime &right)
 	{
-		auto diffSec = left - right;
-		return diffSec < 0;
+		return left.unixTime() < right.unixTime();
 	}
 
 	bool operator>(const Datetime &left, const Datetime &right)
 	{
-		auto diffSec = left - right;
-		return diffSec > 0;
+		return left.unixTime() > right.unixTime();
 	}
 
 	bool operator<=(const Datetime &left, const Datetime &right)
 	{
-		return (left < right) || (left == right);
+		return left.unixTime() <= right.unixTime();
 	}
 
 	bool operator>=(const Datetime &left, const Datetime &right)
 	{
-		return (left > right) || (left == right);
+		return left.unixTime() >= right.unixTime();
 	}
 
 }
@@ -0,0 +1,402 @@
+#ifndef _MY_DATETIME_BINARY_
+#define _MY_DATETIME_BINARY_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "datetime.h"
+#include "time_delta.h"
+#include "datetime_exceptions.h"
+
+// Datetime と TimeDelta のバイナリ形式 (リトルエンディアン、CPU に依存しない)。
+// 仕様: Datetime はタイムゾーンの設定 (0 = ローカル時刻, 1 = UTC) を付けた値 unixTime * 2 + zone を保存する。TimeDelta は累計秒。
+//   FIXED: 8バイトの符号付き整数。配列は要素数 (8バイト) に続けて要素を並べるので、メモリマップしたまま View で読める。
+//   VARINT: zigzag 符号の可変長整数 (7ビットずつ、下位から)。Datetime の配列は2個目から直前との差を保存する。
+
+namespace EZ
+{
+    namespace Binary
+    {
+        /**
+        * 整数の形式 \n
+        * Encoding of integers.
+        */
+        enum Mode
+        {
+            FIXED,  // 8 bytes, little endian
+            VARINT, // zigzag varint (1 ~ 10 bytes)
+        };
+
+        // Size of a value in FIXED mode.
+        const size_t FIXED_SIZE = 8;
+
+        namespace Detail
+        {
+            inline uint64_t load64(const unsigned char *p)
+            {
+                // Compilers make this a single load on little endian CPUs.
+                uint64_t value = 0;
+                for (int i = 7; i >= 0; i--)
+                {
+                    value = (value << 8) | p[i];
+                }
+                return value;
+            }
+            inline void store64(unsigned char *p, const uint64_t &value)
+            {
+                for (int i = 0; i < 8; i++)
+                {
+                    p[i] = (unsigned char)(value >> (8 * i));
+                }
+            }
+            inline uint64_t zigzag(const long long &value)
+            {
+                return (uint64_t(value) << 1) ^ uint64_t(0 - uint64_t(value < 0 ? 1 : 0));
+            }
+            inline long long unzigzag(const uint64_t &value)
+            {
+                return (long long)((value >> 1) ^ (0 - (value & 1)));
+            }
+            inline void putVarint(std::vector<unsigned char> &out, uint64_t value)
+            {
+                while (value >= 0x80)
+                {
+                    out.push_back((unsigned char)(value | 0x80));
+                    value >>= 7;
+                }
+                out.push_back((unsigned char)value);
+            }
+            // Datetime with its timezone setting.
+            inline long long tagged(const Datetime &time)
+            {
+                return time.unixTime() * 2 + (time.isUTC() ? 1 : 0);
+            }
+            inline Datetime untagged(const long long &value)
+            {
+                const long long zone = value & 1;
+                return Datetime(time_t((value - zone) / 2), zone == 1);
+            }
+        }
+
+        /**
+        * バイト列に書き込む \n
+        * Append the binary form to out.
+        */
+        inline void write(std::vector<unsigned char> &out, const Datetime &time, const Mode &mode = FIXED)
+        {
+            if (mode == FIXED)
+            {
+                out.resize(out.size() + FIXED_SIZE);
+                Detail::store64(&out[out.size() - FIXED_SIZE], uint64_t(Detail::tagged(time)));
+            }
+            else
+            {
+                Detail::putVarint(out, Detail::zigzag(Detail::tagged(time)));
+            }
+        }
+        inline void write(std::vector<unsigned char> &out, const TimeDelta &delta, const Mode &mode = FIXED)
+        {
+            if (mode == FIXED)
+            {
+                out.resize(out.size() + FIXED_SIZE);
+                Detail::store64(&out[out.size() - FIXED_SIZE], uint64_t(delta.totalSeconds()));
+            }
+            else
+            {
+                Detail::putVarint(out, Detail::zigzag(delta.totalSeconds()));
+            }
+        }
+        /**
+        * 配列を書き込む (要素数、要素の順) \n
+        * Append an array: the number of elements, then the elements.
+        * @details In VARINT mode, Datetimes after the first are stored as the differences from the previous ones.
+        */
+        inline void write(std::vector<unsigned char> &out, const Datetime *times, const size_t &count, const Mode &mode = FIXED)
+        {
+            if (mode == FIXED)
+            {
+                size_t position = out.size();
+                out.resize(out.size() + FIXED_SIZE * (count + 1));
+                Detail::store64(&out[position], uint64_t(count));
+                for (size_t i = 0; i < count; i++)
+                {
+                    position += FIXED_SIZE;
+                    Detail::store64(&out[position], uint64_t(Detail::tagged(times[i])));
+                }
+                return;
+            }
+            Detail::putVarint(out, uint64_t(count));
+            long long previous = 0;
+            for (size_t i = 0; i < count; i++)
+            {
+                // The difference of the unix times and the timezone setting of the time.
+                const long long unixTime = times[i].unixTime();
+                Detail::putVarint(out, Detail::zigzag(unixTime - previous) * 2 + (times[i].isUTC() ? 1 : 0));
+                previous = unixTime;
+            }
+        }
+        inline void write(std::vector<unsigned char> &out, const std::vector<Datetime> &times, const Mode &mode = FIXED)
+        {
+            write(out, times.data(), times.size(), mode);
+        }
+        inline void write(std::vector<unsigned char> &out, const TimeDelta *deltas, const size_t &count, const Mode &mode = FIXED)
+        {
+            if (mode == FIXED)
+            {
+                size_t position = out.size();
+                out.resize(out.size() + FIXED_SIZE * (count + 1));
+                Detail::store64(&out[position], uint64_t(count));
+                for (size_t i = 0; i < count; i++)
+                {
+                    position += FIXED_SIZE;
+                    Detail::store64(&out[position], uint64_t(deltas[i].totalSeconds()));
+                }
+                return;
+            }
+            Detail::putVarint(out, uint64_t(count));
+            for (size_t i = 0; i < count; i++)
+            {
+                Detail::putVarint(out, Detail::zigzag(deltas[i].totalSeconds()));
+            }
+        }
+        inline void write(std::vector<unsigned char> &out, const std::vector<TimeDelta> &deltas, const Mode &mode = FIXED)
+        {
+            write(out, deltas.data(), deltas.size(), mode);
+        }
+
+        /**
+        * @brief Zero-copy view of an array of Datetimes in FIXED mode
+        * @details Elements are decoded on access from the buffer (ex: a memory-mapped file). Keep the buffer alive while using the view.
+        */
+        class DatetimeView
+        {
+        public:
+            /**
+            * @param[in] data	the first element (after the number of elements). No alignment is required.
+            * @param[in] count	number of elements
+            */
+            DatetimeView(const unsigned char *data = nullptr, const size_t &count = 0) : m_data(data), m_count(count)
+            {
+            }
+            size_t size() const
+            {
+                return m_count;
+            }
+            Datetime operator[](const size_t &index) const
+            {
+                return Detail::untagged((long long)Detail::load64(m_data + index * FIXED_SIZE));
+            }
+            /**
+            * 要素の Unix秒 (Datetime を作らない) \n
+            * Unix time of the element, without making a Datetime.
+            */
+            long long unixTime(const size_t &index) const
+            {
+                const long long value = (long long)Detail::load64(m_data + index * FIXED_SIZE);
+                return (value - (value & 1)) / 2;
+            }
+            bool isUTC(const size_t &index) const
+            {
+                return (m_data[index * FIXED_SIZE] & 1) != 0;
+            }
+
+        private:
+            const unsigned char *m_data;
+            size_t m_count;
+        };
+
+        /**
+        * @brief Zero-copy view of an array of TimeDeltas in FIXED mode
+        */
+        class TimeDeltaView
+        {
+        public:
+            TimeDeltaView(const unsigned char *data = nullptr, const size_t &count = 0) : m_data(data), m_count(count)
+            {
+            }
+            size_t size() const
+            {
+                return m_count;
+            }
+            TimeDelta operator[](const size_t &index) const
+            {
+                return TimeDelta(totalSeconds(index));
+            }
+            long long totalSeconds(const size_t &index) const
+            {
+                return (long long)Detail::load64(m_data + index * FIXED_SIZE);
+            }
+
+        private:
+            const unsigned char *m_data;
+            size_t m_count;
+        };
+
+        /**
+        * @brief Reader of the binary form
+        * @details Reads values in the order they were written. Throws DatetimeException if the data is truncated or corrupted. \n
+        * ex: \n
+        * EZ::Binary::Reader reader(buffer.data(), buffer.size()); \n
+        * EZ::Datetime time = reader.readDatetime();
+        */
+        class Reader
+        {
+        public:
+            Reader(const unsigned char *data, const size_t &size) : m_data(data), m_size(size), m_position(0)
+            {
+            }
+            Reader(const std::vector<unsigned char> &data) : Reader(data.data(), data.size())
+            {
+            }
+
+            /**
+            * 読んだバイト数 \n
+            * Number of bytes read.
+            */
+            size_t position() const
+            {
+                return m_position;
+            }
+            /**
+            * すべて読んだら true \n
+            * true if all bytes have been read.
+            */
+            bool atEnd() const
+            {
+                return m_position == m_size;
+            }
+
+            Datetime readDatetime(const Mode &mode = FIXED)
+            {
+                return Detail::untagged(mode == FIXED ? (long long)readFixed() : Detail::unzigzag(readVarint()));
+            }
+            TimeDelta readTimeDelta(const Mode &mode = FIXED)
+            {
+                return TimeDelta(mode == FIXED ? (long long)readFixed() : Detail::unzigzag(readVarint()));
+            }
+            std::vector<Datetime> readDatetimes(const Mode &mode = FIXED)
+            {
+                std::vector<Datetime> times;
+                if (mode == FIXED)
+                {
+                    const DatetimeView view = viewDatetimes();
+                    times.reserve(view.size());
+                    for (size_t i = 0; i < view.size(); i++)
+                    {
+                        times.push_back(view[i]);
+                    }
+                    return times;
+                }
+                const size_t count = readCount(1);
+                times.reserve(count);
+                long long previous = 0;
+                for (size_t i = 0; i < count; i++)
+                {
+                    // Add in unsigned arithmetic, so corrupted differences can not overflow.
+                    const uint64_t value = readVarint();
+                    const long long unixTime = (long long)(uint64_t(previous) + uint64_t(Detail::unzigzag(value >> 1)));
+                    if (unixTime < DatetimeConstants::MINIMUM_SEC || unixTime > DatetimeConstants::MAXIMUM_SEC)
+                    {
+                        throw DatetimeException("ERROR: The binary data is corrupted.");
+                    }
+                    previous = unixTime;
+                    times.push_back(Datetime(time_t(unixTime), (value & 1) != 0));
+                }
+                return times;
+            }
+            std::vector<TimeDelta> readTimeDeltas(const Mode &mode = FIXED)
+            {
+                std::vector<TimeDelta> deltas;
+                if (mode == FIXED)
+                {
+                    const TimeDeltaView view = viewTimeDeltas();
+                    deltas.reserve(view.size());
+                    for (size_t i = 0; i < view.size(); i++)
+                    {
+                        deltas.push_back(view[i]);
+                    }
+                    return deltas;
+                }
+                const size_t count = readCount(1);
+                deltas.reserve(count);
+                for (size_t i = 0; i < count; i++)
+                {
+                    deltas.push_back(TimeDelta(Detail::unzigzag(readVarint())));
+                }
+                return deltas;
+            }
+
+            /**
+            * FIXED 形式の配列をコピーせずに参照する \n
+            * View of an array in FIXED mode without copying.
+            */
+            DatetimeView viewDatetimes()
+            {
+                const size_t count = size_t(readFixed());
+                return DatetimeView(skip(count), count);
+            }
+            TimeDeltaView viewTimeDeltas()
+            {
+                const size_t count = size_t(readFixed());
+                return TimeDeltaView(skip(count), count);
+            }
+
+        private:
+            const unsigned char *m_data;
+            size_t m_size;
+            size_t m_position;
+
+            uint64_t readFixed()
+            {
+                if (m_size - m_position < FIXED_SIZE)
+                {
+                    throw DatetimeException("ERROR: The binary data is truncated.");
+                }
+                const uint64_t value = Detail::load64(m_data + m_position);
+                m_position += FIXED_SIZE;
+                return value;
+            }
+            uint64_t readVarint()
+            {
+                uint64_t value = 0;
+                for (int shift = 0; shift < 64; shift += 7)
+                {
+                    if (m_position == m_size)
+                    {
+                        throw DatetimeException("ERROR: The binary data is truncated.");
+                    }
+                    const unsigned char byte = m_data[m_position++];
+                    value |= uint64_t(byte & 0x7F) << shift;
+                    if ((byte & 0x80) == 0)
+                    {
+                        return value;
+                    }
+                }
+                throw DatetimeException("ERROR: The binary data is corrupted.");
+            }
+            // Number of elements of an array whose elements take at least minimumSize bytes each.
+            size_t readCount(const size_t &minimumSize)
+            {
+                const uint64_t count = readVarint();
+                if (count > (m_size - m_position) / minimumSize)
+                {
+                    throw DatetimeException("ERROR: The binary data is truncated.");
+                }
+                return size_t(count);
+            }
+            // Skip the elements of a FIXED array and return the first one.
+            const unsigned char *skip(const size_t &count)
+            {
+                if (count > (m_size - m_position) / FIXED_SIZE)
+                {
+                    throw DatetimeException("ERROR: The binary data is truncated.");
+                }
+                const unsigned char *first = m_data + m_position;
+                m_position += count * FIXED_SIZE;
+                return first;
+            }
+        };
+    }
+}
+#endif
@@ -0,0 +1,438 @@
+#ifndef _MY_DATETIME_CLOCK_
+#define _MY_DATETIME_CLOCK_
+
+#include <time.h>
+#include <atomic>
+#include <chrono>
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define EZ_CLOCK_TSC
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define EZ_CLOCK_TSC
+#endif
+
+#include "time_delta.h"
+#include "datetime_exceptions.h"
+
+// 現在時刻の取得元 (時計)。now() で Unix秒を返す型を、時刻を扱う関数やクラスにテンプレート引数で渡す (仮想関数を使わない)。
+// 仕様: SystemClock: time(NULL) / CoarseClock: update() で読んだ時刻を保持する (イベントループの1周ごとに更新する)
+//   AnchoredClock: システムの時刻 + 時刻印カウンタ (rdtsc) か単調増加の時計の経過時間。定期的にシステムの時刻を読み直し、差が小さければ速さを調整し、大きければ飛ばす / ManualClock: 手動で進める / SimulatedClock: 実時間の speed 倍で進む
+// 秒未満も返す時計は unixNanoseconds() を持つ (SystemClock, AnchoredClock, SimulatedClock)。
+// ex: EZ::Datetime::now(clock), EZ::FixedFormat::httpDateNow(clock, length), EZ::TimerWheel::poll(clock, expired)
+
+namespace EZ
+{
+    namespace Detail
+    {
+        const long long NANOSECONDS_PER_SECOND = 1000000000LL;
+        // Minimum interval of re-anchoring (a millisecond).
+        const long long MINIMUM_ANCHOR_INTERVAL = 1000000LL;
+#if defined(EZ_CLOCK_TSC)
+        const bool TSC_AVAILABLE = true;
+#else
+        const bool TSC_AVAILABLE = false;
+#endif
+
+        // Unix seconds of unix nanoseconds (rounded down).
+        inline long long floorSeconds(const long long &unixNanoseconds)
+        {
+            const long long seconds = unixNanoseconds / NANOSECONDS_PER_SECOND;
+            return seconds - (unixNanoseconds % NANOSECONDS_PER_SECOND < 0 ? 1 : 0);
+        }
+
+        inline long long systemNanoseconds()
+        {
+            return (long long)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+
+        // Ticks of the time stamp counter, or nanoseconds of the monotonic clock.
+        inline long long readTicks(const bool &tsc)
+        {
+#if defined(EZ_CLOCK_TSC)
+            if (tsc)
+            {
+                return (long long)__rdtsc();
+            }
+#else
+            (void)tsc;
+#endif
+            return (long long)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+    }
+
+    /**
+    * @brief System clock: time(NULL)
+    * @details A clock is a type with "long long now() const" returning unix seconds. Functions take it as a template parameter (no virtual call).
+    */
+    class SystemClock
+    {
+    public:
+        long long now() const
+        {
+            return (long long)time(NULL);
+        }
+        /**
+        * 現在時刻 (Unix時間のナノ秒) \n
+        * Current unix time in nanoseconds.
+        */
+        long long unixNanoseconds() const
+        {
+            return Detail::systemNanoseconds();
+        }
+    };
+
+    /**
+    * @brief Cached clock for hot paths
+    * @details now() returns the time stored by the last update(), by an atomic load. \n
+    * Call update() once per iteration of an event loop (or from a thread every second), and read now() any number of times in between.
+    * Thread-safe. Pass it by reference.
+    */
+    class CoarseClock
+    {
+    public:
+        CoarseClock()
+        {
+            update();
+        }
+        CoarseClock(const CoarseClock &) = delete;
+        CoarseClock &operator=(const CoarseClock &) = delete;
+
+        long long now() const
+        {
+            return m_now.load(std::memory_order_relaxed);
+        }
+        /**
+        * システムの時刻を読み直す \n
+        * Read the system time again, and return it.
+        */
+        long long update()
+        {
+            const long long unixTime = (long long)time(NULL);
+            m_now.store(unixTime, std::memory_order_relaxed);
+            return unixTime;
+        }
+
+    private:
+        std::atomic<long long> m_now;
+    };
+
+    /**
+    * @brief Wall clock anchored to a counter, with nanoseconds
+    * @details Reads the system time once, and derives the time from the time stamp counter (rdtsc on x86) or the monotonic clock since then.
+    * It reads the system time again periodically (re-anchoring) to follow NTP: \n
+    * - differences up to maxDrift are slewed (the rate is adjusted until the next anchor, so the time never goes back). \n
+    * - larger differences (the system time was set) are stepped, as Datetime::now() would see them. \n
+    * The interval of re-anchoring is halved while the differences exceed maxDrift / 2, and doubled (up to maxInterval) while they are under maxDrift / 8. \n
+    * Thread-safe: the anchor is published by a sequence lock, and one of the readers re-anchors when it is due.
+    */
+    class AnchoredClock
+    {
+    public:
+        /**
+        * @param[in] maxDrift	maximum difference from the system time in nanoseconds (default: 100 microseconds)
+        * @param[in] maxInterval	maximum interval of re-anchoring in nanoseconds (default: 1 second)
+        * @param[in] useTsc	if true, the time stamp counter is used where available. Otherwise std::chrono::steady_clock is used.
+        */
+        AnchoredClock(const long long &maxDrift = 100000, const long long &maxInterval = Detail::NANOSECONDS_PER_SECOND, const bool &useTsc = true)
+            : m_tsc(useTsc && Detail::TSC_AVAILABLE), m_maxDrift(maxDrift), m_maxInterval(maxInterval), m_sequence(0), m_numAnchors(0), m_numSteps(0), m_lastDrift(0)
+        {
+            if (maxDrift <= 0 || maxInterval < Detail::MINIMUM_ANCHOR_INTERVAL)
+            {
+                throw DatetimeException("ERROR: The drift bound or the interval is too small.");
+            }
+            long long ticks, wall;
+            read(ticks, wall);
+            m_baseTicks = ticks;
+            m_baseWall = wall;
+            m_rate = 1.0;
+            // Calibrate the counter for a millisecond. Try again if the thread was preempted meanwhile
+            // (the counter may stop while a virtual machine is descheduled).
+            for (int attempt = 0; m_tsc && attempt < 4; attempt++)
+            {
+                long long endTicks, endWall;
+                do
+                {
+                    read(endTicks, endWall);
+                } while (endWall - wall < Detail::MINIMUM_ANCHOR_INTERVAL && endWall >= wall);
+                if (endTicks > ticks && endWall > wall)
+                {
+                    m_rate = double(endWall - wall) / double(endTicks - ticks);
+                }
+                m_baseTicks = ticks;
+                m_baseWall = wall;
+                ticks = endTicks;
+                wall = endWall;
+                if (endWall - m_baseWall < 2 * Detail::MINIMUM_ANCHOR_INTERVAL)
+                {
+                    break;
+                }
+            }
+            m_nominalRate = m_rate;
+            m_rebased = false;
+            m_interval = Detail::MINIMUM_ANCHOR_INTERVAL * 8 < m_maxInterval ? Detail::MINIMUM_ANCHOR_INTERVAL * 8 : m_maxInterval;
+            m_anchorTicks.store(ticks, std::memory_order_relaxed);
+            m_anchorWall.store(wall, std::memory_order_relaxed);
+            m_anchorRate.store(m_rate, std::memory_order_relaxed);
+            m_nextTicks.store(ticks + toTicks(m_interval), std::memory_order_relaxed);
+        }
+        AnchoredClock(const AnchoredClock &) = delete;
+        AnchoredClock &operator=(const AnchoredClock &) = delete;
+
+        /**
+        * 現在時刻 (Unix秒) \n
+        * Current unix time in seconds.
+        */
+        long long now() const
+        {
+            return Detail::floorSeconds(unixNanoseconds());
+        }
+        /**
+        * 現在時刻 (Unix時間のナノ秒) \n
+        * Current unix time in nanoseconds.
+        */
+        long long unixNanoseconds() const
+        {
+            while (true)
+            {
+                const unsigned sequence = m_sequence.load(std::memory_order_acquire);
+                const long long ticks = Detail::readTicks(m_tsc);
+                const long long anchorTicks = m_anchorTicks.load(std::memory_order_relaxed);
+                const long long anchorWall = m_anchorWall.load(std::memory_order_relaxed);
+                const double rate = m_anchorRate.load(std::memory_order_relaxed);
+                const long long nextTicks = m_nextTicks.load(std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if ((sequence & 1) != 0 || m_sequence.load(std::memory_order_relaxed) != sequence)
+                {
+                    // Being re-anchored.
+                    continue;
+                }
+                if (ticks >= nextTicks && reanchor(sequence))
+                {
+                    continue;
+                }
+                return anchorWall + (long long)(double(ticks - anchorTicks) * rate);
+            }
+        }
+
+        /**
+        * 再アンカーの回数 (作成時を除く) \n
+        * Number of re-anchorings.
+        */
+        long long numAnchors() const
+        {
+            return m_numAnchors.load(std::memory_order_relaxed);
+        }
+        /**
+        * 差が maxDrift を超えて時刻を飛ばした回数 \n
+        * Number of re-anchorings whose differences exceeded maxDrift (stepped).
+        */
+        long long numSteps() const
+        {
+            return m_numSteps.load(std::memory_order_relaxed);
+        }
+        /**
+        * 最後の再アンカーでのシステムの時刻との差 (ナノ秒, 正ならこの時計が遅れていた) \n
+        * Difference from the system time at the last re-anchoring in nanoseconds: positive if this clock was behind.
+        */
+        long long lastDrift() const
+        {
+            return m_lastDrift.load(std::memory_order_relaxed);
+        }
+        /**
+        * 時刻の元が時刻印カウンタなら true \n
+        * true if the time stamp counter is used.
+        */
+        bool usesTsc() const
+        {
+            return m_tsc;
+        }
+
+    private:
+        const bool m_tsc;
+        const long long m_maxDrift;
+        const long long m_maxInterval;
+        // Anchor: the time anchorWall (unix nanoseconds) at anchorTicks, advancing by rate nanoseconds per tick. Re-anchored at nextTicks.
+        mutable std::atomic<unsigned> m_sequence;
+        mutable std::atomic<long long> m_anchorTicks;
+        mutable std::atomic<long long> m_anchorWall;
+        mutable std::atomic<double> m_anchorRate;
+        mutable std::atomic<long long> m_nextTicks;
+        mutable std::atomic<long long> m_numAnchors;
+        mutable std::atomic<long long> m_numSteps;
+        mutable std::atomic<long long> m_lastDrift;
+        // Used only while re-anchoring (the sequence is odd): the system time read at the base (since the system time was last set),
+        // the rate measured since the base and the nominal rate (calibrated at the start), and the interval in nanoseconds.
+        mutable long long m_baseTicks;
+        mutable long long m_baseWall;
+        mutable double m_rate;
+        mutable double m_nominalRate;
+        mutable bool m_rebased; // the base was moved at the last anchor
+        mutable long long m_interval;
+
+        // The system time and the ticks at the same moment: the tightest of a few reads,
+        // since a read across a preemption (or the first call of the system clock) is off by half of it.
+        void read(long long &ticks, long long &wall) const
+        {
+            long long tightest = -1;
+            for (int i = 0; i < 3; i++)
+            {
+                const long long before = Detail::readTicks(m_tsc);
+                const long long system = Detail::systemNanoseconds();
+                const long long after = Detail::readTicks(m_tsc);
+                if (tightest < 0 || after - before < tightest)
+                {
+                    tightest = after - before;
+                    ticks = before + (after - before) / 2;
+                    wall = system;
+                }
+            }
+        }
+
+        long long toTicks(const long long &nanoseconds) const
+        {
+            return (long long)(double(nanoseconds) / m_rate);
+        }
+
+        // Re-anchor unless another thread is doing so. true if re-anchored.
+        bool reanchor(const unsigned &sequence) const
+        {
+            unsigned expected = sequence;
+            if (!m_sequence.compare_exchange_strong(expected, sequence + 1, std::memory_order_acquire, std::memory_order_relaxed))
+            {
+                return false;
+            }
+            std::atomic_thread_fence(std::memory_order_release);
+            long long ticks, wall;
+            read(ticks, wall);
+            const long long anchorTicks = m_anchorTicks.load(std::memory_order_relaxed);
+            const long long predicted = m_anchorWall.load(std::memory_order_relaxed) +
+                                        (long long)(double(ticks - anchorTicks) * m_anchorRate.load(std::memory_order_relaxed));
+            const long long drift = wall - predicted;
+            const long long magnitude = drift < 0 ? -drift : drift;
+            if (magnitude > m_maxDrift / 2)
+            {
+                m_interval = m_interval / 2 > Detail::MINIMUM_ANCHOR_INTERVAL ? m_interval / 2 : Detail::MINIMUM_ANCHOR_INTERVAL;
+            }
+            else if (magnitude < m_maxDrift / 8)
+            {
+                m_interval = m_interval * 2 < m_maxInterval ? m_interval * 2 : m_maxInterval;
+            }
+            // Measure the rate over the whole span since the base, so the jitter of the reads fades as it grows.
+            // A rate far from the nominal one means that the system time was set since the base,
+            // or that the calibration was wrong if it is still far right after moving the base.
+            bool plausible = false;
+            if (ticks > m_baseTicks && wall > m_baseWall)
+            {
+                const double rate = double(wall - m_baseWall) / double(ticks - m_baseTicks);
+                plausible = m_rebased || (rate > m_nominalRate * 0.9 && rate < m_nominalRate * 1.1);
+                m_nominalRate = m_rebased ? rate : m_nominalRate;
+                m_rate = plausible ? rate : m_rate;
+            }
+            if (magnitude > m_maxDrift)
+            {
+                // Step. If the system time was set, measure the rate again from here.
+                if (!plausible)
+                {
+                    m_baseTicks = ticks;
+                    m_baseWall = wall;
+                }
+                m_rebased = !plausible;
+                m_anchorWall.store(wall, std::memory_order_relaxed);
+                m_anchorRate.store(m_rate, std::memory_order_relaxed);
+                m_numSteps.fetch_add(1, std::memory_order_relaxed);
+            }
+            else
+            {
+                m_rebased = false;
+                // Slew: continue from the predicted time, and catch up with the system time by the next anchor.
+                const double rate = m_rate + double(drift) / double(toTicks(m_interval));
+                m_anchorWall.store(predicted, std::memory_order_relaxed);
+                m_anchorRate.store(rate > m_rate / 2 ? rate : m_rate / 2, std::memory_order_relaxed);
+            }
+            m_anchorTicks.store(ticks, std::memory_order_relaxed);
+            m_nextTicks.store(ticks + toTicks(m_interval), std::memory_order_relaxed);
+            m_lastDrift.store(drift, std::memory_order_relaxed);
+            m_numAnchors.fetch_add(1, std::memory_order_relaxed);
+            m_sequence.store(sequence + 2, std::memory_order_release);
+            return true;
+        }
+    };
+
+    /**
+    * @brief Clock set by hand (for tests)
+    * @details Thread-safe: it can be advanced by a thread and read by others. Pass it by reference.
+    */
+    class ManualClock
+    {
+    public:
+        ManualClock(const long long &unixTime = 0) : m_now(unixTime)
+        {
+        }
+        ManualClock(const ManualClock &) = delete;
+        ManualClock &operator=(const ManualClock &) = delete;
+
+        long long now() const
+        {
+            return m_now.load(std::memory_order_acquire);
+        }
+        /**
+        * 時刻を設定する (戻してもよい) \n
+        * Set the time. It may go back.
+        */
+        void set(const long long &unixTime)
+        {
+            m_now.store(unixTime, std::memory_order_release);
+        }
+        /**
+        * 時刻を進める \n
+        * Advance the time.
+        */
+        void advance(const long long &seconds)
+        {
+            m_now.fetch_add(seconds, std::memory_order_acq_rel);
+        }
+        void advance(const TimeDelta &delta)
+        {
+            advance(delta.totalSeconds());
+        }
+
+    private:
+        std::atomic<long long> m_now;
+    };
+
+    /**
+    * @brief Simulated clock running speed times faster than real time (ex: replaying a day of traffic in minutes)
+    * @details Starts at start, and advances by the time elapsed on std::chrono::steady_clock multiplied by speed.
+    */
+    class SimulatedClock
+    {
+    public:
+        /**
+        * @param[in] start	simulated time at the construction (unix seconds)
+        * @param[in] speed	simulated seconds per real second. ex: 288 => a day in 5 minutes
+        */
+        SimulatedClock(const long long &start, const double &speed) : m_anchor(start), m_speed(speed), m_start(std::chrono::steady_clock::now())
+        {
+        }
+        long long now() const
+        {
+            return Detail::floorSeconds(unixNanoseconds());
+        }
+        long long unixNanoseconds() const
+        {
+            const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start).count();
+            return m_anchor * Detail::NANOSECONDS_PER_SECOND + (long long)(double(elapsed) * m_speed);
+        }
+        double speed() const
+        {
+            return m_speed;
+        }
+
+    private:
+        long long m_anchor;
+        double m_speed;
+        std::chrono::steady_clock::time_point m_start;
+    };
+}
+#endif
@@ -12,9 +12,32 @@ namespace DatetimeConstants
 	const int TM_BASE_YEAR = 1900;
 	const int MONTH_OFFSET = 1;
 
+	// 月名・曜日名 ("%b %B %a %A")。略称は先頭3文字。
+	// Names of "%b %B %a %A". The abbreviation is the first 3 letters.
+	const char *const MONTH_NAMES[12] = {"January", "February", "March", "April", "May", "June",
+										 "July", "August", "September", "October", "November", "December"};
+	const char *const WEEKDAY_NAMES[7] = {"Sunday", "Monday", "Tuesday", "Wednesday", "Thursday", "Friday", "Saturday"};
+
+	// 扱える範囲は struct tm の tm_year (int) で表現できる年に制限する (ローカル時刻の補正用に前後1年の余裕を持たせる)
+	// The range is limited to years representable by tm_year (int) of struct tm, with one year margin for local offsets.
+	const long long MINIMUM_YEAR = -2147481747;
+	const long long MAXIMUM_YEAR = 2147483646;
+	const long long MINIMUM_SEC = -67768040578118400; // at -2147481747/01/01 00:00:00 UTC
+	const long long MAXIMUM_SEC = 67767976201996799;  // at 2147483646/12/31 23:59:59 UTC
+
+	// Windows の localtime()/mktime() が扱える範囲。範囲外は400年周期でずらして計算する。
+	// The range handled by localtime()/mktime() on Windows. Out of this range, the time is shifted by 400-year cycles.
 	// https://docs.microsoft.com/ja-jp/cpp/c-runtime-library/reference/gmtime-gmtime32-gmtime64?view=msvc-160
-	const int MINIMUM_SEC = 0;
-	const long long MAXIMUM_SEC = 32503766400; // at 3000/1/2 00:00:00 UTC
+	const long long NATIVE_MINIMUM_SEC = 0;
+	const long long NATIVE_MAXIMUM_SEC = 32503766400; // at 3000/1/2 00:00:00 UTC
+	const long long NATIVE_MINIMUM_YEAR = 1970;
+	const long long NATIVE_MAXIMUM_YEAR = 2999;
+	const long long NATIVE_ANCHOR_SEC = 946684800; // at 2000/1/1 00:00:00 UTC
+	const long long NATIVE_ANCHOR_YEAR = 2000;
+
+	const long long SECONDS_PER_DAY = 86400;
+	const long long DAYS_PER_400_YEARS = 146097;
+	const long long SECONDS_PER_400_YEARS = DAYS_PER_400_YEARS * SECONDS_PER_DAY;
 
 	double DOUBLE_EPSILON = std::numeric_limits<double>::epsilon();
 }
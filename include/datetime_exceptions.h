@@ -3,6 +3,8 @@
 
 #include <stdexcept>
 #include <string>
+
+#include "datetime_metrics.h"
 namespace EZ
 {
 	class DatetimeException : std::exception
@@ -12,9 +14,11 @@ namespace EZ
 	public:
 		DatetimeException(const char *msg) : m_err(msg)
 		{
+			Metrics::increment(Metrics::EXCEPTIONS_THROWN);
 		}
 		DatetimeException(const std::string str) : m_err(str.c_str())
 		{
+			Metrics::increment(Metrics::EXCEPTIONS_THROWN);
 		}
 
 		const char *what() const throw()
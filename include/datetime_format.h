@@ -0,0 +1,575 @@
+#ifndef _MY_DATETIME_FORMAT_
+#define _MY_DATETIME_FORMAT_
+
+#include <string>
+#include <sstream>
+#include <vector>
+#include <algorithm>
+#include <time.h>
+#include <string.h>
+
+#include "datetime_parser.h"
+#include "datetime_exceptions.h"
+#include "datetime_constants.h"
+#include "datetime_metrics.h"
+#include "unix_time.h"
+
+// 書式を事前に解析した CompiledFormat と、サンプル文字列から書式を推定する detectFormat()
+// 仕様: 書式の検証 (指定子の重複・未対応・年の有無) はコンパイル時に1度だけ行い、解析時は例外を投げずに成否を返す。
+
+namespace EZ
+{
+    /**
+    * @brief Compiled format
+    * @details Pre-tokenized input format. Parsing with it skips the validation of the format
+    * and does not allocate. Create it with compile() or detectFormat().
+    */
+    class CompiledFormat
+    {
+    public:
+        enum Kind
+        {
+            INVALID = 0,   // Not compiled.
+            PATTERN,       // Specifiers and delimiters. ex: %Y/%m/%d %H:%M:%S
+            EPOCH_SECONDS, // Unix seconds. ex: 1615161615
+            EPOCH_MILLIS   // Unix milliseconds. ex: 1615161615123
+        };
+
+        CompiledFormat()
+        {
+        }
+
+        /**
+        * 書式文字列をコンパイルする \n
+        * Compile the format string. Throw DatetimeException if the format is invalid.
+        * @param[in] format ex: %Y/%m/%d %H:%M:%S
+        */
+        static CompiledFormat compile(const std::string &format)
+        {
+            CompiledFormat ret;
+            ret.m_kind = PATTERN;
+            ret.m_format = format;
+
+            unsigned long long registeredKeys = 0;
+            size_t fi = 0;
+            while (fi < format.size())
+            {
+                if (!MyParser::isSpecifier(format.c_str(), format.size(), fi))
+                {
+                    if (MyParser::isDigit(format[fi]))
+                    {
+                        // Digit runs of timestamp are always read as values.
+                        throw DatetimeException("ERROR: Delimiter must not contain digits. in " + format);
+                    }
+                    if (ret.m_ops.empty() || ret.m_ops.back().key != '\0')
+                    {
+                        ret.m_ops.push_back(Op{'\0', fi, 0});
+                    }
+                    ret.m_ops.back().length++;
+                    fi++;
+                    continue;
+                }
+                const char key = format[fi + 1];
+                const unsigned long long bits = MyParser::fieldBits(key);
+                if (registeredKeys & bits)
+                {
+                    std::stringstream ss;
+                    ss << "ERORR: Format specifier is duplicated."
+                       << " \"%" << key << "\" "
+                       << std::endl
+                       << "in " << format << std::endl;
+                    throw DatetimeException(ss.str());
+                }
+                if (bits == 0)
+                {
+                    std::stringstream ess;
+                    ess << "ERROR: "
+                        << "\"%" << key << "\""
+                        << " is invalid input specifier.";
+                    throw DatetimeException(ess.str());
+                }
+                registeredKeys |= bits;
+                ret.m_ops.push_back(Op{key, fi, 2});
+                fi += 2;
+            }
+            if (registeredKeys == 0)
+            {
+                throw DatetimeException("ERROR: No specifier is contained.");
+            }
+            if (!(registeredKeys & MyParser::keyBit('Y')))
+            {
+                throw DatetimeException("ERROR: Expression \"%Y\" (Year) must be designated.");
+            }
+            return ret;
+        }
+
+        static CompiledFormat epochSeconds()
+        {
+            CompiledFormat ret;
+            ret.m_kind = EPOCH_SECONDS;
+            return ret;
+        }
+
+        static CompiledFormat epochMillis()
+        {
+            CompiledFormat ret;
+            ret.m_kind = EPOCH_MILLIS;
+            return ret;
+        }
+
+        Kind kind() const
+        {
+            return m_kind;
+        }
+
+        bool valid() const
+        {
+            return m_kind != INVALID;
+        }
+
+        /**
+        * 書式文字列を返す (PATTERN 以外は空文字列) \n
+        * Return the format string. Empty unless kind() is PATTERN.
+        */
+        const std::string &format() const
+        {
+            return m_format;
+        }
+
+        /**
+        * 文字列を解析してUnix秒を返す。例外を投げず、ヒープ確保も行わない。 \n
+        * Parse the timestamp to unix seconds. Return false if the timestamp does not match. No throw, no allocation.
+        */
+        bool tryParse(const char *timestamp, const size_t &timestampLen, const bool &isUTC, long long &unixTime) const
+        {
+            Metrics::increment(Metrics::PARSE_CALLS);
+            Metrics::increment(Metrics::PARSE_FAST_PATH);
+            switch (m_kind)
+            {
+            case PATTERN:
+            {
+                struct tm time;
+                MyParser::Offset utcOffset;
+                if (!tryParseFields(timestamp, timestampLen, time, utcOffset))
+                {
+                    return false;
+                }
+                return toUnixTime(time, isUTC, utcOffset, unixTime);
+            }
+            case EPOCH_SECONDS:
+            case EPOCH_MILLIS:
+            {
+                long long value;
+                if (!tryParseInteger(timestamp, timestampLen, value))
+                {
+                    return false;
+                }
+                unixTime = (m_kind == EPOCH_MILLIS) ? MyTM::floorDiv(value, 1000) : value;
+                return DatetimeConstants::MINIMUM_SEC <= unixTime && unixTime <= DatetimeConstants::MAXIMUM_SEC;
+            }
+            default:
+                return false;
+            }
+        }
+
+        bool tryParse(const std::string &timestamp, const bool &isUTC, long long &unixTime) const
+        {
+            return tryParse(timestamp.c_str(), timestamp.size(), isUTC, unixTime);
+        }
+
+        bool operator==(const CompiledFormat &right) const
+        {
+            return m_kind == right.m_kind && m_format == right.m_format;
+        }
+
+        bool operator!=(const CompiledFormat &right) const
+        {
+            return !operator==(right);
+        }
+
+    private:
+        // key == '\0' : delimiter of m_format[pos, pos + length)
+        // key != '\0' : specifier
+        struct Op
+        {
+            char key;
+            size_t pos;
+            size_t length;
+        };
+
+        Kind m_kind = INVALID;
+        std::string m_format;
+        std::vector<Op> m_ops;
+
+        bool tryParseFields(const char *timestamp, const size_t &timestampLen, struct tm &time, MyParser::Offset &utcOffset) const
+        {
+            MyParser::Fields fields;
+            size_t ti = 0;
+            for (const auto &op : m_ops)
+            {
+                if (op.key == '\0')
+                {
+                    if (timestampLen - ti < op.length)
+                    {
+                        return false;
+                    }
+                    const char *delim = m_format.data() + op.pos;
+                    for (size_t i = 0; i < op.length; i++, ti++)
+                    {
+                        if (timestamp[ti] != delim[i])
+                        {
+                            return false;
+                        }
+                    }
+                    continue;
+                }
+                if (MyParser::readValue(timestamp, timestampLen, ti, op.key, fields) != MyParser::READ_OK)
+                {
+                    return false;
+                }
+            }
+            return ti == timestampLen && MyParser::toStructTm(fields, time, utcOffset) == MyParser::BUILD_OK;
+        }
+
+        static bool tryParseInteger(const char *timestamp, const size_t &timestampLen, long long &value)
+        {
+            // 19 digits may overflow long long.
+            if (timestampLen == 0 || timestampLen > 18)
+            {
+                return false;
+            }
+            value = 0;
+            for (size_t i = 0; i < timestampLen; i++)
+            {
+                if (!MyParser::isDigit(timestamp[i]))
+                {
+                    return false;
+                }
+                value = value * 10 + (timestamp[i] - '0');
+            }
+            return true;
+        }
+
+        static bool toUnixTime(const struct tm &time, const bool &isUTC, const MyParser::Offset &utcOffset, long long &unixTime)
+        {
+            const long long year = (long long)time.tm_year + DatetimeConstants::TM_BASE_YEAR;
+            if (!MyTM::isValidFields(time) || year < DatetimeConstants::MINIMUM_YEAR || year > DatetimeConstants::MAXIMUM_YEAR)
+            {
+                return false;
+            }
+            if (utcOffset.designated)
+            {
+                unixTime = MyTM::my_timegm(time) - utcOffset.seconds;
+                return DatetimeConstants::MINIMUM_SEC <= unixTime && unixTime <= DatetimeConstants::MAXIMUM_SEC;
+            }
+            if (isUTC)
+            {
+                unixTime = MyTM::my_timegm(time);
+                return true;
+            }
+            try
+            {
+                // Only non-existent local times (ex: skipped by summer time) throw here.
+                unixTime = MyTM::my_mktime(time, false);
+            }
+            catch (const DatetimeException &)
+            {
+                return false;
+            }
+            return true;
+        }
+    };
+
+    /**
+    * サンプル文字列から書式を推定する。推定できなければ false を返す。 \n
+    * Detect the format from the sample timestamp. Return false if the format can not be detected.
+    * @details Supported shapes: \n
+    * - Year first or last date, with any delimiters: 2021/3/8, 2021-03-08, 08.03.2021 \n
+    * - Dates with month names: 8 Mar 2021, March 8, 2021 \n
+    * - Date and time in either order, with any delimiters: 2021/3/8 0:00:15, 2021-03-08T00:00:15Z, 00:00:15 2021/03/08 \n
+    * - Weekday names and UTC offsets after the time: Mon, 08 Mar 2021 00:00:15 +0900 (RFC 2822) \n
+    * - UTC designators after the time (Z, UTC, GMT) are read as the offset 0 by %z: 2021-03-08T00:00:15Z \n
+    * - Unix seconds (9 ~ 11 digits) and unix milliseconds (12 ~ 14 digits) \n
+    * Day-first is assumed for ambiguous dates such as 03/08/2021.
+    */
+    bool detectFormat(const std::string &sample, CompiledFormat &format)
+    {
+        // Tokenize digit runs (the same way as MyParser::str2time) and month/weekday names.
+        struct Token
+        {
+            size_t pos;    // The span [pos, end) is replaced by "%key".
+            size_t end;
+            long long value;
+            char key;      // '\0' until assigned
+            bool isName;   // month or weekday name
+        };
+        const size_t maxTokens = 10;
+        Token tokens[maxTokens];
+        size_t numTokens = 0;
+        for (size_t i = 0; i < sample.size();)
+        {
+            const size_t pos = i;
+            if (MyParser::isDigit(sample[i]))
+            {
+                long long value = 0;
+                while (i < sample.size() && MyParser::isDigit(sample[i]))
+                {
+                    value = (value < DatetimeConstants::MAXIMUM_YEAR) ? value * 10 + (sample[i] - '0') : value;
+                    i++;
+                }
+                if (numTokens == maxTokens)
+                {
+                    return false;
+                }
+                tokens[numTokens++] = Token{pos, i, value, '\0', false};
+                continue;
+            }
+            if (!MyParser::isAlpha(sample[i]))
+            {
+                i++;
+                continue;
+            }
+            while (i < sample.size() && MyParser::isAlpha(sample[i]))
+            {
+                i++;
+            }
+            // Other words (ex: "T", "GMT") are delimiters.
+            const size_t length = i - pos;
+            const unsigned int packed = (length >= 3) ? MyParser::packLower(sample.c_str() + pos) : 0;
+            const int month = MyParser::lookupMonth(packed);
+            const int weekday = MyParser::lookupWeekday(packed);
+            char key = '\0';
+            if (month >= 0 && (length == 3 || length == strlen(DatetimeConstants::MONTH_NAMES[month])))
+            {
+                key = (length == 3) ? 'b' : 'B';
+            }
+            else if (weekday >= 0 && (length == 3 || length == strlen(DatetimeConstants::WEEKDAY_NAMES[weekday])))
+            {
+                key = (length == 3) ? 'a' : 'A';
+            }
+            if (key == '\0')
+            {
+                continue;
+            }
+            if (numTokens == maxTokens)
+            {
+                return false;
+            }
+            tokens[numTokens++] = Token{pos, i, 0, key, true};
+        }
+
+        // Unix time
+        if (numTokens == 1 && !tokens[0].isName && tokens[0].pos == 0 && tokens[0].end == sample.size())
+        {
+            const size_t length = tokens[0].end;
+            if (9 <= length && length <= 11)
+            {
+                format = CompiledFormat::epochSeconds();
+                return true;
+            }
+            if (12 <= length && length <= 14)
+            {
+                format = CompiledFormat::epochMillis();
+                return true;
+            }
+        }
+
+        auto joinedByColon = [&](const size_t &i)
+        {
+            return !tokens[i].isName && !tokens[i + 1].isName &&
+                   tokens[i + 1].pos == tokens[i].end + 1 && sample[tokens[i].end] == ':';
+        };
+
+        // Runs joined by ':' are time (H:M or H:M:S).
+        size_t timeStart = numTokens;
+        for (size_t i = 0; i + 1 < numTokens; i++)
+        {
+            if (joinedByColon(i))
+            {
+                timeStart = i;
+                break;
+            }
+        }
+        size_t timeEnd = timeStart;
+        if (timeStart < numTokens)
+        {
+            timeEnd = timeStart + 1;
+            while (timeEnd < numTokens && timeEnd - timeStart < 3 && joinedByColon(timeEnd - 1))
+            {
+                timeEnd++;
+            }
+            const char timeKeys[] = {'H', 'M', 'S'};
+            for (size_t i = timeStart; i < timeEnd; i++)
+            {
+                tokens[i].key = timeKeys[i - timeStart];
+            }
+            // UTC offset just after the time: +0900, -05:00
+            if (timeEnd < numTokens && !tokens[timeEnd].isName)
+            {
+                Token &first = tokens[timeEnd];
+                const char sign = sample[first.pos - 1];
+                size_t numOffsetTokens = 0;
+                if ((sign == '+' || sign == '-') && first.end - first.pos == 4)
+                {
+                    numOffsetTokens = 1;
+                }
+                else if ((sign == '+' || sign == '-') && first.end - first.pos == 2 && timeEnd + 1 < numTokens &&
+                         joinedByColon(timeEnd) && tokens[timeEnd + 1].end - tokens[timeEnd + 1].pos == 2)
+                {
+                    numOffsetTokens = 2;
+                }
+                if (numOffsetTokens > 0)
+                {
+                    // Merge the offset into one token including the sign.
+                    first.pos--;
+                    first.end = tokens[timeEnd + numOffsetTokens - 1].end;
+                    first.key = 'z';
+                    for (size_t i = timeEnd + numOffsetTokens; i < numTokens; i++)
+                    {
+                        tokens[i - numOffsetTokens + 1] = tokens[i];
+                    }
+                    numTokens -= numOffsetTokens - 1;
+                    timeEnd++;
+                }
+            }
+            // UTC designator just after the time: 00:00:15Z, 00:00:15 UTC, 00:00 GMT
+            if (timeEnd == numTokens || tokens[timeEnd].key != 'z')
+            {
+                size_t pos = tokens[timeEnd - 1].end;
+                pos += (pos < sample.size() && sample[pos] == ' ') ? 1 : 0;
+                size_t end = pos;
+                while (end < sample.size() && MyParser::isAlpha(sample[end]))
+                {
+                    end++;
+                }
+                const std::string word = sample.substr(pos, end - pos);
+                if ((word == "Z" && pos == tokens[timeEnd - 1].end) || word == "UTC" || word == "GMT")
+                {
+                    if (numTokens == maxTokens)
+                    {
+                        return false;
+                    }
+                    for (size_t i = numTokens; i > timeEnd; i--)
+                    {
+                        tokens[i] = tokens[i - 1];
+                    }
+                    tokens[timeEnd] = Token{pos, end, 0, 'z', true};
+                    numTokens++;
+                    timeEnd++;
+                }
+            }
+        }
+
+        // Date tokens (weekday names excluded) must be contiguous, before or after the time.
+        size_t date[maxTokens];
+        size_t numDate = 0;
+        bool beforeTime = false;
+        bool afterTime = false;
+        for (size_t i = 0; i < numTokens; i++)
+        {
+            if (timeStart <= i && i < timeEnd)
+            {
+                continue;
+            }
+            if (tokens[i].key == 'a' || tokens[i].key == 'A')
+            {
+                continue;
+            }
+            (i < timeStart ? beforeTime : afterTime) = true;
+            date[numDate++] = i;
+        }
+        if (beforeTime && afterTime)
+        {
+            return false;
+        }
+        auto length = [&](const size_t &i)
+        {
+            return tokens[date[i]].end - tokens[date[i]].pos;
+        };
+        auto isMonthName = [&](const size_t &i)
+        {
+            return tokens[date[i]].key == 'b' || tokens[date[i]].key == 'B';
+        };
+        auto setKeys = [&](const char &k0, const char &k1, const char &k2)
+        {
+            tokens[date[0]].key = k0;
+            tokens[date[1]].key = k1;
+            tokens[date[2]].key = k2;
+        };
+        if (numDate == 1 && !isMonthName(0) && length(0) == 4)
+        {
+            tokens[date[0]].key = 'Y';
+        }
+        else if (numDate != 3)
+        {
+            return false;
+        }
+        else if (isMonthName(1) && !isMonthName(0) && !isMonthName(2) && length(2) >= 3)
+        {
+            setKeys('d', tokens[date[1]].key, 'Y'); // 8 Mar 2021
+        }
+        else if (isMonthName(0) && !isMonthName(1) && !isMonthName(2) && length(2) >= 3)
+        {
+            setKeys(tokens[date[0]].key, 'd', 'Y'); // Mar 8 2021
+        }
+        else if (isMonthName(0) || isMonthName(1) || isMonthName(2))
+        {
+            return false;
+        }
+        else if (length(0) >= 3)
+        {
+            setKeys('Y', 'm', 'd');
+        }
+        else if (length(2) >= 3)
+        {
+            const bool monthFirst = tokens[date[0]].value <= 12 && tokens[date[1]].value > 12;
+            setKeys(monthFirst ? 'm' : 'd', monthFirst ? 'd' : 'm', 'Y');
+        }
+        else
+        {
+            return false;
+        }
+
+        // Replace tokens by specifiers.
+        std::string formatStr;
+        size_t prev = 0;
+        for (size_t i = 0; i < numTokens; i++)
+        {
+            formatStr.append(sample, prev, tokens[i].pos - prev);
+            formatStr += '%';
+            formatStr += tokens[i].key;
+            prev = tokens[i].end;
+        }
+        formatStr.append(sample, prev, std::string::npos);
+        // "%" followed by a letter in the delimiters would be read as a specifier.
+        if (std::count(formatStr.begin(), formatStr.end(), '%') != (long)numTokens)
+        {
+            return false;
+        }
+
+        CompiledFormat candidate = CompiledFormat::compile(formatStr);
+        long long unixTime;
+        if (!candidate.tryParse(sample, true, unixTime))
+        {
+            return false;
+        }
+        format = candidate;
+        return true;
+    }
+
+    /**
+    * サンプル文字列から書式を推定する。推定できなければ DatetimeException を投げる。 \n
+    * Detect the format from the sample timestamp. Throw DatetimeException if the format can not be detected.
+    * @details ex: detectFormat("2021-03-08T00:00:15").format() => "%Y-%m-%dT%H:%M:%S"
+    */
+    CompiledFormat detectFormat(const std::string &sample)
+    {
+        CompiledFormat format;
+        if (!detectFormat(sample, format))
+        {
+            throw DatetimeException("ERROR: Could not detect the format of \"" + sample + "\".");
+        }
+        return format;
+    }
+}
+#endif
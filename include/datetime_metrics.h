@@ -0,0 +1,200 @@
+#ifndef _MY_DATETIME_METRICS_
+#define _MY_DATETIME_METRICS_
+
+#include <atomic>
+#include <cstddef>
+
+// 実行時メトリクス (解析・出力のホットパスのカウンタ)
+// Runtime metrics of parse/format hot paths.
+//
+// 仕様: EZ_ENABLE_METRICS を定義した場合のみ有効。未定義なら increment() は空関数になり、コストはかからない。
+//       カウンタはスレッドごとに持ち、ロックを使わずに加算する。snapshot() は全スレッドの合計を返す。
+// Define EZ_ENABLE_METRICS before including "datetime.h" (or with -DEZ_ENABLE_METRICS) to enable.
+
+namespace EZ
+{
+    namespace Metrics
+    {
+        enum Counter
+        {
+            PARSE_CALLS = 0,                // Calls of the parser.
+            PARSE_FAST_PATH,                // Parses done by fixed-layout routines.
+            PARSE_SLOW_PATH,                // Parses done by the generic specifier engine.
+            PARSE_FAILURE_MISMATCH,         // Timestamp does not match the format.
+            PARSE_FAILURE_INVALID_SPECIFIER,// Unsupported specifier.
+            PARSE_FAILURE_DUPLICATED,       // Duplicated specifier.
+            PARSE_FAILURE_MISSING_YEAR,     // "%Y" is not designated.
+            PARSE_FAILURE_OUT_OF_RANGE,     // Value is out of range.
+            FORMAT_CALLS,                   // Calls of the formatter.
+            FORMAT_CACHE_HITS,              // Output served from a cache.
+            FORMAT_CACHE_MISSES,            // Output not in the cache.
+            FORMAT_BUFFER_OVERFLOWS,        // Output did not fit in the stack buffer (heap is used).
+            ZONE_LOOKUPS,                   // Calls of localtime()/mktime().
+            EXCEPTIONS_THROWN,              // DatetimeException objects constructed.
+            NUM_COUNTERS
+        };
+
+        /**
+        * カウンタ名を返す (メトリクス出力用) \n
+        * Return the name of the counter for metrics exporters.
+        */
+        inline const char *name(const Counter &counter)
+        {
+            static const char *names[NUM_COUNTERS] = {
+                "parse_calls",
+                "parse_fast_path",
+                "parse_slow_path",
+                "parse_failure_mismatch",
+                "parse_failure_invalid_specifier",
+                "parse_failure_duplicated",
+                "parse_failure_missing_year",
+                "parse_failure_out_of_range",
+                "format_calls",
+                "format_cache_hits",
+                "format_cache_misses",
+                "format_buffer_overflows",
+                "zone_lookups",
+                "exceptions_thrown"};
+            return names[counter];
+        }
+
+        /**
+        * 全スレッドのカウンタの合計値 \n
+        * Sum of the counters of all threads.
+        */
+        struct Snapshot
+        {
+            unsigned long long values[NUM_COUNTERS] = {};
+
+            unsigned long long operator[](const Counter &counter) const
+            {
+                return values[counter];
+            }
+
+            // Difference between two snapshots. ex: auto delta = Metrics::snapshot() - before;
+            Snapshot operator-(const Snapshot &right) const
+            {
+                Snapshot ret;
+                for (int i = 0; i < NUM_COUNTERS; i++)
+                {
+                    ret.values[i] = values[i] - right.values[i];
+                }
+                return ret;
+            }
+        };
+
+        /**
+        * メトリクスが有効なら true を返す \n
+        * Return true if metrics are compiled in.
+        */
+        constexpr bool enabled()
+        {
+#if defined(EZ_ENABLE_METRICS)
+            return true;
+#else
+            return false;
+#endif
+        }
+
+#if defined(EZ_ENABLE_METRICS)
+        namespace Detail
+        {
+            // スレッドごとのカウンタ。書き込むのは所有スレッドのみ。スレッド終了後は次のスレッドが再利用する。
+            struct ThreadCounters
+            {
+                std::atomic<unsigned long long> values[NUM_COUNTERS];
+                std::atomic<bool> inUse;
+                ThreadCounters *next;
+
+                ThreadCounters() : inUse(true), next(nullptr)
+                {
+                    for (int i = 0; i < NUM_COUNTERS; i++)
+                    {
+                        values[i].store(0, std::memory_order_relaxed);
+                    }
+                }
+            };
+
+            inline std::atomic<ThreadCounters *> &head()
+            {
+                static std::atomic<ThreadCounters *> list(nullptr);
+                return list;
+            }
+
+            inline ThreadCounters *acquire()
+            {
+                for (ThreadCounters *p = head().load(std::memory_order_acquire); p != nullptr; p = p->next)
+                {
+                    bool expected = false;
+                    if (p->inUse.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+                    {
+                        return p;
+                    }
+                }
+                // Blocks are never freed, so the list can be traversed without locks.
+                ThreadCounters *block = new ThreadCounters();
+                ThreadCounters *expected = head().load(std::memory_order_relaxed);
+                do
+                {
+                    block->next = expected;
+                } while (!head().compare_exchange_weak(expected, block, std::memory_order_release, std::memory_order_relaxed));
+                return block;
+            }
+
+            struct ThreadSlot
+            {
+                ThreadCounters *block;
+
+                ThreadSlot() : block(acquire())
+                {
+                }
+                ~ThreadSlot()
+                {
+                    block->inUse.store(false, std::memory_order_release);
+                }
+            };
+
+            inline ThreadCounters &local()
+            {
+                static thread_local ThreadSlot slot;
+                return *slot.block;
+            }
+        }
+#endif
+
+        /**
+        * カウンタを1つ進める。メトリクスが無効なら何もしない。 \n
+        * Increment the counter of the current thread. Do nothing if metrics are disabled.
+        */
+        inline void increment(const Counter &counter)
+        {
+#if defined(EZ_ENABLE_METRICS)
+            // Single writer per block: a relaxed load and store is enough (no locked instruction).
+            auto &value = Detail::local().values[counter];
+            value.store(value.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+#else
+            (void)counter;
+#endif
+        }
+
+        /**
+        * 全スレッドのカウンタの合計を返す。メトリクスが無効なら全て0。 \n
+        * Return the sum of the counters of all threads. All values are 0 if metrics are disabled.
+        */
+        inline Snapshot snapshot()
+        {
+            Snapshot ret;
+#if defined(EZ_ENABLE_METRICS)
+            for (Detail::ThreadCounters *p = Detail::head().load(std::memory_order_acquire); p != nullptr; p = p->next)
+            {
+                for (int i = 0; i < NUM_COUNTERS; i++)
+                {
+                    ret.values[i] += p->values[i].load(std::memory_order_relaxed);
+                }
+            }
+#endif
+            return ret;
+        }
+    }
+}
+#endif
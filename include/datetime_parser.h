@@ -5,107 +5,181 @@
 #include <regex>
 #include <vector>
 #include <time.h>
+#include <string.h>
+#include <stdio.h>
 #include <sstream>
 #include <iomanip>
+#include <limits>
 
 #include "datetime_exceptions.h"
 #include "datetime_constants.h"
+#include "datetime_metrics.h"
+#include "unix_time.h"
+#include "calendar.h"
 
 // key valのペアからstruct_tmに正しく代入する
 // struct_tm から文字列に正しくparseする
+// 仕様: 解析・出力ともに正規表現や stringstream を使わず、書式と文字列を先頭から1度だけ走査する。
+//       正常系ではヒープ確保を行わない (出力は返却する std::string の1回のみ)。
 
 namespace EZ
 {
+    class CompiledFormat;
+    bool detectFormat(const std::string &sample, CompiledFormat &format);
+
     class MyParser
     {
+        // CompiledFormat and detectFormat() share the specifier machinery.
+        friend class CompiledFormat;
+        friend bool detectFormat(const std::string &sample, CompiledFormat &format);
 
     public:
         MyParser(){};
         ~MyParser(){};
 
+        // UTCからのオフセット ("%z" または "%s" で指定された場合のみ有効)
+        // UTC offset designated by "%z" or "%s".
+        struct Offset
+        {
+            bool designated = false;
+            long long seconds = 0; // seconds east of UTC. ex: +0900 => 32400
+        };
+
         struct tm str2time(const std::string &timestamp, const std::string &format)
         {
-            std::vector<std::string> keys;
-            std::vector<int> values;
-            std::vector<std::string> delimList;
-            extractTimeKeyValues(keys, values, delimList, timestamp, format);
+            return str2time(timestamp.c_str(), timestamp.size(), format.c_str(), format.size());
+        }
 
-            std::string duplicated;
-            if (duplicatedKeyExists(duplicated, keys))
-            {
-                std::stringstream ss;
-                ss << "ERORR: Format specifier is duplicated."
-                   << " \"" << duplicated << "\" "
-                   << std::endl
-                   << "in " << format << std::endl;
-                throw DatetimeException(ss.str());
-            }
+        /**
+        * 文字列を struct tm に変換する。正常系ではヒープ確保を行わない。 \n
+        * Parse the timestamp to struct tm without heap allocation (except for errors).
+        * @details The UTC offset given by "%z" or "%s" is ignored. Use the overload with utcOffset to get it.
+        */
+        struct tm str2time(const char *timestamp, const size_t &timestampLen, const char *format, const size_t &formatLen)
+        {
+            Offset utcOffset;
+            return str2time(timestamp, timestampLen, format, formatLen, utcOffset);
+        }
 
-            struct tm time;
-            // Initialize tm
-            time.tm_mon = 0;
-            time.tm_mday = 1;
-            time.tm_hour = 0;
-            time.tm_min = 0;
-            time.tm_sec = 0;
-
-            // spec: Year must be specified.
-            bool hasYearRegisterd = false;
-            for (size_t idx = 0; idx < keys.size(); idx++)
-            {
-                if (keys[idx] == "%Y")
+        /**
+        * 文字列を struct tm に変換し、"%z" / "%s" で指定されたUTCからのオフセットを utcOffset に返す。 \n
+        * Parse the timestamp to struct tm. The UTC offset designated by "%z" or "%s" is returned by utcOffset.
+        * @details If utcOffset.designated is true, the fields of struct tm are local time of utcOffset.seconds east of UTC.
+        */
+        struct tm str2time(const char *timestamp, const size_t &timestampLen, const char *format, const size_t &formatLen, Offset &utcOffset)
+        {
+            Metrics::increment(Metrics::PARSE_CALLS);
+            Metrics::increment(Metrics::PARSE_SLOW_PATH);
+
+            Fields fields;
+            unsigned long long registeredKeys = 0;
+            char duplicated = '\0';
+            char invalidKey = '\0';
+            size_t numKeys = 0;
+
+            size_t ti = 0;
+            size_t fi = 0;
+            while (fi < formatLen)
+            {
+                if (!isSpecifier(format, formatLen, fi))
                 {
-                    if (values[idx] > 3000)
+                    // Delimiters must be same. (Delimiters of timestamp never contain digits.)
+                    if (ti >= timestampLen || timestamp[ti] != format[fi] || isDigit(format[fi]))
                     {
-                        throw DatetimeException("Input year must be under 3001.");
+                        throwMismatch(timestamp, timestampLen, format, formatLen);
                     }
-                    if (values[idx] < 1970)
-                    {
-                        throw DatetimeException("Input year must be at least 1970.");
-                    }
-                    time.tm_year = values[idx] - DatetimeConstants::TM_BASE_YEAR;
-                    hasYearRegisterd = true;
+                    ti++;
+                    fi++;
                     continue;
                 }
-                if (keys[idx] == "%m")
-                {
-                    time.tm_mon = values[idx] - DatetimeConstants::MONTH_OFFSET;
-                    continue;
-                }
-                if (keys[idx] == "%d")
+
+                const char key = format[fi + 1];
+                fi += 2;
+                numKeys++;
+                const size_t start = ti;
+                switch (readValue(timestamp, timestampLen, ti, key, fields))
                 {
-                    time.tm_mday = values[idx];
-                    continue;
-                }
-                if (keys[idx] == "%H")
+                case READ_MISMATCH:
+                    throwMismatch(timestamp, timestampLen, format, formatLen);
+                case READ_TOO_LARGE:
                 {
-                    time.tm_hour = values[idx];
-                    continue;
+                    Metrics::increment(Metrics::PARSE_FAILURE_OUT_OF_RANGE);
+                    std::string strMsg = "Too large number. str = '" + std::string(timestamp + start, timestampLen - start) + "'";
+                    throw DatetimeException(strMsg);
                 }
-                if (keys[idx] == "%M")
-                {
-                    time.tm_min = values[idx];
-                    continue;
+                default:
+                    break;
                 }
-                if (keys[idx] == "%S")
+
+                const unsigned long long bits = fieldBits(key);
+                if ((registeredKeys & bits) && duplicated == '\0')
                 {
-                    time.tm_sec = values[idx];
-                    continue;
+                    duplicated = key;
                 }
-                else
+                registeredKeys |= bits;
+                if (bits == 0 && invalidKey == '\0')
                 {
-                    std::stringstream ess;
-                    ess << "ERROR: "
-                        << "\"" << keys[idx] << "\""
-                        << " is invalid input specifier.";
-                    throw DatetimeException(ess.str());
+                    invalidKey = key;
                 }
             }
-            if (!hasYearRegisterd)
+            if (ti != timestampLen)
+            {
+                throwMismatch(timestamp, timestampLen, format, formatLen);
+            }
+            if (numKeys == 0)
+            {
+                Metrics::increment(Metrics::PARSE_FAILURE_MISMATCH);
+                throw DatetimeException("ERROR: No specifier is contained.");
+            }
+
+            if (duplicated != '\0')
             {
+                Metrics::increment(Metrics::PARSE_FAILURE_DUPLICATED);
+                std::stringstream ss;
+                ss << "ERORR: Format specifier is duplicated."
+                   << " \"%" << duplicated << "\" "
+                   << std::endl
+                   << "in " << std::string(format, formatLen) << std::endl;
+                throw DatetimeException(ss.str());
+            }
+            if (invalidKey != '\0')
+            {
+                Metrics::increment(Metrics::PARSE_FAILURE_INVALID_SPECIFIER);
+                std::stringstream ess;
+                ess << "ERROR: "
+                    << "\"%" << invalidKey << "\""
+                    << " is invalid input specifier.";
+                throw DatetimeException(ess.str());
+            }
+            // spec: Year must be specified. ("%s" contains the year.)
+            if (!(registeredKeys & keyBit('Y')))
+            {
+                Metrics::increment(Metrics::PARSE_FAILURE_MISSING_YEAR);
                 throw DatetimeException("ERROR: Expression \"%Y\" (Year) must be designated.");
             }
 
+            struct tm time;
+            switch (toStructTm(fields, time, utcOffset))
+            {
+            case BUILD_YEAR_TOO_LARGE:
+            {
+                Metrics::increment(Metrics::PARSE_FAILURE_OUT_OF_RANGE);
+                std::stringstream ess;
+                ess << "Input year must be at most " << DatetimeConstants::MAXIMUM_YEAR << ".";
+                throw DatetimeException(ess.str());
+            }
+            case BUILD_YEAR_TOO_SMALL:
+            {
+                Metrics::increment(Metrics::PARSE_FAILURE_OUT_OF_RANGE);
+                std::stringstream ess;
+                ess << "Input year must be at least " << DatetimeConstants::MINIMUM_YEAR << ".";
+                throw DatetimeException(ess.str());
+            }
+            case BUILD_WEEKDAY_MISMATCH:
+                throwMismatch(timestamp, timestampLen, format, formatLen);
+            default:
+                break;
+            }
             return time;
         }
 
@@ -116,18 +190,41 @@ namespace EZ
 
         std::string time2str(const struct tm &time, const std::string &format) const
         {
-            std::vector<std::string> keys;
-            std::vector<std::string> delimList;
-            std::regex re2(R"(%[a-zA-Z])");
-            getMatchedLists(keys, delimList, format, re2);
+            Metrics::increment(Metrics::FORMAT_CALLS);
 
-            std::stringstream ss;
-            for (size_t idx = 0; idx < keys.size(); idx++)
+            char buf[OUTPUT_BUFFER_SIZE];
+            size_t len = 0;
+            // Used only if the output does not fit in the buffer.
+            std::string overflow;
+
+            bool hasKey = false;
+            size_t fi = 0;
+            while (fi < format.size())
             {
-                ss << delimList[idx] << outValues(time, keys[idx]);
+                if (!isSpecifier(format.c_str(), format.size(), fi))
+                {
+                    append(buf, len, overflow, &format[fi], 1);
+                    fi++;
+                    continue;
+                }
+                char value[VALUE_BUFFER_SIZE];
+                const size_t valueLen = outValues(time, format[fi + 1], value);
+                append(buf, len, overflow, value, valueLen);
+                hasKey = true;
+                fi += 2;
+            }
+            if (!hasKey)
+            {
+                throw DatetimeException("ERROR: No specifier is contained.");
+            }
+
+            if (overflow.empty())
+            {
+                return std::string(buf, len);
             }
-            ss << delimList.back();
-            return ss.str();
+            Metrics::increment(Metrics::FORMAT_BUFFER_OVERFLOWS);
+            overflow.append(buf, len);
+            return overflow;
         }
         // DEFAULT
         std::string time2str(const struct tm &time) const
@@ -135,192 +232,562 @@ namespace EZ
             return time2str(time, DatetimeConstants::DEFAULT_OUTPUT_FORMAT);
         }
 
+        // 名前の照合 (固定レイアウトの解析でも使う)
+        // Name lookup, shared with the fixed-layout routines.
+
+        // 3文字を小文字にして1つの整数にまとめる (名前の照合用)。英字でなければ 0 を返す。
+        static unsigned int packLower(const char *str)
+        {
+            if (!isAlpha(str[0]) || !isAlpha(str[1]) || !isAlpha(str[2]))
+            {
+                return 0;
+            }
+            return ((unsigned int)(unsigned char)(str[0] | 0x20)) |
+                   ((unsigned int)(unsigned char)(str[1] | 0x20) << 8) |
+                   ((unsigned int)(unsigned char)(str[2] | 0x20) << 16);
+        }
+
+        // 月名の略称 (3文字) の完全ハッシュ。一致しなければ -1 を返す。
+        // Multiplicative perfect hash of the 12 abbreviations to 16 slots (checked by the name table).
+        static int lookupMonth(const unsigned int &packed)
+        {
+            static const int SLOTS[16] = {6, 10, -1, 9, 4, 11, 2, 3, -1, 8, -1, -1, 0, 5, 1, 7};
+            const int idx = SLOTS[(packed * 26597u) >> 28];
+            return (idx >= 0 && packLower(DatetimeConstants::MONTH_NAMES[idx]) == packed) ? idx : -1;
+        }
+
+        // 曜日名の略称 (3文字) の完全ハッシュ。一致しなければ -1 を返す。
+        static int lookupWeekday(const unsigned int &packed)
+        {
+            static const int SLOTS[8] = {-1, 1, 0, 3, 2, 6, 4, 5};
+            const int idx = SLOTS[(packed * 4895u) >> 29];
+            return (idx >= 0 && packLower(DatetimeConstants::WEEKDAY_NAMES[idx]) == packed) ? idx : -1;
+        }
+
     private:
-        std::string outValues(const struct tm &time, const std::string &key) const
+        static const size_t OUTPUT_BUFFER_SIZE = 256;
+        static const size_t VALUE_BUFFER_SIZE = 64;
+
+        static bool isDigit(const char &c)
+        {
+            return '0' <= c && c <= '9';
+        }
+
+        static bool isAlpha(const char &c)
         {
+            return ('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z');
+        }
+
+        // "%" + [a-zA-Z] が書式指定子
+        static bool isSpecifier(const char *format, const size_t &formatLen, const size_t &pos)
+        {
+            return format[pos] == '%' && pos + 1 < formatLen && isAlpha(format[pos + 1]);
+        }
+
+        // 指定子ごとのビット (重複チェック用)
+        static unsigned long long keyBit(const char &key)
+        {
+            const int idx = ('a' <= key && key <= 'z') ? key - 'a' : key - 'A' + 26;
+            return 1ULL << idx;
+        }
+
+        [[noreturn]] static void throwMismatch(const char *timestamp, const size_t &timestampLen, const char *format, const size_t &formatLen)
+        {
+            Metrics::increment(Metrics::PARSE_FAILURE_MISMATCH);
             std::stringstream ss;
-            if (key == "%y")
+            ss << "ERROR: mismatch format and timestamp!" << std::endl
+               << "timestamp: \t" << std::string(timestamp, timestampLen) << std::endl
+               << "format: \t" << std::string(format, formatLen) << std::endl;
+            throw DatetimeException(ss.str());
+        }
+
+        // 解析中の値。toStructTm() で struct tm にまとめる。
+        struct Fields
+        {
+            long long year = 0;
+            int mon = 1;
+            int mday = 1;
+            int hour = 0;
+            int min = 0;
+            int sec = 0;
+            int yday = -1; // %j (1 ~ 366). -1 if not designated.
+            int wday = -1; // %a %A %u (0: Sunday). -1 if not designated.
+            int isoWeek = -1; // %V (1 ~ 53). -1 if not designated. The year is the ISO week-year then.
+            int pm = -1;   // %p (0: AM, 1: PM). -1 if not designated.
+            bool hasOffset = false;
+            long long utcOffset = 0; // %z
+            bool hasEpoch = false;
+            long long epoch = 0; // %s
+        };
+
+        enum ReadStatus
+        {
+            READ_OK = 0,
+            READ_MISMATCH,
+            READ_TOO_LARGE
+        };
+
+        enum BuildStatus
+        {
+            BUILD_OK = 0,
+            BUILD_YEAR_TOO_LARGE,
+            BUILD_YEAR_TOO_SMALL,
+            BUILD_WEEKDAY_MISMATCH
+        };
+
+        // 指定子が設定する項目のビット (重複チェック用)。未対応の指定子なら 0 を返す。
+        // ex: "%b" and "%m" both set the month, "%s" sets every field.
+        static unsigned long long fieldBits(const char &key)
+        {
+            switch (key)
             {
-                ss << std::setw(4) << std::right << std::setfill('0') << time.tm_year + DatetimeConstants::TM_BASE_YEAR;
-                return ss.str().substr(2);
+            case 'Y':
+            case 'H':
+            case 'M':
+            case 'S':
+            case 'd':
+            case 'm':
+            case 'p':
+            case 'z':
+                return keyBit(key);
+            case 'I':
+                return keyBit('H');
+            case 'b':
+            case 'B':
+                return keyBit('m');
+            case 'a':
+            case 'A':
+                return keyBit('a');
+            case 'j':
+            case 'V':
+                return keyBit('m') | keyBit('d');
+            case 'G':
+                return keyBit('Y');
+            case 'u':
+                return keyBit('a');
+            case 's':
+                return keyBit('Y') | keyBit('m') | keyBit('d') | keyBit('H') | keyBit('M') | keyBit('S') | keyBit('z') | keyBit('p');
+            default:
+                return 0;
             }
-            if (key == "%Y")
+        }
+
+        // 略称または正式名を読む (大文字小文字は区別しない)。 ex: "Mar", "march", "MARCH"
+        static ReadStatus readName(const char *timestamp, const size_t &timestampLen, size_t &ti,
+                                   const char *const *names, int (*lookup)(const unsigned int &), int &value)
+        {
+            if (timestampLen - ti < 3)
             {
-                ss << std::setw(4) << std::right << std::setfill('0') << time.tm_year + DatetimeConstants::TM_BASE_YEAR;
-                return ss.str();
+                return READ_MISMATCH;
             }
-            if (key == "%m")
+            const int idx = lookup(packLower(timestamp + ti));
+            if (idx < 0)
             {
-                ss << std::setw(2) << std::right << std::setfill('0') << time.tm_mon + DatetimeConstants::MONTH_OFFSET;
-                return ss.str();
+                return READ_MISMATCH;
             }
-            if (key == "%d")
+            ti += 3;
+            const char *rest = names[idx] + 3;
+            size_t restLen = strlen(rest);
+            if (timestampLen - ti >= restLen && restLen > 0 && strncasecmpAscii(timestamp + ti, rest, restLen))
             {
-                ss << std::setw(2) << std::right << std::setfill('0') << time.tm_mday;
-                return ss.str();
+                ti += restLen;
             }
-            if (key == "%H")
+            // A name must not be followed by letters. ex: "Marc"
+            if (ti < timestampLen && isAlpha(timestamp[ti]))
             {
-                ss << std::setw(2) << std::right << std::setfill('0') << time.tm_hour;
-                return ss.str();
+                return READ_MISMATCH;
             }
-            if (key == "%M")
+            value = idx;
+            return READ_OK;
+        }
+
+        static bool strncasecmpAscii(const char *a, const char *b, const size_t &len)
+        {
+            for (size_t i = 0; i < len; i++)
             {
-                ss << std::setw(2) << std::right << std::setfill('0') << time.tm_min;
-                return ss.str();
+                if (!isAlpha(a[i]) || (a[i] | 0x20) != (b[i] | 0x20))
+                {
+                    return false;
+                }
             }
-            if (key == "%S")
+            return true;
+        }
+
+        // 連続する数字を読む。1文字以上必要。
+        static ReadStatus readNumber(const char *timestamp, const size_t &timestampLen, size_t &ti, const long long &maxValue, long long &value)
+        {
+            if (ti >= timestampLen || !isDigit(timestamp[ti]))
             {
-                ss << std::setw(2) << std::right << std::setfill('0') << time.tm_sec;
-                return ss.str();
+                return READ_MISMATCH;
             }
-            if (key == "%Z")
+            value = 0;
+            while (ti < timestampLen && isDigit(timestamp[ti]))
             {
-#if defined(_WIN32) || defined(_WIN64)
-                TIME_ZONE_INFORMATION tzi;
-                GetTimeZoneInformation(&tzi);
-                std::stringstream ss;
-                long bias = tzi.Bias;
-                if (bias == 0)
+                value = value * 10 + (timestamp[ti] - '0');
+                if (value > maxValue)
                 {
-                    ss << "UTC";
+                    return READ_TOO_LARGE;
                 }
-                else
-                {
-                    ss << "(" << tzi.Bias << "min from UTC)";
-                }
-                return ss.str().c_str();
-#else
-                ss << time.tm_zone;
-#endif
-                return ss.str();
+                ti++;
             }
-
-            std::stringstream ess;
-            ess << "ERROR: "
-                << "\"" << key << "\""
-                << " is invalid output specifier.";
-            throw DatetimeException(ess.str());
-            return "";
+            return READ_OK;
         }
 
-        void extractTimeKeyValues(
-            std::vector<std::string> &keys, std::vector<int> &values, std::vector<std::string> &delimList,
-            const std::string &timestamp, const std::string &format)
+        // UTCからのオフセットを読む。 ex: "Z", "UTC", "GMT", "+09", "+0900", "-05:30"
+        static ReadStatus readOffset(const char *timestamp, const size_t &timestampLen, size_t &ti, long long &seconds)
         {
-            std::vector<std::string> delimListTime;
-            std::vector<std::string> delimListFormat;
-
-            // Parse format string
-            std::regex re2(R"(%[a-zA-Z])");
-            getMatchedLists(keys, delimListFormat, format, re2);
-
-            // Parse timestamp string
-            std::regex re(R"(\d+)");
-            std::vector<std::string> result;
-            getMatchedLists(result, delimListTime, timestamp, re);
-            for (auto v : result)
+            if (ti < timestampLen && timestamp[ti] == 'Z')
             {
-                values.push_back(my_stoi(v));
+                ti++;
+                seconds = 0;
+                return READ_OK;
             }
-
-            if (keys.size() != values.size())
+            if (timestampLen - ti >= 3 && (memcmp(timestamp + ti, "UTC", 3) == 0 || memcmp(timestamp + ti, "GMT", 3) == 0))
             {
-                std::stringstream ss;
-                ss << "ERROR: mismatch format and timestamp!" << std::endl
-                   << "timestamp: \t" << timestamp << std::endl
-                   << "format: \t" << format << std::endl;
-                throw DatetimeException(ss.str());
+                ti += 3;
+                seconds = 0;
+                return READ_OK;
             }
-
-            if (delimListFormat != delimListTime)
+            if (timestampLen - ti < 3 || (timestamp[ti] != '+' && timestamp[ti] != '-') ||
+                !isDigit(timestamp[ti + 1]) || !isDigit(timestamp[ti + 2]))
             {
-                std::stringstream ss;
-                ss << "ERROR: mismatch format and timestamp!" << std::endl
-                   << "timestamp: \t" << timestamp << std::endl
-                   << "format: \t" << format << std::endl;
-                throw DatetimeException(ss.str());
+                return READ_MISMATCH;
+            }
+            const int sign = (timestamp[ti] == '-') ? -1 : 1;
+            const int hours = (timestamp[ti + 1] - '0') * 10 + (timestamp[ti + 2] - '0');
+            ti += 3;
+            int minutes = 0;
+            const size_t colon = (ti < timestampLen && timestamp[ti] == ':') ? 1 : 0;
+            if (timestampLen - ti >= colon + 2 && isDigit(timestamp[ti + colon]) && isDigit(timestamp[ti + colon + 1]))
+            {
+                minutes = (timestamp[ti + colon] - '0') * 10 + (timestamp[ti + colon + 1] - '0');
+                ti += colon + 2;
             }
-            delimList = delimListFormat;
+            else if (colon)
+            {
+                return READ_MISMATCH;
+            }
+            if (hours > 23 || minutes > 59)
+            {
+                return READ_MISMATCH;
+            }
+            seconds = sign * (hours * 3600LL + minutes * 60LL);
+            return READ_OK;
         }
 
-        void getMatchedLists(
-            std::vector<std::string> &matches, std::vector<std::string> &delimList,
-            const std::string &target, const std::regex re) const
+        // 指定子1つ分の値を読み、fields に代入する。未対応の指定子は数字を読み捨てる。
+        static ReadStatus readValue(const char *timestamp, const size_t &timestampLen, size_t &ti, const char &key, Fields &fields)
         {
-            std::vector<std::string>().swap(matches);
-            std::vector<std::string>().swap(delimList);
-            std::vector<int> startList;
-            std::vector<int> endList;
+            switch (key)
+            {
+            case 'b':
+            case 'B':
+            {
+                int idx = 0;
+                const ReadStatus status = readName(timestamp, timestampLen, ti, DatetimeConstants::MONTH_NAMES, lookupMonth, idx);
+                fields.mon = idx + DatetimeConstants::MONTH_OFFSET;
+                return status;
+            }
+            case 'a':
+            case 'A':
+                return readName(timestamp, timestampLen, ti, DatetimeConstants::WEEKDAY_NAMES, lookupWeekday, fields.wday);
+            case 'p':
+            {
+                if (timestampLen - ti < 2 || (timestamp[ti + 1] | 0x20) != 'm')
+                {
+                    return READ_MISMATCH;
+                }
+                const char c = timestamp[ti] | 0x20;
+                if (c != 'a' && c != 'p')
+                {
+                    return READ_MISMATCH;
+                }
+                fields.pm = (c == 'p');
+                ti += 2;
+                return READ_OK;
+            }
+            case 'z':
+                fields.hasOffset = true;
+                return readOffset(timestamp, timestampLen, ti, fields.utcOffset);
+            case 's':
+            {
+                const bool negative = (ti < timestampLen && timestamp[ti] == '-');
+                ti += negative;
+                const ReadStatus status = readNumber(timestamp, timestampLen, ti,
+                                                     negative ? -DatetimeConstants::MINIMUM_SEC : DatetimeConstants::MAXIMUM_SEC, fields.epoch);
+                fields.epoch = negative ? -fields.epoch : fields.epoch;
+                fields.hasEpoch = true;
+                return status;
+            }
+            default:
+                break;
+            }
 
-            for (std::sregex_iterator it(std::begin(target), std::end(target), re), end; it != end; ++it)
+            // Years may be negative, as written by "%Y".
+            const bool negative = (key == 'Y' || key == 'G') && ti < timestampLen && timestamp[ti] == '-';
+            ti += negative;
+            long long value = 0;
+            const ReadStatus status = readNumber(timestamp, timestampLen, ti, std::numeric_limits<int>::max(), value);
+            switch (key)
             {
-                auto &&m = *it;
-                //std::cout << "position = " << m.position() << ", length = " << m.length() << ", str = '" << m.str() << '\'' << std::endl;
-                matches.push_back(m.str());
-                startList.push_back(m.position());
-                endList.push_back(m.position() + m.length());
+            case 'Y':
+            case 'G':
+                fields.year = negative ? -value : value;
+                break;
+            case 'm':
+                fields.mon = int(value);
+                break;
+            case 'd':
+                fields.mday = int(value);
+                break;
+            case 'H':
+            case 'I':
+                fields.hour = int(value);
+                break;
+            case 'M':
+                fields.min = int(value);
+                break;
+            case 'S':
+                fields.sec = int(value);
+                break;
+            case 'j':
+                fields.yday = int(value);
+                break;
+            case 'V':
+                fields.isoWeek = int(value);
+                break;
+            case 'u':
+                // 1 => Monday, ..., 7 => Sunday. Out of range never matches a weekday.
+                fields.wday = (1 <= value && value <= 7) ? int(value % 7) : 7;
+                break;
+            default:
+                break;
             }
+            return status;
+        }
 
-            // for (int i = 0; i < startList.size(); i++){
-            //     std::cout << startList[i] << " -> " << endList[i] << std::endl;
-            // }
-            //std::cout << "SST " << startList.size() << " " << endList.size() <<std::endl;
-            if (startList.empty())
+        // 読んだ値を struct tm にまとめる。範囲外の値は struct tm にそのまま残し、後段の検証で弾く。
+        static BuildStatus toStructTm(const Fields &fields, struct tm &time, Offset &utcOffset)
+        {
+            time = {};
+            if (fields.hasEpoch)
             {
-                throw DatetimeException("ERROR: No specifier is contained.");
+                time = MyTM::my_gmtime(fields.epoch);
+                utcOffset.designated = true;
+                utcOffset.seconds = 0;
+                return (fields.wday >= 0 && fields.wday != time.tm_wday) ? BUILD_WEEKDAY_MISMATCH : BUILD_OK;
             }
-            // First
-            std::vector<int> startList2 = {0};
-            std::vector<int> endList2 = {startList[0]};
-            // Middle
-            for (int i = 0; i < startList.size() - 1; i++)
+            if (fields.year > DatetimeConstants::MAXIMUM_YEAR)
             {
-                startList2.push_back(endList[i]);
-                endList2.push_back(startList[i + 1]);
+                return BUILD_YEAR_TOO_LARGE;
             }
-            // End
-            startList2.push_back(endList[startList.size() - 1]);
-            endList2.push_back(target.size());
-
-            for (int i = 0; i < startList2.size(); i++)
+            if (fields.year < DatetimeConstants::MINIMUM_YEAR)
+            {
+                return BUILD_YEAR_TOO_SMALL;
+            }
+            time.tm_year = int(fields.year - DatetimeConstants::TM_BASE_YEAR);
+            time.tm_mon = fields.mon - DatetimeConstants::MONTH_OFFSET;
+            time.tm_mday = fields.mday;
+            time.tm_hour = fields.hour;
+            time.tm_min = fields.min;
+            time.tm_sec = fields.sec;
+            if (fields.yday >= 0)
+            {
+                const long long daysOfYear = MyTM::isLeapYear(fields.year) ? 366 : 365;
+                if (fields.yday < 1 || fields.yday > daysOfYear)
+                {
+                    time.tm_mday = 0; // invalid
+                }
+                else
+                {
+                    long long year;
+                    int mon, day;
+                    MyTM::civilFromDays(MyTM::daysFromCivil(fields.year, 1, 1) + fields.yday - 1, year, mon, day);
+                    time.tm_mon = mon - DatetimeConstants::MONTH_OFFSET;
+                    time.tm_mday = day;
+                }
+            }
+            if (fields.isoWeek >= 0)
+            {
+                // ISO week date: "%G-W%V-%u". Monday if the weekday is not designated.
+                const int weekday = fields.wday >= 0 ? (fields.wday + 6) % 7 + 1 : 1;
+                if (fields.isoWeek < 1 || fields.isoWeek > Calendar::isoWeeksInYear(fields.year) || fields.wday > 6)
+                {
+                    time.tm_mday = 0; // invalid
+                }
+                else
+                {
+                    long long year;
+                    int mon, day;
+                    MyTM::civilFromDays(Calendar::daysFromIsoWeekDate(fields.year, fields.isoWeek, weekday), year, mon, day);
+                    time.tm_year = int(year - DatetimeConstants::TM_BASE_YEAR);
+                    time.tm_mon = mon - DatetimeConstants::MONTH_OFFSET;
+                    time.tm_mday = day;
+                }
+            }
+            if (fields.pm >= 0)
             {
-                delimList.push_back(target.substr(startList2[i], endList2[i] - startList2[i]));
-                //std::cout << startList2[i] << " -> " << endList2[i] << std::endl;
+                // 12-hour clock: 12 AM is 0 o'clock, 12 PM is 12 o'clock.
+                time.tm_hour = (1 <= fields.hour && fields.hour <= 12) ? fields.hour % 12 + 12 * fields.pm : -1;
+            }
+            if (fields.wday >= 0 && MyTM::isValidFields(time))
+            {
+                const long long days = MyTM::daysFromCivil((long long)time.tm_year + DatetimeConstants::TM_BASE_YEAR, time.tm_mon + DatetimeConstants::MONTH_OFFSET, time.tm_mday);
+                if (MyTM::floorDiv(days + 4, 7) * 7 != days + 4 - fields.wday)
+                {
+                    return BUILD_WEEKDAY_MISMATCH;
+                }
             }
+            utcOffset.designated = fields.hasOffset;
+            utcOffset.seconds = fields.utcOffset;
+            return BUILD_OK;
+        }
+
+        // 整数を0埋めで書き込む (std::setw(width), std::internal, std::setfill('0') と同じ)
+        static size_t writePadded(char *out, const long long &value, const int &width)
+        {
+            char digits[24];
+            int numDigits = 0;
+            unsigned long long absValue = value < 0 ? 0ULL - (unsigned long long)value : (unsigned long long)value;
+            do
+            {
+                digits[numDigits++] = char('0' + absValue % 10);
+                absValue /= 10;
+            } while (absValue > 0);
 
-            // for (auto d : delimList){
-            //     std::cout << d << ",";
-            // }
-            // std::cout << std::endl;
+            size_t len = 0;
+            if (value < 0)
+            {
+                out[len++] = '-';
+            }
+            for (int i = int(len) + numDigits; i < width; i++)
+            {
+                out[len++] = '0';
+            }
+            while (numDigits > 0)
+            {
+                out[len++] = digits[--numDigits];
+            }
+            return len;
         }
 
-        bool duplicatedKeyExists(std::string &duplicated, const std::vector<std::string> &formatList)
+        static void append(char *buf, size_t &len, std::string &overflow, const char *data, const size_t &dataLen)
         {
-            for (size_t idx = 0; idx < formatList.size() - 1; idx++)
+            if (len + dataLen > OUTPUT_BUFFER_SIZE)
             {
-                for (size_t j = idx + 1; j < formatList.size(); j++)
+                overflow.append(buf, len);
+                len = 0;
+                if (dataLen > OUTPUT_BUFFER_SIZE)
                 {
-                    if (formatList[idx] == formatList[j])
-                    {
-                        duplicated = formatList[idx];
-                        return true;
-                    }
+                    overflow.append(data, dataLen);
+                    return;
                 }
             }
-            return false;
+            memcpy(buf + len, data, dataLen);
+            len += dataLen;
         }
 
-        // 文字列を正の数値に変換する（不正な文字列の場合エラーを返す)
-        int my_stoi(const std::string &str)
+        static size_t copyName(char *out, const char *name)
         {
-            std::smatch m;
-            if (std::regex_search(str, m, std::regex("[^0-9]+")))
+            const size_t len = strlen(name);
+            memcpy(out, name, len);
+            return len;
+        }
+
+        // 出力指定子の値を out に書き込み、書き込んだ長さを返す
+        size_t outValues(const struct tm &time, const char &key, char *out) const
+        {
+            switch (key)
+            {
+            case 'y':
+            {
+                char year[VALUE_BUFFER_SIZE];
+                const size_t len = writePadded(year, (long long)time.tm_year + DatetimeConstants::TM_BASE_YEAR, 4);
+                memcpy(out, year + 2, len - 2);
+                return len - 2;
+            }
+            case 'Y':
+                return writePadded(out, (long long)time.tm_year + DatetimeConstants::TM_BASE_YEAR, 4);
+            case 'm':
+                return writePadded(out, time.tm_mon + DatetimeConstants::MONTH_OFFSET, 2);
+            case 'd':
+                return writePadded(out, time.tm_mday, 2);
+            case 'H':
+                return writePadded(out, time.tm_hour, 2);
+            case 'M':
+                return writePadded(out, time.tm_min, 2);
+            case 'S':
+                return writePadded(out, time.tm_sec, 2);
+            case 'I':
+                return writePadded(out, (time.tm_hour + 11) % 12 + 1, 2);
+            case 'j':
+                return writePadded(out, time.tm_yday + 1, 3);
+            case 'u':
+                return writePadded(out, (time.tm_wday + 6) % 7 + 1, 1);
+            case 'V':
+            case 'G':
+            {
+                long long isoYear;
+                int week, weekday;
+                Calendar::isoWeekDate(MyTM::daysFromCivil((long long)time.tm_year + DatetimeConstants::TM_BASE_YEAR,
+                                                          time.tm_mon + DatetimeConstants::MONTH_OFFSET, time.tm_mday),
+                                      isoYear, week, weekday);
+                return key == 'V' ? writePadded(out, week, 2) : writePadded(out, isoYear, 4);
+            }
+            case 'b':
+                memcpy(out, DatetimeConstants::MONTH_NAMES[time.tm_mon], 3);
+                return 3;
+            case 'B':
+                return copyName(out, DatetimeConstants::MONTH_NAMES[time.tm_mon]);
+            case 'a':
+                memcpy(out, DatetimeConstants::WEEKDAY_NAMES[time.tm_wday], 3);
+                return 3;
+            case 'A':
+                return copyName(out, DatetimeConstants::WEEKDAY_NAMES[time.tm_wday]);
+            case 'p':
+                memcpy(out, time.tm_hour < 12 ? "AM" : "PM", 2);
+                return 2;
+            case 'z':
             {
-                std::string strMsg = "Invalid string contains. str = '" + m.str() + "'";
-                throw DatetimeException(strMsg);
+                const long long offset = MyTM::utcOffsetOf(time);
+                const long long absOffset = offset < 0 ? -offset : offset;
+                out[0] = offset < 0 ? '-' : '+';
+                return 1 + writePadded(out + 1, absOffset / 3600 * 100 + absOffset % 3600 / 60, 4);
+            }
+            case 's':
+                return writePadded(out, MyTM::my_timegm(time) - MyTM::utcOffsetOf(time), 1);
+            case 'Z':
+            {
+#if defined(_WIN32) || defined(_WIN64)
+                TIME_ZONE_INFORMATION tzi;
+                GetTimeZoneInformation(&tzi);
+                long bias = tzi.Bias;
+                if (bias == 0)
+                {
+                    memcpy(out, "UTC", 3);
+                    return 3;
+                }
+                return size_t(snprintf(out, VALUE_BUFFER_SIZE, "(%ldmin from UTC)", bias));
+#else
+                const char *zone = time.tm_zone ? time.tm_zone : "";
+                size_t len = strlen(zone);
+                if (len >= VALUE_BUFFER_SIZE)
+                {
+                    len = VALUE_BUFFER_SIZE - 1;
+                }
+                memcpy(out, zone, len);
+                return len;
+#endif
             }
-            return std::stoi(str);
+            default:
+                break;
+            }
+
+            std::stringstream ess;
+            ess << "ERROR: "
+                << "\"%" << key << "\""
+                << " is invalid output specifier.";
+            throw DatetimeException(ess.str());
         }
 
         // Not used now (文字列を区切り文字で分割する)
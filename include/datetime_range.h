@@ -0,0 +1,376 @@
+#ifndef _MY_DATETIME_RANGE_
+#define _MY_DATETIME_RANGE_
+
+#include <stddef.h>
+#include <iterator>
+
+#include "datetime.h"
+#include "time_delta.h"
+#include "calendar.h"
+#include "datetime_exceptions.h"
+
+// 日時の範囲 [start, end) を一定の間隔で列挙する。要素は配列に展開せず、添字から O(1) で計算する。
+// 仕様: 各要素は start からの演算で求める (加算を積み重ねない)。月単位なら 1/31 => 2/28 => 3/31 のように日が保たれる。
+
+namespace EZ
+{
+    /**
+    * @brief Lazy range of Datetimes
+    * @details Datetimes in [start, end) at a fixed step (TimeDelta) or a calendar step (days, weeks, months, years).
+    * Elements are computed from the index and never stored. See EZ::range(). \n
+    * ex: \n
+    * for (const auto &t : EZ::range(start, end, EZ::TimeDelta(0, 0, 1, 0))) { ... }
+    */
+    class DatetimeRange
+    {
+    public:
+        /**
+        * ランダムアクセスイテレータ。参照先は持たず、要素を値で返す。 \n
+        * Random access iterator. Dereferencing returns a Datetime by value.
+        */
+        class iterator
+        {
+        public:
+            typedef std::random_access_iterator_tag iterator_category;
+            typedef Datetime value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef const Datetime *pointer;
+            typedef Datetime reference;
+
+            iterator()
+                : m_range(nullptr), m_index(0)
+            {
+            }
+            iterator(const DatetimeRange *range, const difference_type &index)
+                : m_range(range), m_index(index)
+            {
+            }
+
+            Datetime operator*() const
+            {
+                return (*m_range)[size_t(m_index)];
+            }
+            Datetime operator[](const difference_type &n) const
+            {
+                return (*m_range)[size_t(m_index + n)];
+            }
+
+            iterator &operator++()
+            {
+                ++m_index;
+                return *this;
+            }
+            iterator operator++(int)
+            {
+                iterator tmp = *this;
+                ++m_index;
+                return tmp;
+            }
+            iterator &operator--()
+            {
+                --m_index;
+                return *this;
+            }
+            iterator operator--(int)
+            {
+                iterator tmp = *this;
+                --m_index;
+                return tmp;
+            }
+            iterator &operator+=(const difference_type &n)
+            {
+                m_index += n;
+                return *this;
+            }
+            iterator &operator-=(const difference_type &n)
+            {
+                m_index -= n;
+                return *this;
+            }
+            iterator operator+(const difference_type &n) const
+            {
+                return iterator(m_range, m_index + n);
+            }
+            iterator operator-(const difference_type &n) const
+            {
+                return iterator(m_range, m_index - n);
+            }
+            difference_type operator-(const iterator &right) const
+            {
+                return m_index - right.m_index;
+            }
+
+            bool operator==(const iterator &right) const
+            {
+                return m_index == right.m_index;
+            }
+            bool operator!=(const iterator &right) const
+            {
+                return m_index != right.m_index;
+            }
+            bool operator<(const iterator &right) const
+            {
+                return m_index < right.m_index;
+            }
+            bool operator>(const iterator &right) const
+            {
+                return m_index > right.m_index;
+            }
+            bool operator<=(const iterator &right) const
+            {
+                return m_index <= right.m_index;
+            }
+            bool operator>=(const iterator &right) const
+            {
+                return m_index >= right.m_index;
+            }
+
+        private:
+            const DatetimeRange *m_range;
+            difference_type m_index;
+        };
+        typedef iterator const_iterator;
+
+        /**
+        * 一定の間隔の範囲 \n
+        * Range at a fixed step.
+        * @param[in] start first element
+        * @param[in] end end of the range (not included)
+        * @param[in] step non-zero. If negative, the range goes back from start to end (end < start).
+        */
+        DatetimeRange(const Datetime &start, const Datetime &end, const TimeDelta &step)
+            : m_start(start), m_kind(FIXED), m_step(step.totalSeconds()), m_first(0), m_size(0)
+        {
+            if (m_step == 0)
+            {
+                throw DatetimeException("ERROR: The step of the range must not be zero.");
+            }
+            m_size = countFixed(end.unixTime());
+        }
+
+        /**
+        * 暦の単位の間隔の範囲。現地時刻の日・週・月・年は現地時刻の暦で進める (時刻は保たれる)。 \n
+        * Range at a calendar step. Local days, weeks, months and years keep the local time of day.
+        * @param[in] unit Calendar::SECOND, MINUTE, HOUR, DAY, WEEK, MONTH or YEAR
+        * @param[in] multiple=1	ex: every 3 months => (Calendar::MONTH, 3)
+        * @details Months follow Calendar::CLAMP from start: 1/31 => 2/28 => 3/31.
+        */
+        DatetimeRange(const Datetime &start, const Datetime &end, const Calendar::Unit &unit, const long long &multiple = 1)
+            : m_start(start), m_kind(FIXED), m_step(0), m_first(0), m_size(0)
+        {
+            Calendar::Detail::checkUnit(unit, multiple);
+            switch (unit)
+            {
+            case Calendar::MONTH:
+            case Calendar::YEAR:
+                m_kind = MONTHS;
+                m_step = (unit == Calendar::YEAR) ? multiple * 12 : multiple;
+                break;
+            case Calendar::DAY:
+            case Calendar::WEEK:
+                // Days of UTC are always 86400 seconds.
+                m_kind = start.isUTC() ? FIXED : DAYS;
+                m_step = (unit == Calendar::WEEK) ? multiple * 7 : multiple;
+                m_step *= start.isUTC() ? DatetimeConstants::SECONDS_PER_DAY : 1;
+                break;
+            default:
+                m_step = multiple * Calendar::Detail::unitSeconds(unit);
+                break;
+            }
+            m_size = (m_kind == FIXED) ? countFixed(end.unixTime()) : countCalendar(end);
+        }
+
+        size_t size() const
+        {
+            return m_size;
+        }
+        bool empty() const
+        {
+            return m_size == 0;
+        }
+        /**
+        * 一定の間隔なら true (日時は start + index * step) \n
+        * true if the step is a fixed number of seconds.
+        */
+        bool isFixedStride() const
+        {
+            return m_kind == FIXED;
+        }
+
+        /**
+        * index 番目の要素 (範囲の確認はしない) \n
+        * The element at index. Not checked.
+        */
+        Datetime operator[](const size_t &index) const
+        {
+            return element((long long)(m_first + index));
+        }
+        /**
+        * index 番目の要素。範囲外なら例外を投げる。 \n
+        * The element at index. Throw DatetimeException if index is out of range.
+        */
+        Datetime at(const size_t &index) const
+        {
+            if (index >= m_size)
+            {
+                throw DatetimeException("ERROR: The index is out of the range.");
+            }
+            return operator[](index);
+        }
+        Datetime front() const
+        {
+            return at(0);
+        }
+        Datetime back() const
+        {
+            return at(m_size - 1);
+        }
+
+        iterator begin() const
+        {
+            return iterator(this, 0);
+        }
+        iterator end() const
+        {
+            return iterator(this, iterator::difference_type(m_size));
+        }
+
+        /**
+        * 要素 [begin, end) の部分範囲 \n
+        * Sub-range of the elements [begin, end).
+        */
+        DatetimeRange slice(const size_t &begin, const size_t &end) const
+        {
+            if (begin > end || end > m_size)
+            {
+                throw DatetimeException("ERROR: The slice is out of the range.");
+            }
+            DatetimeRange sub(*this);
+            sub.m_first = m_first + begin;
+            sub.m_size = end - begin;
+            return sub;
+        }
+        /**
+        * 範囲を numChunks 個に分けた index 番目 (並列処理向け。各部分の要素数の差は高々1) \n
+        * The index-th of numChunks contiguous parts, for parallel consumers. Sizes of the parts differ by at most one.
+        * @details ex: thread i of n => for (const auto &t : range.chunk(i, n)) { ... }
+        */
+        DatetimeRange chunk(const size_t &index, const size_t &numChunks) const
+        {
+            if (numChunks == 0 || index >= numChunks)
+            {
+                throw DatetimeException("ERROR: The chunk is out of the range.");
+            }
+            const size_t base = m_size / numChunks;
+            const size_t rest = m_size % numChunks;
+            const size_t begin = index * base + (index < rest ? index : rest);
+            return slice(begin, begin + base + (index < rest ? 1 : 0));
+        }
+
+    private:
+        enum Kind
+        {
+            FIXED,  // m_step seconds
+            DAYS,   // m_step local days
+            MONTHS, // m_step months
+        };
+
+        Datetime m_start;
+        Kind m_kind;
+        long long m_step;
+        size_t m_first;
+        size_t m_size;
+
+        // start から k 番目の要素
+        Datetime element(const long long &k) const
+        {
+            switch (m_kind)
+            {
+            case DAYS:
+                return m_start.addDays(k * m_step);
+            case MONTHS:
+                if (m_start.isUTC())
+                {
+                    Calendar::Detail::checkMonths(k * m_step);
+                    return Datetime(time_t(Calendar::addMonths(m_start.unixTime(), k * m_step)), true);
+                }
+                return m_start.addMonths(k * m_step);
+            default:
+                return Datetime(time_t(m_start.unixTime() + k * m_step), m_start.isUTC());
+            }
+        }
+
+        size_t countFixed(const long long &end) const
+        {
+            const long long start = m_start.unixTime();
+            if (m_step > 0)
+            {
+                return end > start ? size_t((end - start - 1) / m_step + 1) : 0;
+            }
+            return end < start ? size_t((start - end - 1) / -m_step + 1) : 0;
+        }
+
+        // k 番目の要素が end より前にあるか (扱える範囲を超えたら false)
+        bool isBefore(const long long &k, const Datetime &end) const
+        {
+            try
+            {
+                return element(k).unixTime() < end.unixTime();
+            }
+            catch (const DatetimeException &)
+            {
+                return false;
+            }
+        }
+
+        // 暦の間隔の要素数。平均の長さから見積もり、前後の要素を確かめて補正する。
+        size_t countCalendar(const Datetime &end) const
+        {
+            if (end.unixTime() <= m_start.unixTime())
+            {
+                return 0;
+            }
+            long long estimate;
+            if (m_kind == DAYS)
+            {
+                estimate = (end.unixTime() - m_start.unixTime()) / (m_step * DatetimeConstants::SECONDS_PER_DAY);
+            }
+            else
+            {
+                const auto startTm = m_start.structTm();
+                const auto endTm = end.structTm();
+                estimate = (((long long)endTm.tm_year - startTm.tm_year) * 12 + endTm.tm_mon - startTm.tm_mon) / m_step;
+            }
+            long long k = estimate > 1 ? estimate - 1 : 1;
+            while (isBefore(k, end))
+            {
+                k++;
+            }
+            while (k > 1 && !isBefore(k - 1, end))
+            {
+                k--;
+            }
+            return size_t(k);
+        }
+    };
+
+    /**
+    * 日時の範囲 [start, end) を step ごとに列挙する (配列を作らない) \n
+    * Lazy range of Datetimes in [start, end) at every step. No vector is allocated.
+    * @details ex: every minute of 2021 => EZ::range(Datetime(2021, 1, 1, 0, 0, 0, true), Datetime(2022, 1, 1, 0, 0, 0, true), TimeDelta(0, 0, 1, 0))
+    */
+    inline DatetimeRange range(const Datetime &start, const Datetime &end, const TimeDelta &step)
+    {
+        return DatetimeRange(start, end, step);
+    }
+    /**
+    * 日時の範囲 [start, end) を暦の単位 (の multiple 倍) ごとに列挙する \n
+    * Lazy range of Datetimes in [start, end) at every calendar unit (or its multiple).
+    * @details ex: the first day of every quarter => EZ::range(Datetime(2021, 1, 1, 0, 0, 0), Datetime(2031, 1, 1, 0, 0, 0), Calendar::MONTH, 3)
+    */
+    inline DatetimeRange range(const Datetime &start, const Datetime &end, const Calendar::Unit &unit, const long long &multiple = 1)
+    {
+        return DatetimeRange(start, end, unit, multiple);
+    }
+}
+#endif
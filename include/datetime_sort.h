@@ -0,0 +1,358 @@
+#ifndef _MY_DATETIME_SORT_
+#define _MY_DATETIME_SORT_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include <thread>
+#include <algorithm>
+
+#include "datetime.h"
+
+// 時刻の配列の整列。LSD 基数ソート (8ビットずつ、最大8パス) で、最小値を引いた値の桁がすべて同じパスは飛ばす。
+// 仕様: 1年分の時刻なら値の幅は 2^25 程度なので 4パスで済む。整列済み、または少数の整列済みの区間 (run) の連結なら併合する。
+// 基数ソートは安定なので、キーと値の組の整列にも使える。
+
+namespace EZ
+{
+    namespace Detail
+    {
+        // 並列に整列するとき、1スレッドが受け持つ最小の要素数
+        const size_t MINIMUM_SORT_ROWS_PER_THREAD = 1 << 16;
+        // これ以下の要素数は比較による安定ソート
+        const size_t MINIMUM_RADIX_SORT_SIZE = 64;
+        // これ以下の個数の整列済みの区間なら併合する
+        const size_t MAXIMUM_MERGED_RUNS = 8;
+
+        inline long long keyOf(const long long &value)
+        {
+            return value;
+        }
+        inline long long keyOf(const Datetime &time)
+        {
+            return time.unixTime();
+        }
+
+        // 整列済みの区間の先頭 (limit 個を超えたら数えるのをやめる)
+        template <class T>
+        std::vector<size_t> runStarts(const T *data, const size_t &count, const size_t &limit)
+        {
+            std::vector<size_t> starts;
+            if (count == 0)
+            {
+                return starts;
+            }
+            starts.push_back(0);
+            for (size_t i = 1; i < count && starts.size() <= limit; i++)
+            {
+                if (keyOf(data[i]) < keyOf(data[i - 1]))
+                {
+                    starts.push_back(i);
+                }
+            }
+            return starts;
+        }
+
+        // f(r) を numRanges 個のスレッドで実行する
+        template <class F>
+        void runParallel(const size_t &numRanges, F f)
+        {
+            std::vector<std::thread> threads;
+            threads.reserve(numRanges);
+            for (size_t r = 0; r < numRanges; r++)
+            {
+                threads.emplace_back(f, r);
+            }
+            for (auto &thread : threads)
+            {
+                thread.join();
+            }
+        }
+
+        /**
+        * LSD 基数ソート。keys と values (なければ nullptr) を keyOf(keys[i]) の順に安定に並べる。 \n
+        * Stable LSD radix sort of keys (and values along with them) by 8-bit digits of keyOf(key) - minimum.
+        * Passes whose digit is the same for all keys are skipped.
+        */
+        template <class T, class V>
+        void radixSort(T *keys, V *values, const size_t &count, const size_t &numThreads)
+        {
+            if (count <= MINIMUM_RADIX_SORT_SIZE)
+            {
+                std::vector<size_t> order(count);
+                for (size_t i = 0; i < count; i++)
+                {
+                    order[i] = i;
+                }
+                std::stable_sort(order.begin(), order.end(), [&](const size_t &a, const size_t &b) {
+                    return keyOf(keys[a]) < keyOf(keys[b]);
+                });
+                std::vector<T> sortedKeys(count);
+                std::vector<V> sortedValues(values != nullptr ? count : 0);
+                for (size_t i = 0; i < count; i++)
+                {
+                    sortedKeys[i] = keys[order[i]];
+                    if (values != nullptr)
+                    {
+                        sortedValues[i] = values[order[i]];
+                    }
+                }
+                std::copy(sortedKeys.begin(), sortedKeys.end(), keys);
+                std::copy(sortedValues.begin(), sortedValues.end(), values);
+                return;
+            }
+
+            size_t numRanges = count / MINIMUM_SORT_ROWS_PER_THREAD;
+            numRanges = numThreads < numRanges ? numThreads : numRanges;
+            numRanges = numRanges > 1 ? numRanges : 1;
+            auto beginOf = [&](const size_t &r) { return count * r / numRanges; };
+
+            // The minimum and the histograms of all digits in one read.
+            long long minimum = keyOf(keys[0]);
+            for (size_t i = 1; i < count; i++)
+            {
+                minimum = keyOf(keys[i]) < minimum ? keyOf(keys[i]) : minimum;
+            }
+            std::vector<size_t> totals(8 * 256, 0);
+            for (size_t i = 0; i < count; i++)
+            {
+                const uint64_t digits = uint64_t(keyOf(keys[i])) - uint64_t(minimum);
+                for (int b = 0; b < 8; b++)
+                {
+                    totals[b * 256 + ((digits >> (8 * b)) & 0xFF)]++;
+                }
+            }
+
+            std::vector<T> keyBuffer(count);
+            std::vector<V> valueBuffer(values != nullptr ? count : 0);
+            T *srcKeys = keys, *dstKeys = keyBuffer.data();
+            V *srcValues = values, *dstValues = values != nullptr ? valueBuffer.data() : nullptr;
+            std::vector<size_t> offsets(numRanges * 256);
+            for (int b = 0; b < 8; b++)
+            {
+                const int shift = 8 * b;
+                const size_t first = size_t(((uint64_t(keyOf(srcKeys[0])) - uint64_t(minimum)) >> shift) & 0xFF);
+                if (totals[b * 256 + first] == count)
+                {
+                    // The digit is the same for all keys.
+                    continue;
+                }
+                // Offsets of each digit for each range: digits in order, and ranges in order within a digit (stable).
+                if (numRanges == 1)
+                {
+                    size_t offset = 0;
+                    for (size_t d = 0; d < 256; d++)
+                    {
+                        offsets[d] = offset;
+                        offset += totals[b * 256 + d];
+                    }
+                }
+                else
+                {
+                    runParallel(numRanges, [&](const size_t &r) {
+                        size_t *histogram = &offsets[r * 256];
+                        std::fill(histogram, histogram + 256, 0);
+                        for (size_t i = beginOf(r); i < beginOf(r + 1); i++)
+                        {
+                            histogram[((uint64_t(keyOf(srcKeys[i])) - uint64_t(minimum)) >> shift) & 0xFF]++;
+                        }
+                    });
+                    size_t offset = 0;
+                    for (size_t d = 0; d < 256; d++)
+                    {
+                        for (size_t r = 0; r < numRanges; r++)
+                        {
+                            const size_t n = offsets[r * 256 + d];
+                            offsets[r * 256 + d] = offset;
+                            offset += n;
+                        }
+                    }
+                }
+                auto scatter = [&](const size_t &r) {
+                    size_t *offset = &offsets[r * 256];
+                    for (size_t i = beginOf(r); i < beginOf(r + 1); i++)
+                    {
+                        const size_t d = size_t(((uint64_t(keyOf(srcKeys[i])) - uint64_t(minimum)) >> shift) & 0xFF);
+                        if (srcValues != nullptr)
+                        {
+                            dstValues[offset[d]] = srcValues[i];
+                        }
+                        dstKeys[offset[d]++] = srcKeys[i];
+                    }
+                };
+                if (numRanges == 1)
+                {
+                    scatter(0);
+                }
+                else
+                {
+                    runParallel(numRanges, scatter);
+                }
+                std::swap(srcKeys, dstKeys);
+                std::swap(srcValues, dstValues);
+            }
+            if (srcKeys != keys)
+            {
+                std::copy(srcKeys, srcKeys + count, keys);
+                if (values != nullptr)
+                {
+                    std::copy(srcValues, srcValues + count, values);
+                }
+            }
+        }
+
+        // 整列済みか、少数の整列済みの区間なら併合する。そうでなければ基数ソート。
+        template <class T>
+        void sort(T *data, const size_t &count, const size_t &numThreads)
+        {
+            const auto starts = runStarts(data, count, MAXIMUM_MERGED_RUNS);
+            if (starts.size() <= 1)
+            {
+                return;
+            }
+            if (starts.size() <= MAXIMUM_MERGED_RUNS)
+            {
+                auto less = [](const T &a, const T &b) { return keyOf(a) < keyOf(b); };
+                for (size_t i = 1; i < starts.size(); i++)
+                {
+                    const size_t end = (i + 1 < starts.size()) ? starts[i + 1] : count;
+                    std::inplace_merge(data, data + starts[i], data + end, less);
+                }
+                return;
+            }
+            radixSort(data, (char *)nullptr, count, numThreads);
+        }
+    }
+
+    /**
+    * 時刻 (Unix秒) の配列を昇順に並べる。基数ソートで、値の幅が狭い (ex: 1年以内) ほど速い。 \n
+    * Sort an array of unix seconds in ascending order by radix sort. The narrower the range of values (ex: within a year), the faster.
+    * @details Already sorted input, or a few sorted runs, is detected in O(n) and merged instead.
+    */
+    inline void sort(long long *values, const size_t &count)
+    {
+        Detail::sort(values, count, 1);
+    }
+    inline void sort(std::vector<long long> &values)
+    {
+        sort(values.data(), values.size());
+    }
+    /**
+    * Datetime の配列を時刻の昇順に並べる (安定。タイムゾーンの設定は問わない) \n
+    * Sort an array of Datetimes by their unix times. Stable. (Timezone settings do not matter)
+    */
+    inline void sort(Datetime *times, const size_t &count)
+    {
+        Detail::sort(times, count, 1);
+    }
+    inline void sort(std::vector<Datetime> &times)
+    {
+        sort(times.data(), times.size());
+    }
+
+    /**
+    * sort() の並列版 (link with -pthread)。結果は sort() と同じ。 \n
+    * Parallel version of sort(). The result is the same as sort().
+    * @param[in] numThreads each pass of the radix sort is split into numThreads ranges (at least 65536 elements per thread)
+    */
+    inline void parallelSort(long long *values, const size_t &count, const size_t &numThreads)
+    {
+        Detail::sort(values, count, numThreads);
+    }
+    inline void parallelSort(std::vector<long long> &values, const size_t &numThreads)
+    {
+        parallelSort(values.data(), values.size(), numThreads);
+    }
+    inline void parallelSort(Datetime *times, const size_t &count, const size_t &numThreads)
+    {
+        Detail::sort(times, count, numThreads);
+    }
+    inline void parallelSort(std::vector<Datetime> &times, const size_t &numThreads)
+    {
+        parallelSort(times.data(), times.size(), numThreads);
+    }
+
+    /**
+    * キーの順に、キーと値の組を安定に並べる (ex: 時刻と行番号) \n
+    * Sort pairs of keys and values by the keys. Stable: values of equal keys keep their order.
+    * @details ex: keys = {3, 1, 3, 2}, values = {0, 1, 2, 3} => keys = {1, 2, 3, 3}, values = {1, 3, 0, 2}
+    */
+    template <class V>
+    void sortByKey(long long *keys, V *values, const size_t &count, const size_t &numThreads = 1)
+    {
+        Detail::radixSort(keys, values, count, numThreads);
+    }
+    template <class V>
+    void sortByKey(std::vector<long long> &keys, std::vector<V> &values, const size_t &numThreads = 1)
+    {
+        if (keys.size() != values.size())
+        {
+            throw DatetimeException("ERROR: The keys and the values have different sizes.");
+        }
+        sortByKey(keys.data(), values.data(), keys.size(), numThreads);
+    }
+    /**
+    * キーを昇順に並べる添字 (安定)。キーは変更しない。 \n
+    * Indices that sort the keys (stable). The keys are not changed.
+    * @details ex: keys = {3, 1, 3, 2} => {1, 3, 0, 2}
+    */
+    inline std::vector<size_t> sortedIndices(const long long *keys, const size_t &count, const size_t &numThreads = 1)
+    {
+        std::vector<long long> copied(keys, keys + count);
+        std::vector<size_t> indices(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            indices[i] = i;
+        }
+        sortByKey(copied.data(), indices.data(), count, numThreads);
+        return indices;
+    }
+    inline std::vector<size_t> sortedIndices(const std::vector<long long> &keys, const size_t &numThreads = 1)
+    {
+        return sortedIndices(keys.data(), keys.size(), numThreads);
+    }
+
+    /**
+    * 昇順に並んでいれば true \n
+    * true if the array is in ascending order.
+    */
+    inline bool isSorted(const long long *values, const size_t &count)
+    {
+        return std::is_sorted(values, values + count);
+    }
+    inline bool isSorted(const std::vector<long long> &values)
+    {
+        return isSorted(values.data(), values.size());
+    }
+    inline bool isSorted(const Datetime *times, const size_t &count)
+    {
+        return std::is_sorted(times, times + count);
+    }
+    inline bool isSorted(const std::vector<Datetime> &times)
+    {
+        return isSorted(times.data(), times.size());
+    }
+
+    /**
+    * 昇順の区間 (run) の先頭の添字。ほぼ整列済みのログなら少数になる。 \n
+    * Start indices of the maximal ascending runs. Nearly sorted logs have a few runs.
+    * @details ex: {1, 2, 5, 3, 4, 0} => {0, 3, 5}
+    */
+    inline std::vector<size_t> sortedRuns(const long long *values, const size_t &count)
+    {
+        return Detail::runStarts(values, count, count);
+    }
+    inline std::vector<size_t> sortedRuns(const std::vector<long long> &values)
+    {
+        return sortedRuns(values.data(), values.size());
+    }
+    inline std::vector<size_t> sortedRuns(const Datetime *times, const size_t &count)
+    {
+        return Detail::runStarts(times, count, count);
+    }
+    inline std::vector<size_t> sortedRuns(const std::vector<Datetime> &times)
+    {
+        return sortedRuns(times.data(), times.size());
+    }
+}
+#endif
@@ -0,0 +1,633 @@
+#ifndef _MY_FIXED_FORMAT_
+#define _MY_FIXED_FORMAT_
+
+#include <stddef.h>
+#include <string.h>
+#include <time.h>
+#include <limits.h>
+
+#include "datetime_constants.h"
+#include "datetime_metrics.h"
+#include "datetime_parser.h"
+#include "unix_time.h"
+#include "datetime_clock.h"
+
+// 固定レイアウトの書式 (RFC 3339, HTTP-date, RFC 2822) を書式指定子の解析なしで読み書きする。
+// 仕様: 例外を投げず、ヒープ確保も行わない。出力は呼び出し側のバッファに書き込む。
+
+namespace EZ
+{
+    namespace FixedFormat
+    {
+        // Enough for "-2147481747-01-01T00:00:00.000000000+23:59"
+        const size_t RFC3339_BUFFER_SIZE = 48;
+        // Length of "Sun, 06 Nov 1994 08:49:37 GMT" (years 0000 ~ 9999)
+        const size_t HTTP_DATE_LENGTH = 29;
+        // Enough for "Sun, 06 Nov -2147481747 08:49:37 GMT"
+        const size_t HTTP_DATE_BUFFER_SIZE = 48;
+        // Enough for "Sun, 06 Nov -2147481747 08:49:37 +0900"
+        const size_t RFC2822_BUFFER_SIZE = 48;
+
+        namespace Detail
+        {
+            inline bool isDigit(const char &c)
+            {
+                return '0' <= c && c <= '9';
+            }
+
+            inline bool isAlpha(const char &c)
+            {
+                return ('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z');
+            }
+
+            // 固定桁の数字を読む。数字以外が含まれていれば false を返す。
+            inline bool readDigits(const char *str, const int &numDigits, int &value)
+            {
+                value = 0;
+                for (int i = 0; i < numDigits; i++)
+                {
+                    if (!isDigit(str[i]))
+                    {
+                        return false;
+                    }
+                    value = value * 10 + (str[i] - '0');
+                }
+                return true;
+            }
+
+            inline void write2(char *out, const int &value)
+            {
+                out[0] = char('0' + value / 10);
+                out[1] = char('0' + value % 10);
+            }
+
+            // 年を4桁以上で書き込む (負の年は '-' を付ける)
+            inline size_t writeYear(char *out, const long long &year)
+            {
+                char digits[24];
+                int numDigits = 0;
+                unsigned long long absYear = year < 0 ? 0ULL - (unsigned long long)year : (unsigned long long)year;
+                do
+                {
+                    digits[numDigits++] = char('0' + absYear % 10);
+                    absYear /= 10;
+                } while (absYear > 0);
+                size_t len = 0;
+                if (year < 0)
+                {
+                    out[len++] = '-';
+                }
+                for (int i = numDigits; i < 4; i++)
+                {
+                    out[len++] = '0';
+                }
+                while (numDigits > 0)
+                {
+                    out[len++] = digits[--numDigits];
+                }
+                return len;
+            }
+
+            // "Sun, 06 Nov 1994 08:49:37" を書き込む (HTTP-date と RFC 2822 の共通部分)
+            inline size_t writeDayDateTime(char *out, const long long &localTime)
+            {
+                const long long days = MyTM::floorDiv(localTime, DatetimeConstants::SECONDS_PER_DAY);
+                const int secOfDay = int(localTime - days * DatetimeConstants::SECONDS_PER_DAY);
+                long long year;
+                int mon, day;
+                MyTM::civilFromDays(days, year, mon, day);
+                // 1970/1/1 is Thursday.
+                const int wday = int(days + 4 - MyTM::floorDiv(days + 4, 7) * 7);
+
+                memcpy(out, DatetimeConstants::WEEKDAY_NAMES[wday], 3);
+                out[3] = ',';
+                out[4] = ' ';
+                write2(out + 5, day);
+                out[7] = ' ';
+                memcpy(out + 8, DatetimeConstants::MONTH_NAMES[mon - 1], 3);
+                out[11] = ' ';
+                size_t len = 12 + writeYear(out + 12, year);
+                out[len] = ' ';
+                write2(out + len + 1, secOfDay / 3600);
+                out[len + 3] = ':';
+                write2(out + len + 4, secOfDay % 3600 / 60);
+                out[len + 6] = ':';
+                write2(out + len + 7, secOfDay % 60);
+                return len + 9;
+            }
+
+            // 空白 (スペース・タブ) を読み飛ばし、読み飛ばした数を返す
+            inline size_t skipSpaces(const char *str, const size_t &len, size_t &i)
+            {
+                const size_t start = i;
+                while (i < len && (str[i] == ' ' || str[i] == '\t'))
+                {
+                    i++;
+                }
+                return i - start;
+            }
+
+            // minDigits ~ maxDigits 桁の数字を読む
+            inline bool readDigitRun(const char *str, const size_t &len, size_t &i, const size_t &minDigits, const size_t &maxDigits, int &value)
+            {
+                const size_t start = i;
+                value = 0;
+                while (i < len && i - start < maxDigits && isDigit(str[i]))
+                {
+                    value = value * 10 + (str[i] - '0');
+                    i++;
+                }
+                return i - start >= minDigits && !(i < len && isDigit(str[i]));
+            }
+
+            // 3文字の月名・曜日名を読む (大文字小文字は区別しない)
+            inline bool readMonth(const char *str, const size_t &len, size_t &i, int &mon)
+            {
+                if (len - i < 3)
+                {
+                    return false;
+                }
+                const int idx = MyParser::lookupMonth(MyParser::packLower(str + i));
+                mon = idx + 1;
+                i += 3;
+                return idx >= 0;
+            }
+
+            inline bool readWeekday(const char *str, const size_t &len, size_t &i)
+            {
+                if (len - i < 3)
+                {
+                    return false;
+                }
+                const int idx = MyParser::lookupWeekday(MyParser::packLower(str + i));
+                i += 3;
+                return idx >= 0;
+            }
+
+            // 曜日の正式名を読む (大文字小文字は区別しない)。 ex: "Sunday"
+            inline bool readFullWeekday(const char *str, const size_t &len, size_t &i)
+            {
+                size_t j = i;
+                if (!readWeekday(str, len, j))
+                {
+                    return false;
+                }
+                const char *name = DatetimeConstants::WEEKDAY_NAMES[MyParser::lookupWeekday(MyParser::packLower(str + i))];
+                const size_t nameLen = strlen(name);
+                if (len - i < nameLen || (len - i > nameLen && isAlpha(str[i + nameLen])))
+                {
+                    return false;
+                }
+                for (size_t k = 3; k < nameLen; k++)
+                {
+                    if ((str[i + k] | 0x20) != (name[k] | 0x20))
+                    {
+                        return false;
+                    }
+                }
+                i += nameLen;
+                return true;
+            }
+
+            // "HH:MM:SS" (optionalSeconds = true なら秒は省略可)
+            inline bool readTime(const char *str, const size_t &len, size_t &i, const bool &optionalSeconds, int &hour, int &min, int &sec)
+            {
+                sec = 0;
+                if (len - i < 5 || !readDigits(str + i, 2, hour) || str[i + 2] != ':' || !readDigits(str + i + 3, 2, min))
+                {
+                    return false;
+                }
+                i += 5;
+                if (i < len && str[i] == ':')
+                {
+                    if (len - i < 3 || !readDigits(str + i + 1, 2, sec))
+                    {
+                        return false;
+                    }
+                    i += 3;
+                }
+                else if (!optionalSeconds)
+                {
+                    return false;
+                }
+                return true;
+            }
+
+            // 値を検証してUnix秒にする
+            inline bool toUnixTime(const long long &year, const int &mon, const int &day,
+                                   const int &hour, const int &min, const int &sec, const long long &utcOffset, long long &unixTime)
+            {
+                if (year < DatetimeConstants::MINIMUM_YEAR || year > DatetimeConstants::MAXIMUM_YEAR ||
+                    mon < 1 || mon > 12 || day < 1 || day > MyTM::daysInMonth(year, mon) || hour > 23 || min > 59 || sec > 59)
+                {
+                    return false;
+                }
+                unixTime = MyTM::daysFromCivil(year, mon, day) * DatetimeConstants::SECONDS_PER_DAY +
+                           hour * 3600LL + min * 60LL + sec - utcOffset;
+                return true;
+            }
+
+            // RFC 850 の2桁の年: 50年より先の未来になる場合は過去の年とみなす (RFC 7231 7.1.1.1)
+            inline long long expandTwoDigitYear(const int &yy)
+            {
+                long long currentYear;
+                int mon, day;
+                MyTM::civilFromDays(MyTM::floorDiv((long long)time(NULL), DatetimeConstants::SECONDS_PER_DAY), currentYear, mon, day);
+                const long long year = MyTM::floorDiv(currentYear, 100) * 100 + yy;
+                return (year > currentYear + 50) ? year - 100 : year;
+            }
+        }
+
+        /**
+        * RFC 3339 の文字列を解析する。例外を投げず、ヒープ確保も行わない。 \n
+        * Parse an RFC 3339 timestamp. No throw, no allocation.
+        * @param[out] unixTime unix seconds (the fraction is not included)
+        * @param[out] nanoseconds fraction of the second (0 ~ 999999999). Digits after the 9th are truncated.
+        * @returns false if the timestamp is not RFC 3339 or out of range.
+        * @details ex: "2021-03-08T00:00:15Z", "2021-03-08T09:00:15.123+09:00", "2021-03-08 00:00:15z" \n
+        * The separator may be 'T', 't' or ' '. Leap seconds (":60") are not supported.
+        */
+        inline bool parseRfc3339(const char *timestamp, const size_t &timestampLen, long long &unixTime, long &nanoseconds)
+        {
+            using Detail::readDigits;
+            Metrics::increment(Metrics::PARSE_CALLS);
+            Metrics::increment(Metrics::PARSE_FAST_PATH);
+
+            // YYYY-MM-DDTHH:MM:SS + Z (shortest)
+            if (timestampLen < 20)
+            {
+                return false;
+            }
+            const char *p = timestamp;
+            int year, mon, day, hour, min, sec;
+            if (!readDigits(p, 4, year) || p[4] != '-' || !readDigits(p + 5, 2, mon) || p[7] != '-' ||
+                !readDigits(p + 8, 2, day) || (p[10] != 'T' && p[10] != 't' && p[10] != ' ') ||
+                !readDigits(p + 11, 2, hour) || p[13] != ':' || !readDigits(p + 14, 2, min) || p[16] != ':' ||
+                !readDigits(p + 17, 2, sec))
+            {
+                return false;
+            }
+            if (mon < 1 || mon > 12 || day < 1 || day > MyTM::daysInMonth(year, mon) || hour > 23 || min > 59 || sec > 59)
+            {
+                return false;
+            }
+
+            size_t i = 19;
+            nanoseconds = 0;
+            if (timestamp[i] == '.')
+            {
+                i++;
+                const size_t start = i;
+                long scale = 100000000;
+                while (i < timestampLen && Detail::isDigit(timestamp[i]))
+                {
+                    nanoseconds += (timestamp[i] - '0') * scale;
+                    scale /= 10;
+                    i++;
+                }
+                if (i == start)
+                {
+                    return false;
+                }
+            }
+
+            long long offset = 0;
+            if (i < timestampLen && (timestamp[i] == 'Z' || timestamp[i] == 'z'))
+            {
+                i++;
+            }
+            else if (timestampLen - i >= 6 && (timestamp[i] == '+' || timestamp[i] == '-'))
+            {
+                int offsetHour, offsetMin;
+                if (!readDigits(timestamp + i + 1, 2, offsetHour) || timestamp[i + 3] != ':' ||
+                    !readDigits(timestamp + i + 4, 2, offsetMin) || offsetHour > 23 || offsetMin > 59)
+                {
+                    return false;
+                }
+                offset = (offsetHour * 3600LL + offsetMin * 60LL) * (timestamp[i] == '-' ? -1 : 1);
+                i += 6;
+            }
+            else
+            {
+                return false;
+            }
+            if (i != timestampLen)
+            {
+                return false;
+            }
+
+            unixTime = MyTM::daysFromCivil(year, mon, day) * DatetimeConstants::SECONDS_PER_DAY +
+                       hour * 3600LL + min * 60LL + sec - offset;
+            return true;
+        }
+
+        /**
+        * RFC 3339 の文字列を out に書き込み、長さを返す (終端文字は書き込まない)。 \n
+        * Write an RFC 3339 timestamp to out and return the length. (No terminating null)
+        * @param[out] out buffer of at least RFC3339_BUFFER_SIZE bytes
+        * @param[in] unixTime unix seconds
+        * @param[in] utcOffset seconds east of UTC. "Z" is written if 0.
+        * @param[in] nanoseconds fraction of the second (0 ~ 999999999)
+        * @param[in] fractionDigits number of fraction digits (0 ~ 9). ex: 3 => ".123"
+        * @details Years out of 0000 ~ 9999 are written with more digits or a sign (not RFC 3339).
+        */
+        inline size_t writeRfc3339(char *out, const long long &unixTime, const long long &utcOffset = 0,
+                                   const long &nanoseconds = 0, const int &fractionDigits = 0)
+        {
+            using Detail::write2;
+            Metrics::increment(Metrics::FORMAT_CALLS);
+
+            const long long localTime = unixTime + utcOffset;
+            const long long days = MyTM::floorDiv(localTime, DatetimeConstants::SECONDS_PER_DAY);
+            const int secOfDay = int(localTime - days * DatetimeConstants::SECONDS_PER_DAY);
+            long long year;
+            int mon, day;
+            MyTM::civilFromDays(days, year, mon, day);
+
+            size_t len = Detail::writeYear(out, year);
+            char *p = out + len;
+            p[0] = '-';
+            write2(p + 1, mon);
+            p[3] = '-';
+            write2(p + 4, day);
+            p[6] = 'T';
+            write2(p + 7, secOfDay / 3600);
+            p[9] = ':';
+            write2(p + 10, secOfDay % 3600 / 60);
+            p[12] = ':';
+            write2(p + 13, secOfDay % 60);
+            len += 15;
+
+            if (fractionDigits > 0)
+            {
+                out[len++] = '.';
+                long scale = 100000000;
+                for (int i = 0; i < fractionDigits && i < 9; i++)
+                {
+                    out[len++] = char('0' + nanoseconds / scale % 10);
+                    scale /= 10;
+                }
+            }
+
+            if (utcOffset == 0)
+            {
+                out[len++] = 'Z';
+                return len;
+            }
+            const long long absOffset = utcOffset < 0 ? -utcOffset : utcOffset;
+            out[len] = utcOffset < 0 ? '-' : '+';
+            write2(out + len + 1, int(absOffset / 3600));
+            out[len + 3] = ':';
+            write2(out + len + 4, int(absOffset % 3600 / 60));
+            return len + 6;
+        }
+
+        /**
+        * HTTP-date (IMF-fixdate) を out に書き込み、長さを返す (終端文字は書き込まない)。 \n
+        * Write an HTTP-date (IMF-fixdate of RFC 7231) to out and return the length. (No terminating null)
+        * @param[out] out buffer of at least HTTP_DATE_BUFFER_SIZE bytes
+        * @details ex: "Sun, 06 Nov 1994 08:49:37 GMT". The length is HTTP_DATE_LENGTH for years 0000 ~ 9999.
+        */
+        inline size_t writeHttpDate(char *out, const long long &unixTime)
+        {
+            Metrics::increment(Metrics::FORMAT_CALLS);
+            const size_t len = Detail::writeDayDateTime(out, unixTime);
+            memcpy(out + len, " GMT", 4);
+            return len + 4;
+        }
+
+        /**
+        * HTTP-date を解析する。例外を投げず、ヒープ確保も行わない。 \n
+        * Parse an HTTP-date. No throw, no allocation.
+        * @details Accepts the 3 formats of RFC 7231: \n
+        * "Sun, 06 Nov 1994 08:49:37 GMT" (IMF-fixdate) \n
+        * "Sunday, 06-Nov-94 08:49:37 GMT" (RFC 850. The 2-digit year is the most recent year not more than 50 years ahead.) \n
+        * "Sun Nov  6 08:49:37 1994" (asctime) \n
+        * The weekday name is not checked against the date.
+        */
+        inline bool parseHttpDate(const char *timestamp, const size_t &timestampLen, long long &unixTime)
+        {
+            using namespace Detail;
+            Metrics::increment(Metrics::PARSE_CALLS);
+            Metrics::increment(Metrics::PARSE_FAST_PATH);
+
+            const char *p = timestamp;
+            int day, mon, year, hour, min, sec;
+            size_t i = 0;
+            if (timestampLen == HTTP_DATE_LENGTH && p[3] == ',')
+            {
+                // IMF-fixdate: fixed positions
+                size_t weekdayPos = 0;
+                size_t monthPos = 8;
+                size_t timePos = 17;
+                if (!readWeekday(p, timestampLen, weekdayPos) || p[4] != ' ' || !readDigits(p + 5, 2, day) || p[7] != ' ' ||
+                    !readMonth(p, timestampLen, monthPos, mon) || p[11] != ' ' || !readDigits(p + 12, 4, year) || p[16] != ' ' ||
+                    !readTime(p, timestampLen, timePos, false, hour, min, sec) || memcmp(p + 25, " GMT", 4) != 0)
+                {
+                    return false;
+                }
+                return toUnixTime(year, mon, day, hour, min, sec, 0, unixTime);
+            }
+            if (timestampLen > 3 && isAlpha(p[3]))
+            {
+                // RFC 850: full weekday name
+                int yy;
+                if (!readFullWeekday(p, timestampLen, i) || i == timestampLen || p[i] != ',' || ++i == timestampLen || p[i++] != ' ' ||
+                    !readDigitRun(p, timestampLen, i, 2, 2, day) || i == timestampLen || p[i++] != '-' ||
+                    !readMonth(p, timestampLen, i, mon) || i == timestampLen || p[i++] != '-' ||
+                    !readDigitRun(p, timestampLen, i, 2, 2, yy) || i == timestampLen || p[i++] != ' ' ||
+                    !readTime(p, timestampLen, i, false, hour, min, sec) || timestampLen - i != 4 || memcmp(p + i, " GMT", 4) != 0)
+                {
+                    return false;
+                }
+                return toUnixTime(expandTwoDigitYear(yy), mon, day, hour, min, sec, 0, unixTime);
+            }
+            // asctime: "Sun Nov  6 08:49:37 1994"
+            if (!readWeekday(p, timestampLen, i) || i == timestampLen || p[i++] != ' ' ||
+                !readMonth(p, timestampLen, i, mon) || i == timestampLen || p[i++] != ' ')
+            {
+                return false;
+            }
+            if (i < timestampLen && p[i] == ' ')
+            {
+                i++;
+            }
+            if (!readDigitRun(p, timestampLen, i, 1, 2, day) || i == timestampLen || p[i++] != ' ' ||
+                !readTime(p, timestampLen, i, false, hour, min, sec) || i == timestampLen || p[i++] != ' ' ||
+                !readDigitRun(p, timestampLen, i, 4, 4, year) || i != timestampLen)
+            {
+                return false;
+            }
+            return toUnixTime(year, mon, day, hour, min, sec, 0, unixTime);
+        }
+
+        /**
+        * RFC 2822 の文字列を out に書き込み、長さを返す (終端文字は書き込まない)。 \n
+        * Write an RFC 2822 timestamp to out and return the length. (No terminating null)
+        * @param[out] out buffer of at least RFC2822_BUFFER_SIZE bytes
+        * @param[in] utcOffset seconds east of UTC
+        * @details ex: "Mon, 08 Mar 2021 09:00:15 +0900"
+        */
+        inline size_t writeRfc2822(char *out, const long long &unixTime, const long long &utcOffset = 0)
+        {
+            Metrics::increment(Metrics::FORMAT_CALLS);
+            size_t len = Detail::writeDayDateTime(out, unixTime + utcOffset);
+            const long long absOffset = utcOffset < 0 ? -utcOffset : utcOffset;
+            out[len] = ' ';
+            out[len + 1] = utcOffset < 0 ? '-' : '+';
+            Detail::write2(out + len + 2, int(absOffset / 3600));
+            Detail::write2(out + len + 4, int(absOffset % 3600 / 60));
+            return len + 6;
+        }
+
+        /**
+        * RFC 2822 の文字列を解析する。例外を投げず、ヒープ確保も行わない。 \n
+        * Parse an RFC 2822 timestamp. No throw, no allocation.
+        * @details ex: "Mon, 08 Mar 2021 09:00:15 +0900", "8 Mar 2021 00:00 GMT" \n
+        * The weekday and the seconds are optional. Zones: +hhmm, -hhmm, UT, GMT, Z and the US zones (EST, EDT, CST, CDT, MST, MDT, PST, PDT).
+        * 2-digit years are 19xx if >= 50, else 20xx. Comments are not supported. The weekday name is not checked against the date.
+        */
+        inline bool parseRfc2822(const char *timestamp, const size_t &timestampLen, long long &unixTime)
+        {
+            using namespace Detail;
+            Metrics::increment(Metrics::PARSE_CALLS);
+            Metrics::increment(Metrics::PARSE_FAST_PATH);
+
+            const char *p = timestamp;
+            size_t i = 0;
+            skipSpaces(p, timestampLen, i);
+            if (i < timestampLen && isAlpha(p[i]))
+            {
+                if (!readWeekday(p, timestampLen, i) || i == timestampLen || p[i++] != ',')
+                {
+                    return false;
+                }
+                skipSpaces(p, timestampLen, i);
+            }
+            int day, mon, year, hour, min, sec;
+            if (!readDigitRun(p, timestampLen, i, 1, 2, day) || skipSpaces(p, timestampLen, i) == 0 ||
+                !readMonth(p, timestampLen, i, mon) || skipSpaces(p, timestampLen, i) == 0)
+            {
+                return false;
+            }
+            const size_t yearStart = i;
+            if (!readDigitRun(p, timestampLen, i, 2, 9, year) || i - yearStart == 3)
+            {
+                return false;
+            }
+            if (i - yearStart == 2)
+            {
+                year += (year >= 50) ? 1900 : 2000;
+            }
+            if (skipSpaces(p, timestampLen, i) == 0 || !readTime(p, timestampLen, i, true, hour, min, sec) ||
+                skipSpaces(p, timestampLen, i) == 0 || i == timestampLen)
+            {
+                return false;
+            }
+
+            long long offset = 0;
+            if (p[i] == '+' || p[i] == '-')
+            {
+                int hhmm;
+                const int sign = (p[i] == '-') ? -1 : 1;
+                i++;
+                if (timestampLen - i < 4 || !readDigits(p + i, 4, hhmm) || hhmm / 100 > 23 || hhmm % 100 > 59)
+                {
+                    return false;
+                }
+                offset = sign * (hhmm / 100 * 3600LL + hhmm % 100 * 60LL);
+                i += 4;
+            }
+            else
+            {
+                const size_t start = i;
+                while (i < timestampLen && isAlpha(p[i]))
+                {
+                    i++;
+                }
+                const size_t len = i - start;
+                static const char *const ZONES[] = {"EST", "EDT", "CST", "CDT", "MST", "MDT", "PST", "PDT"};
+                static const int ZONE_HOURS[] = {-5, -4, -6, -5, -7, -6, -8, -7};
+                bool found = (len == 1 && (p[start] | 0x20) == 'z') ||
+                             (len == 2 && (p[start] | 0x20) == 'u' && (p[start + 1] | 0x20) == 't') ||
+                             (len == 3 && MyParser::packLower(p + start) == MyParser::packLower("gmt"));
+                for (int z = 0; z < 8 && !found && len == 3; z++)
+                {
+                    if (MyParser::packLower(p + start) == MyParser::packLower(ZONES[z]))
+                    {
+                        offset = ZONE_HOURS[z] * 3600LL;
+                        found = true;
+                    }
+                }
+                if (!found)
+                {
+                    return false;
+                }
+            }
+            skipSpaces(p, timestampLen, i);
+            if (i != timestampLen)
+            {
+                return false;
+            }
+            return toUnixTime(year, mon, day, hour, min, sec, offset, unixTime);
+        }
+
+        /**
+        * @brief HTTP-date cache
+        * @details Keep the HTTP-date of the last second, so header generation formats at most once per second.
+        * Not thread-safe: keep one per thread (see httpDateNow()).
+        */
+        class HttpDateCache
+        {
+        public:
+            HttpDateCache() : m_second(LLONG_MIN), m_length(0)
+            {
+                m_buffer[0] = '\0';
+            }
+
+            /**
+            * unixTime の HTTP-date を返す (終端文字あり)。秒が変わった時だけ書き直す。 \n
+            * Return the HTTP-date of unixTime (null terminated). Formatted only when the second changes.
+            */
+            const char *get(const long long &unixTime, size_t &length)
+            {
+                if (unixTime != m_second)
+                {
+                    Metrics::increment(Metrics::FORMAT_CACHE_MISSES);
+                    m_length = writeHttpDate(m_buffer, unixTime);
+                    m_buffer[m_length] = '\0';
+                    m_second = unixTime;
+                }
+                else
+                {
+                    Metrics::increment(Metrics::FORMAT_CACHE_HITS);
+                }
+                length = m_length;
+                return m_buffer;
+            }
+
+        private:
+            long long m_second;
+            size_t m_length;
+            char m_buffer[HTTP_DATE_BUFFER_SIZE + 1];
+        };
+
+        /**
+        * 時計 clock の現在時刻の HTTP-date を返す (終端文字あり)。スレッドごとのキャッシュを使う。 \n
+        * Return the HTTP-date of the current time of the clock (null terminated) from the cache of the calling thread.
+        * @details ex: response.setHeader("Date", EZ::FixedFormat::httpDateNow(coarseClock, length)); \n
+        * Without a clock, EZ::SystemClock is used.
+        */
+        template <class Clock>
+        inline const char *httpDateNow(const Clock &clock, size_t &length)
+        {
+            static thread_local HttpDateCache cache;
+            return cache.get(clock.now(), length);
+        }
+        inline const char *httpDateNow(size_t &length)
+        {
+            return httpDateNow(SystemClock(), length);
+        }
+    }
+}
+#endif
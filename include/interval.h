@@ -0,0 +1,431 @@
+#ifndef _MY_INTERVAL_
+#define _MY_INTERVAL_
+
+#include <stddef.h>
+#include <climits>
+#include <vector>
+#include <ostream>
+#include <algorithm>
+
+#include "datetime.h"
+#include "time_delta.h"
+#include "datetime_sort.h"
+#include "datetime_exceptions.h"
+
+// 時間区間 (両端の開閉を指定できる) と、区間の集合の重なりの検索 (区間木)、整列済みの区間列の和・積・併合。
+// 仕様: 比較は端点を2倍した整数で行う。閉じた始点 s => 2s、開いた始点 => 2s+1、開いた終点 e => 2e、閉じた終点 => 2e+1 として半開区間 [lo, hi) にする。
+// こうすると [1, 2] と (2, 3) は隣接 (併合できる) し、[1, 2] と [3, 4] の間には隙間が残る。
+
+namespace EZ
+{
+    /**
+    * @brief Interval of time
+    * @details Interval between two Datetimes whose ends are open or closed. [start, end) by default. \n
+    * ex: \n
+    * EZ::Interval shift(EZ::Datetime(2021, 3, 8, 9, 0, 0), EZ::Datetime(2021, 3, 8, 17, 0, 0)); // [09:00, 17:00)
+    */
+    class Interval
+    {
+    public:
+        /**
+        * 両端の開閉 \n
+        * Open or closed ends.
+        */
+        enum Bounds
+        {
+            CLOSED_OPEN, // [start, end)
+            CLOSED,      // [start, end]
+            OPEN,        // (start, end)
+            OPEN_CLOSED, // (start, end]
+        };
+
+        /**
+        * 終点が始点より前なら DatetimeException を投げる \n
+        * Throw DatetimeException if end is before start.
+        */
+        Interval(const Datetime &start, const Datetime &end, const Bounds &bounds = CLOSED_OPEN)
+            : m_start(start), m_end(end), m_isStartClosed(bounds == CLOSED_OPEN || bounds == CLOSED),
+              m_isEndClosed(bounds == CLOSED || bounds == OPEN_CLOSED)
+        {
+            if (end < start)
+            {
+                throw DatetimeException("ERROR: The end of the interval is before the start.");
+            }
+        }
+
+        const Datetime &start() const
+        {
+            return m_start;
+        }
+        const Datetime &end() const
+        {
+            return m_end;
+        }
+        bool isStartClosed() const
+        {
+            return m_isStartClosed;
+        }
+        bool isEndClosed() const
+        {
+            return m_isEndClosed;
+        }
+        /**
+        * 長さ (終点 - 始点) \n
+        * Length of the interval: end - start.
+        */
+        TimeDelta duration() const
+        {
+            return m_end - m_start;
+        }
+        /**
+        * 時刻を含まなければ true (ex: [t, t), (t, t)) \n
+        * true if the interval contains no time. ex: [t, t), (t, t)
+        */
+        bool empty() const
+        {
+            return lowerKey() >= upperKey();
+        }
+        /**
+        * 時刻を含めば true \n
+        * true if the time is in the interval.
+        */
+        bool contains(const Datetime &time) const
+        {
+            const long long key = 2 * time.unixTime();
+            return lowerKey() <= key && key < upperKey();
+        }
+        /**
+        * 共通の時刻があれば true \n
+        * true if the intervals have a time in common.
+        */
+        bool overlaps(const Interval &other) const
+        {
+            return lowerKey() < other.upperKey() && other.lowerKey() < upperKey() && !empty() && !other.empty();
+        }
+
+        /**
+        * 始点を2倍した整数 (閉じていれば 2s、開いていれば 2s+1)。区間は [lowerKey(), upperKey()) \n
+        * Doubled start: 2s if closed, 2s+1 if open. The interval is [lowerKey(), upperKey()) on doubled times.
+        */
+        long long lowerKey() const
+        {
+            return 2 * m_start.unixTime() + (m_isStartClosed ? 0 : 1);
+        }
+        /**
+        * 終点を2倍した整数 (閉じていれば 2e+1、開いていれば 2e) \n
+        * Doubled end: 2e+1 if closed, 2e if open.
+        */
+        long long upperKey() const
+        {
+            return 2 * m_end.unixTime() + (m_isEndClosed ? 1 : 0);
+        }
+
+    private:
+        Datetime m_start;
+        Datetime m_end;
+        bool m_isStartClosed;
+        bool m_isEndClosed;
+    };
+
+    /**
+    * 両端と開閉が等しければ true (タイムゾーンの設定は問わない) \n
+    * true if the ends and their bounds are equal. (Timezone settings do not matter)
+    */
+    inline bool operator==(const Interval &left, const Interval &right)
+    {
+        return left.lowerKey() == right.lowerKey() && left.upperKey() == right.upperKey();
+    }
+    inline bool operator!=(const Interval &left, const Interval &right)
+    {
+        return !(left == right);
+    }
+    inline std::ostream &operator<<(std::ostream &stream, const Interval &interval)
+    {
+        stream << (interval.isStartClosed() ? "[" : "(") << interval.start() << ", " << interval.end() << (interval.isEndClosed() ? "]" : ")");
+        return stream;
+    }
+
+    /**
+    * first の始点から last の終点までの区間 \n
+    * Interval from the start of first to the end of last.
+    */
+    inline Interval joinEnds(const Interval &first, const Interval &last)
+    {
+        const Interval::Bounds bounds = first.isStartClosed() ? (last.isEndClosed() ? Interval::CLOSED : Interval::CLOSED_OPEN)
+                                                              : (last.isEndClosed() ? Interval::OPEN_CLOSED : Interval::OPEN);
+        return Interval(first.start(), last.end(), bounds);
+    }
+
+    namespace Detail
+    {
+        inline bool startsBefore(const Interval &a, const Interval &b)
+        {
+            return a.lowerKey() < b.lowerKey();
+        }
+
+        inline void checkSorted(const std::vector<Interval> &intervals)
+        {
+            for (size_t i = 1; i < intervals.size(); i++)
+            {
+                if (startsBefore(intervals[i], intervals[i - 1]))
+                {
+                    throw DatetimeException("ERROR: The intervals are not sorted by their starts.");
+                }
+            }
+        }
+
+        // Append the interval to the coalesced list, joining it with the last one if they overlap or touch.
+        inline void appendCoalesced(std::vector<Interval> &result, const Interval &interval)
+        {
+            if (interval.empty())
+            {
+                return;
+            }
+            if (!result.empty() && interval.lowerKey() <= result.back().upperKey())
+            {
+                if (interval.upperKey() > result.back().upperKey())
+                {
+                    result.back() = joinEnds(result.back(), interval);
+                }
+                return;
+            }
+            result.push_back(interval);
+        }
+    }
+
+    /**
+    * 始点の順に並んだ区間列を、重なる・接する区間をまとめた互いに素な区間列にする (O(n)) \n
+    * Coalesce intervals sorted by their starts into disjoint intervals, joining overlapping or touching ones. O(n)
+    * @details Empty intervals are removed. Throw DatetimeException if the intervals are not sorted. \n
+    * ex: [1:00, 2:00), [1:30, 3:00), (3:00, 4:00) => [1:00, 3:00), (3:00, 4:00)
+    */
+    inline std::vector<Interval> coalesce(const std::vector<Interval> &sorted)
+    {
+        Detail::checkSorted(sorted);
+        std::vector<Interval> result;
+        for (const auto &interval : sorted)
+        {
+            Detail::appendCoalesced(result, interval);
+        }
+        return result;
+    }
+
+    /**
+    * 始点の順に並んだ2つの区間列の和 (互いに素な区間列、O(n + m)) \n
+    * Union of two interval lists sorted by their starts, as disjoint intervals. O(n + m)
+    */
+    inline std::vector<Interval> unionOf(const std::vector<Interval> &a, const std::vector<Interval> &b)
+    {
+        Detail::checkSorted(a);
+        Detail::checkSorted(b);
+        std::vector<Interval> result;
+        size_t i = 0, j = 0;
+        while (i < a.size() || j < b.size())
+        {
+            if (j == b.size() || (i < a.size() && !Detail::startsBefore(b[j], a[i])))
+            {
+                Detail::appendCoalesced(result, a[i++]);
+            }
+            else
+            {
+                Detail::appendCoalesced(result, b[j++]);
+            }
+        }
+        return result;
+    }
+
+    /**
+    * 始点の順に並んだ2つの区間列の積 (共通部分の互いに素な区間列、O(n + m)) \n
+    * Intersection of two interval lists sorted by their starts, as disjoint intervals. O(n + m)
+    */
+    inline std::vector<Interval> intersectionOf(const std::vector<Interval> &a, const std::vector<Interval> &b)
+    {
+        const auto left = coalesce(a);
+        const auto right = coalesce(b);
+        std::vector<Interval> result;
+        size_t i = 0, j = 0;
+        while (i < left.size() && j < right.size())
+        {
+            const Interval &x = left[i];
+            const Interval &y = right[j];
+            if (x.overlaps(y))
+            {
+                const Interval &first = Detail::startsBefore(x, y) ? y : x;
+                const Interval &last = x.upperKey() < y.upperKey() ? x : y;
+                result.push_back(joinEnds(first, last));
+            }
+            if (x.upperKey() < y.upperKey())
+            {
+                i++;
+            }
+            else
+            {
+                j++;
+            }
+        }
+        return result;
+    }
+
+    /**
+    * @brief Interval tree
+    * @details Static set of intervals for overlap and stabbing queries in O(log n + k) for k results.
+    * The intervals are sorted by their starts, and each node of the implicit binary tree over the sorted array
+    * (the middle of each range) has the largest end in its subtree. \n
+    * ex: \n
+    * EZ::IntervalTree reservations(intervals); \n
+    * if (!reservations.overlapsAny(request)) { ... }
+    */
+    class IntervalTree
+    {
+    public:
+        /**
+        * 区間をまとめて登録する (O(n log n)、始点の順に並んでいれば O(n)) \n
+        * Build the tree from the intervals. Results of queries are indices of this vector.
+        */
+        IntervalTree(const std::vector<Interval> &intervals) : m_intervals(intervals)
+        {
+            std::vector<long long> lowers;
+            for (size_t i = 0; i < intervals.size(); i++)
+            {
+                // Empty intervals overlap nothing.
+                if (!intervals[i].empty())
+                {
+                    lowers.push_back(intervals[i].lowerKey());
+                    m_order.push_back(i);
+                }
+            }
+            sortByKey(lowers, m_order);
+            m_lowers = lowers;
+            m_uppers.resize(m_order.size());
+            for (size_t i = 0; i < m_order.size(); i++)
+            {
+                m_uppers[i] = intervals[m_order[i]].upperKey();
+            }
+            m_maxUppers.resize(m_order.size());
+            buildMax(0, m_order.size());
+        }
+
+        /**
+        * 区間の数 \n
+        * Number of intervals.
+        */
+        size_t size() const
+        {
+            return m_intervals.size();
+        }
+        const Interval &operator[](const size_t &index) const
+        {
+            return m_intervals[index];
+        }
+
+        /**
+        * query と重なる区間があれば true \n
+        * true if an interval overlaps the query.
+        */
+        bool overlapsAny(const Interval &query) const
+        {
+            if (query.empty())
+            {
+                return false;
+            }
+            return findAny(0, m_order.size(), query.lowerKey(), query.upperKey());
+        }
+        /**
+        * query と重なる区間の添字を indices に追加する (始点の順) \n
+        * Append the indices of the intervals overlapping the query to indices, in the order of their starts.
+        */
+        void overlapping(const Interval &query, std::vector<size_t> &indices) const
+        {
+            if (!query.empty())
+            {
+                collect(0, m_order.size(), query.lowerKey(), query.upperKey(), indices);
+            }
+        }
+        std::vector<size_t> overlapping(const Interval &query) const
+        {
+            std::vector<size_t> indices;
+            overlapping(query, indices);
+            return indices;
+        }
+        /**
+        * 時刻を含む区間の添字を indices に追加する (始点の順) \n
+        * Append the indices of the intervals containing the time to indices, in the order of their starts.
+        */
+        void stabbing(const Datetime &time, std::vector<size_t> &indices) const
+        {
+            const long long key = 2 * time.unixTime();
+            collect(0, m_order.size(), key, key + 1, indices);
+        }
+        std::vector<size_t> stabbing(const Datetime &time) const
+        {
+            std::vector<size_t> indices;
+            stabbing(time, indices);
+            return indices;
+        }
+
+    private:
+        std::vector<Interval> m_intervals;
+        // Non-empty intervals sorted by their starts: indices of m_intervals and their doubled ends.
+        std::vector<size_t> m_order;
+        std::vector<long long> m_lowers;
+        std::vector<long long> m_uppers;
+        // The largest upper key in the subtree whose root is the index (the middle of its range).
+        std::vector<long long> m_maxUppers;
+
+        long long buildMax(const size_t &begin, const size_t &end)
+        {
+            if (begin >= end)
+            {
+                return LLONG_MIN;
+            }
+            const size_t middle = begin + (end - begin) / 2;
+            const long long left = buildMax(begin, middle);
+            const long long right = buildMax(middle + 1, end);
+            m_maxUppers[middle] = std::max(m_uppers[middle], std::max(left, right));
+            return m_maxUppers[middle];
+        }
+
+        bool findAny(const size_t &begin, const size_t &end, const long long &lower, const long long &upper) const
+        {
+            if (begin >= end)
+            {
+                return false;
+            }
+            const size_t middle = begin + (end - begin) / 2;
+            if (m_maxUppers[middle] <= lower)
+            {
+                return false;
+            }
+            if (m_lowers[middle] < upper && lower < m_uppers[middle])
+            {
+                return true;
+            }
+            // Intervals on the right start at or after the middle one.
+            return findAny(begin, middle, lower, upper) ||
+                   (m_lowers[middle] < upper && findAny(middle + 1, end, lower, upper));
+        }
+
+        void collect(const size_t &begin, const size_t &end, const long long &lower, const long long &upper, std::vector<size_t> &indices) const
+        {
+            if (begin >= end)
+            {
+                return;
+            }
+            const size_t middle = begin + (end - begin) / 2;
+            if (m_maxUppers[middle] <= lower)
+            {
+                return;
+            }
+            collect(begin, middle, lower, upper, indices);
+            if (m_lowers[middle] < upper)
+            {
+                if (lower < m_uppers[middle])
+                {
+                    indices.push_back(m_order[middle]);
+                }
+                collect(middle + 1, end, lower, upper, indices);
+            }
+        }
+    };
+}
+#endif
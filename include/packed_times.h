@@ -0,0 +1,432 @@
+#ifndef _MY_PACKED_TIMES_
+#define _MY_PACKED_TIMES_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#if defined(__SSE2__) || (defined(_MSC_VER) && defined(_M_X64))
+#include <emmintrin.h>
+#define EZ_PACKED_TIMES_SSE2
+#endif
+
+#include "datetime.h"
+#include "bit_utils.h"
+#include "datetime_exceptions.h"
+
+// 時刻の列 (Unix秒) の列指向の圧縮 (frame of reference)。128個ごとのブロックに分け、ブロックの最小値と、最小値からの差を固定のビット幅で詰めて持つ。
+// 仕様: 差が32ビットに収まるブロックは、4レーンの縦型の配置 (i 番目の値はレーン i % 4) で32ビット語に詰める。SSE2 で4個ずつ展開する。
+//   差が32ビットを超えるブロックは差を64ビットのまま持つ。範囲 [from, to) の検索はブロックの最小値・最大値で読み飛ばし、差のまま比較する。
+// 列の途中には追加できない (作り直す)。ランダムアクセスは O(1)。
+
+namespace EZ
+{
+    /**
+    * @brief Bit-packed column of unix times (frame of reference)
+    * @details Times are split into blocks of 128. Each block keeps its minimum and the offsets from it, packed in the bits they need.
+    * Blocks are unpacked 4 offsets at a time with SSE2 (if available), and range filters [from, to) run on the packed offsets. \n
+    * ex: \n
+    * EZ::PackedTimes packed(times); \n
+    * size_t count = packed.count(from, to); // rows in [from, to)
+    */
+    class PackedTimes
+    {
+    public:
+        /**
+        * 1ブロックの時刻の数 \n
+        * Number of times in a block.
+        */
+        enum
+        {
+            BLOCK_SIZE = 128
+        };
+
+        PackedTimes() : m_count(0)
+        {
+        }
+        PackedTimes(const long long *times, const size_t &count) : m_count(count)
+        {
+            for (size_t first = 0; first < count; first += BLOCK_SIZE)
+            {
+                pack(times + first, count - first < size_t(BLOCK_SIZE) ? count - first : size_t(BLOCK_SIZE));
+            }
+        }
+        PackedTimes(const std::vector<long long> &times) : PackedTimes(times.data(), times.size())
+        {
+        }
+        /**
+        * Datetime の列 (Unix秒を保存する。タイムゾーンの設定は保存しない) \n
+        * Column of Datetimes. Their unix times are stored, but not their timezone settings.
+        */
+        PackedTimes(const std::vector<Datetime> &times) : PackedTimes(unixTimes(times))
+        {
+        }
+
+        /**
+        * 時刻の数 \n
+        * Number of times.
+        */
+        size_t size() const
+        {
+            return m_count;
+        }
+        /**
+        * ブロックの数 \n
+        * Number of blocks.
+        */
+        size_t numBlocks() const
+        {
+            return m_blocks.size();
+        }
+        /**
+        * ブロックのビット幅 (0 ~ 32, 差が32ビットを超えれば 64) \n
+        * Bits per offset in the block: 0 ~ 32, or 64 if the offsets need more than 32 bits.
+        */
+        int blockWidth(const size_t &block) const
+        {
+            return m_blocks.at(block).width;
+        }
+        /**
+        * 圧縮後の大きさ (ブロックの最小値・最大値を含む) \n
+        * Packed size in bytes, including the minimum and the maximum of each block.
+        */
+        size_t sizeInBytes() const
+        {
+            return m_words.size() * sizeof(uint32_t) + m_blocks.size() * sizeof(Block);
+        }
+        /**
+        * 1個あたりのビット数 \n
+        * Bits per time.
+        */
+        double bitsPerTime() const
+        {
+            return m_count == 0 ? 0.0 : double(sizeInBytes() * 8) / double(m_count);
+        }
+
+        /**
+        * index 番目の時刻 \n
+        * Time at the index.
+        */
+        long long at(const size_t &index) const
+        {
+            if (index >= m_count)
+            {
+                throw DatetimeException("ERROR: The index is out of range.");
+            }
+            const Block &block = m_blocks[index / BLOCK_SIZE];
+            const size_t i = index % BLOCK_SIZE;
+            const uint32_t *words = m_words.data() + block.word;
+            uint64_t offset = 0;
+            if (block.width == 64)
+            {
+                offset = uint64_t(words[i]) | (uint64_t(words[BLOCK_SIZE + i]) << 32);
+            }
+            else if (block.width > 0)
+            {
+                const size_t lane = i % 4;
+                const size_t bit = i / 4 * size_t(block.width);
+                const size_t shift = bit % 32;
+                offset = words[bit / 32 * 4 + lane] >> shift;
+                if (shift + size_t(block.width) > 32)
+                {
+                    offset |= uint64_t(words[(bit / 32 + 1) * 4 + lane]) << (32 - shift);
+                }
+                offset &= mask(block.width);
+            }
+            return (long long)(uint64_t(block.minimum) + offset);
+        }
+
+        /**
+        * ブロックの時刻を復号する (最大 BLOCK_SIZE 個) \n
+        * Decode the times of the block (up to BLOCK_SIZE) into out, and return the number of times.
+        */
+        size_t decodeBlock(const size_t &block, long long *out) const
+        {
+            if (block >= m_blocks.size())
+            {
+                throw DatetimeException("ERROR: The block is out of range.");
+            }
+            const size_t count = blockCount(block);
+            const Block &b = m_blocks[block];
+            const uint64_t minimum = uint64_t(b.minimum);
+            if (b.width == 64)
+            {
+                const uint32_t *words = m_words.data() + b.word;
+                for (size_t i = 0; i < count; i++)
+                {
+                    out[i] = (long long)(minimum + (uint64_t(words[i]) | (uint64_t(words[BLOCK_SIZE + i]) << 32)));
+                }
+                return count;
+            }
+            uint32_t offsets[BLOCK_SIZE];
+            unpack(b, offsets);
+            for (size_t i = 0; i < count; i++)
+            {
+                out[i] = (long long)(minimum + offsets[i]);
+            }
+            return count;
+        }
+        /**
+        * すべての時刻を復号する (out には size() 個の領域が必要) \n
+        * Decode all times into out, which must have size() elements.
+        */
+        void decode(long long *out) const
+        {
+            for (size_t block = 0; block < m_blocks.size(); block++)
+            {
+                out += decodeBlock(block, out);
+            }
+        }
+        std::vector<long long> decode() const
+        {
+            std::vector<long long> times(m_count);
+            decode(times.data());
+            return times;
+        }
+
+        /**
+        * 時刻が [from, to) の行の数 (復号しない) \n
+        * Number of rows whose times are in [from, to), counted on the packed data.
+        */
+        size_t count(const long long &from, const long long &to) const
+        {
+            size_t total = 0;
+            for (size_t block = 0; block < m_blocks.size() && from < to; block++)
+            {
+                const Block &b = m_blocks[block];
+                if (b.maximum < from || b.minimum >= to)
+                {
+                    continue;
+                }
+                if (b.minimum >= from && b.maximum < to)
+                {
+                    total += blockCount(block);
+                    continue;
+                }
+                uint64_t bits[2];
+                match(block, from, to, bits);
+                total += size_t(Bits::popcount(bits[0]) + Bits::popcount(bits[1]));
+            }
+            return total;
+        }
+        size_t count(const Datetime &from, const Datetime &to) const
+        {
+            return count(from.unixTime(), to.unixTime());
+        }
+        /**
+        * 時刻が [from, to) の行を rows に追加する (行の順) \n
+        * Append the rows whose times are in [from, to) to rows, in ascending order.
+        */
+        void filter(const long long &from, const long long &to, std::vector<size_t> &rows) const
+        {
+            for (size_t block = 0; block < m_blocks.size() && from < to; block++)
+            {
+                const Block &b = m_blocks[block];
+                if (b.maximum < from || b.minimum >= to)
+                {
+                    continue;
+                }
+                const size_t first = block * BLOCK_SIZE;
+                if (b.minimum >= from && b.maximum < to)
+                {
+                    for (size_t i = 0; i < blockCount(block); i++)
+                    {
+                        rows.push_back(first + i);
+                    }
+                    continue;
+                }
+                uint64_t bits[2];
+                match(block, from, to, bits);
+                for (size_t half = 0; half < 2; half++)
+                {
+                    for (uint64_t word = bits[half]; word != 0; word &= word - 1)
+                    {
+                        rows.push_back(first + half * 64 + size_t(Bits::countTrailingZeros(word)));
+                    }
+                }
+            }
+        }
+        std::vector<size_t> filter(const long long &from, const long long &to) const
+        {
+            std::vector<size_t> rows;
+            filter(from, to, rows);
+            return rows;
+        }
+        void filter(const Datetime &from, const Datetime &to, std::vector<size_t> &rows) const
+        {
+            filter(from.unixTime(), to.unixTime(), rows);
+        }
+        std::vector<size_t> filter(const Datetime &from, const Datetime &to) const
+        {
+            return filter(from.unixTime(), to.unixTime());
+        }
+
+    private:
+        struct Block
+        {
+            long long minimum;
+            long long maximum;
+            // First word of the block in m_words.
+            size_t word;
+            int width;
+        };
+
+        size_t m_count;
+        std::vector<Block> m_blocks;
+        // Width <= 32: 4 * width words (word m of lane j at m * 4 + j). Width 64: 128 lower halves and then 128 upper halves.
+        std::vector<uint32_t> m_words;
+
+        static std::vector<long long> unixTimes(const std::vector<Datetime> &times)
+        {
+            std::vector<long long> ret;
+            ret.reserve(times.size());
+            for (const auto &time : times)
+            {
+                ret.push_back(time.unixTime());
+            }
+            return ret;
+        }
+
+        static uint32_t mask(const int &width)
+        {
+            return width >= 32 ? ~uint32_t(0) : (uint32_t(1) << width) - 1;
+        }
+
+        size_t blockCount(const size_t &block) const
+        {
+            return (block + 1 < m_blocks.size()) ? size_t(BLOCK_SIZE) : m_count - block * BLOCK_SIZE;
+        }
+
+        void pack(const long long *times, const size_t &count)
+        {
+            Block block = {times[0], times[0], m_words.size(), 0};
+            for (size_t i = 1; i < count; i++)
+            {
+                block.minimum = times[i] < block.minimum ? times[i] : block.minimum;
+                block.maximum = times[i] > block.maximum ? times[i] : block.maximum;
+            }
+            // Wrapping arithmetic: exact for any pair of times. The rest of the last block is padded with the minimum.
+            const uint64_t range = uint64_t(block.maximum) - uint64_t(block.minimum);
+            block.width = Bits::highestBit(range) + 1;
+            if (block.width > 32)
+            {
+                block.width = 64;
+                m_words.resize(m_words.size() + 2 * BLOCK_SIZE, 0);
+                uint32_t *words = m_words.data() + block.word;
+                for (size_t i = 0; i < count; i++)
+                {
+                    const uint64_t offset = uint64_t(times[i]) - uint64_t(block.minimum);
+                    words[i] = uint32_t(offset);
+                    words[BLOCK_SIZE + i] = uint32_t(offset >> 32);
+                }
+            }
+            else if (block.width > 0)
+            {
+                const size_t width = size_t(block.width);
+                m_words.resize(m_words.size() + 4 * width, 0);
+                uint32_t *words = m_words.data() + block.word;
+                for (size_t i = 0; i < count; i++)
+                {
+                    const uint32_t offset = uint32_t(uint64_t(times[i]) - uint64_t(block.minimum));
+                    const size_t lane = i % 4;
+                    const size_t bit = i / 4 * width;
+                    const size_t shift = bit % 32;
+                    words[bit / 32 * 4 + lane] |= offset << shift;
+                    if (shift + width > 32)
+                    {
+                        words[(bit / 32 + 1) * 4 + lane] |= offset >> (32 - shift);
+                    }
+                }
+            }
+            m_blocks.push_back(block);
+        }
+
+        // Unpack the offsets of a block of width <= 32.
+        void unpack(const Block &block, uint32_t *offsets) const
+        {
+            const size_t width = size_t(block.width);
+            const uint32_t *words = m_words.data() + block.word;
+#if defined(EZ_PACKED_TIMES_SSE2)
+            const __m128i bitMask = _mm_set1_epi32(int(mask(block.width)));
+            for (size_t k = 0; k < BLOCK_SIZE / 4; k++)
+            {
+                const size_t bit = k * width;
+                const size_t shift = bit % 32;
+                __m128i v = width == 0 ? _mm_setzero_si128()
+                                       : _mm_srl_epi32(_mm_loadu_si128((const __m128i *)(words + bit / 32 * 4)), _mm_cvtsi32_si128(int(shift)));
+                if (shift + width > 32)
+                {
+                    v = _mm_or_si128(v, _mm_sll_epi32(_mm_loadu_si128((const __m128i *)(words + (bit / 32 + 1) * 4)), _mm_cvtsi32_si128(int(32 - shift))));
+                }
+                _mm_storeu_si128((__m128i *)(offsets + k * 4), _mm_and_si128(v, bitMask));
+            }
+#else
+            const uint32_t bitMask = mask(block.width);
+            for (size_t k = 0; k < BLOCK_SIZE / 4; k++)
+            {
+                const size_t bit = k * width;
+                const size_t shift = bit % 32;
+                for (size_t lane = 0; lane < 4; lane++)
+                {
+                    uint32_t v = width == 0 ? 0 : words[bit / 32 * 4 + lane] >> shift;
+                    if (shift + width > 32)
+                    {
+                        v |= words[(bit / 32 + 1) * 4 + lane] << (32 - shift);
+                    }
+                    offsets[k * 4 + lane] = v & bitMask;
+                }
+            }
+#endif
+        }
+
+        // Bits of the rows of the block in [from, to), where the block overlaps [from, to) but is not inside it.
+        void match(const size_t &block, const long long &from, const long long &to, uint64_t *bits) const
+        {
+            const Block &b = m_blocks[block];
+            bits[0] = 0;
+            bits[1] = 0;
+            if (b.width == 64)
+            {
+                long long times[BLOCK_SIZE];
+                const size_t count = decodeBlock(block, times);
+                for (size_t i = 0; i < count; i++)
+                {
+                    bits[i / 64] |= uint64_t(times[i] >= from && times[i] < to) << (i % 64);
+                }
+                return;
+            }
+            // offset in [low, high) <=> offset - low < high - low (unsigned). Both are in 32 bits, since the block is not inside [from, to).
+            const uint32_t low = from <= b.minimum ? 0 : uint32_t(uint64_t(from) - uint64_t(b.minimum));
+            const uint32_t span = (to > b.maximum ? uint32_t(uint64_t(b.maximum) - uint64_t(b.minimum)) + 1 : uint32_t(uint64_t(to) - uint64_t(b.minimum))) - low;
+            uint32_t offsets[BLOCK_SIZE];
+            unpack(b, offsets);
+#if defined(EZ_PACKED_TIMES_SSE2)
+            const __m128i sign = _mm_set1_epi32(int(0x80000000u));
+            const __m128i lowVector = _mm_set1_epi32(int(low));
+            const __m128i spanVector = _mm_xor_si128(_mm_set1_epi32(int(span)), sign);
+            for (size_t k = 0; k < BLOCK_SIZE / 4; k++)
+            {
+                const __m128i v = _mm_xor_si128(_mm_sub_epi32(_mm_loadu_si128((const __m128i *)(offsets + k * 4)), lowVector), sign);
+                const uint64_t hits = uint64_t(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmplt_epi32(v, spanVector))));
+                bits[k / 16] |= hits << (k % 16 * 4);
+            }
+#else
+            for (size_t i = 0; i < BLOCK_SIZE; i++)
+            {
+                bits[i / 64] |= uint64_t(offsets[i] - low < span) << (i % 64);
+            }
+#endif
+            // Padding of the last block.
+            const size_t count = blockCount(block);
+            if (count < 64)
+            {
+                bits[0] &= (uint64_t(1) << count) - 1;
+                bits[1] = 0;
+            }
+            else if (count < 128)
+            {
+                bits[1] &= (uint64_t(1) << (count - 64)) - 1;
+            }
+        }
+    };
+}
+#endif
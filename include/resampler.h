@@ -0,0 +1,292 @@
+#ifndef _MY_RESAMPLER_
+#define _MY_RESAMPLER_
+
+#include <stddef.h>
+#include <limits>
+#include <vector>
+#include <thread>
+#include <exception>
+
+#include "datetime.h"
+#include "time_delta.h"
+#include "calendar.h"
+#include "datetime_exceptions.h"
+
+// 時系列の集計 (リサンプリング)。ソート済みの時刻列を暦の区間 (バケット) に分け、値の列を区間ごとに集計する。
+// 仕様: 区間の境界は区間が変わるときだけ計算する (1行ごとの比較は1回)。値の集計は区間ごとに列単位で行う。
+
+namespace EZ
+{
+    /**
+    * @brief Time-series resampler
+    * @details Group rows of a sorted timestamp column into calendar buckets and aggregate value columns
+    * (count, sum, min, max, first, last) in a single pass. Only non-empty buckets are returned. \n
+    * ex: \n
+    * EZ::Resampler resampler(EZ::Calendar::MINUTE, 5, true); \n
+    * auto result = resampler.resample(times, {prices, volumes}); \n
+    * for (size_t i = 0; i < result.size(); i++) { result.starts[i], result.counts[i], result.columns[0].max[i], ... }
+    */
+    class Resampler
+    {
+    public:
+        // 並列に集計するとき、1スレッドが受け持つ最小の行数
+        static const size_t MINIMUM_ROWS_PER_THREAD = 8192;
+
+        /**
+        * 値の列1本分の集計結果 (バケットごと) \n
+        * Aggregates of one value column. Each vector has one element per bucket.
+        */
+        struct Column
+        {
+            std::vector<double> sum;
+            std::vector<double> min;
+            std::vector<double> max;
+            std::vector<double> first;
+            std::vector<double> last;
+        };
+
+        /**
+        * 集計結果。starts[i] のバケットに counts[i] 行が入る。 \n
+        * Result of resample(). The bucket starting at starts[i] contains counts[i] rows.
+        */
+        struct Result
+        {
+            std::vector<long long> starts; // Unix seconds at the start of each bucket
+            std::vector<long long> counts;
+            std::vector<Column> columns; // Same order as the value columns
+
+            size_t size() const
+            {
+                return starts.size();
+            }
+        };
+
+        /**
+        * @param[in] unit Calendar::SECOND, MINUTE, HOUR, DAY, WEEK, MONTH or YEAR
+        * @param[in] multiple=1	ex: 5 minutes => (Calendar::MINUTE, 5)
+        * @param[in] isUTC=false	if true, buckets are on the UTC calendar.\n if false, on the local calendar (ex: local days).
+        */
+        Resampler(const Calendar::Unit &unit, const long long &multiple = 1, const bool &isUTC = false)
+            : m_unit(unit), m_multiple(multiple), m_isUTC(isUTC)
+        {
+            Calendar::Detail::checkUnit(unit, multiple);
+        }
+
+        /**
+        * 固定幅のバケット (1970/1/1 00:00:00 起点) \n
+        * Buckets of a fixed width, aligned to 1970/1/1 00:00:00.
+        * @param[in] width ex: EZ::TimeDelta(0, 0, 15, 0) => 15 minutes
+        */
+        Resampler(const TimeDelta &width, const bool &isUTC = false)
+            : Resampler(Calendar::SECOND, width.totalSeconds(), isUTC)
+        {
+        }
+
+        /**
+        * unixTime を含むバケット [start, end) を返す \n
+        * Return the bucket [start, end) containing unixTime.
+        */
+        void bucketOf(const long long &unixTime, long long &start, long long &end) const
+        {
+            if (m_isUTC)
+            {
+                Calendar::Detail::unitBounds(unixTime, m_unit, m_multiple, 0, start, end);
+                return;
+            }
+            try
+            {
+                // Zone-aware boundaries. (ex: a local day is 23 or 25 hours on a summer time change)
+                const Datetime time(time_t(unixTime), false);
+                start = time.floor(m_unit, m_multiple).unixTime();
+                end = Datetime(time_t(start + 1), false).ceil(m_unit, m_multiple).unixTime();
+            }
+            catch (const DatetimeException &)
+            {
+                // Beyond the range of Datetime.
+                start = end = unixTime;
+            }
+            if (start > unixTime || end <= unixTime)
+            {
+                // Boundaries skipped or repeated by summer time. Use the offset of unixTime.
+                const long long utcOffset = MyTM::utcOffsetOf(MyTM::my_mkStructTm(time_t(unixTime), false));
+                Calendar::Detail::unitBounds(unixTime, m_unit, m_multiple, utcOffset, start, end);
+            }
+        }
+
+        /**
+        * ソート済みの時刻列と値の列を集計する \n
+        * Aggregate value columns by the buckets of a sorted timestamp column.
+        * @param[in] unixTimes timestamps in ascending order (unix seconds)
+        * @param[in] count number of rows
+        * @param[in] columns value columns, each of count elements
+        * @param[in] numThreads=1	rows are split into numThreads ranges and aggregated in parallel.
+        * (at least MINIMUM_ROWS_PER_THREAD rows per thread)
+        * @details Throw DatetimeException if the timestamps are not sorted or out of range.
+        */
+        Result resample(const long long *unixTimes, const size_t &count, const std::vector<const double *> &columns,
+                        const size_t &numThreads = 1) const
+        {
+            validate(unixTimes, count);
+            // Small ranges do not pay for starting a thread.
+            size_t numRanges = count / MINIMUM_ROWS_PER_THREAD;
+            numRanges = numThreads < numRanges ? numThreads : numRanges;
+            numRanges = numRanges > 1 ? numRanges : 1;
+            if (numRanges == 1)
+            {
+                Result result;
+                aggregate(unixTimes, columns, 0, count, result);
+                return result;
+            }
+
+            std::vector<Result> partials(numRanges);
+            std::vector<std::exception_ptr> errors(numRanges);
+            std::vector<std::thread> threads;
+            threads.reserve(numRanges);
+            for (size_t i = 0; i < numRanges; i++)
+            {
+                threads.emplace_back([&, i]() {
+                    try
+                    {
+                        aggregate(unixTimes, columns, count * i / numRanges, count * (i + 1) / numRanges, partials[i]);
+                    }
+                    catch (...)
+                    {
+                        errors[i] = std::current_exception();
+                    }
+                });
+            }
+            for (auto &thread : threads)
+            {
+                thread.join();
+            }
+            for (const auto &error : errors)
+            {
+                if (error)
+                {
+                    std::rethrow_exception(error);
+                }
+            }
+            return merge(partials, columns.size());
+        }
+
+        Result resample(const std::vector<long long> &unixTimes, const std::vector<std::vector<double>> &columns,
+                        const size_t &numThreads = 1) const
+        {
+            std::vector<const double *> pointers;
+            for (const auto &column : columns)
+            {
+                if (column.size() != unixTimes.size())
+                {
+                    throw DatetimeException("ERROR: The value column and the timestamp column have different sizes.");
+                }
+                pointers.push_back(column.data());
+            }
+            return resample(unixTimes.data(), unixTimes.size(), pointers, numThreads);
+        }
+
+    private:
+        Calendar::Unit m_unit;
+        long long m_multiple;
+        bool m_isUTC;
+
+        static void validate(const long long *unixTimes, const size_t &count)
+        {
+            if (count == 0)
+            {
+                return;
+            }
+            size_t unsorted = 0;
+            for (size_t i = 1; i < count; i++)
+            {
+                unsorted += (unixTimes[i] < unixTimes[i - 1]);
+            }
+            if (unsorted > 0)
+            {
+                throw DatetimeException("ERROR: The timestamps must be sorted in ascending order.");
+            }
+            if (unixTimes[0] < DatetimeConstants::MINIMUM_SEC || unixTimes[count - 1] > DatetimeConstants::MAXIMUM_SEC)
+            {
+                throw DatetimeException("ERROR: The timestamps are out of range.");
+            }
+        }
+
+        // 行 [begin, end) を集計して result に追加する
+        void aggregate(const long long *unixTimes, const std::vector<const double *> &columns,
+                       const size_t &begin, const size_t &end, Result &result) const
+        {
+            result.columns.resize(columns.size());
+            size_t row = begin;
+            while (row < end)
+            {
+                long long start, upper;
+                bucketOf(unixTimes[row], start, upper);
+                size_t last = row + 1;
+                while (last < end && unixTimes[last] < upper)
+                {
+                    last++;
+                }
+                result.starts.push_back(start);
+                result.counts.push_back((long long)(last - row));
+                for (size_t c = 0; c < columns.size(); c++)
+                {
+                    const double *values = columns[c];
+                    double sum = 0;
+                    double minimum = values[row];
+                    double maximum = values[row];
+                    for (size_t i = row; i < last; i++)
+                    {
+                        sum += values[i];
+                        minimum = values[i] < minimum ? values[i] : minimum;
+                        maximum = values[i] > maximum ? values[i] : maximum;
+                    }
+                    Column &column = result.columns[c];
+                    column.sum.push_back(sum);
+                    column.min.push_back(minimum);
+                    column.max.push_back(maximum);
+                    column.first.push_back(values[row]);
+                    column.last.push_back(values[last - 1]);
+                }
+                row = last;
+            }
+        }
+
+        // 並列に集計した結果をつなげる。範囲の境目で分かれたバケットは1つにまとめる。
+        static Result merge(const std::vector<Result> &partials, const size_t &numColumns)
+        {
+            Result result;
+            result.columns.resize(numColumns);
+            for (const auto &partial : partials)
+            {
+                size_t i = 0;
+                if (partial.size() > 0 && result.size() > 0 && partial.starts[0] == result.starts.back())
+                {
+                    result.counts.back() += partial.counts[0];
+                    for (size_t c = 0; c < numColumns; c++)
+                    {
+                        Column &column = result.columns[c];
+                        const Column &other = partial.columns[c];
+                        column.sum.back() += other.sum[0];
+                        column.min.back() = other.min[0] < column.min.back() ? other.min[0] : column.min.back();
+                        column.max.back() = other.max[0] > column.max.back() ? other.max[0] : column.max.back();
+                        column.last.back() = other.last[0];
+                    }
+                    i = 1;
+                }
+                result.starts.insert(result.starts.end(), partial.starts.begin() + i, partial.starts.end());
+                result.counts.insert(result.counts.end(), partial.counts.begin() + i, partial.counts.end());
+                for (size_t c = 0; c < numColumns; c++)
+                {
+                    Column &column = result.columns[c];
+                    const Column &other = partial.columns[c];
+                    column.sum.insert(column.sum.end(), other.sum.begin() + i, other.sum.end());
+                    column.min.insert(column.min.end(), other.min.begin() + i, other.min.end());
+                    column.max.insert(column.max.end(), other.max.begin() + i, other.max.end());
+                    column.first.insert(column.first.end(), other.first.begin() + i, other.first.end());
+                    column.last.insert(column.last.end(), other.last.begin() + i, other.last.end());
+                }
+            }
+            return result;
+        }
+    };
+}
+#endif
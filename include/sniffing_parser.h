@@ -0,0 +1,212 @@
+#ifndef _MY_SNIFFING_PARSER_
+#define _MY_SNIFFING_PARSER_
+
+#include <string>
+
+#include "datetime.h"
+#include "datetime_format.h"
+#include "datetime_exceptions.h"
+
+// 書式を自動判定するパーサ。最初のレコードで書式を推定し、以降はコンパイル済みの書式で解析する。
+// 書式が一致しなくなった場合 (入力の切り替わり) のみ再推定する。
+// 仕様: 日と月のどちらが先か分からない日付 (03/08/2021) は、どちらかに決まるレコード (03/13/2021) が来るまで日が先と仮定する。
+// 決まった順序は再推定後も使う。それまでの結果は誤りの可能性があるので、ambiguousRecords() で数を返す。
+
+namespace EZ
+{
+    /**
+    * @brief Format sniffing parser
+    * @details Detect the format from the first record and parse the following records with the compiled format.
+    * The format is detected again only when a record does not match it. \n
+    * The order of day and month stays undecided while dates such as 03/08/2021 can be read either way.
+    * Day-first is assumed until a record decides it (ex: 13/03/2021 or 03/13/2021), and the decided order is kept
+    * when the format is detected again. Results parsed before that may be wrong: see ambiguousRecords(),
+    * or call sample() with the first records before parsing. \n
+    * ex: \n
+    * EZ::SniffingParser parser(true); \n
+    * for (const auto &line : lines) { auto time = parser.parse(line); }
+    */
+    class SniffingParser
+    {
+    public:
+        /**
+        * 日と月の順序 \n
+        * Order of day and month in numeric dates.
+        */
+        enum Order
+        {
+            UNDECIDED,   // no record has decided it (ambiguous records are parsed day-first)
+            DAY_FIRST,   // ex: 13/03/2021
+            MONTH_FIRST, // ex: 03/13/2021
+        };
+
+        /**
+        * @param[in] isUTC=false	if true, UTC is set to timezone.\n if false, local time is applied.
+        */
+        SniffingParser(const bool &isUTC = false) : m_isUTC(isUTC), m_redetections(0), m_ambiguousRecords(0), m_order(UNDECIDED)
+        {
+        }
+
+        /**
+        * 文字列を解析する。書式を推定できなければ DatetimeException を投げる。 \n
+        * Parse the timestamp. Throw DatetimeException if the format can not be detected.
+        */
+        Datetime parse(const std::string &timestamp)
+        {
+            long long unixTime;
+            if (!tryParse(timestamp, unixTime))
+            {
+                throw DatetimeException("ERROR: Could not detect the format of \"" + timestamp + "\".");
+            }
+            return Datetime(time_t(unixTime), m_isUTC);
+        }
+
+        /**
+        * 文字列を解析してUnix秒を返す。解析できなければ false を返す (例外を投げない)。 \n
+        * Parse the timestamp to unix seconds. Return false if it can not be parsed. No throw.
+        */
+        bool tryParse(const std::string &timestamp, long long &unixTime)
+        {
+            long long swapped;
+            if (m_format.tryParse(timestamp, m_isUTC, unixTime))
+            {
+                if (m_swapped.valid() && !m_swapped.tryParse(timestamp, m_isUTC, swapped))
+                {
+                    decide(m_format);
+                }
+                else if (m_swapped.valid() && swapped != unixTime)
+                {
+                    m_ambiguousRecords++;
+                }
+                return true;
+            }
+            if (m_swapped.tryParse(timestamp, m_isUTC, unixTime))
+            {
+                // The record shows the month first.
+                m_redetections++;
+                m_format = m_swapped;
+                decide(m_format);
+                return true;
+            }
+            CompiledFormat detected;
+            if (!detectFormat(timestamp, detected) || !detected.tryParse(timestamp, m_isUTC, unixTime))
+            {
+                return false;
+            }
+            if (m_format.valid())
+            {
+                m_redetections++;
+            }
+            const CompiledFormat other = swapDayAndMonth(detected);
+            if (!other.valid() || !other.tryParse(timestamp, m_isUTC, swapped))
+            {
+                m_format = detected;
+                decide(m_format);
+                return true;
+            }
+            // detectFormat() reads ambiguous dates day-first.
+            if (m_order == MONTH_FIRST)
+            {
+                m_format = other;
+                unixTime = swapped;
+                return true;
+            }
+            m_format = detected;
+            if (m_order == UNDECIDED)
+            {
+                m_swapped = other;
+                m_ambiguousRecords += (swapped != unixTime) ? 1 : 0;
+            }
+            return true;
+        }
+
+        /**
+        * 最初のレコードで書式と日・月の順序を推定する (結果は捨てる)。順序が決まった時点で止める。 \n
+        * Detect the format and the order of day and month from the first records (ex: the first lines of a file)
+        * before parsing, discarding the results. Stop when the order is decided.
+        */
+        template <class Iterator>
+        void sample(Iterator first, const Iterator &last)
+        {
+            long long unixTime;
+            for (; first != last && m_order == UNDECIDED; ++first)
+            {
+                tryParse(*first, unixTime);
+            }
+            m_ambiguousRecords = 0;
+        }
+
+        /**
+        * 現在の書式を返す。まだ推定していなければ無効な書式を返す。 \n
+        * Return the current format. Invalid if no record has been parsed yet.
+        */
+        const CompiledFormat &format() const
+        {
+            return m_format;
+        }
+
+        /**
+        * 書式を再推定した回数 \n
+        * Number of times the format was detected again after the first detection.
+        */
+        long long redetections() const
+        {
+            return m_redetections;
+        }
+
+        /**
+        * 日と月の順序 \n
+        * Order of day and month decided so far.
+        */
+        Order order() const
+        {
+            return m_order;
+        }
+
+        /**
+        * 順序が決まる前に日が先として解析した、どちらとも読めるレコードの数 \n
+        * Number of records that read differently either way and were parsed day-first while the order was undecided.
+        * @details If order() becomes MONTH_FIRST later, the results of those records were wrong and should be parsed again.
+        */
+        long long ambiguousRecords() const
+        {
+            return m_ambiguousRecords;
+        }
+
+    private:
+        bool m_isUTC;
+        long long m_redetections;
+        long long m_ambiguousRecords;
+        Order m_order;
+        CompiledFormat m_format;
+        CompiledFormat m_swapped; // m_format with day and month swapped, while the order is undecided
+
+        void decide(const CompiledFormat &format)
+        {
+            const std::string &text = format.format();
+            const size_t day = text.find("%d");
+            const size_t month = text.find("%m");
+            if (day != std::string::npos && month != std::string::npos)
+            {
+                m_order = (day < month) ? DAY_FIRST : MONTH_FIRST;
+            }
+            m_swapped = CompiledFormat();
+        }
+
+        // The format with %d and %m swapped, or an invalid format if it does not have both.
+        static CompiledFormat swapDayAndMonth(const CompiledFormat &format)
+        {
+            std::string text = format.format();
+            const size_t day = text.find("%d");
+            const size_t month = text.find("%m");
+            if (!format.valid() || format.kind() != CompiledFormat::PATTERN || day == std::string::npos || month == std::string::npos)
+            {
+                return CompiledFormat();
+            }
+            text[day + 1] = 'm';
+            text[month + 1] = 'd';
+            return CompiledFormat::compile(text);
+        }
+    };
+}
+#endif
@@ -0,0 +1,337 @@
+#ifndef _MY_STREAM_MERGER_
+#define _MY_STREAM_MERGER_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <limits.h>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <utility>
+
+#include "datetime.h"
+#include "datetime_sort.h"
+#include "datetime_exceptions.h"
+
+// 時刻順のレコード列 (ex: ホストごとのログ) を1本の時刻順の列に併合する。敗者木 (loser tree) で k 本の先頭を比較する。
+// 仕様: 各列から1件ずつ取り出しながら併合するので、保持するのは列ごとの先頭と並べ替え窓の中のレコードだけ。
+// 並べ替え窓 (window 秒) を指定すると、各列で window 秒以内の遅れ (順序の乱れ) を並べ直す。それより遅れたレコードは LatePolicy に従う。
+
+namespace EZ
+{
+    /**
+    * @brief K-way merger of time-ordered record streams
+    * @details Source is a callable bool(Record &) which sets the next record of the stream and returns true, or returns false at the end.
+    * Records of equal times are output in the order of the sources, then in the order of each source. \n
+    * ex: \n
+    * EZ::StreamMerger<EZ::Datetime> merger({EZ::rangeSource(a.begin(), a.end()), EZ::rangeSource(b.begin(), b.end())}); \n
+    * EZ::Datetime time; \n
+    * while (merger.next(time)) { ... }
+    */
+    template <class Record, class Source = std::function<bool(Record &)>>
+    class StreamMerger
+    {
+    public:
+        /**
+        * 並べ替え窓より遅れたレコード (その列で既に出力した時刻より前のレコード) の扱い \n
+        * What to do with a record later than the reorder window (earlier than a record already output from its source).
+        */
+        enum LatePolicy
+        {
+            EMIT,  // output it at once (out of order)
+            DROP,  // skip it (counted by numLate())
+            THROW, // throw DatetimeException
+        };
+
+        /**
+        * @param[in] sources	streams of records ordered by time
+        * @param[in] keyOf	time (ex: unix seconds) of a record. Called once per record.
+        * @param[in] window=0	each source may be out of order by up to window (in the unit of keyOf)
+        * @param[in] policy=THROW	what to do with records later than the window
+        */
+        StreamMerger(std::vector<Source> sources, std::function<long long(const Record &)> keyOf,
+                     const long long &window = 0, const LatePolicy &policy = THROW)
+            : m_keyOf(std::move(keyOf)), m_window(window), m_policy(policy), m_numLate(0)
+        {
+            if (window < 0)
+            {
+                throw DatetimeException("ERROR: The reorder window must not be negative.");
+            }
+            m_cursors.resize(sources.size());
+            for (size_t s = 0; s < sources.size(); s++)
+            {
+                m_cursors[s].source = std::move(sources[s]);
+            }
+            build();
+        }
+        /**
+        * Datetime または Unix秒 (long long) の列の併合 \n
+        * Merger of streams of Datetimes or unix seconds (long long).
+        */
+        StreamMerger(std::vector<Source> sources, const long long &window = 0, const LatePolicy &policy = THROW)
+            : StreamMerger(std::move(sources), [](const Record &record) { return Detail::keyOf(record); }, window, policy)
+        {
+        }
+
+        /**
+        * 次のレコード。すべての列が終われば false \n
+        * Set the next record in time order and return true. Return false when all sources have ended.
+        */
+        bool next(Record &record)
+        {
+            if (m_cursors.empty())
+            {
+                return false;
+            }
+            const size_t winner = m_tree[0];
+            if (!live(winner))
+            {
+                return false;
+            }
+            record = std::move(m_cursors[winner].head);
+            advance(winner);
+            replay(winner);
+            return true;
+        }
+
+        /**
+        * 列の数 \n
+        * Number of sources.
+        */
+        size_t size() const
+        {
+            return m_cursors.size();
+        }
+        /**
+        * 並べ替え窓より遅れたレコードの数 \n
+        * Number of records later than the reorder window.
+        */
+        size_t numLate() const
+        {
+            return m_numLate;
+        }
+        /**
+        * 保持しているレコードの数 (列ごとの先頭と並べ替え窓の中) \n
+        * Number of records held: heads of the sources and records in the reorder windows.
+        */
+        size_t buffered() const
+        {
+            size_t count = 0;
+            for (size_t s = 0; s < m_cursors.size(); s++)
+            {
+                count += m_cursors[s].buffer.size() + (live(s) ? 1 : 0);
+            }
+            return count;
+        }
+
+    private:
+        struct Entry
+        {
+            long long key;
+            unsigned long long sequence;
+            Record record;
+        };
+        // Time of the head of a source, compared in the loser tree (apart from the cursor for the cache).
+        // An ended source has the largest key and a rank after all sources.
+        struct Head
+        {
+            long long key;
+            size_t rank;
+        };
+        struct Cursor
+        {
+            Source source;
+            bool ended = false; // source returned false
+            Record head{};
+            // Reorder window: a min-heap of records by (key, sequence).
+            std::vector<Entry> buffer;
+            unsigned long long sequence = 0;
+            long long maxKey = 0;       // latest time read
+            bool hasWatermark = false;
+            long long watermark = 0;    // time of the last head
+        };
+
+        std::function<long long(const Record &)> m_keyOf;
+        long long m_window;
+        LatePolicy m_policy;
+        size_t m_numLate;
+        std::vector<Cursor> m_cursors;
+        std::vector<Head> m_heads;
+        // Loser tree: m_tree[0] is the winner (index of the source), m_tree[1 ~ k-1] are the losers of the matches.
+        // Leaves (sources) are the virtual nodes k ~ 2k-1.
+        std::vector<size_t> m_tree;
+
+        static bool laterEntry(const Entry &a, const Entry &b)
+        {
+            return a.key > b.key || (a.key == b.key && a.sequence > b.sequence);
+        }
+
+        bool live(const size_t &s) const
+        {
+            return m_heads[s].rank < m_cursors.size();
+        }
+
+        // true if the head of source a is output before the head of source b. Ended sources are the last.
+        bool before(const size_t &a, const size_t &b) const
+        {
+            const Head &ha = m_heads[a];
+            const Head &hb = m_heads[b];
+            // Without branches: the result is hard to predict.
+            return (ha.key < hb.key) | ((ha.key == hb.key) & (ha.rank < hb.rank));
+        }
+
+        // true if the record is late, and then it is handled by the policy (true is returned only for DROP).
+        bool dropLate(Cursor &cursor, const long long &key)
+        {
+            if (!cursor.hasWatermark || key >= cursor.watermark)
+            {
+                return false;
+            }
+            m_numLate++;
+            if (m_policy == THROW)
+            {
+                throw DatetimeException("ERROR: A record is later than the reorder window.");
+            }
+            return m_policy == DROP;
+        }
+
+        // Set the next head of the source.
+        void advance(const size_t &s)
+        {
+            Cursor &cursor = m_cursors[s];
+            m_heads[s] = {LLONG_MAX, m_cursors.size() + s};
+            if (m_window == 0)
+            {
+                while (!cursor.ended && cursor.source(cursor.head))
+                {
+                    const long long key = m_keyOf(cursor.head);
+                    if (!dropLate(cursor, key))
+                    {
+                        setKey(s, key);
+                        return;
+                    }
+                }
+                cursor.ended = true;
+                return;
+            }
+            // Read until the earliest buffered record is window older than the latest one.
+            while (!cursor.ended && (cursor.buffer.empty() ||
+                                     uint64_t(cursor.maxKey) - uint64_t(cursor.buffer.front().key) < uint64_t(m_window)))
+            {
+                Entry entry;
+                if (!cursor.source(entry.record))
+                {
+                    cursor.ended = true;
+                    break;
+                }
+                entry.key = m_keyOf(entry.record);
+                if (dropLate(cursor, entry.key))
+                {
+                    continue;
+                }
+                if (cursor.hasWatermark && entry.key < cursor.watermark)
+                {
+                    // EMIT: output the late record at once.
+                    setHead(s, std::move(entry.record), entry.key);
+                    return;
+                }
+                entry.sequence = cursor.sequence++;
+                cursor.maxKey = (cursor.buffer.empty() || entry.key > cursor.maxKey) ? entry.key : cursor.maxKey;
+                cursor.buffer.push_back(std::move(entry));
+                std::push_heap(cursor.buffer.begin(), cursor.buffer.end(), laterEntry);
+            }
+            if (cursor.buffer.empty())
+            {
+                return;
+            }
+            std::pop_heap(cursor.buffer.begin(), cursor.buffer.end(), laterEntry);
+            Entry &earliest = cursor.buffer.back();
+            setHead(s, std::move(earliest.record), earliest.key);
+            cursor.buffer.pop_back();
+        }
+
+        void setHead(const size_t &s, Record &&record, const long long &key)
+        {
+            m_cursors[s].head = std::move(record);
+            setKey(s, key);
+        }
+
+        void setKey(const size_t &s, const long long &key)
+        {
+            Cursor &cursor = m_cursors[s];
+            m_heads[s] = {key, s};
+            if (!cursor.hasWatermark || key > cursor.watermark)
+            {
+                cursor.watermark = key;
+                cursor.hasWatermark = true;
+            }
+        }
+
+        // Winner of the subtree of the node, storing the losers.
+        size_t play(const size_t &node)
+        {
+            const size_t k = m_cursors.size();
+            if (node >= k)
+            {
+                return node - k;
+            }
+            const size_t left = play(2 * node);
+            const size_t right = play(2 * node + 1);
+            if (before(right, left))
+            {
+                m_tree[node] = left;
+                return right;
+            }
+            m_tree[node] = right;
+            return left;
+        }
+
+        void build()
+        {
+            m_heads.resize(m_cursors.size());
+            for (size_t s = 0; s < m_cursors.size(); s++)
+            {
+                advance(s);
+            }
+            m_tree.assign(m_cursors.size(), 0);
+            if (m_cursors.size() > 1)
+            {
+                m_tree[0] = play(1);
+            }
+        }
+
+        // Replay the matches from the leaf of the source to the root: O(log k) comparisons.
+        void replay(const size_t &source)
+        {
+            size_t winner = source;
+            for (size_t node = (source + m_cursors.size()) / 2; node > 0; node /= 2)
+            {
+                const size_t loser = m_tree[node];
+                const bool swapped = before(loser, winner);
+                m_tree[node] = swapped ? winner : loser;
+                winner = swapped ? loser : winner;
+            }
+            m_tree[0] = winner;
+        }
+    };
+
+    /**
+    * 範囲 [first, last) から順に取り出す列 (ex: 配列、メモリマップしたレコードの配列、読み込んだチャンク) \n
+    * Source which reads the records in [first, last) in order. (ex: arrays, memory-mapped records, parsed chunks)
+    */
+    template <class Iterator>
+    std::function<bool(typename std::iterator_traits<Iterator>::value_type &)> rangeSource(Iterator first, Iterator last)
+    {
+        return [first, last](typename std::iterator_traits<Iterator>::value_type &record) mutable {
+            if (first == last)
+            {
+                return false;
+            }
+            record = *first;
+            ++first;
+            return true;
+        };
+    }
+}
+#endif
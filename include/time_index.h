@@ -0,0 +1,242 @@
+#ifndef _MY_TIME_INDEX_
+#define _MY_TIME_INDEX_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include <algorithm>
+
+#include "datetime.h"
+#include "datetime_exceptions.h"
+
+// 整列済みの時刻の列 (Unix秒) の索引。時刻の範囲を 2のべき乗の幅のバケットに分け、各バケットの最初の行を持つ (補間探索の表)。
+// 仕様: 検索はバケットを shift で求め、バケット内 (一様なら数行) だけを二分探索する。表は行数の 1/4 程度。
+// 列はコピーしない (ポインタを持つ) ので、索引より長く生存させること。Datetime の列は Unix秒にしてコピーする。
+
+namespace EZ
+{
+    /**
+    * 該当する行がない \n
+    * No row.
+    */
+    const size_t NO_ROW = size_t(-1);
+
+    /**
+    * @brief Index of a sorted timestamp column
+    * @details Lookups of lower bounds, ranges [a, b) and as-of rows (the last row at or before a time).
+    * A lookup finds the bucket of the time by a shift and searches only the rows in the bucket. \n
+    * ex: \n
+    * EZ::TimeIndex index(times); // unix seconds in ascending order \n
+    * size_t row = index.asOf(t); // EZ::NO_ROW if all rows are after t
+    */
+    class TimeIndex
+    {
+    public:
+        /**
+        * @param[in] times	unix seconds in ascending order (not copied: keep them alive while using the index)
+        * @param[in] count	number of rows
+        */
+        TimeIndex(const long long *times, const size_t &count) : m_times(times), m_count(count)
+        {
+            build();
+        }
+        TimeIndex(const std::vector<long long> &times) : TimeIndex(times.data(), times.size())
+        {
+        }
+        /**
+        * Datetime の列 (Unix秒をコピーする) \n
+        * Index of a column of Datetimes. Their unix times are copied.
+        */
+        TimeIndex(const std::vector<Datetime> &times) : m_times(nullptr), m_count(times.size())
+        {
+            m_owned.reserve(times.size());
+            for (const auto &time : times)
+            {
+                m_owned.push_back(time.unixTime());
+            }
+            m_times = m_owned.data();
+            build();
+        }
+        TimeIndex(const TimeIndex &other) : m_owned(other.m_owned), m_times(other.m_owned.empty() ? other.m_times : m_owned.data()),
+                                            m_count(other.m_count), m_minimum(other.m_minimum), m_maximum(other.m_maximum),
+                                            m_shift(other.m_shift), m_starts(other.m_starts)
+        {
+        }
+        TimeIndex &operator=(const TimeIndex &other)
+        {
+            if (this != &other)
+            {
+                m_owned = other.m_owned;
+                m_times = other.m_owned.empty() ? other.m_times : m_owned.data();
+                m_count = other.m_count;
+                m_minimum = other.m_minimum;
+                m_maximum = other.m_maximum;
+                m_shift = other.m_shift;
+                m_starts = other.m_starts;
+            }
+            return *this;
+        }
+
+        /**
+        * 行数 \n
+        * Number of rows.
+        */
+        size_t size() const
+        {
+            return m_count;
+        }
+        /**
+        * 行の時刻 (Unix秒) \n
+        * Unix time of the row.
+        */
+        long long time(const size_t &row) const
+        {
+            if (row >= m_count)
+            {
+                throw DatetimeException("ERROR: The row is out of range.");
+            }
+            return m_times[row];
+        }
+
+        /**
+        * 時刻が unixTime 以上の最初の行 (なければ size()) \n
+        * First row at or after unixTime. size() if there is none.
+        */
+        size_t lowerBound(const long long &unixTime) const
+        {
+            if (m_count == 0 || unixTime <= m_minimum)
+            {
+                return 0;
+            }
+            if (unixTime > m_maximum)
+            {
+                return m_count;
+            }
+            const size_t bucket = bucketOf(unixTime);
+            return size_t(std::lower_bound(m_times + m_starts[bucket], m_times + m_starts[bucket + 1], unixTime) - m_times);
+        }
+        size_t lowerBound(const Datetime &time) const
+        {
+            return lowerBound(time.unixTime());
+        }
+        /**
+        * 時刻が unixTime より後の最初の行 (なければ size()) \n
+        * First row after unixTime. size() if there is none.
+        */
+        size_t upperBound(const long long &unixTime) const
+        {
+            if (m_count == 0 || unixTime < m_minimum)
+            {
+                return 0;
+            }
+            if (unixTime >= m_maximum)
+            {
+                return m_count;
+            }
+            const size_t bucket = bucketOf(unixTime);
+            return size_t(std::upper_bound(m_times + m_starts[bucket], m_times + m_starts[bucket + 1], unixTime) - m_times);
+        }
+        size_t upperBound(const Datetime &time) const
+        {
+            return upperBound(time.unixTime());
+        }
+
+        /**
+        * 時刻が [from, to) の行の範囲 [first, second) \n
+        * Rows [first, second) whose times are in [from, to).
+        */
+        std::pair<size_t, size_t> range(const long long &from, const long long &to) const
+        {
+            const size_t first = lowerBound(from);
+            return {first, to > from ? lowerBound(to) : first};
+        }
+        std::pair<size_t, size_t> range(const Datetime &from, const Datetime &to) const
+        {
+            return range(from.unixTime(), to.unixTime());
+        }
+
+        /**
+        * 時刻が unixTime 以前の最後の行 (as-of 結合)。なければ NO_ROW \n
+        * Last row at or before unixTime (as-of join). NO_ROW if there is none.
+        */
+        size_t asOf(const long long &unixTime) const
+        {
+            return upperBound(unixTime) - 1;
+        }
+        size_t asOf(const Datetime &time) const
+        {
+            return asOf(time.unixTime());
+        }
+        /**
+        * asOf() の一括版 \n
+        * asOf() of each time.
+        */
+        void asOf(const long long *times, const size_t &count, size_t *rows) const
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                rows[i] = asOf(times[i]);
+            }
+        }
+
+    private:
+        // Owned unix times (index of Datetimes).
+        std::vector<long long> m_owned;
+        const long long *m_times;
+        size_t m_count;
+        long long m_minimum = 0;
+        long long m_maximum = 0;
+        // Bucket of a time: (time - minimum) >> shift.
+        int m_shift = 0;
+        // First row of each bucket, and size() at the end.
+        std::vector<size_t> m_starts;
+
+        size_t bucketOf(const long long &unixTime) const
+        {
+            return size_t((uint64_t(unixTime) - uint64_t(m_minimum)) >> m_shift);
+        }
+
+        void build()
+        {
+            for (size_t i = 1; i < m_count; i++)
+            {
+                if (m_times[i] < m_times[i - 1])
+                {
+                    throw DatetimeException("ERROR: The times are not sorted.");
+                }
+            }
+            if (m_count == 0)
+            {
+                m_starts.assign(2, 0);
+                return;
+            }
+            m_minimum = m_times[0];
+            m_maximum = m_times[m_count - 1];
+            // About 4 rows per bucket if the times are uniform.
+            size_t numBuckets = 1;
+            while (numBuckets < m_count / 4)
+            {
+                numBuckets *= 2;
+            }
+            const uint64_t width = uint64_t(m_maximum) - uint64_t(m_minimum);
+            m_shift = 0;
+            while (m_shift < 63 && (width >> m_shift) >= numBuckets)
+            {
+                m_shift++;
+            }
+            const size_t lastBucket = bucketOf(m_maximum);
+            m_starts.assign(lastBucket + 2, m_count);
+            size_t bucket = 0;
+            m_starts[0] = 0;
+            for (size_t i = 0; i < m_count; i++)
+            {
+                const size_t current = bucketOf(m_times[i]);
+                while (bucket < current)
+                {
+                    m_starts[++bucket] = i;
+                }
+            }
+        }
+    };
+}
+#endif
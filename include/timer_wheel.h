@@ -0,0 +1,438 @@
+#ifndef _MY_TIMER_WHEEL_
+#define _MY_TIMER_WHEEL_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <utility>
+#include <vector>
+
+#include "datetime.h"
+#include "time_delta.h"
+#include "bit_utils.h"
+
+// 期限 (Unix秒) つきのタイマーの階層型タイマーホイール。6段 x 64スロット (各段 6ビット, 計 36ビット ≒ 2177年) と、それより先の期限の overflow リスト。
+// 仕様: 期限は現在時刻と最上位で異なるビットの段に置く (スロットは期限のその段の桁)。時刻がスロットの先頭に達したら下の段に置き直すか、満了にする。
+//   空でないスロットはビットマップで探すので、時刻を大きく進めても空のスロットは走査しない。
+// タイマーは配列のノード (添字の双方向リスト) に置き、解放したノードを再利用する。追加・取り消しは O(1)。
+// スレッド: post() だけは他のスレッドから呼べる (lock-free のスタックに積み、advance() で取り込む)。ほかは所有するスレッドから呼ぶ。
+
+namespace EZ
+{
+    /**
+    * @brief Hierarchical timer wheel of deadlines (unix seconds)
+    * @details insert() and cancel() take O(1) time without allocating per timer (nodes are reused).
+    * advance(now) expires the timers whose deadlines are at or before now, in the order of their deadlines. \n
+    * Drive it by a clock: call poll(clock) (or advance() with the current time) periodically. \n
+    * ex: \n
+    * EZ::TimerWheel<int> wheel(EZ::Datetime::now()); \n
+    * auto id = wheel.insert(EZ::Datetime::now() + 30, sessionId); \n
+    * wheel.poll(coarseClock, [](std::vector<int> &expired) { ... });
+    */
+    template <class Payload>
+    class TimerWheel
+    {
+    public:
+        /**
+        * タイマーの識別子 (insert() が返す) \n
+        * Identifier of a timer returned by insert().
+        */
+        typedef uint64_t Id;
+
+        /**
+        * @param[in] now	current time (unix seconds)
+        */
+        TimerWheel(const long long &now = 0) : m_now(biased(now)), m_size(0), m_free(NIL), m_posted(nullptr)
+        {
+            for (auto &bitmap : m_bitmaps)
+            {
+                bitmap = 0;
+            }
+            for (auto &list : m_lists)
+            {
+                list.head = NIL;
+                list.tail = NIL;
+            }
+        }
+        TimerWheel(const Datetime &now) : TimerWheel(now.unixTime())
+        {
+        }
+        TimerWheel(const TimerWheel &) = delete;
+        TimerWheel &operator=(const TimerWheel &) = delete;
+        ~TimerWheel()
+        {
+            Posted *posted = m_posted.exchange(nullptr);
+            while (posted != nullptr)
+            {
+                Posted *next = posted->next;
+                delete posted;
+                posted = next;
+            }
+        }
+
+        /**
+        * 現在時刻 (最後に advance() した時刻) \n
+        * Current time: the time of the last advance().
+        */
+        long long now() const
+        {
+            return unbiased(m_now);
+        }
+        /**
+        * 満了していないタイマーの数 (post() して取り込んでいないものを除く) \n
+        * Number of pending timers, excluding posted ones not taken in yet.
+        */
+        size_t size() const
+        {
+            return m_size;
+        }
+        bool empty() const
+        {
+            return m_size == 0;
+        }
+
+        /**
+        * タイマーを追加する。期限が現在時刻以前なら次の advance() で満了する。 \n
+        * Add a timer. If the deadline is at or before now(), it expires at the next advance().
+        * @returns the identifier to cancel the timer
+        */
+        Id insert(const long long &deadline, Payload payload)
+        {
+            uint32_t index;
+            if (m_free != NIL)
+            {
+                index = m_free;
+                m_free = m_nodes[index].next;
+                m_nodes[index].payload = std::move(payload);
+            }
+            else
+            {
+                index = uint32_t(m_nodes.size());
+                m_nodes.push_back(Node{0, NIL, NIL, 0, 0, std::move(payload)});
+            }
+            m_nodes[index].deadline = biased(deadline);
+            place(index);
+            m_size++;
+            return (Id(m_nodes[index].generation) << 32) | index;
+        }
+        Id insert(const Datetime &deadline, Payload payload)
+        {
+            return insert(deadline.unixTime(), std::move(payload));
+        }
+        /**
+        * 現在時刻の delay 後に満了するタイマーを追加する \n
+        * Add a timer that expires delay after now().
+        */
+        Id insertAfter(const TimeDelta &delay, Payload payload)
+        {
+            return insert(now() + delay.totalSeconds(), std::move(payload));
+        }
+
+        /**
+        * タイマーを取り消す。満了済み・取り消し済みなら false \n
+        * Cancel a timer. false if it has expired or been cancelled.
+        */
+        bool cancel(const Id &id)
+        {
+            const uint32_t index = uint32_t(id);
+            if (index >= m_nodes.size() || m_nodes[index].generation != uint32_t(id >> 32) || m_nodes[index].list == FREE)
+            {
+                return false;
+            }
+            const size_t list = m_nodes[index].list;
+            unlink(index);
+            if (list < NUM_LEVELS * NUM_SLOTS && m_lists[list].head == NIL)
+            {
+                m_bitmaps[list / NUM_SLOTS] &= ~(uint64_t(1) << (list % NUM_SLOTS));
+            }
+            m_nodes[index].payload = Payload();
+            release(index);
+            m_size--;
+            return true;
+        }
+
+        /**
+        * 他のスレッドからタイマーを追加する (lock-free)。次の advance() で取り込む。取り消しはできない。 \n
+        * Add a timer from any thread without locking. It is taken in by the next advance(), and cannot be cancelled.
+        */
+        void post(const long long &deadline, Payload payload)
+        {
+            Posted *posted = new Posted{deadline, std::move(payload), m_posted.load(std::memory_order_relaxed)};
+            while (!m_posted.compare_exchange_weak(posted->next, posted, std::memory_order_release, std::memory_order_relaxed))
+            {
+            }
+        }
+        void post(const Datetime &deadline, Payload payload)
+        {
+            post(deadline.unixTime(), std::move(payload));
+        }
+
+        /**
+        * 時刻を now まで進め、期限が now 以前のタイマーの値を expired に追加する (期限の順) \n
+        * Advance the time to now, and append the payloads of the timers expiring at or before now to expired, in the order of their deadlines.
+        * @returns number of expired timers
+        * @details Timers inserted with deadlines at or before now() expire first, in the order of insertion. \n
+        * The time does not go back: if now is before now(), only those timers expire.
+        */
+        size_t advance(const long long &now, std::vector<Payload> &expired)
+        {
+            const size_t first = expired.size();
+            takePosted();
+            expireList(DUE, expired);
+            const uint64_t target = biased(now);
+            while (true)
+            {
+                size_t level;
+                const uint64_t next = nextEvent(level);
+                if (next > target || next <= m_now)
+                {
+                    break;
+                }
+                m_now = next;
+                if (level == 0)
+                {
+                    expireList(size_t(next % NUM_SLOTS), expired);
+                    m_bitmaps[0] &= ~(uint64_t(1) << (next % NUM_SLOTS));
+                }
+                else
+                {
+                    const size_t list = level < NUM_LEVELS ? level * NUM_SLOTS + digit(next, level) : size_t(OVERFLOW_LIST);
+                    if (level < NUM_LEVELS)
+                    {
+                        m_bitmaps[level] &= ~(uint64_t(1) << digit(next, level));
+                    }
+                    uint32_t index = m_lists[list].head;
+                    m_lists[list].head = NIL;
+                    m_lists[list].tail = NIL;
+                    while (index != NIL)
+                    {
+                        const uint32_t following = m_nodes[index].next;
+                        place(index);
+                        index = following;
+                    }
+                    expireList(DUE, expired);
+                }
+            }
+            m_now = target > m_now ? target : m_now;
+            return expired.size() - first;
+        }
+        size_t advance(const Datetime &now, std::vector<Payload> &expired)
+        {
+            return advance(now.unixTime(), expired);
+        }
+        /**
+        * 時刻を now まで進め、満了したタイマーの値の一括を callback(std::vector<Payload> &) に渡す (満了がなければ呼ばない) \n
+        * Advance the time to now, and pass the payloads of the expired timers to callback(std::vector<Payload> &) at once (not called if none expired).
+        */
+        template <class Callback>
+        size_t advance(const long long &now, Callback callback)
+        {
+            m_batch.clear();
+            const size_t count = advance(now, m_batch);
+            if (count > 0)
+            {
+                callback(m_batch);
+            }
+            return count;
+        }
+        template <class Callback>
+        size_t advance(const Datetime &now, Callback callback)
+        {
+            return advance(now.unixTime(), callback);
+        }
+
+        /**
+        * 時計 clock の現在時刻まで進める (advance(clock.now(), ...) と同じ) \n
+        * Advance the time to the current time of the clock: same as advance(clock.now(), ...).
+        * @param[in] clock	a clock such as EZ::CoarseClock or EZ::ManualClock (see datetime_clock.h)
+        */
+        template <class Clock>
+        size_t poll(const Clock &clock, std::vector<Payload> &expired)
+        {
+            return advance(clock.now(), expired);
+        }
+        template <class Clock, class Callback>
+        size_t poll(const Clock &clock, Callback callback)
+        {
+            return advance(clock.now(), callback);
+        }
+
+    private:
+        enum
+        {
+            BITS_PER_LEVEL = 6,
+            NUM_SLOTS = 64,
+            NUM_LEVELS = 6,
+            // Lists after the slots: overdue timers and timers beyond the levels.
+            DUE = NUM_LEVELS * NUM_SLOTS,
+            OVERFLOW_LIST = DUE + 1,
+            NUM_LISTS = OVERFLOW_LIST + 1,
+            // The list of a free node.
+            FREE = NUM_LISTS,
+        };
+        static const uint32_t NIL = 0xFFFFFFFFu;
+
+        struct Node
+        {
+            // Biased deadline.
+            uint64_t deadline;
+            uint32_t prev;
+            uint32_t next;
+            uint32_t generation;
+            uint32_t list;
+            Payload payload;
+        };
+        struct List
+        {
+            uint32_t head;
+            uint32_t tail;
+        };
+        struct Posted
+        {
+            long long deadline;
+            Payload payload;
+            Posted *next;
+        };
+
+        // Biased time (unsigned, in the same order as signed times).
+        uint64_t m_now;
+        size_t m_size;
+        std::vector<Node> m_nodes;
+        uint32_t m_free;
+        List m_lists[NUM_LISTS];
+        // Non-empty slots of each level.
+        uint64_t m_bitmaps[NUM_LEVELS];
+        std::atomic<Posted *> m_posted;
+        std::vector<Payload> m_batch;
+
+        static uint64_t biased(const long long &time)
+        {
+            return uint64_t(time) ^ (uint64_t(1) << 63);
+        }
+        static long long unbiased(const uint64_t &time)
+        {
+            return (long long)(time ^ (uint64_t(1) << 63));
+        }
+        static size_t digit(const uint64_t &time, const size_t &level)
+        {
+            return size_t(time >> (BITS_PER_LEVEL * level)) % NUM_SLOTS;
+        }
+
+        // Put a node in the list of its deadline.
+        void place(const uint32_t &index)
+        {
+            const uint64_t deadline = m_nodes[index].deadline;
+            if (deadline <= m_now)
+            {
+                append(DUE, index);
+                return;
+            }
+            const size_t level = size_t(Bits::highestBit(deadline ^ m_now)) / BITS_PER_LEVEL;
+            if (level >= NUM_LEVELS)
+            {
+                append(OVERFLOW_LIST, index);
+                return;
+            }
+            const size_t slot = digit(deadline, level);
+            append(level * NUM_SLOTS + slot, index);
+            m_bitmaps[level] |= uint64_t(1) << slot;
+        }
+
+        void append(const size_t &list, const uint32_t &index)
+        {
+            Node &node = m_nodes[index];
+            node.list = uint32_t(list);
+            node.prev = m_lists[list].tail;
+            node.next = NIL;
+            if (node.prev == NIL)
+            {
+                m_lists[list].head = index;
+            }
+            else
+            {
+                m_nodes[node.prev].next = index;
+            }
+            m_lists[list].tail = index;
+        }
+
+        void unlink(const uint32_t &index)
+        {
+            const Node &node = m_nodes[index];
+            List &list = m_lists[node.list];
+            (node.prev == NIL ? list.head : m_nodes[node.prev].next) = node.next;
+            (node.next == NIL ? list.tail : m_nodes[node.next].prev) = node.prev;
+        }
+
+        void release(const uint32_t &index)
+        {
+            Node &node = m_nodes[index];
+            node.list = FREE;
+            node.generation++;
+            node.next = m_free;
+            m_free = index;
+        }
+
+        // Expire all timers of the list.
+        void expireList(const size_t &list, std::vector<Payload> &expired)
+        {
+            uint32_t index = m_lists[list].head;
+            m_lists[list].head = NIL;
+            m_lists[list].tail = NIL;
+            while (index != NIL)
+            {
+                const uint32_t following = m_nodes[index].next;
+                expired.push_back(std::move(m_nodes[index].payload));
+                m_nodes[index].payload = Payload();
+                release(index);
+                m_size--;
+                index = following;
+            }
+        }
+
+        // The earliest start of a non-empty slot after now, and its level (NUM_LEVELS: overflow). UINT64_MAX if none.
+        uint64_t nextEvent(size_t &level) const
+        {
+            for (size_t l = 0; l < NUM_LEVELS; l++)
+            {
+                // Slots of a level start later than the slots of the lower levels.
+                const size_t current = digit(m_now, l);
+                const uint64_t later = current + 1 < NUM_SLOTS ? m_bitmaps[l] & (~uint64_t(0) << (current + 1)) : 0;
+                if (later != 0)
+                {
+                    const size_t shift = BITS_PER_LEVEL * (l + 1);
+                    level = l;
+                    return ((m_now >> shift) << shift) | (uint64_t(Bits::countTrailingZeros(later)) << (BITS_PER_LEVEL * l));
+                }
+            }
+            const size_t shift = BITS_PER_LEVEL * NUM_LEVELS;
+            level = NUM_LEVELS;
+            if (m_lists[OVERFLOW_LIST].head == NIL || (m_now >> shift) == (~uint64_t(0) >> shift))
+            {
+                return ~uint64_t(0);
+            }
+            return ((m_now >> shift) + 1) << shift;
+        }
+
+        // Take in the posted timers (in the order of posting).
+        void takePosted()
+        {
+            Posted *posted = m_posted.exchange(nullptr, std::memory_order_acquire);
+            Posted *reversed = nullptr;
+            while (posted != nullptr)
+            {
+                Posted *next = posted->next;
+                posted->next = reversed;
+                reversed = posted;
+                posted = next;
+            }
+            while (reversed != nullptr)
+            {
+                Posted *next = reversed->next;
+                insert(reversed->deadline, std::move(reversed->payload));
+                delete reversed;
+                reversed = next;
+            }
+        }
+    };
+}
+#endif
@@ -10,6 +10,7 @@
 
 #include "datetime_exceptions.h"
 #include "datetime_constants.h"
+#include "datetime_metrics.h"
 
 namespace EZ
 {
@@ -51,63 +52,236 @@ namespace EZ
 			return !(operator==(tm1, tm2));
 		}
 
+		// 整数の切り捨て除算 (負の数は -∞ 方向に丸める)
+		long long floorDiv(const long long &a, const long long &b)
+		{
+			long long q = a / b;
+			if ((a % b != 0) && ((a < 0) != (b < 0)))
+			{
+				q--;
+			}
+			return q;
+		}
+
+		/**
+		* 閏年なら true を返す (先発グレゴリオ暦) \n
+		* Return true if the year is a leap year. (proleptic Gregorian calendar)
+		*/
+		bool isLeapYear(const long long &year)
+		{
+			return (year % 4 == 0) && ((year % 100 != 0) || (year % 400 == 0));
+		}
+
+		/**
+		* 月の日数を返す \n
+		* Return the number of days in the month. (mon: 1 ~ 12)
+		*/
+		int daysInMonth(const long long &year, const int &mon)
+		{
+			static const int days[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+			return (mon == 2 && isLeapYear(year)) ? 29 : days[mon - 1];
+		}
+
+		/**
+		* 1970/1/1 からの通算日数を返す \n
+		* Return the number of days since 1970/1/1. (mon: 1 ~ 12, day: 1 ~ 31)
+		* @details http://howardhinnant.github.io/date_algorithms.html#days_from_civil
+		*/
+		long long daysFromCivil(long long year, const int &mon, const int &day)
+		{
+			year -= (mon <= 2);
+			const long long era = floorDiv(year, 400);
+			const long long yoe = year - era * 400;									  // [0, 399]
+			const long long doy = (153 * (mon + (mon > 2 ? -3 : 9)) + 2) / 5 + day - 1; // [0, 365]
+			const long long doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;				  // [0, 146096]
+			return era * DatetimeConstants::DAYS_PER_400_YEARS + doe - 719468;
+		}
+
+		/**
+		* 1970/1/1 からの通算日数を年月日に変換する \n
+		* Convert the number of days since 1970/1/1 to year, month (1 ~ 12) and day (1 ~ 31).
+		* @details http://howardhinnant.github.io/date_algorithms.html#civil_from_days
+		*/
+		void civilFromDays(long long days, long long &year, int &mon, int &day)
+		{
+			days += 719468;
+			const long long era = floorDiv(days, DatetimeConstants::DAYS_PER_400_YEARS);
+			const long long doe = days - era * DatetimeConstants::DAYS_PER_400_YEARS; // [0, 146096]
+			const long long yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+			const long long doy = doe - (365 * yoe + yoe / 4 - yoe / 100); // [0, 365]
+			const long long mp = (5 * doy + 2) / 153;						 // [0, 11]
+			day = int(doy - (153 * mp + 2) / 5 + 1);
+			mon = int(mp < 10 ? mp + 3 : mp - 9);
+			year = yoe + era * 400 + (mon <= 2);
+		}
+
+		/**
+		* struct tm の各値が範囲内か判定する (正規化は行わない) \n
+		* Return true if every field of struct tm is in its range. (No normalization)
+		*/
+		bool isValidFields(const struct tm &time)
+		{
+			const long long year = (long long)time.tm_year + DatetimeConstants::TM_BASE_YEAR;
+			if (time.tm_mon < 0 || time.tm_mon > 11)
+			{
+				return false;
+			}
+			if (time.tm_mday < 1 || time.tm_mday > daysInMonth(year, time.tm_mon + DatetimeConstants::MONTH_OFFSET))
+			{
+				return false;
+			}
+			if (time.tm_hour < 0 || time.tm_hour > 23)
+			{
+				return false;
+			}
+			if (time.tm_min < 0 || time.tm_min > 59)
+			{
+				return false;
+			}
+			if (time.tm_sec < 0 || time.tm_sec > 59)
+			{
+				return false;
+			}
+			return true;
+		}
+
+		/**
+		* struct tm (UTC) を Unix秒に変換する。timegm() を使わず自前で計算する。 \n
+		* Convert struct tm (UTC) to unix seconds without calling timegm().
+		*/
+		long long my_timegm(const struct tm &time)
+		{
+			const long long year = (long long)time.tm_year + DatetimeConstants::TM_BASE_YEAR;
+			const long long days = daysFromCivil(year, time.tm_mon + DatetimeConstants::MONTH_OFFSET, time.tm_mday);
+			return days * DatetimeConstants::SECONDS_PER_DAY + time.tm_hour * 3600 + time.tm_min * 60 + time.tm_sec;
+		}
+
+		/**
+		* Unix秒を struct tm (UTC) に変換する。gmtime() を使わず自前で計算する。 \n
+		* Convert unix seconds to struct tm (UTC) without calling gmtime().
+		*/
+		struct tm my_gmtime(const long long &unixTime)
+		{
+			const long long days = floorDiv(unixTime, DatetimeConstants::SECONDS_PER_DAY);
+			const long long secOfDay = unixTime - days * DatetimeConstants::SECONDS_PER_DAY;
+			long long year;
+			int mon, day;
+			civilFromDays(days, year, mon, day);
+
+			struct tm retTm = {};
+			retTm.tm_year = int(year - DatetimeConstants::TM_BASE_YEAR);
+			retTm.tm_mon = mon - DatetimeConstants::MONTH_OFFSET;
+			retTm.tm_mday = day;
+			retTm.tm_hour = int(secOfDay / 3600);
+			retTm.tm_min = int(secOfDay % 3600 / 60);
+			retTm.tm_sec = int(secOfDay % 60);
+			// 1970/1/1 is Thursday.
+			retTm.tm_wday = int(days + 4 - floorDiv(days + 4, 7) * 7);
+			retTm.tm_yday = int(days - daysFromCivil(year, 1, 1));
+			retTm.tm_isdst = 0;
+#if !defined(_WIN32) && !defined(_WIN64)
+			retTm.tm_gmtoff = 0;
+			retTm.tm_zone = "GMT";
+#endif
+			return retTm;
+		}
+
 		// 仕様: サマータイムの設定は struct tmの仕様に準拠する
 		// mktime()のサマータイム対策用関数
 		// https://stackoverflow.com/questions/12122084/confusing-behaviour-of-mktime-function-increasing-tm-hour-count-by-one
 		// https://stackoverflow.com/questions/8558919/mktime-and-tm-isdst
+		// 仕様: UTCは自前の暦計算で変換する。現地時刻はmktime()を使う。
+		//       ただしWindowsでは処理系が扱える範囲 (1970 ~ 2999年) の外を、400年周期 (グレゴリオ暦は400年で曜日も含めて一巡する)
+		//       でずらしてから計算する。
 		time_t my_mktime(const struct tm &time, const bool &isUTC)
 		{
-			auto time2 = time;
-			//time2.tm_isdst = 0;
-			//tzset();
-			// https://stackoverflow.com/questions/16647819/timegm-cross-platform
-			// https://stackoverflow.com/questions/8666378/detect-windows-or-linux-in-c-c/33088568
-			// https://web.archive.org/web/20191012035921/http://nadeausoftware.com/articles/2012/01/c_c_tip_how_use_compiler_predefined_macros_detect_operating_system
-
-			time_t unixTime;
+			const long long year = (long long)time.tm_year + DatetimeConstants::TM_BASE_YEAR;
+			if (!isValidFields(time) || year < DatetimeConstants::MINIMUM_YEAR || year > DatetimeConstants::MAXIMUM_YEAR)
+			{
+				throw DatetimeException("Invalid input to mktime() !. Check input args.");
+			}
 			if (isUTC)
 			{
+				return time_t(my_timegm(time));
+			}
+
+			auto time2 = time;
+			long long cycles = 0;
 #if defined(_WIN32) || defined(_WIN64)
-				unixTime = _mkgmtime(&(time2));
+			if (year < DatetimeConstants::NATIVE_MINIMUM_YEAR || year > DatetimeConstants::NATIVE_MAXIMUM_YEAR)
 #else
-				unixTime = timegm(&(time2));
+			if (false)
 #endif
-			}
-			else
 			{
+				cycles = floorDiv(year - DatetimeConstants::NATIVE_ANCHOR_YEAR, 400);
+				time2.tm_year = int(year - cycles * 400 - DatetimeConstants::TM_BASE_YEAR);
+			}
+			// Let mktime() decide whether summer time is in effect.
+			time2.tm_isdst = -1;
+			auto time3 = time2;
+			// https://stackoverflow.com/questions/16647819/timegm-cross-platform
+			// https://stackoverflow.com/questions/8666378/detect-windows-or-linux-in-c-c/33088568
+			// https://web.archive.org/web/20191012035921/http://nadeausoftware.com/articles/2012/01/c_c_tip_how_use_compiler_predefined_macros_detect_operating_system
+			Metrics::increment(Metrics::ZONE_LOOKUPS);
+			time_t unixTime;
 #if defined(_WIN32) || defined(_WIN64)
-				unixTime = mktime(&(time2));
+			unixTime = mktime(&(time3));
 #else
-				unixTime = timelocal(&(time2));
+			unixTime = timelocal(&(time3));
 #endif
-			}
-			if (time != time2)
+			if (time2 != time3)
 			{
-				//std::cout << time.tm_year << "<>" <<time2.tm_year << std::endl;
-				//std::cout << time.tm_mon << "<>" <<time2.tm_mon << std::endl;
-				//std::cout << time.tm_mday << "<>" <<time2.tm_mday << std::endl;
-				//std::cout << time.tm_hour << "<>" <<time2.tm_hour << std::endl;
-				//std::cout << time.tm_min << "<>" <<time2.tm_min << std::endl;
-				//std::cout << time.tm_sec << "<>" <<time2.tm_sec << std::endl;
 				throw DatetimeException("Invalid input to mktime() !. Check input args.");
 			}
-			return unixTime;
+			return time_t(unixTime + cycles * DatetimeConstants::SECONDS_PER_400_YEARS);
 		}
 
 		struct tm my_mkStructTm(const time_t &unixTime, const bool &isUTC)
 		{
-			// http://www.orchid.co.jp/computer/cschool/CREF/gmtime.html
-			struct tm retTm;
 			if (isUTC)
 			{
-				retTm = *gmtime(&unixTime);
+				return my_gmtime(unixTime);
 			}
-			else
+
+			// http://www.orchid.co.jp/computer/cschool/CREF/gmtime.html
+			long long cycles = 0;
+			time_t nativeTime = unixTime;
+#if defined(_WIN32) || defined(_WIN64)
+			if (unixTime < DatetimeConstants::NATIVE_MINIMUM_SEC || unixTime > DatetimeConstants::NATIVE_MAXIMUM_SEC)
+#else
+			if (false)
+#endif
 			{
-				retTm = *localtime(&unixTime);
+				cycles = floorDiv(unixTime - DatetimeConstants::NATIVE_ANCHOR_SEC, DatetimeConstants::SECONDS_PER_400_YEARS);
+				nativeTime = time_t(unixTime - cycles * DatetimeConstants::SECONDS_PER_400_YEARS);
 			}
+			Metrics::increment(Metrics::ZONE_LOOKUPS);
+			// Reentrant versions: localtime() shares one buffer between threads.
+			struct tm retTm;
+#if defined(_WIN32) || defined(_WIN64)
+			localtime_s(&retTm, &nativeTime);
+#else
+			localtime_r(&nativeTime, &retTm);
+#endif
+			retTm.tm_year = int(retTm.tm_year + cycles * 400);
 			return retTm;
 		}
+
+		/**
+		* struct tm のUTCからのオフセット (秒、東が正) を返す \n
+		* Return the UTC offset of struct tm in seconds east of UTC.
+		* @details Windows has no tm_gmtoff: the offset of the current local timezone is used (same as "%Z").
+		*/
+		long long utcOffsetOf(const struct tm &time)
+		{
+#if defined(_WIN32) || defined(_WIN64)
+			TIME_ZONE_INFORMATION tzi;
+			GetTimeZoneInformation(&tzi);
+			return -60LL * (tzi.Bias + (time.tm_isdst > 0 ? tzi.DaylightBias : tzi.StandardBias));
+#else
+			return time.tm_gmtoff;
+#endif
+		}
 	}
 }
 #endif
@@ -0,0 +1,113 @@
+#ifndef _MY_ALLOC_COUNTER_
+#define _MY_ALLOC_COUNTER_
+
+// Replace global operator new/delete to count heap allocations per thread.
+// Include this header from exactly one translation unit of an executable.
+
+#include <cstdlib>
+#include <new>
+
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+// The replaced operators pair malloc() with free(), which GCC can not see through after inlining.
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+namespace MyHelper
+{
+    namespace AllocationStats
+    {
+        // Number of allocations on the current thread.
+        inline long long &count()
+        {
+            static thread_local long long allocations = 0;
+            return allocations;
+        }
+    }
+
+    /**
+    * Count heap allocations done on the current thread during the lifetime of this object.
+    * @details ex: AllocationCounter counter; t.str(); EXPECT_LE(counter.count(), 1);
+    */
+    class AllocationCounter
+    {
+        long long m_start;
+
+    public:
+        AllocationCounter() : m_start(AllocationStats::count())
+        {
+        }
+
+        long long count() const
+        {
+            return AllocationStats::count() - m_start;
+        }
+
+        void reset()
+        {
+            m_start = AllocationStats::count();
+        }
+    };
+}
+
+void *operator new(std::size_t size)
+{
+    MyHelper::AllocationStats::count()++;
+    if (size == 0)
+    {
+        size = 1;
+    }
+    void *p = std::malloc(size);
+    if (p == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    MyHelper::AllocationStats::count()++;
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &tag) noexcept
+{
+    return operator new(size, tag);
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, const std::nothrow_t &) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p, const std::nothrow_t &) noexcept
+{
+    std::free(p);
+}
+
+#endif
@@ -0,0 +1,153 @@
+#ifndef _MY_PERF_COUNTER_
+#define _MY_PERF_COUNTER_
+
+// Read hardware counters (cycles, instructions, cache misses) of the current thread
+// with Linux perf_event_open(2). On other platforms, or if the kernel denies access
+// (ex: /proc/sys/kernel/perf_event_paranoid), available() returns false and all values are 0.
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <string.h>
+#endif
+
+namespace MyHelper
+{
+    class PerfCounters
+    {
+    public:
+        enum Event
+        {
+            CYCLES = 0,
+            INSTRUCTIONS,
+            CACHE_MISSES,
+            NUM_EVENTS
+        };
+
+        PerfCounters()
+        {
+            for (int i = 0; i < NUM_EVENTS; i++)
+            {
+                m_fd[i] = -1;
+                m_values[i] = 0;
+            }
+#if defined(__linux__)
+            const unsigned long long configs[NUM_EVENTS] = {
+                PERF_COUNT_HW_CPU_CYCLES,
+                PERF_COUNT_HW_INSTRUCTIONS,
+                PERF_COUNT_HW_CACHE_MISSES};
+            for (int i = 0; i < NUM_EVENTS; i++)
+            {
+                struct perf_event_attr attr;
+                memset(&attr, 0, sizeof(attr));
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.size = sizeof(attr);
+                attr.config = configs[i];
+                attr.disabled = 1;
+                attr.exclude_kernel = 1;
+                attr.exclude_hv = 1;
+                m_fd[i] = int(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+            }
+#endif
+        }
+
+        ~PerfCounters()
+        {
+#if defined(__linux__)
+            for (int i = 0; i < NUM_EVENTS; i++)
+            {
+                if (m_fd[i] >= 0)
+                {
+                    close(m_fd[i]);
+                }
+            }
+#endif
+        }
+
+        PerfCounters(const PerfCounters &) = delete;
+        PerfCounters &operator=(const PerfCounters &) = delete;
+
+        /**
+        * Return true if at least one counter could be opened.
+        */
+        bool available() const
+        {
+            for (int i = 0; i < NUM_EVENTS; i++)
+            {
+                if (m_fd[i] >= 0)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /**
+        * Return true if the counter could be opened.
+        */
+        bool available(const Event &event) const
+        {
+            return m_fd[event] >= 0;
+        }
+
+        void start()
+        {
+#if defined(__linux__)
+            for (int i = 0; i < NUM_EVENTS; i++)
+            {
+                if (m_fd[i] >= 0)
+                {
+                    ioctl(m_fd[i], PERF_EVENT_IOC_RESET, 0);
+                    ioctl(m_fd[i], PERF_EVENT_IOC_ENABLE, 0);
+                }
+            }
+#endif
+        }
+
+        void stop()
+        {
+#if defined(__linux__)
+            for (int i = 0; i < NUM_EVENTS; i++)
+            {
+                if (m_fd[i] >= 0)
+                {
+                    ioctl(m_fd[i], PERF_EVENT_IOC_DISABLE, 0);
+                    long long value = 0;
+                    if (read(m_fd[i], &value, sizeof(value)) == sizeof(value))
+                    {
+                        m_values[i] = value;
+                    }
+                }
+            }
+#endif
+        }
+
+        long long value(const Event &event) const
+        {
+            return m_values[event];
+        }
+
+        long long cycles() const
+        {
+            return value(CYCLES);
+        }
+
+        long long instructions() const
+        {
+            return value(INSTRUCTIONS);
+        }
+
+        long long cacheMisses() const
+        {
+            return value(CACHE_MISSES);
+        }
+
+    private:
+        int m_fd[NUM_EVENTS];
+        long long m_values[NUM_EVENTS];
+    };
+}
+
+#endif
@@ -3,8 +3,27 @@
 
 // If you want to define global variables, define them here before include header files. //
 //const std::string testDataFolder = "../test/test_data/";
+#define EZ_ENABLE_METRICS
 
 // Please include test*.h files to add them to test suite. //
 #include "testDatetime.h"
 #include "testTimeDelta.h"
-#include "testTimeZone.h"
\ No newline at end of file
+#include "testTimeZone.h"
+#include "testAllocation.h"
+#include "testMetrics.h"
+#include "testFormat.h"
+#include "testFixedFormat.h"
+#include "testCalendar.h"
+#include "testResampler.h"
+#include "testRange.h"
+#include "testBusinessCalendar.h"
+#include "testCronSchedule.h"
+#include "testSort.h"
+#include "testStreamMerger.h"
+#include "testTimeIndex.h"
+#include "testInterval.h"
+#include "testCompressedTimes.h"
+#include "testBinary.h"
+#include "testPackedTimes.h"
+#include "testTimerWheel.h"
+#include "testClock.h"
@@ -0,0 +1,158 @@
+#pragma once
+#include "gtest/gtest.h"
+#include "datetime.h"
+#include "alloc_counter.h"
+#include "perf_counter.h"
+
+using namespace EZ;
+using MyHelper::AllocationCounter;
+
+// Allocation budgets of public APIs.
+// The counts are taken before EXPECT_* because gtest itself allocates.
+class TestAllocation : public ::testing::Test
+{
+protected:
+    static Datetime timeUTC;
+    static Datetime timeLocal;
+
+    static void SetUpTestCase()
+    {
+        std::cout << "\tCALL SetUpTestCase()" << std::endl;
+        timeUTC = Datetime(2021, 3, 8, 0, 0, 15, true);
+        timeLocal = Datetime(2021, 3, 8, 0, 0, 15, false);
+        // Warm up (localtime() loads the timezone at the first call).
+        timeLocal.str();
+    }
+
+    static void TearDownTestCase()
+    {
+        std::cout << "\tCALL TearDownTestCase()" << std::endl;
+    }
+};
+
+Datetime TestAllocation::timeUTC;
+Datetime TestAllocation::timeLocal;
+
+TEST_F(TestAllocation, CounterWorks)
+{
+    AllocationCounter counter;
+    std::vector<std::string> v;
+    v.reserve(2);
+    v.push_back(std::string(100, 'a'));
+    long long n = counter.count();
+    EXPECT_EQ(n, 2);
+    EXPECT_EQ(v[0].size(), 100);
+}
+
+TEST_F(TestAllocation, ParseFixedFormat)
+{
+    AllocationCounter counter;
+    Datetime t1("2021/3/8 0:00:15", true);
+    Datetime t2("2021-03-08T00:00:15", "%Y-%m-%dT%H:%M:%S", true);
+    Datetime t3("2021/3/8 0:00:15");
+    long long n = counter.count();
+    EXPECT_EQ(n, 0);
+    EXPECT_EQ(t1, t2);
+    EXPECT_EQ(t1.isUTC(), true);
+    EXPECT_EQ(t3.isUTC(), false);
+
+    std::string timestamp = "2021/3/8 0:00:15";
+    std::string format = "%Y/%m/%d %H:%M:%S";
+    counter.reset();
+    Datetime t4(timestamp, format, true);
+    Datetime t5(timestamp, true);
+    n = counter.count();
+    EXPECT_EQ(n, 0);
+    EXPECT_EQ(t4, t1);
+    EXPECT_EQ(t5, t1);
+}
+
+TEST_F(TestAllocation, Str)
+{
+    AllocationCounter counter;
+    auto s1 = timeUTC.str();
+    long long n = counter.count();
+    EXPECT_LE(n, 1);
+    EXPECT_EQ(s1, "2021/03/08 00:00:15 GMT");
+
+    counter.reset();
+    auto s2 = timeLocal.str();
+    n = counter.count();
+    EXPECT_LE(n, 1);
+
+    counter.reset();
+    auto s3 = timeUTC.str("%Y/%m/%d");
+    auto s4 = timeUTC.str("%H:%M:%S");
+    auto s5 = timeUTC.date();
+    n = counter.count();
+    EXPECT_EQ(n, 0); // short strings fit in SSO.
+    EXPECT_EQ(s3, "2021/03/08");
+    EXPECT_EQ(s4, "00:00:15");
+    EXPECT_EQ(s5, "2021/03/08");
+
+    // Output longer than the internal buffer is still correct.
+    std::string longFormat(300, '_');
+    longFormat += "%Y";
+    counter.reset();
+    auto s6 = timeUTC.str(longFormat);
+    n = counter.count();
+    EXPECT_LE(n, 3);
+    EXPECT_EQ(s6, std::string(300, '_') + "2021");
+}
+
+TEST_F(TestAllocation, Accessors)
+{
+    AllocationCounter counter;
+    long long sum = 0;
+    sum += timeLocal.year() + timeLocal.month() + timeLocal.day();
+    sum += timeLocal.hour() + timeLocal.minute() + timeLocal.sec();
+    sum += timeLocal.daysOfWeek() + timeLocal.isDst() + timeLocal.unixTime();
+    sum += timeUTC.year() + timeUTC.month() + timeUTC.day();
+    long long n = counter.count();
+    EXPECT_EQ(n, 0);
+    EXPECT_NE(sum, 0);
+}
+
+TEST_F(TestAllocation, Arithmetic)
+{
+    AllocationCounter counter;
+    auto t = timeUTC + TimeDelta(0, 1, 0, 0);
+    t -= 60;
+    t += TimeDelta(60);
+    auto delta = t - timeUTC;
+    bool cmp = (t > timeUTC) && (timeUTC < t) && (t != timeUTC);
+    long long n = counter.count();
+    EXPECT_EQ(n, 0);
+    EXPECT_TRUE(cmp);
+    EXPECT_EQ(delta, 3600);
+}
+
+TEST_F(TestAllocation, PerfCounters)
+{
+    MyHelper::PerfCounters perf;
+    perf.start();
+    long long sum = 0;
+    for (int i = 0; i < 1000; i++)
+    {
+        sum += (timeUTC + i).sec();
+    }
+    perf.stop();
+    EXPECT_GT(sum, 0);
+    if (!perf.available())
+    {
+        std::cout << "\tperf_event_open() is not available. Skip checking counters." << std::endl;
+        return;
+    }
+    std::cout << "\tcycles=" << perf.cycles()
+              << " instructions=" << perf.instructions()
+              << " cache-misses=" << perf.cacheMisses() << std::endl;
+    // The loop runs 1000 iterations, so it takes more than 1000 instructions.
+    if (perf.available(MyHelper::PerfCounters::CYCLES))
+    {
+        EXPECT_GT(perf.cycles(), 0);
+    }
+    if (perf.available(MyHelper::PerfCounters::INSTRUCTIONS))
+    {
+        EXPECT_GT(perf.instructions(), 1000);
+    }
+}
@@ -0,0 +1,156 @@
+#pragma once
+#include <random>
+#include <cstring>
+#include "gtest/gtest.h"
+#include "datetime_binary.h"
+
+using namespace EZ;
+
+TEST(TestBinary, Values)
+{
+    const Datetime local(2021, 3, 8, 9, 30, 15);
+    const Datetime utc(1969, 12, 31, 23, 59, 59, true);
+    const Datetime minimum(time_t(DatetimeConstants::MINIMUM_SEC), true);
+    const Datetime maximum(time_t(DatetimeConstants::MAXIMUM_SEC));
+    const TimeDelta delta(-3, 4, 5, 6);
+    const Binary::Mode modes[] = {Binary::FIXED, Binary::VARINT};
+    for (const auto &mode : modes)
+    {
+        std::vector<unsigned char> buffer;
+        Binary::write(buffer, local, mode);
+        Binary::write(buffer, utc, mode);
+        Binary::write(buffer, minimum, mode);
+        Binary::write(buffer, maximum, mode);
+        Binary::write(buffer, delta, mode);
+        Binary::Reader reader(buffer);
+        const Datetime a = reader.readDatetime(mode);
+        const Datetime b = reader.readDatetime(mode);
+        EXPECT_EQ(a, local);
+        EXPECT_FALSE(a.isUTC());
+        EXPECT_EQ(b, utc);
+        EXPECT_TRUE(b.isUTC());
+        EXPECT_EQ(reader.readDatetime(mode), minimum);
+        EXPECT_EQ(reader.readDatetime(mode), maximum);
+        EXPECT_EQ(reader.readTimeDelta(mode), delta);
+        EXPECT_TRUE(reader.atEnd());
+        EXPECT_EQ(reader.position(), buffer.size());
+    }
+
+    // Little endian regardless of the CPU.
+    std::vector<unsigned char> buffer;
+    Binary::write(buffer, Datetime(time_t(0x0102), true));
+    const unsigned char expected[] = {0x05, 0x02, 0, 0, 0, 0, 0, 0};
+    ASSERT_EQ(buffer.size(), 8u);
+    EXPECT_EQ(std::memcmp(buffer.data(), expected, 8), 0);
+    buffer.clear();
+    Binary::write(buffer, TimeDelta(-1), Binary::VARINT);
+    ASSERT_EQ(buffer.size(), 1u);
+    EXPECT_EQ(buffer[0], 1);
+}
+
+TEST(TestBinary, Arrays)
+{
+    std::mt19937_64 random(29);
+    std::vector<Datetime> times;
+    std::vector<TimeDelta> deltas;
+    long long t = Datetime(2021, 3, 8, 0, 0, 0, true).unixTime();
+    for (int i = 0; i < 1000; i++)
+    {
+        t += (long long)(random() % 120) - 10;
+        times.push_back(Datetime(time_t(t), random() % 2 == 0));
+        deltas.push_back(TimeDelta((long long)(random() % 100000) - 50000));
+    }
+    std::vector<unsigned char> fixed, varint;
+    Binary::write(fixed, times, Binary::FIXED);
+    Binary::write(fixed, deltas, Binary::FIXED);
+    Binary::write(varint, times, Binary::VARINT);
+    Binary::write(varint, deltas, Binary::VARINT);
+    EXPECT_EQ(fixed.size(), 8u * (2 + 2 * times.size()));
+    EXPECT_LT(varint.size(), fixed.size() / 3);
+
+    Binary::Reader fixedReader(fixed);
+    const auto fixedTimes = fixedReader.readDatetimes(Binary::FIXED);
+    const auto fixedDeltas = fixedReader.readTimeDeltas(Binary::FIXED);
+    EXPECT_TRUE(fixedReader.atEnd());
+    Binary::Reader varintReader(varint);
+    const auto varintTimes = varintReader.readDatetimes(Binary::VARINT);
+    const auto varintDeltas = varintReader.readTimeDeltas(Binary::VARINT);
+    EXPECT_TRUE(varintReader.atEnd());
+    ASSERT_EQ(fixedTimes.size(), times.size());
+    ASSERT_EQ(varintTimes.size(), times.size());
+    for (size_t i = 0; i < times.size(); i++)
+    {
+        EXPECT_EQ(fixedTimes[i], times[i]);
+        EXPECT_EQ(fixedTimes[i].isUTC(), times[i].isUTC());
+        EXPECT_EQ(varintTimes[i], times[i]);
+        EXPECT_EQ(varintTimes[i].isUTC(), times[i].isUTC());
+    }
+    EXPECT_EQ(fixedDeltas, deltas);
+    EXPECT_EQ(varintDeltas, deltas);
+
+    std::vector<unsigned char> empty;
+    Binary::write(empty, std::vector<Datetime>(), Binary::VARINT);
+    Binary::Reader emptyReader(empty);
+    EXPECT_TRUE(emptyReader.readDatetimes(Binary::VARINT).empty());
+}
+
+TEST(TestBinary, Views)
+{
+    const std::vector<Datetime> times = {Datetime(2021, 3, 8, 9, 0, 0, true), Datetime(1900, 1, 1, 0, 0, 0), Datetime(2100, 12, 31, 23, 59, 59, true)};
+    const std::vector<TimeDelta> deltas = {TimeDelta(-7), TimeDelta(1, 2, 3, 4)};
+    // A header before the arrays, so that they are not aligned.
+    std::vector<unsigned char> buffer(3, 0xAB);
+    Binary::write(buffer, times);
+    Binary::write(buffer, deltas);
+    Binary::Reader reader(buffer.data() + 3, buffer.size() - 3);
+    const Binary::DatetimeView timeView = reader.viewDatetimes();
+    const Binary::TimeDeltaView deltaView = reader.viewTimeDeltas();
+    EXPECT_TRUE(reader.atEnd());
+    ASSERT_EQ(timeView.size(), times.size());
+    for (size_t i = 0; i < times.size(); i++)
+    {
+        EXPECT_EQ(timeView[i], times[i]);
+        EXPECT_EQ(timeView.unixTime(i), times[i].unixTime());
+        EXPECT_EQ(timeView.isUTC(i), times[i].isUTC());
+    }
+    ASSERT_EQ(deltaView.size(), deltas.size());
+    EXPECT_EQ(deltaView[0], deltas[0]);
+    EXPECT_EQ(deltaView.totalSeconds(1), deltas[1].totalSeconds());
+    // Views refer to the buffer.
+    EXPECT_EQ(buffer.size(), 3u + 8u * (2 + times.size() + deltas.size()));
+}
+
+TEST(TestBinary, Corrupted)
+{
+    std::vector<unsigned char> buffer;
+    Binary::write(buffer, std::vector<Datetime>(10, Datetime(2021, 3, 8, 0, 0, 0, true)), Binary::VARINT);
+    for (size_t size = 0; size < buffer.size(); size++)
+    {
+        Binary::Reader reader(buffer.data(), size);
+        EXPECT_THROW(reader.readDatetimes(Binary::VARINT), DatetimeException) << size;
+    }
+    buffer.clear();
+    Binary::write(buffer, std::vector<TimeDelta>(4, TimeDelta(60)));
+    for (size_t size = 0; size < buffer.size(); size++)
+    {
+        Binary::Reader reader(buffer.data(), size);
+        EXPECT_THROW(reader.viewTimeDeltas(), DatetimeException) << size;
+    }
+
+    // Huge counts and endless varints.
+    const std::vector<unsigned char> huge = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+    EXPECT_THROW(Binary::Reader(huge).readDatetimes(Binary::FIXED), DatetimeException);
+    const std::vector<unsigned char> endless(11, 0x80);
+    EXPECT_THROW(Binary::Reader(endless).readTimeDelta(Binary::VARINT), DatetimeException);
+    // Out of the range of Datetime.
+    std::vector<unsigned char> outOfRange;
+    Binary::write(outOfRange, TimeDelta((DatetimeConstants::MAXIMUM_SEC + 1) * 2), Binary::VARINT);
+    EXPECT_THROW(Binary::Reader(outOfRange).readDatetime(Binary::VARINT), DatetimeException);
+    // Differences out of the range of Datetime (2 elements: 1970/1/1 UTC, then the largest differences).
+    const unsigned char lastBytes[] = {0x01, 0x00};
+    for (const unsigned char &last : lastBytes)
+    {
+        std::vector<unsigned char> corrupted = {0x02, 0x01, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, last};
+        EXPECT_THROW(Binary::Reader(corrupted).readDatetimes(Binary::VARINT), DatetimeException);
+    }
+}
@@ -0,0 +1,154 @@
+#pragma once
+#include <memory>
+#include "gtest/gtest.h"
+#include "business_calendar.h"
+
+using namespace EZ;
+
+namespace MyHelper
+{
+    // 1日ずつ進めて数える (BusinessCalendar との比較用)
+    inline bool isBusinessDayByStep(const Datetime &date, const int &weekendMask, const std::set<std::string> &holidays)
+    {
+        return !((weekendMask >> date.daysOfWeek()) & 1) && holidays.count(date.str("%Y/%m/%d")) == 0;
+    }
+}
+
+TEST(TestBusinessCalendar, Weekends)
+{
+    BusinessCalendar calendar;
+    EXPECT_EQ(calendar.weekendMask(), BusinessCalendar::SATURDAY | BusinessCalendar::SUNDAY);
+    const Datetime friday(2021, 3, 5, 15, 0, 0, true);
+    const Datetime saturday(2021, 3, 6, 15, 0, 0, true);
+    EXPECT_TRUE(calendar.isBusinessDay(friday));
+    EXPECT_FALSE(calendar.isBusinessDay(saturday));
+    EXPECT_FALSE(calendar.isBusinessDay(Datetime(2021, 3, 7, 0, 0, 0, true)));
+
+    EXPECT_EQ(calendar.addBusinessDays(friday, 1), Datetime(2021, 3, 8, 15, 0, 0, true));
+    EXPECT_EQ(calendar.addBusinessDays(friday, 0), friday);
+    EXPECT_EQ(calendar.addBusinessDays(friday, -5), Datetime(2021, 2, 26, 15, 0, 0, true));
+    EXPECT_EQ(calendar.addBusinessDays(saturday, 0), Datetime(2021, 3, 8, 15, 0, 0, true));
+    EXPECT_EQ(calendar.addBusinessDays(saturday, 1), Datetime(2021, 3, 9, 15, 0, 0, true));
+    EXPECT_EQ(calendar.addBusinessDays(saturday, -1), friday);
+    EXPECT_TRUE(calendar.addBusinessDays(saturday, 1).isUTC());
+
+    EXPECT_EQ(calendar.businessDaysBetween(friday, Datetime(2021, 3, 12, 0, 0, 0, true)), 5);
+    EXPECT_EQ(calendar.businessDaysBetween(Datetime(2021, 3, 12, 0, 0, 0, true), friday), -5);
+    EXPECT_EQ(calendar.businessDaysBetween(saturday, saturday), 0);
+    EXPECT_EQ(calendar.businessDaysBetween(Datetime(1970, 1, 1, 0, 0, 0, true), Datetime(2970, 1, 1, 0, 0, 0, true)), 260887);
+
+    BusinessCalendar gulf(BusinessCalendar::FRIDAY | BusinessCalendar::SATURDAY);
+    EXPECT_FALSE(gulf.isBusinessDay(friday));
+    EXPECT_TRUE(gulf.isBusinessDay(Datetime(2021, 3, 7, 0, 0, 0, true)));
+    EXPECT_EQ(gulf.addBusinessDays(Datetime(2021, 3, 4, 0, 0, 0, true), 1), Datetime(2021, 3, 7, 0, 0, 0, true));
+    EXPECT_THROW(BusinessCalendar(0x7F), DatetimeException);
+
+    // Whole range of Datetime.
+    EXPECT_EQ(calendar.addBusinessDays(Datetime::minimum(true), 1), Datetime(DatetimeConstants::MINIMUM_YEAR, 1, 4, 0, 0, 0, true));
+    EXPECT_THROW(calendar.addBusinessDays(Datetime::maximum(true), 1), DatetimeException);
+}
+
+TEST(TestBusinessCalendar, Holidays)
+{
+    BusinessCalendar calendar;
+    calendar.addHoliday(2021, 1, 1);
+    calendar.addHolidays({Datetime(2021, 12, 24, 0, 0, 0, true), Datetime(2021, 12, 25, 0, 0, 0, true)});
+    EXPECT_TRUE(calendar.isHoliday(Datetime(2021, 1, 1, 12, 0, 0, true)));
+    EXPECT_FALSE(calendar.isBusinessDay(Datetime(2021, 1, 1, 12, 0, 0, true)));
+    EXPECT_EQ(calendar.addBusinessDays(Datetime(2020, 12, 31, 9, 0, 0, true), 1), Datetime(2021, 1, 4, 9, 0, 0, true));
+    EXPECT_EQ(calendar.addBusinessDays(Datetime(2021, 1, 4, 9, 0, 0, true), -1), Datetime(2020, 12, 31, 9, 0, 0, true));
+    EXPECT_EQ(calendar.addBusinessDays(Datetime(2021, 12, 23, 0, 0, 0, true), 1), Datetime(2021, 12, 27, 0, 0, 0, true));
+    // Dec 25 is Saturday, so only two holidays are on weekdays.
+    EXPECT_EQ(calendar.businessDaysBetween(Datetime(2021, 1, 1, 0, 0, 0, true), Datetime(2022, 1, 1, 0, 0, 0, true)), 259);
+    EXPECT_EQ(calendar.businessDaysBetween(Datetime(2000, 1, 1, 0, 0, 0, true), Datetime(2040, 1, 1, 0, 0, 0, true)),
+              BusinessCalendar().businessDaysBetween(Datetime(2000, 1, 1, 0, 0, 0, true), Datetime(2040, 1, 1, 0, 0, 0, true)) - 2);
+
+    calendar.removeHoliday(Datetime(2021, 1, 1, 0, 0, 0, true));
+    EXPECT_TRUE(calendar.isBusinessDay(Datetime(2021, 1, 1, 12, 0, 0, true)));
+    EXPECT_THROW(calendar.addHoliday(2021, 2, 29), DatetimeException);
+    EXPECT_THROW(calendar.addHoliday(12021, 1, 1), DatetimeException);
+    EXPECT_FALSE(calendar.isHoliday(Datetime(12021, 1, 1, 0, 0, 0, true)));
+
+    // A year of holidays: the result is far from the estimate by the business days per week.
+    BusinessCalendar closed;
+    std::vector<Datetime> year;
+    for (long long i = 0; i < 365; i++)
+    {
+        year.push_back(Datetime(2021, 1, 1, 0, 0, 0, true) + i * 86400);
+    }
+    closed.addHolidays(year);
+    EXPECT_EQ(closed.addBusinessDays(Datetime(2020, 12, 31, 0, 0, 0, true), 1), Datetime(2022, 1, 3, 0, 0, 0, true));
+    EXPECT_EQ(closed.addBusinessDays(Datetime(2022, 1, 3, 0, 0, 0, true), -1), Datetime(2020, 12, 31, 0, 0, 0, true));
+
+    // Local dates keep the time of day.
+    BusinessCalendar local;
+    local.addHoliday(Datetime(2021, 3, 15, 0, 0, 0, false));
+    EXPECT_EQ(local.addBusinessDays(Datetime(2021, 3, 12, 12, 0, 0, false), 1), Datetime(2021, 3, 16, 12, 0, 0, false));
+}
+
+TEST(TestBusinessCalendar, CompareWithStepping)
+{
+    const int masks[] = {BusinessCalendar::SATURDAY | BusinessCalendar::SUNDAY, BusinessCalendar::FRIDAY, BusinessCalendar::SUNDAY | BusinessCalendar::MONDAY | BusinessCalendar::WEDNESDAY};
+    for (const int &mask : masks)
+    {
+        BusinessCalendar calendar(mask);
+        std::set<std::string> holidays;
+        std::vector<Datetime> dates;
+        for (long long i = 0; i < 60; i++)
+        {
+            Datetime holiday = Datetime(2019, 11, 1, 0, 0, 0, true) + (i * 7919 % 900) * 86400;
+            holidays.insert(holiday.str("%Y/%m/%d"));
+            dates.push_back(holiday);
+        }
+        calendar.addHolidays(dates);
+
+        const Datetime start(2019, 6, 1, 10, 0, 0, true);
+        std::vector<Datetime> businessDays;
+        for (long long i = 0; i < 1500; i++)
+        {
+            const Datetime date = start + i * 86400;
+            const bool expected = MyHelper::isBusinessDayByStep(date, mask, holidays);
+            ASSERT_EQ(calendar.isBusinessDay(date), expected) << date;
+            if (expected)
+            {
+                businessDays.push_back(date);
+            }
+        }
+        for (size_t i = 0; i < businessDays.size(); i += 7)
+        {
+            for (size_t j = 0; j < businessDays.size(); j += 11)
+            {
+                ASSERT_EQ(calendar.addBusinessDays(businessDays[i], (long long)j - (long long)i), businessDays[j]);
+                ASSERT_EQ(calendar.businessDaysBetween(businessDays[i], businessDays[j]), (long long)j - (long long)i);
+            }
+        }
+    }
+}
+
+TEST(TestBusinessCalendar, Bulk)
+{
+    BusinessCalendar calendar;
+    calendar.addHolidays({Datetime(2021, 1, 1, 0, 0, 0, true), Datetime(2021, 5, 3, 0, 0, 0, true)});
+    std::vector<long long> times;
+    for (long long i = 0; i < 1000; i++)
+    {
+        times.push_back(Datetime(2020, 9, 1, 0, 0, 0, true).unixTime() + i * 37931);
+    }
+    const long long utcOffset = 9 * 3600;
+    std::vector<long long> settled(times.size());
+    std::vector<long long> between(times.size());
+    std::unique_ptr<bool[]> business(new bool[times.size()]);
+    calendar.addBusinessDays(times.data(), times.size(), 2, settled.data(), utcOffset);
+    calendar.businessDaysBetween(times.data(), settled.data(), times.size(), between.data(), utcOffset);
+    calendar.isBusinessDay(times.data(), times.size(), business.get(), utcOffset);
+    for (size_t i = 0; i < times.size(); i++)
+    {
+        // The dates of the calendar of UTC+9 are the dates of UTC at the shifted time.
+        const Datetime shifted(time_t(times[i] + utcOffset), true);
+        EXPECT_EQ(settled[i] + utcOffset, calendar.addBusinessDays(shifted, 2).unixTime()) << i;
+        EXPECT_EQ(business[i], calendar.isBusinessDay(shifted)) << i;
+        EXPECT_EQ(between[i], 2) << i;
+    }
+    long long tooLate = DatetimeConstants::MAXIMUM_SEC;
+    EXPECT_THROW(calendar.addBusinessDays(&tooLate, 1, 1, &tooLate), DatetimeException);
+}
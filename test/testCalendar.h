@@ -0,0 +1,315 @@
+#pragma once
+#include "gtest/gtest.h"
+#include "datetime.h"
+#include "calendar.h"
+
+using namespace EZ;
+
+TEST(TestCalendar, AddMonths)
+{
+    const Datetime jan31(2021, 1, 31, 12, 30, 15, true);
+    EXPECT_EQ(jan31.addMonths(1), Datetime(2021, 2, 28, 12, 30, 15, true));
+    EXPECT_EQ(jan31.addMonths(1, Calendar::CARRY_OVER), Datetime(2021, 3, 3, 12, 30, 15, true));
+    EXPECT_EQ(jan31.addMonths(1, Calendar::KEEP_END_OF_MONTH), Datetime(2021, 2, 28, 12, 30, 15, true));
+    EXPECT_EQ(jan31.addMonths(13), Datetime(2022, 2, 28, 12, 30, 15, true));
+    EXPECT_EQ(jan31.addMonths(37), Datetime(2024, 2, 29, 12, 30, 15, true));
+    EXPECT_EQ(jan31.addMonths(-2), Datetime(2020, 11, 30, 12, 30, 15, true));
+    EXPECT_EQ(jan31.addMonths(-13), Datetime(2019, 12, 31, 12, 30, 15, true));
+    EXPECT_EQ(jan31.addMonths(0), jan31);
+    EXPECT_TRUE(jan31.addMonths(1).isUTC());
+
+    const Datetime feb28(2021, 2, 28, 0, 0, 0, true);
+    EXPECT_EQ(feb28.addMonths(1), Datetime(2021, 3, 28, 0, 0, 0, true));
+    EXPECT_EQ(feb28.addMonths(1, Calendar::KEEP_END_OF_MONTH), Datetime(2021, 3, 31, 0, 0, 0, true));
+
+    const Datetime leap(2020, 2, 29, 0, 0, 0, true);
+    EXPECT_EQ(leap.addYears(1), Datetime(2021, 2, 28, 0, 0, 0, true));
+    EXPECT_EQ(leap.addYears(1, Calendar::CARRY_OVER), Datetime(2021, 3, 1, 0, 0, 0, true));
+    EXPECT_EQ(leap.addYears(4), Datetime(2024, 2, 29, 0, 0, 0, true));
+    EXPECT_EQ(leap.addYears(-2020), Datetime(0, 2, 29, 0, 0, 0, true));
+
+    EXPECT_THROW(Datetime::maximum(true).addMonths(1), DatetimeException);
+    EXPECT_THROW(Datetime::minimum(true).addYears(-1), DatetimeException);
+    EXPECT_THROW(jan31.addMonths(std::numeric_limits<long long>::max()), DatetimeException);
+    EXPECT_THROW(jan31.addYears(std::numeric_limits<long long>::min()), DatetimeException);
+
+    // Local time keeps the local fields.
+    const Datetime local(2021, 1, 31, 12, 0, 0, false);
+    EXPECT_EQ(local.addMonths(1), Datetime(2021, 2, 28, 12, 0, 0, false));
+    EXPECT_EQ(local.addMonths(6), Datetime(2021, 7, 31, 12, 0, 0, false));
+    EXPECT_EQ(local.addYears(-1).toVector(), std::vector<int>({2020, 1, 31, 12, 0, 0}));
+    EXPECT_FALSE(local.addMonths(1).isUTC());
+}
+
+TEST(TestCalendar, MonthBoundaries)
+{
+    const Datetime time(2024, 2, 10, 13, 45, 0, true);
+    EXPECT_EQ(time.startOfMonth(), Datetime(2024, 2, 1, 0, 0, 0, true));
+    EXPECT_EQ(time.endOfMonth(), Datetime(2024, 2, 29, 23, 59, 59, true));
+    EXPECT_EQ(Datetime(1969, 12, 31, 23, 59, 59, true).startOfMonth(), Datetime(1969, 12, 1, 0, 0, 0, true));
+    EXPECT_EQ(Datetime(1969, 12, 1, 0, 0, 0, true).endOfMonth(), Datetime(1969, 12, 31, 23, 59, 59, true));
+    EXPECT_EQ(Datetime::maximum(true).endOfMonth(), Datetime::maximum(true));
+    EXPECT_EQ(Datetime::minimum(true).startOfMonth(), Datetime::minimum(true));
+
+    const Datetime local(2021, 7, 15, 12, 0, 0, false);
+    EXPECT_EQ(local.startOfMonth().toVector(), std::vector<int>({2021, 7, 1, 0, 0, 0}));
+    EXPECT_EQ(local.endOfMonth().toVector(), std::vector<int>({2021, 7, 31, 23, 59, 59}));
+}
+
+TEST(TestCalendar, Bulk)
+{
+    // Compare with the calendar of struct tm for every day of 400 years.
+    std::vector<long long> times;
+    for (long long days = -73000; days < -73000 + DatetimeConstants::DAYS_PER_400_YEARS; days += 3)
+    {
+        times.push_back(days * DatetimeConstants::SECONDS_PER_DAY + 3723);
+    }
+    for (const long long &months : {1LL, -1LL, 11LL, 12LL, -25LL})
+    {
+        std::vector<long long> out(times.size());
+        Calendar::addMonths(times.data(), times.size(), months, out.data());
+        for (size_t i = 0; i < times.size(); i++)
+        {
+            struct tm time = MyTM::my_gmtime(times[i]);
+            long long total = (time.tm_year + DatetimeConstants::TM_BASE_YEAR) * 12LL + time.tm_mon + months;
+            time.tm_year = int(MyTM::floorDiv(total, 12) - DatetimeConstants::TM_BASE_YEAR);
+            time.tm_mon = int(total - MyTM::floorDiv(total, 12) * 12);
+            const int lastDay = MyTM::daysInMonth(time.tm_year + DatetimeConstants::TM_BASE_YEAR, time.tm_mon + 1);
+            time.tm_mday = time.tm_mday < lastDay ? time.tm_mday : lastDay;
+            ASSERT_EQ(out[i], MyTM::my_timegm(time)) << times[i] << " + " << months;
+        }
+    }
+
+    // In place with a fixed UTC offset.
+    std::vector<long long> billing = {Datetime(2021, 1, 31, 0, 0, 0, true).unixTime() - 32400,
+                                      Datetime(2021, 4, 30, 0, 0, 0, true).unixTime() - 32400};
+    Calendar::addMonths(billing.data(), billing.size(), 1, billing.data(), Calendar::KEEP_END_OF_MONTH, 32400);
+    EXPECT_EQ(billing[0], Datetime(2021, 2, 28, 0, 0, 0, true).unixTime() - 32400);
+    EXPECT_EQ(billing[1], Datetime(2021, 5, 31, 0, 0, 0, true).unixTime() - 32400);
+    Calendar::addYears(billing.data(), billing.size(), 1, billing.data(), Calendar::CLAMP, 32400);
+    EXPECT_EQ(billing[0], Datetime(2022, 2, 28, 0, 0, 0, true).unixTime() - 32400);
+
+    std::vector<long long> boundaries = {Datetime(2021, 2, 10, 13, 45, 0, true).unixTime(), -1};
+    std::vector<long long> out(boundaries.size());
+    Calendar::startOfMonth(boundaries.data(), boundaries.size(), out.data());
+    EXPECT_EQ(out, std::vector<long long>({Datetime(2021, 2, 1, 0, 0, 0, true).unixTime(), Datetime(1969, 12, 1, 0, 0, 0, true).unixTime()}));
+    Calendar::endOfMonth(boundaries.data(), boundaries.size(), out.data());
+    EXPECT_EQ(out, std::vector<long long>({Datetime(2021, 2, 28, 23, 59, 59, true).unixTime(), -1}));
+
+    std::vector<long long> extreme = {0, DatetimeConstants::MAXIMUM_SEC};
+    EXPECT_THROW(Calendar::addMonths(extreme.data(), extreme.size(), 1, out.data()), DatetimeException);
+    EXPECT_NO_THROW(Calendar::addMonths(extreme.data(), 0, 1, out.data()));
+}
+
+TEST(TestCalendar, IsoWeekDate)
+{
+    struct Case
+    {
+        int year, mon, day;
+        long long isoYear;
+        int week, weekday;
+    };
+    const std::vector<Case> cases = {
+        {2021, 1, 1, 2020, 53, 5},
+        {2021, 1, 4, 2021, 1, 1},
+        {2020, 12, 31, 2020, 53, 4},
+        {2024, 12, 30, 2025, 1, 1},
+        {2008, 12, 29, 2009, 1, 1},
+        {2010, 1, 3, 2009, 53, 7},
+        {1969, 12, 29, 1970, 1, 1},
+        {2000, 2, 29, 2000, 9, 2},
+        {0, 1, 1, -1, 52, 6},
+    };
+    for (const auto &c : cases)
+    {
+        long long isoYear;
+        int week, weekday;
+        const long long days = MyTM::daysFromCivil(c.year, c.mon, c.day);
+        Calendar::isoWeekDate(days, isoYear, week, weekday);
+        EXPECT_EQ(isoYear, c.isoYear) << c.year << "/" << c.mon << "/" << c.day;
+        EXPECT_EQ(week, c.week) << c.year << "/" << c.mon << "/" << c.day;
+        EXPECT_EQ(weekday, c.weekday) << c.year << "/" << c.mon << "/" << c.day;
+        EXPECT_EQ(Calendar::daysFromIsoWeekDate(isoYear, week, weekday), days);
+    }
+    EXPECT_EQ(Calendar::isoWeeksInYear(2020), 53);
+    EXPECT_EQ(Calendar::isoWeeksInYear(2021), 52);
+    EXPECT_EQ(Calendar::isoWeeksInYear(2015), 53);
+    EXPECT_EQ(Calendar::isoWeeksInYear(2026), 53);
+
+    // Compare with strftime() for every day of 400 years.
+    for (long long days = -146097; days < 146097 * 2; days += 2)
+    {
+        struct tm time = MyTM::my_gmtime(days * DatetimeConstants::SECONDS_PER_DAY);
+        char expected[32];
+        strftime(expected, sizeof(expected), "%G-%V-%u", &time);
+        long long isoYear;
+        int week, weekday;
+        Calendar::isoWeekDate(days, isoYear, week, weekday);
+        char actual[32];
+        snprintf(actual, sizeof(actual), "%04lld-%02d-%d", isoYear, week, weekday);
+        ASSERT_STREQ(actual, expected) << days;
+    }
+
+    const Datetime time(2021, 1, 1, 0, 0, 0, true);
+    EXPECT_EQ(time.weeksOfYear(), 53);
+    EXPECT_EQ(time.isoYear(), 2020);
+    EXPECT_EQ(time.daysOfYear(), 1);
+    EXPECT_EQ(Datetime(2020, 12, 31, 23, 59, 59, true).daysOfYear(), 366);
+    const Datetime local(2024, 12, 30, 12, 0, 0, false);
+    EXPECT_EQ(local.weeksOfYear(), 1);
+    EXPECT_EQ(local.isoYear(), 2025);
+    EXPECT_EQ(local.daysOfYear(), 365);
+}
+
+TEST(TestCalendar, IsoWeekSpecifiers)
+{
+    const Datetime time(2021, 1, 1, 0, 0, 0, true);
+    EXPECT_EQ(time.str("%G-W%V-%u"), "2020-W53-5");
+    EXPECT_EQ(Datetime(2021, 3, 8, 0, 0, 0, true).str("%Y/%m/%d %G-W%V-%u"), "2021/03/08 2021-W10-1");
+    EXPECT_EQ(Datetime(2021, 3, 7, 0, 0, 0, true).str("%u"), "7");
+
+    EXPECT_EQ(Datetime("2020-W53-5", "%G-W%V-%u", true), time);
+    EXPECT_EQ(Datetime("2021-W01", "%G-W%V", true), Datetime(2021, 1, 4, 0, 0, 0, true));
+    EXPECT_EQ(Datetime("2025-W01-7 12:30", "%G-W%V-%u %H:%M", true), Datetime(2025, 1, 5, 12, 30, 0, true));
+    EXPECT_EQ(Datetime("2021/03/08 1", "%Y/%m/%d %u", true), Datetime(2021, 3, 8, 0, 0, 0, true));
+    EXPECT_THROW(Datetime("2021/03/08 2", "%Y/%m/%d %u", true), DatetimeException);
+    EXPECT_THROW(Datetime("2021-W53-1", "%G-W%V-%u", true), DatetimeException);
+    EXPECT_THROW(Datetime("2021-W00-1", "%G-W%V-%u", true), DatetimeException);
+    EXPECT_THROW(Datetime("2021-W10-8", "%G-W%V-%u", true), DatetimeException);
+    EXPECT_THROW(Datetime("2021-W10-1 2021", "%G-W%V-%u %Y", true), DatetimeException);
+    EXPECT_THROW(Datetime("2021-W10 03/08", "%G-W%V %m/%d", true), DatetimeException);
+
+    auto format = CompiledFormat::compile("%G-W%V-%u");
+    long long unixTime = 0;
+    EXPECT_TRUE(format.tryParse("2020-W53-5", true, unixTime));
+    EXPECT_EQ(unixTime, time.unixTime());
+}
+
+TEST(TestCalendar, IsoWeekBulk)
+{
+    std::vector<long long> times;
+    for (long long t = -5000000000LL; t < 5000000000LL; t += 86400 * 3 + 3607)
+    {
+        times.push_back(t);
+    }
+    for (const long long &utcOffset : {0LL, 32400LL, -16200LL})
+    {
+        std::vector<long long> isoYears(times.size()), starts(times.size());
+        std::vector<int> weeks(times.size());
+        Calendar::isoWeeks(times.data(), times.size(), isoYears.data(), weeks.data(), utcOffset);
+        Calendar::isoWeekStarts(times.data(), times.size(), starts.data(), utcOffset);
+        for (size_t i = 0; i < times.size(); i++)
+        {
+            const long long days = MyTM::floorDiv(times[i] + utcOffset, DatetimeConstants::SECONDS_PER_DAY);
+            long long isoYear;
+            int week, weekday;
+            Calendar::isoWeekDate(days, isoYear, week, weekday);
+            ASSERT_EQ(isoYears[i], isoYear) << times[i];
+            ASSERT_EQ(weeks[i], week) << times[i];
+            ASSERT_EQ(starts[i], (days - weekday + 1) * DatetimeConstants::SECONDS_PER_DAY - utcOffset) << times[i];
+        }
+    }
+
+    // The extremes of the range.
+    const long long extremes[] = {DatetimeConstants::MINIMUM_SEC, DatetimeConstants::MAXIMUM_SEC};
+    long long isoYears[2];
+    int weeks[2];
+    Calendar::isoWeeks(extremes, 2, isoYears, weeks);
+    EXPECT_EQ(isoYears[0], DatetimeConstants::MINIMUM_YEAR - 1);
+    EXPECT_EQ(weeks[0], 53);
+    EXPECT_EQ(Datetime::minimum(true).str("%G-%V"), std::to_string(isoYears[0]) + "-53");
+    EXPECT_EQ(isoYears[1], DatetimeConstants::MAXIMUM_YEAR + 1);
+    EXPECT_EQ(weeks[1], 1);
+    EXPECT_EQ(Datetime::maximum(true).str("%G-%V"), std::to_string(isoYears[1]) + "-01");
+}
+
+TEST(TestCalendar, FloorCeilRound)
+{
+    const Datetime time(2021, 3, 8, 13, 47, 15, true);
+    EXPECT_EQ(time.floor(Calendar::SECOND), time);
+    EXPECT_EQ(time.floor(Calendar::SECOND, 10), Datetime(2021, 3, 8, 13, 47, 10, true));
+    EXPECT_EQ(time.floor(Calendar::MINUTE), Datetime(2021, 3, 8, 13, 47, 0, true));
+    EXPECT_EQ(time.floor(Calendar::MINUTE, 5), Datetime(2021, 3, 8, 13, 45, 0, true));
+    EXPECT_EQ(time.floor(Calendar::HOUR), Datetime(2021, 3, 8, 13, 0, 0, true));
+    EXPECT_EQ(time.floor(Calendar::HOUR, 6), Datetime(2021, 3, 8, 12, 0, 0, true));
+    EXPECT_EQ(time.floor(Calendar::DAY), Datetime(2021, 3, 8, 0, 0, 0, true));
+    EXPECT_EQ(time.floor(Calendar::WEEK), Datetime(2021, 3, 8, 0, 0, 0, true));
+    EXPECT_EQ(Datetime(2021, 3, 7, 23, 0, 0, true).floor(Calendar::WEEK), Datetime(2021, 3, 1, 0, 0, 0, true));
+    EXPECT_EQ(time.floor(Calendar::MONTH), Datetime(2021, 3, 1, 0, 0, 0, true));
+    EXPECT_EQ(time.floor(Calendar::MONTH, 3), Datetime(2021, 1, 1, 0, 0, 0, true));
+    EXPECT_EQ(time.floor(Calendar::MONTH, 6), Datetime(2021, 1, 1, 0, 0, 0, true));
+    EXPECT_EQ(time.floor(Calendar::YEAR), Datetime(2021, 1, 1, 0, 0, 0, true));
+    EXPECT_EQ(time.floor(Calendar::YEAR, 10), Datetime(2020, 1, 1, 0, 0, 0, true));
+    EXPECT_EQ(Datetime(1969, 12, 31, 23, 59, 59, true).floor(Calendar::HOUR, 5), Datetime(1969, 12, 31, 19, 0, 0, true));
+    EXPECT_EQ(Datetime(-5, 3, 8, 0, 0, 0, true).floor(Calendar::YEAR, 10), Datetime(-10, 1, 1, 0, 0, 0, true));
+
+    EXPECT_EQ(time.ceil(Calendar::MINUTE, 5), Datetime(2021, 3, 8, 13, 50, 0, true));
+    EXPECT_EQ(time.ceil(Calendar::DAY), Datetime(2021, 3, 9, 0, 0, 0, true));
+    EXPECT_EQ(time.ceil(Calendar::MONTH, 3), Datetime(2021, 4, 1, 0, 0, 0, true));
+    EXPECT_EQ(time.ceil(Calendar::YEAR), Datetime(2022, 1, 1, 0, 0, 0, true));
+    EXPECT_EQ(time.floor(Calendar::HOUR).ceil(Calendar::HOUR), time.floor(Calendar::HOUR));
+
+    EXPECT_EQ(time.round(Calendar::MINUTE), Datetime(2021, 3, 8, 13, 47, 0, true));
+    EXPECT_EQ(time.round(Calendar::HOUR), Datetime(2021, 3, 8, 14, 0, 0, true));
+    EXPECT_EQ(time.round(Calendar::MONTH), Datetime(2021, 3, 1, 0, 0, 0, true));
+    EXPECT_EQ(Datetime(2021, 2, 15, 0, 0, 0, true).round(Calendar::MONTH), Datetime(2021, 3, 1, 0, 0, 0, true));
+    EXPECT_EQ(Datetime(2021, 3, 8, 12, 30, 0, true).round(Calendar::HOUR), Datetime(2021, 3, 8, 13, 0, 0, true));
+    EXPECT_EQ(Datetime(2021, 7, 1, 0, 0, 0, true).round(Calendar::YEAR), Datetime(2021, 1, 1, 0, 0, 0, true));
+    EXPECT_EQ(Datetime(2021, 7, 3, 0, 0, 0, true).round(Calendar::YEAR), Datetime(2022, 1, 1, 0, 0, 0, true));
+    EXPECT_TRUE(time.round(Calendar::DAY).isUTC());
+
+    EXPECT_THROW(time.floor(Calendar::MINUTE, 0), DatetimeException);
+    EXPECT_THROW(time.ceil(Calendar::Unit(99)), DatetimeException);
+    EXPECT_THROW(Datetime::maximum(true).ceil(Calendar::DAY, 2), DatetimeException);
+    EXPECT_EQ(Datetime::minimum(true).floor(Calendar::YEAR), Datetime::minimum(true));
+
+    // Local time is floored on the local calendar.
+    const Datetime local(2021, 7, 15, 13, 47, 15, false);
+    EXPECT_EQ(local.floor(Calendar::DAY).toVector(), std::vector<int>({2021, 7, 15, 0, 0, 0}));
+    EXPECT_EQ(local.floor(Calendar::HOUR).toVector(), std::vector<int>({2021, 7, 15, 13, 0, 0}));
+    EXPECT_EQ(local.ceil(Calendar::MONTH).toVector(), std::vector<int>({2021, 8, 1, 0, 0, 0}));
+    EXPECT_EQ(local.round(Calendar::WEEK).toVector(), std::vector<int>({2021, 7, 19, 0, 0, 0}));
+    EXPECT_FALSE(local.floor(Calendar::DAY).isUTC());
+}
+
+TEST(TestCalendar, FloorCeilRoundBulk)
+{
+    std::vector<long long> times;
+    for (long long t = -3000000000LL; t < 3000000000LL; t += 86400 * 2 + 1237)
+    {
+        times.push_back(t);
+    }
+    times.push_back(0);
+    times.push_back(-1);
+    const std::vector<std::pair<Calendar::Unit, long long>> units = {
+        {Calendar::SECOND, 1}, {Calendar::SECOND, 15}, {Calendar::MINUTE, 1}, {Calendar::MINUTE, 5}, {Calendar::HOUR, 1}, {Calendar::HOUR, 5}, {Calendar::DAY, 1}, {Calendar::DAY, 3}, {Calendar::WEEK, 1}, {Calendar::WEEK, 2}, {Calendar::MONTH, 1}, {Calendar::MONTH, 3}, {Calendar::YEAR, 1}, {Calendar::YEAR, 10}};
+    std::vector<long long> floors(times.size()), ceils(times.size()), rounds(times.size());
+    for (const long long &utcOffset : {0LL, 19800LL, -36000LL})
+    {
+        for (const auto &unit : units)
+        {
+            Calendar::floorTo(times.data(), times.size(), floors.data(), unit.first, unit.second, utcOffset);
+            Calendar::ceilTo(times.data(), times.size(), ceils.data(), unit.first, unit.second, utcOffset);
+            Calendar::roundTo(times.data(), times.size(), rounds.data(), unit.first, unit.second, utcOffset);
+            for (size_t i = 0; i < times.size(); i++)
+            {
+                ASSERT_EQ(floors[i], Calendar::floorTo(times[i], unit.first, unit.second, utcOffset)) << times[i] << " " << unit.first;
+                ASSERT_EQ(ceils[i], Calendar::ceilTo(times[i], unit.first, unit.second, utcOffset)) << times[i] << " " << unit.first;
+                ASSERT_EQ(rounds[i], Calendar::roundTo(times[i], unit.first, unit.second, utcOffset)) << times[i] << " " << unit.first;
+                ASSERT_LE(floors[i], times[i]);
+                ASSERT_GE(ceils[i], times[i]);
+            }
+        }
+    }
+
+    // Compare with formatting and parsing. ("%Y/%m/%d %H")
+    for (size_t i = 0; i < times.size(); i += 97)
+    {
+        const Datetime time(time_t(times[i]), true);
+        EXPECT_EQ(Datetime(time.str("%Y/%m/%d %H"), "%Y/%m/%d %H", true).unixTime(), Calendar::floorTo(times[i], Calendar::HOUR));
+    }
+
+    std::vector<long long> extreme = {DatetimeConstants::MAXIMUM_SEC};
+    EXPECT_THROW(Calendar::ceilTo(extreme.data(), extreme.size(), extreme.data(), Calendar::MINUTE), DatetimeException);
+    EXPECT_THROW(Calendar::floorTo(extreme.data(), extreme.size(), extreme.data(), Calendar::MINUTE, -1), DatetimeException);
+}
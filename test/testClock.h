@@ -0,0 +1,148 @@
+#pragma once
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include "gtest/gtest.h"
+#include "datetime.h"
+#include "timer_wheel.h"
+
+using namespace EZ;
+
+TEST(TestClock, RealClocks)
+{
+    const long long system = SystemClock().now();
+    CoarseClock coarse;
+    EXPECT_LE(std::abs(coarse.now() - system), 2);
+    EXPECT_LE(std::abs(coarse.update() - system), 2);
+    EXPECT_EQ(Datetime::now(coarse, true).unixTime(), coarse.now());
+    const AnchoredClock anchored;
+    EXPECT_LE(std::abs(anchored.now() - system), 2);
+    EXPECT_TRUE(Datetime::now(anchored, true).isUTC());
+    // Arguments other than clocks are the timezone setting, as before the clock overloads.
+    EXPECT_TRUE(Datetime::now(1).isUTC());
+    EXPECT_FALSE(Datetime::now(0).isUTC());
+}
+
+TEST(TestClock, ManualClock)
+{
+    ManualClock clock(Datetime(2021, 3, 8, 9, 0, 0, true).unixTime());
+    EXPECT_EQ(Datetime::now(clock, true), Datetime(2021, 3, 8, 9, 0, 0, true));
+    clock.advance(TimeDelta(1, 0, 0, 0));
+    EXPECT_EQ(Datetime::now(clock), Datetime(2021, 3, 9, 9, 0, 0, true));
+    clock.set(0);
+    EXPECT_EQ(clock.now(), 0);
+
+    // Formatters and the timer wheel read the clock.
+    size_t length;
+    clock.set(Datetime(1994, 11, 6, 8, 49, 37, true).unixTime());
+    EXPECT_STREQ(FixedFormat::httpDateNow(clock, length), "Sun, 06 Nov 1994 08:49:37 GMT");
+    EXPECT_EQ(length, strlen("Sun, 06 Nov 1994 08:49:37 GMT"));
+    TimerWheel<int> wheel(clock.now());
+    wheel.insertAfter(TimeDelta(0, 0, 30, 0), 1);
+    wheel.insertAfter(TimeDelta(0, 1, 0, 0), 2);
+    std::vector<int> expired;
+    clock.advance(1799);
+    EXPECT_EQ(wheel.poll(clock, expired), 0u);
+    clock.advance(1);
+    EXPECT_EQ(wheel.poll(clock, expired), 1u);
+    clock.advance(TimeDelta(0, 1, 0, 0));
+    EXPECT_EQ(wheel.poll(clock, [](std::vector<int> &batch) { EXPECT_EQ(batch, std::vector<int>({2})); }), 1u);
+}
+
+TEST(TestClock, SimulatedClock)
+{
+    // An hour per real second.
+    const long long start = Datetime(2021, 3, 8, 0, 0, 0, true).unixTime();
+    const auto realStart = std::chrono::steady_clock::now();
+    const SimulatedClock clock(start, 3600.0);
+    EXPECT_EQ(clock.speed(), 3600.0);
+    const long long first = clock.now();
+    EXPECT_GE(first, start);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    const long long second = clock.now();
+    const double real = std::chrono::duration<double>(std::chrono::steady_clock::now() - realStart).count();
+    // At least 50 ms (180 seconds), and at most the real time elapsed.
+    EXPECT_GE(second - first, 179);
+    EXPECT_LE(second - start, (long long)(real * 3600.0) + 1);
+}
+
+TEST(TestClock, AnchoredClock)
+{
+    EXPECT_THROW(AnchoredClock(0), DatetimeException);
+    EXPECT_THROW(AnchoredClock(100000, 1000), DatetimeException);
+    const bool useTsc[] = {true, false};
+    for (const auto &tsc : useTsc)
+    {
+        // Within 100 us, re-anchored every 10 ms at the most.
+        const long long maxDrift = 100000;
+        const AnchoredClock clock(maxDrift, 10000000, tsc);
+        if (!tsc)
+        {
+            EXPECT_FALSE(clock.usesTsc());
+        }
+        std::vector<std::thread> threads;
+        std::atomic<int> far(0);
+        for (int t = 0; t < 4; t++)
+        {
+            threads.push_back(std::thread([&clock, &far]() {
+                for (int i = 0; i < 50; i++)
+                {
+                    const long long system = SystemClock().unixNanoseconds();
+                    const long long anchored = clock.unixNanoseconds();
+                    // The bound plus the time between the two reads on a busy machine.
+                    if (std::abs(anchored - system) > 50000000)
+                    {
+                        far++;
+                    }
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            }));
+        }
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+        EXPECT_EQ(far.load(), 0);
+        EXPECT_GE(clock.numAnchors(), 2);
+        EXPECT_LE(clock.numSteps(), clock.numAnchors());
+
+        // After the warm-up, the drift found at each anchor stays within the bound, so the clock only slews.
+        const long long steps = clock.numSteps();
+        long long anchors = clock.numAnchors();
+        int drifted = 0;
+        for (int i = 0; i < 100; i++)
+        {
+            clock.unixNanoseconds();
+            if (clock.numAnchors() != anchors)
+            {
+                anchors = clock.numAnchors();
+                drifted += (std::abs(clock.lastDrift()) > maxDrift) ? 1 : 0;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        // One anchor may be measured across a preemption of the thread.
+        EXPECT_LE(drifted, 1);
+        EXPECT_LE(clock.numSteps() - steps, 1);
+        EXPECT_LE(std::abs(clock.lastDrift()), maxDrift);
+
+        long nanoseconds = -1;
+        const Datetime now = Datetime::now(clock, nanoseconds, true);
+        EXPECT_GE(nanoseconds, 0);
+        EXPECT_LT(nanoseconds, 1000000000);
+        EXPECT_LE(std::abs(now.unixTime() - SystemClock().now()), 2);
+        EXPECT_TRUE(now.isUTC());
+    }
+}
+
+TEST(TestClock, Nanoseconds)
+{
+    long nanoseconds = -1;
+    EXPECT_LE(std::abs(Datetime::now(SystemClock(), nanoseconds).unixTime() - SystemClock().now()), 2);
+    EXPECT_GE(nanoseconds, 0);
+    EXPECT_LT(nanoseconds, 1000000000);
+    // Before 1970: the fraction is positive.
+    const SimulatedClock stopped(-10, 0.0);
+    EXPECT_EQ(Datetime::now(stopped, nanoseconds, true), Datetime(time_t(-10), true));
+    EXPECT_EQ(nanoseconds, 0);
+    EXPECT_EQ(stopped.unixNanoseconds(), -10000000000LL);
+}
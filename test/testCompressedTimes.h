@@ -0,0 +1,81 @@
+#pragma once
+#include <climits>
+#include <random>
+#include "gtest/gtest.h"
+#include "compressed_times.h"
+
+using namespace EZ;
+
+TEST(TestCompressedTimes, RoundTrip)
+{
+    std::mt19937_64 random(29);
+    const long long start = Datetime(2021, 1, 1, 0, 0, 0, true).unixTime();
+    const size_t sizes[] = {0, 1, 2, 1023, 1024, 1025, 5000};
+    for (const size_t &size : sizes)
+    {
+        // Regular with jitter and gaps, random and extreme times.
+        std::vector<std::vector<long long>> columns(3);
+        long long t = start;
+        for (size_t i = 0; i < size; i++)
+        {
+            t += 10 + (random() % 50 == 0 ? (long long)(random() % 5) - 2 : 0) + (random() % 500 == 0 ? (long long)(random() % 100000) : 0);
+            columns[0].push_back(t);
+            columns[1].push_back((long long)random());
+            columns[2].push_back(i % 3 == 0 ? LLONG_MIN : (i % 3 == 1 ? LLONG_MAX : 0));
+        }
+        for (const auto &column : columns)
+        {
+            CompressedTimes compressed(column);
+            ASSERT_EQ(compressed.size(), column.size());
+            EXPECT_EQ(compressed.numBlocks(), (size + 1023) / 1024);
+            EXPECT_EQ(compressed.decode(), column) << size;
+            for (size_t i = 0; i < column.size(); i += 97)
+            {
+                ASSERT_EQ(compressed.at(i), column[i]) << i;
+            }
+            if (!column.empty())
+            {
+                EXPECT_EQ(compressed.at(column.size() - 1), column.back());
+            }
+        }
+    }
+    CompressedTimes empty;
+    EXPECT_TRUE(empty.decode().empty());
+    EXPECT_THROW(empty.at(0), DatetimeException);
+    EXPECT_THROW(CompressedTimes(std::vector<long long>(10)).decodeBlock(1, nullptr), DatetimeException);
+}
+
+TEST(TestCompressedTimes, Size)
+{
+    // Every second for a day: about 1 bit each.
+    std::vector<Datetime> regular;
+    for (long long i = 0; i < 86400; i++)
+    {
+        regular.push_back(Datetime(2021, 3, 8, 0, 0, 0, true) + i);
+    }
+    CompressedTimes compressed(regular);
+    EXPECT_LT(compressed.bitsPerTime(), 1.2);
+    EXPECT_LT(compressed.sizeInBytes(), regular.size() / 6);
+    EXPECT_EQ(compressed.at(3600), regular[3600].unixTime());
+
+    // Appending one by one is the same. Blocks decode independently.
+    CompressedTimes appended;
+    for (const auto &time : regular)
+    {
+        appended.append(time);
+    }
+    EXPECT_EQ(appended.sizeInBytes(), compressed.sizeInBytes());
+    std::vector<long long> block(CompressedTimes::BLOCK_SIZE);
+    EXPECT_EQ(appended.decodeBlock(84, block.data()), 384u);
+    EXPECT_EQ(block[0], regular[84 * 1024].unixTime());
+    EXPECT_EQ(block[383], regular.back().unixTime());
+
+    // Minutes with a second of jitter now and then: under 2 bits each.
+    std::mt19937_64 random(31);
+    std::vector<long long> jittered;
+    for (long long i = 0; i < 100000; i++)
+    {
+        jittered.push_back(1600000000 + i * 60 + (random() % 100 == 0 ? 1 : 0));
+    }
+    EXPECT_LT(CompressedTimes(jittered).bitsPerTime(), 2.0);
+}
@@ -0,0 +1,186 @@
+#pragma once
+#include "gtest/gtest.h"
+#include "cron_schedule.h"
+
+using namespace EZ;
+
+TEST(TestCronSchedule, Parse)
+{
+    EXPECT_EQ(CronSchedule("*/15 9-17 * * MON-FRI").expression(), "*/15 9-17 * * MON-FRI");
+    const std::vector<std::string> valids = {
+        "* * * * *",
+        "0 0 1 1 *",
+        "5,10,15-20/2 */3 1-31 jan-DEC sun-sat",
+        "0 0 * * 7",
+        "30 * * * * *",
+        "@yearly",
+        "@annually",
+        "@monthly",
+        "@weekly",
+        "@daily",
+        "@midnight",
+        "@hourly",
+        "  0   12 * *   1 ",
+    };
+    for (const auto &valid : valids)
+    {
+        EXPECT_NO_THROW(CronSchedule{valid}) << valid;
+    }
+    const std::vector<std::string> invalids = {
+        "",
+        "* * * *",
+        "* * * * * * *",
+        "60 * * * *",
+        "* 24 * * *",
+        "* * 0 * *",
+        "* * 32 * *",
+        "* * * 13 *",
+        "* * * * 8",
+        "5-1 * * * *",
+        "*/0 * * * *",
+        "1, * * * *",
+        "a * * * *",
+        "* * * JANUARY *",
+        "* * * * FOO",
+        "@every",
+    };
+    for (const auto &invalid : invalids)
+    {
+        EXPECT_THROW(CronSchedule{invalid}, DatetimeException) << invalid;
+    }
+}
+
+TEST(TestCronSchedule, Next)
+{
+    const Datetime monday(2021, 3, 8, 10, 7, 30, true);
+    EXPECT_EQ(CronSchedule("*/15 9-17 * * MON-FRI").next(monday), Datetime(2021, 3, 8, 10, 15, 0, true));
+    EXPECT_EQ(CronSchedule("*/15 9-17 * * MON-FRI").next(Datetime(2021, 3, 12, 17, 45, 0, true)), Datetime(2021, 3, 15, 9, 0, 0, true));
+    EXPECT_EQ(CronSchedule("0 0 1 1 *").next(monday), Datetime(2022, 1, 1, 0, 0, 0, true));
+    EXPECT_EQ(CronSchedule("@hourly").next(Datetime(2021, 12, 31, 23, 0, 0, true)), Datetime(2022, 1, 1, 0, 0, 0, true));
+    EXPECT_EQ(CronSchedule("0 0 29 2 *").next(monday), Datetime(2024, 2, 29, 0, 0, 0, true));
+    EXPECT_EQ(CronSchedule("0 0 31 * *").next(Datetime(2021, 4, 1, 0, 0, 0, true)), Datetime(2021, 5, 31, 0, 0, 0, true));
+    EXPECT_EQ(CronSchedule("30 * * * * *").next(monday), Datetime(2021, 3, 8, 10, 8, 30, true));
+    EXPECT_EQ(CronSchedule("0 0 * * 7").next(monday), Datetime(2021, 3, 14, 0, 0, 0, true));
+    // Day of month or day of week when both are restricted.
+    EXPECT_EQ(CronSchedule("0 0 13 * FRI").next(Datetime(2021, 3, 8, 0, 0, 0, true)), Datetime(2021, 3, 12, 0, 0, 0, true));
+    EXPECT_EQ(CronSchedule("0 0 13 * FRI").next(Datetime(2021, 3, 12, 0, 0, 0, true)), Datetime(2021, 3, 13, 0, 0, 0, true));
+    EXPECT_EQ(CronSchedule("0 0 * * 5").next(Datetime(2021, 3, 12, 0, 0, 0, true)), Datetime(2021, 3, 19, 0, 0, 0, true));
+
+    EXPECT_EQ(CronSchedule("0 0 29 2 *").prev(monday), Datetime(2020, 2, 29, 0, 0, 0, true));
+    EXPECT_EQ(CronSchedule("*/15 9-17 * * MON-FRI").prev(monday), Datetime(2021, 3, 8, 10, 0, 0, true));
+    EXPECT_EQ(CronSchedule("*/15 9-17 * * MON-FRI").prev(Datetime(2021, 3, 8, 9, 0, 0, true)), Datetime(2021, 3, 5, 17, 45, 0, true));
+    EXPECT_EQ(CronSchedule("0 0 1 1 *").prev(Datetime(2021, 1, 1, 0, 0, 0, true)), Datetime(2020, 1, 1, 0, 0, 0, true));
+    EXPECT_TRUE(CronSchedule("0 0 1 1 *").prev(monday).isUTC());
+
+    // Never fires.
+    EXPECT_THROW(CronSchedule("0 0 30 2 *").next(monday), DatetimeException);
+    EXPECT_THROW(CronSchedule("0 0 31 4 *").prev(monday), DatetimeException);
+    long long result = 0;
+    EXPECT_FALSE(CronSchedule("0 0 30 2 *").next(monday.unixTime(), result));
+    EXPECT_FALSE(CronSchedule("* * * * *").next(DatetimeConstants::MAXIMUM_SEC, result));
+    EXPECT_FALSE(CronSchedule("* * * * *").prev(DatetimeConstants::MINIMUM_SEC, result));
+
+    // Fixed UTC offset.
+    EXPECT_TRUE(CronSchedule("0 9 * * *").next(monday.unixTime(), result, 9 * 3600));
+    EXPECT_EQ(result, Datetime(2021, 3, 9, 0, 0, 0, true).unixTime());
+    EXPECT_TRUE(CronSchedule("0 9 * * *").matches(result, 9 * 3600));
+    EXPECT_FALSE(CronSchedule("0 9 * * *").matches(result));
+}
+
+TEST(TestCronSchedule, CompareWithScan)
+{
+    const std::vector<std::string> expressions = {
+        "*/7 * * * *",
+        "0 */5 * * *",
+        "15 10 * * 1-5",
+        "0 0 1,15 * *",
+        "0 12 * 2 *",
+        "0 12 1-7 * 1",
+        "59 23 31 12 *",
+        "0 0 29 2 *",
+    };
+    const long long start = Datetime(2023, 12, 25, 0, 0, 0, true).unixTime();
+    const long long end = start + 100 * 86400LL;
+    for (const auto &expression : expressions)
+    {
+        CronSchedule schedule(expression);
+        std::vector<long long> scanned;
+        for (long long t = start; t < end; t += 60)
+        {
+            if (schedule.matches(t))
+            {
+                scanned.push_back(t);
+            }
+        }
+        std::vector<long long> fired;
+        EXPECT_EQ(schedule.fireTimes(start, end, fired), scanned.size()) << expression;
+        EXPECT_EQ(fired, scanned) << expression;
+        for (size_t i = 0; i + 1 < scanned.size(); i++)
+        {
+            long long next = 0, prev = 0;
+            EXPECT_TRUE(schedule.next(scanned[i], next));
+            EXPECT_EQ(next, scanned[i + 1]) << expression;
+            EXPECT_TRUE(schedule.prev(scanned[i + 1], prev));
+            EXPECT_EQ(prev, scanned[i]) << expression;
+        }
+    }
+    EXPECT_EQ(CronSchedule("*/15 * * * *").fireTimes(Datetime(2021, 3, 8, 0, 0, 0, true), Datetime(2021, 3, 9, 0, 0, 0, true)).size(), 96u);
+}
+
+TEST(TestCronSchedule, LocalTime)
+{
+    // Every local day at 12:00, across summer time changes.
+    CronSchedule noon("0 12 * * *");
+    Datetime fire(2021, 3, 1, 0, 0, 0, false);
+    for (int i = 0; i < 70; i++)
+    {
+        fire = noon.next(fire);
+        EXPECT_FALSE(fire.isUTC());
+        EXPECT_EQ(fire.hour(), 12);
+        EXPECT_EQ(fire.minute(), 0);
+    }
+    EXPECT_EQ(fire, Datetime(2021, 5, 9, 12, 0, 0, false));
+    EXPECT_EQ(noon.prev(fire), Datetime(2021, 5, 8, 12, 0, 0, false));
+
+    // Every 30 minutes for two years: local fire times increase and are on :00 or :30.
+    CronSchedule halfHour("*/30 * * * *");
+    auto fires = halfHour.fireTimes(Datetime(2021, 1, 1, 0, 0, 0, false), Datetime(2023, 1, 1, 0, 0, 0, false));
+    EXPECT_GE(fires.size(), 2u * 365 * 48 - 4);
+    EXPECT_LE(fires.size(), 2u * 365 * 48);
+    for (size_t i = 0; i < fires.size(); i++)
+    {
+        EXPECT_EQ(fires[i].minute() % 30, 0);
+        if (i > 0)
+        {
+            EXPECT_GT(fires[i], fires[i - 1]);
+        }
+    }
+    EXPECT_TRUE(halfHour.matches(fires[100]));
+}
+
+TEST(TestCronSchedule, RepeatedLocalTime)
+{
+    // Find the end of summer time in 2021 in the local timezone (ex: 2021-11-07 02:00 EDT in America/New_York).
+    const auto offsetOf = [](const long long &unixTime) { return MyTM::utcOffsetOf(MyTM::my_mkStructTm(time_t(unixTime), false)); };
+    const long long start = Datetime(2021, 1, 1, 0, 0, 0, true).unixTime();
+    for (long long time = start; time < start + 365 * DatetimeConstants::SECONDS_PER_DAY; time += 900)
+    {
+        const long long repeated = offsetOf(time) - offsetOf(time + 900);
+        if (repeated <= 0)
+        {
+            continue;
+        }
+        // The local time 15 minutes before the change repeats. It fires only in the first pass.
+        const long long change = time + 900;
+        const Datetime first(time_t(change - 900), false);
+        CronSchedule schedule(std::to_string(first.minute()) + " " + std::to_string(first.hour()) + " * * *");
+        EXPECT_EQ(schedule.next(Datetime(time_t(change - 1800), false)), first);
+        EXPECT_EQ(schedule.next(first), schedule.next(Datetime(time_t(change + repeated - 1800), false)));
+        EXPECT_EQ(schedule.next(Datetime(time_t(change + repeated - 1800), false)).unixTime(), first.unixTime() + DatetimeConstants::SECONDS_PER_DAY + repeated);
+        EXPECT_EQ(schedule.prev(Datetime(time_t(change + repeated - 1), false)), first);
+        auto fires = schedule.fireTimes(Datetime(time_t(change - 3 * 3600), false), Datetime(time_t(change + 3 * 3600), false));
+        ASSERT_EQ(fires.size(), 1u);
+        EXPECT_EQ(fires[0], first);
+        return;
+    }
+}
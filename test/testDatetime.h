@@ -124,7 +124,6 @@ TEST_F(TestDatetime, ValidateConstruction)
     EXPECT_THROW(Datetime("2020/-1/9 23:30:15"), DatetimeException);
 
     // Timestamp is out of range
-    EXPECT_THROW(Datetime("1900/1/1 0:0:0"), DatetimeException);
     EXPECT_THROW(Datetime("2020/-1/9 23:30:15"), DatetimeException);
     EXPECT_THROW(Datetime("2020/13/1 0:0:0"), DatetimeException);
     EXPECT_THROW(Datetime("2020/1/1 0:0:60"), DatetimeException);
@@ -207,9 +206,12 @@ TEST_F(TestDatetime, ValidateTimeRange)
 {
     // Correct
     EXPECT_NO_THROW(Datetime("3000/1/2 0:0:0", true));
-    EXPECT_THROW(Datetime("3000/1/2 0:0:01", true), DatetimeException);
-    EXPECT_THROW(Datetime("1969/12/31 23:59:59", true), DatetimeException);
+    EXPECT_NO_THROW(Datetime("3000/1/2 0:0:01", true));
+    EXPECT_NO_THROW(Datetime("1969/12/31 23:59:59", true));
     EXPECT_NO_THROW(Datetime("1970/1/1 0:0:0", true));
+    EXPECT_NO_THROW(Datetime("2147483646/12/31 23:59:59", true));
+    EXPECT_THROW(Datetime("2147483647/1/1 0:0:0", true), DatetimeException);
+    EXPECT_THROW(Datetime("99999999999/1/1 0:0:0", true), DatetimeException);
 
     auto max = Datetime::maximum(true);
     auto min = Datetime::minimum(true);
@@ -219,15 +221,57 @@ TEST_F(TestDatetime, ValidateTimeRange)
     EXPECT_NO_THROW(Datetime(max.unixTime()));
 
     EXPECT_NO_THROW(auto b = Datetime(min));
-    EXPECT_NO_THROW(Datetime(min.str("%Y/%m/%d %H:%M:%S"), true));
+    EXPECT_EQ(Datetime(min.str("%Y/%m/%d %H:%M:%S"), true), min);
+    EXPECT_EQ(Datetime("-001/03/08 00:00:15", true), Datetime(-1, 3, 8, 0, 0, 15, true));
     EXPECT_NO_THROW(Datetime(min.structTm(), true));
     EXPECT_NO_THROW(Datetime(min.unixTime()));
 
     EXPECT_THROW(Datetime(max.unixTime() + 1), DatetimeException);
     EXPECT_THROW(Datetime(min.unixTime() - 1), DatetimeException);
 
-    EXPECT_EQ(time1, min);
-    EXPECT_THROW(time1 - 1, DatetimeException);
+    EXPECT_EQ(time1.unixTime(), 0);
+    EXPECT_NO_THROW(time1 - 1);
+    EXPECT_THROW(min - 1, DatetimeException);
+    EXPECT_THROW(max + 1, DatetimeException);
+}
+
+TEST_F(TestDatetime, ExtendedRange)
+{
+    // Pre-1970 and far-future datetimes use the library's own calendar arithmetic.
+    EXPECT_EQ(Datetime("1900/1/1 0:0:0", true).unixTime(), -2208988800LL);
+    EXPECT_EQ(Datetime("1/1/1 0:0:0", true).unixTime(), -62135596800LL);
+    EXPECT_EQ(Datetime("1969/12/31 23:59:59", true).unixTime(), -1);
+    EXPECT_EQ(Datetime("3000/1/2 0:0:0", true).unixTime(), 32503766400LL);
+    EXPECT_EQ(Datetime("10000/3/1 12:0:0", true).unixTime(), 253407528000LL);
+    EXPECT_EQ(Datetime(0, 2, 29, 0, 0, 0, true).unixTime(), -62162121600LL);
+    EXPECT_THROW(Datetime(1900, 2, 29, 0, 0, 0, true), DatetimeException);
+
+    std::vector<int> v = {-4713, 11, 24, 12, 0, 0};
+    EXPECT_EQ(Datetime(-4713, 11, 24, 12, 0, 0, true).toVector(), v);
+    EXPECT_EQ(Datetime(-210866760000LL, true).toVector(), v);
+
+    EXPECT_EQ(Datetime("1900/1/1 0:0:0", true).daysOfWeek(), 1);
+    EXPECT_EQ(Datetime("1969/7/20 20:17:40", true).daysOfWeek(), 0);
+    EXPECT_EQ(Datetime("1582/10/15 0:0:0", true).daysOfWeek(), 5);
+    EXPECT_EQ(Datetime("1969/12/31 23:59:59", true).str("%Y/%m/%d %H:%M:%S"), "1969/12/31 23:59:59");
+    EXPECT_EQ(Datetime(-4713, 1, 1, 0, 0, 0, true).str("%Y/%m/%d"), "-4713/01/01");
+
+    auto max = Datetime::maximum(true);
+    auto min = Datetime::minimum(true);
+    std::vector<int> vmax = {2147483646, 12, 31, 23, 59, 59};
+    std::vector<int> vmin = {-2147481747, 1, 1, 0, 0, 0};
+    EXPECT_EQ(max.toVector(), vmax);
+    EXPECT_EQ(min.toVector(), vmin);
+    EXPECT_NO_THROW(Datetime::maximum(false).str());
+    EXPECT_NO_THROW(Datetime::minimum(false).str());
+
+    // Local time outside of the native range is round-trippable.
+    for (long long sec : {-2208988800LL, -62135596800LL, 253407528000LL, 32503766400LL + 1, -1LL})
+    {
+        auto local = Datetime(time_t(sec), false);
+        auto tm = local.structTm();
+        EXPECT_EQ(Datetime(tm, false).unixTime(), sec);
+    }
 }
 
 TEST_F(TestDatetime, InputEach_YmdHMS)
@@ -245,7 +289,7 @@ TEST_F(TestDatetime, InputEach_YmdHMS)
     EXPECT_EQ(t3, Datetime("2040/12/31 23:59:59"));
 
     EXPECT_THROW(Datetime(2021, 0, 1, 0, 0, 0), DatetimeException);
-    EXPECT_THROW(Datetime(1969, 1, 1, 0, 0, 0), DatetimeException);
+    EXPECT_NO_THROW(Datetime(1969, 1, 1, 0, 0, 0));
     EXPECT_THROW(Datetime(2045, 2, 29, 0, 0, 0), DatetimeException);
     EXPECT_THROW(Datetime(2045, 10, 37, 0, 0, 0), DatetimeException);
     EXPECT_THROW(Datetime(2045, 10, 10, 25, 0, 0), DatetimeException);
@@ -259,3 +303,70 @@ TEST_F(TestDatetime, InputEach_YmdHMS)
 
     EXPECT_NO_THROW(Datetime(2045, 10, 24, 13, 0, 0));
 }
+
+TEST_F(TestDatetime, ExtendedSpecifiers)
+{
+    const Datetime expected(2021, 3, 8, 13, 5, 15, true);
+
+    // Month and weekday names (case insensitive, abbreviated or full)
+    EXPECT_EQ(Datetime("Mon, 08 Mar 2021 13:05:15", "%a, %d %b %Y %H:%M:%S", true), expected);
+    EXPECT_EQ(Datetime("monday 8 MARCH 2021 13:05:15", "%A %d %B %Y %H:%M:%S", true), expected);
+    EXPECT_EQ(Datetime("March 8, 2021 13:05:15", "%b %d, %Y %H:%M:%S", true), expected);
+    EXPECT_EQ(Datetime("Sep 2021", "%b %Y", true), Datetime(2021, 9, 1, 0, 0, 0, true));
+    EXPECT_EQ(Datetime("May 2021", "%B %Y", true), Datetime(2021, 5, 1, 0, 0, 0, true));
+    EXPECT_THROW(Datetime("Tue, 08 Mar 2021", "%a, %d %b %Y", true), DatetimeException);
+    EXPECT_THROW(Datetime("08 Mat 2021", "%d %b %Y", true), DatetimeException);
+    EXPECT_THROW(Datetime("08 Marc 2021", "%d %b %Y", true), DatetimeException);
+    EXPECT_THROW(Datetime("08 Ma 2021", "%d %b %Y", true), DatetimeException);
+    EXPECT_THROW(Datetime("08 Mar 2021", "%m %b %Y", true), DatetimeException);
+    for (int mon = 1; mon <= 12; mon++)
+    {
+        const std::string name = DatetimeConstants::MONTH_NAMES[mon - 1];
+        EXPECT_EQ(Datetime(name.substr(0, 3) + " 2021", "%b %Y", true).month(), mon);
+        EXPECT_EQ(Datetime(name + " 2021", "%B %Y", true).month(), mon);
+    }
+
+    // Day of year
+    EXPECT_EQ(Datetime("2021-067 13:05:15", "%Y-%j %H:%M:%S", true), expected);
+    EXPECT_EQ(Datetime("2020-366", "%Y-%j", true), Datetime(2020, 12, 31, 0, 0, 0, true));
+    EXPECT_THROW(Datetime("2021-366", "%Y-%j", true), DatetimeException);
+    EXPECT_THROW(Datetime("2021-0", "%Y-%j", true), DatetimeException);
+    EXPECT_THROW(Datetime("2021-067-08", "%Y-%j-%d", true), DatetimeException);
+
+    // AM/PM
+    EXPECT_EQ(Datetime("2021/3/8 1:05:15 PM", "%Y/%m/%d %I:%M:%S %p", true), expected);
+    EXPECT_EQ(Datetime("2021/3/8 12:00:00 am", "%Y/%m/%d %I:%M:%S %p", true).hour(), 0);
+    EXPECT_EQ(Datetime("2021/3/8 12:00:00 pm", "%Y/%m/%d %I:%M:%S %p", true).hour(), 12);
+    EXPECT_THROW(Datetime("2021/3/8 13:00:00 PM", "%Y/%m/%d %I:%M:%S %p", true), DatetimeException);
+    EXPECT_THROW(Datetime("2021/3/8 1:00:00 XM", "%Y/%m/%d %I:%M:%S %p", true), DatetimeException);
+
+    // UTC offset: the timestamp designates the instant regardless of isUTC.
+    EXPECT_EQ(Datetime("2021-03-08 22:05:15 +0900", "%Y-%m-%d %H:%M:%S %z", true), expected);
+    EXPECT_EQ(Datetime("2021-03-08 22:05:15+09:00", "%Y-%m-%d %H:%M:%S%z"), expected);
+    EXPECT_EQ(Datetime("2021-03-08 08:05:15-05", "%Y-%m-%d %H:%M:%S%z"), expected);
+    EXPECT_EQ(Datetime("2021-03-08T13:05:15Z", "%Y-%m-%dT%H:%M:%S%z"), expected);
+    EXPECT_FALSE(Datetime("2021-03-08T13:05:15Z", "%Y-%m-%dT%H:%M:%S%z").isUTC());
+    EXPECT_THROW(Datetime("2021-03-08 22:05:15 0900", "%Y-%m-%d %H:%M:%S %z"), DatetimeException);
+    EXPECT_THROW(Datetime("2021-03-08 22:05:15 +09:", "%Y-%m-%d %H:%M:%S %z"), DatetimeException);
+    EXPECT_THROW(Datetime("2021-03-08 22:05:15 +2400", "%Y-%m-%d %H:%M:%S %z"), DatetimeException);
+
+    // Unix seconds
+    EXPECT_EQ(Datetime("1615208715", "%s"), expected);
+    EXPECT_EQ(Datetime("@-1", "@%s", true), Datetime(1969, 12, 31, 23, 59, 59, true));
+    EXPECT_EQ(Datetime("Mon 1615208715", "%a %s", true), expected);
+    EXPECT_THROW(Datetime("Tue 1615208715", "%a %s", true), DatetimeException);
+    EXPECT_THROW(Datetime("2021 1615208715", "%Y %s"), DatetimeException);
+    EXPECT_THROW(Datetime("99999999999999999999", "%s"), DatetimeException);
+
+    // Output
+    EXPECT_EQ(expected.str("%a %A %b %B"), "Mon Monday Mar March");
+    EXPECT_EQ(expected.str("%j %I %p %z %s"), "067 01 PM +0000 1615208715");
+    EXPECT_EQ(Datetime(2021, 1, 1, 0, 0, 0, true).str("%j %I %p"), "001 12 AM");
+    EXPECT_EQ(Datetime(2020, 12, 31, 12, 0, 0, true).str("%j %I %p"), "366 12 PM");
+    EXPECT_EQ(Datetime(2021, 3, 8, 0, 0, 0, false).str("%s"), std::to_string(Datetime(2021, 3, 8, 0, 0, 0, false).unixTime()));
+    EXPECT_EQ(Datetime(-1, true).str("%s"), "-1");
+
+    // Round trip of the local time with its offset
+    const Datetime local(2021, 7, 1, 12, 0, 0, false);
+    EXPECT_EQ(Datetime(local.str("%a, %d %b %Y %H:%M:%S %z"), "%a, %d %b %Y %H:%M:%S %z"), local);
+}
@@ -0,0 +1,209 @@
+#pragma once
+#include "gtest/gtest.h"
+#include "datetime.h"
+#include "alloc_counter.h"
+
+using namespace EZ;
+
+TEST(TestFixedFormat, ParseRfc3339)
+{
+    long long unixTime = 0;
+    long nanoseconds = 0;
+    EXPECT_TRUE(FixedFormat::parseRfc3339("2021-03-08T00:00:15Z", 20, unixTime, nanoseconds));
+    EXPECT_EQ(unixTime, 1615161615);
+    EXPECT_EQ(nanoseconds, 0);
+
+    const std::string withOffset = "2021-03-08T09:00:15.123+09:00";
+    EXPECT_TRUE(FixedFormat::parseRfc3339(withOffset.c_str(), withOffset.size(), unixTime, nanoseconds));
+    EXPECT_EQ(unixTime, 1615161615);
+    EXPECT_EQ(nanoseconds, 123000000);
+
+    const std::string negative = "2021-03-07t19:30:15.1234567891-04:30";
+    EXPECT_TRUE(FixedFormat::parseRfc3339(negative.c_str(), negative.size(), unixTime, nanoseconds));
+    EXPECT_EQ(unixTime, 1615161615);
+    EXPECT_EQ(nanoseconds, 123456789);
+
+    const std::string beforeEpoch = "1969-12-31 23:59:59.5z";
+    EXPECT_TRUE(FixedFormat::parseRfc3339(beforeEpoch.c_str(), beforeEpoch.size(), unixTime, nanoseconds));
+    EXPECT_EQ(unixTime, -1);
+    EXPECT_EQ(nanoseconds, 500000000);
+
+    const std::vector<std::string> invalids = {
+        "",
+        "2021-03-08T00:00:15",
+        "2021-03-08T00:00:15+0900",
+        "2021-03-08T00:00:15+09",
+        "2021-03-08T00:00:15.Z",
+        "2021-03-08T00:00:15ZZ",
+        "2021-3-8T00:00:15Z",
+        "2021/03/08T00:00:15Z",
+        "2021-03-08_00:00:15Z",
+        "2021-02-29T00:00:15Z",
+        "2021-13-08T00:00:15Z",
+        "2021-03-08T24:00:00Z",
+        "2021-03-08T23:59:60Z",
+        "2021-03-08T00:00:15+24:00",
+    };
+    for (const auto &invalid : invalids)
+    {
+        EXPECT_FALSE(FixedFormat::parseRfc3339(invalid.c_str(), invalid.size(), unixTime, nanoseconds)) << invalid;
+    }
+}
+
+TEST(TestFixedFormat, WriteRfc3339)
+{
+    char buf[FixedFormat::RFC3339_BUFFER_SIZE];
+    EXPECT_EQ(std::string(buf, FixedFormat::writeRfc3339(buf, 1615161615)), "2021-03-08T00:00:15Z");
+    EXPECT_EQ(std::string(buf, FixedFormat::writeRfc3339(buf, 1615161615, 32400, 123000000, 3)), "2021-03-08T09:00:15.123+09:00");
+    EXPECT_EQ(std::string(buf, FixedFormat::writeRfc3339(buf, 1615161615, -16200, 123456789, 9)), "2021-03-07T19:30:15.123456789-04:30");
+    EXPECT_EQ(std::string(buf, FixedFormat::writeRfc3339(buf, -1, 0, 5, 6)), "1969-12-31T23:59:59.000000Z");
+    EXPECT_EQ(std::string(buf, FixedFormat::writeRfc3339(buf, -62135596800)), "0001-01-01T00:00:00Z");
+    EXPECT_EQ(std::string(buf, FixedFormat::writeRfc3339(buf, DatetimeConstants::MINIMUM_SEC, -86340, 999999999, 9)),
+              "-2147481748-12-31T00:01:00.999999999-23:59");
+}
+
+TEST(TestFixedFormat, DatetimeRfc3339)
+{
+    const Datetime expected(2021, 3, 8, 0, 0, 15, true);
+    EXPECT_EQ(Datetime::fromRfc3339("2021-03-08T09:00:15+09:00"), expected);
+    EXPECT_TRUE(Datetime::fromRfc3339("2021-03-08T00:00:15Z", true).isUTC());
+    EXPECT_FALSE(Datetime::fromRfc3339(std::string("2021-03-08T00:00:15Z")).isUTC());
+    long nanoseconds = 0;
+    EXPECT_EQ(Datetime::fromRfc3339("2021-03-08T00:00:15.25Z", nanoseconds), expected);
+    EXPECT_EQ(nanoseconds, 250000000);
+    EXPECT_THROW(Datetime::fromRfc3339("2021/03/08 00:00:15"), DatetimeException);
+
+    EXPECT_EQ(expected.toRfc3339(), "2021-03-08T00:00:15Z");
+    const Datetime local(2021, 7, 1, 12, 0, 0, false);
+    EXPECT_EQ(Datetime::fromRfc3339(local.toRfc3339()), local);
+    EXPECT_EQ(local.toRfc3339().substr(0, 19), "2021-07-01T12:00:00");
+
+    MyHelper::AllocationCounter counter;
+    Datetime parsed = Datetime::fromRfc3339("2021-03-08T09:00:15.123+09:00", true);
+    char buf[FixedFormat::RFC3339_BUFFER_SIZE];
+    const size_t len = parsed.toRfc3339(buf);
+    long long n = counter.count();
+    EXPECT_EQ(n, 0);
+    EXPECT_EQ(std::string(buf, len), "2021-03-08T00:00:15Z");
+}
+
+TEST(TestFixedFormat, HttpDate)
+{
+    // Example of RFC 7231
+    const long long expected = 784111777;
+    char buf[FixedFormat::HTTP_DATE_BUFFER_SIZE];
+    const size_t len = FixedFormat::writeHttpDate(buf, expected);
+    EXPECT_EQ(len, FixedFormat::HTTP_DATE_LENGTH);
+    EXPECT_EQ(std::string(buf, len), "Sun, 06 Nov 1994 08:49:37 GMT");
+    EXPECT_EQ(std::string(buf, FixedFormat::writeHttpDate(buf, 0)), "Thu, 01 Jan 1970 00:00:00 GMT");
+
+    const std::vector<std::string> valids = {
+        "Sun, 06 Nov 1994 08:49:37 GMT",
+        "Sunday, 06-Nov-94 08:49:37 GMT",
+        "SUNDAY, 06-Nov-94 08:49:37 GMT",
+        "Sun Nov  6 08:49:37 1994",
+        "Sun Nov 6 08:49:37 1994",
+    };
+    for (const auto &valid : valids)
+    {
+        long long unixTime = 0;
+        EXPECT_TRUE(FixedFormat::parseHttpDate(valid.c_str(), valid.size(), unixTime)) << valid;
+        EXPECT_EQ(unixTime, expected) << valid;
+    }
+    const std::vector<std::string> invalids = {
+        "",
+        "Sun, 06 Nov 1994 08:49:37 UTC",
+        "Sun, 06 Nov 1994 08:49 GMT",
+        "Sun, 6 Nov 1994 08:49:37 GMT",
+        "Sun, 06 Now 1994 08:49:37 GMT",
+        "Sun, 31 Nov 1994 08:49:37 GMT",
+        "Sunday, 06-Nov-1994 08:49:37 GMT",
+        "Sunday 06-Nov-94 08:49:37 GMT",
+        "Sunxyz, 06-Nov-94 08:49:37 GMT",
+        "Sundays, 06-Nov-94 08:49:37 GMT",
+        "Sunda, 06-Nov-94 08:49:37 GMT",
+        "Sun Nov  6 08:49:37 94",
+        "2021-03-08T00:00:15Z",
+    };
+    for (const auto &invalid : invalids)
+    {
+        long long unixTime = 0;
+        EXPECT_FALSE(FixedFormat::parseHttpDate(invalid.c_str(), invalid.size(), unixTime)) << invalid;
+    }
+
+    EXPECT_EQ(Datetime(time_t(expected), false).toHttpDate(), "Sun, 06 Nov 1994 08:49:37 GMT");
+    EXPECT_EQ(Datetime::fromHttpDate("Sun, 06 Nov 1994 08:49:37 GMT", true).unixTime(), expected);
+    EXPECT_THROW(Datetime::fromHttpDate("Sun, 06 Nov 1994"), DatetimeException);
+}
+
+TEST(TestFixedFormat, HttpDateCache)
+{
+    FixedFormat::HttpDateCache cache;
+    size_t len = 0;
+    auto before = Metrics::snapshot();
+    const char *first = cache.get(784111777, len);
+    EXPECT_STREQ(first, "Sun, 06 Nov 1994 08:49:37 GMT");
+    EXPECT_EQ(len, FixedFormat::HTTP_DATE_LENGTH);
+    EXPECT_EQ(cache.get(784111777, len), first);
+    EXPECT_STREQ(cache.get(784111778, len), "Sun, 06 Nov 1994 08:49:38 GMT");
+    auto delta = Metrics::snapshot() - before;
+    EXPECT_EQ(delta[Metrics::FORMAT_CACHE_HITS], 1);
+    EXPECT_EQ(delta[Metrics::FORMAT_CACHE_MISSES], 2);
+    EXPECT_EQ(delta[Metrics::FORMAT_CALLS], 2);
+
+    MyHelper::AllocationCounter counter;
+    const char *now = FixedFormat::httpDateNow(len);
+    long long n = counter.count();
+    EXPECT_EQ(n, 0);
+    long long unixTime = 0;
+    EXPECT_TRUE(FixedFormat::parseHttpDate(now, len, unixTime));
+    EXPECT_LE(std::abs(unixTime - (long long)time(NULL)), 1);
+}
+
+TEST(TestFixedFormat, Rfc2822)
+{
+    char buf[FixedFormat::RFC2822_BUFFER_SIZE];
+    EXPECT_EQ(std::string(buf, FixedFormat::writeRfc2822(buf, 1615161615, 32400)), "Mon, 08 Mar 2021 09:00:15 +0900");
+    EXPECT_EQ(std::string(buf, FixedFormat::writeRfc2822(buf, 1615161615, -16200)), "Sun, 07 Mar 2021 19:30:15 -0430");
+    EXPECT_EQ(std::string(buf, FixedFormat::writeRfc2822(buf, 1615161615)), "Mon, 08 Mar 2021 00:00:15 +0000");
+
+    const std::vector<std::pair<std::string, long long>> valids = {
+        {"Mon, 08 Mar 2021 09:00:15 +0900", 1615161615},
+        {"8 Mar 2021 00:00:15 GMT", 1615161615},
+        {"Mon,  8 mar 2021 00:00:15 UT", 1615161615},
+        {"Mon, 08 Mar 21 00:00:15 Z", 1615161615},
+        {"Sun, 07 Mar 2021 19:00:15 EST", 1615161615},
+        {"Sun, 07 Mar 2021 16:00 PST", 1615161600},
+        {"Sun, 07 Mar 2021 19:30:15 -0430 ", 1615161615},
+        {"Thu, 1 Jan 70 00:00:00 +0000", 0},
+    };
+    for (const auto &valid : valids)
+    {
+        long long unixTime = 0;
+        EXPECT_TRUE(FixedFormat::parseRfc2822(valid.first.c_str(), valid.first.size(), unixTime)) << valid.first;
+        EXPECT_EQ(unixTime, valid.second) << valid.first;
+    }
+    const std::vector<std::string> invalids = {
+        "",
+        "Mon 08 Mar 2021 09:00:15 +0900",
+        "Mon, 08 Mar 2021 09:00:15",
+        "Mon, 08 Mar 2021 09:00:15 +090",
+        "Mon, 08 Mar 2021 09:00:15 JST",
+        "Mon, 08 Mar 021 09:00:15 +0900",
+        "Mon, 08 Mar 2021 9:00:15 +0900",
+        "Mon, 08 Mar 2021 09:00:15 +0900 (JST)",
+        "Mon, 29 Feb 2021 09:00:15 +0900",
+    };
+    for (const auto &invalid : invalids)
+    {
+        long long unixTime = 0;
+        EXPECT_FALSE(FixedFormat::parseRfc2822(invalid.c_str(), invalid.size(), unixTime)) << invalid;
+    }
+
+    const Datetime expected(2021, 3, 8, 0, 0, 15, true);
+    EXPECT_EQ(expected.toRfc2822(), "Mon, 08 Mar 2021 00:00:15 +0000");
+    EXPECT_EQ(Datetime::fromRfc2822("Mon, 08 Mar 2021 09:00:15 +0900", true), expected);
+    const Datetime local(2021, 7, 1, 12, 0, 0, false);
+    EXPECT_EQ(Datetime::fromRfc2822(local.toRfc2822()), local);
+    EXPECT_THROW(Datetime::fromRfc2822("2021-03-08"), DatetimeException);
+}
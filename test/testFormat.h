@@ -0,0 +1,162 @@
+#pragma once
+#include "gtest/gtest.h"
+#include "datetime.h"
+#include "sniffing_parser.h"
+#include "alloc_counter.h"
+
+using namespace EZ;
+
+TEST(TestFormat, Compile)
+{
+    auto format = CompiledFormat::compile("%Y-%m-%dT%H:%M:%S");
+    EXPECT_TRUE(format.valid());
+    EXPECT_EQ(format.kind(), CompiledFormat::PATTERN);
+    EXPECT_EQ(format.format(), "%Y-%m-%dT%H:%M:%S");
+
+    long long unixTime = 0;
+    EXPECT_TRUE(format.tryParse("2021-03-08T00:00:15", true, unixTime));
+    EXPECT_EQ(unixTime, 1615161615);
+    EXPECT_TRUE(format.tryParse("2021-3-8T0:0:15", true, unixTime));
+    EXPECT_EQ(unixTime, 1615161615);
+    EXPECT_FALSE(format.tryParse("2021/03/08T00:00:15", true, unixTime));
+    EXPECT_FALSE(format.tryParse("2021-03-08T00:00:15Z", true, unixTime));
+    EXPECT_FALSE(format.tryParse("2021-13-08T00:00:15", true, unixTime));
+    EXPECT_FALSE(format.tryParse("2021-03-08T00:00:", true, unixTime));
+    EXPECT_FALSE(CompiledFormat().valid());
+    EXPECT_FALSE(CompiledFormat().tryParse("2021", true, unixTime));
+
+    EXPECT_THROW(CompiledFormat::compile("abc"), DatetimeException);
+    EXPECT_THROW(CompiledFormat::compile("%Y_%Y"), DatetimeException);
+    EXPECT_THROW(CompiledFormat::compile("%Y_%K"), DatetimeException);
+    EXPECT_THROW(CompiledFormat::compile("%m_%d"), DatetimeException);
+    EXPECT_THROW(CompiledFormat::compile("%Y0%m"), DatetimeException);
+}
+
+TEST(TestFormat, DatetimeWithCompiledFormat)
+{
+    auto format = CompiledFormat::compile("%Y/%m/%d %H:%M:%S");
+    EXPECT_EQ(Datetime("2021/3/8 0:00:15", format, true), Datetime(2021, 3, 8, 0, 0, 15, true));
+    EXPECT_EQ(Datetime("2021/3/8 0:00:15", format), Datetime(2021, 3, 8, 0, 0, 15));
+    EXPECT_THROW(Datetime("2021-3-8 0:00:15", format), DatetimeException);
+    EXPECT_THROW(Datetime("2021/13/8 0:00:15", format), DatetimeException);
+    EXPECT_THROW(Datetime("abc", CompiledFormat::epochSeconds()), DatetimeException);
+    EXPECT_EQ(Datetime("1615161615", CompiledFormat::epochSeconds(), true).unixTime(), 1615161615);
+
+    MyHelper::AllocationCounter counter;
+    Datetime t("2021/3/8 0:00:15", format, true);
+    long long n = counter.count();
+    EXPECT_EQ(n, 0);
+    EXPECT_EQ(t.unixTime(), 1615161615);
+}
+
+TEST(TestFormat, DetectFormat)
+{
+    EXPECT_EQ(detectFormat("2021/3/8 0:00:15").format(), "%Y/%m/%d %H:%M:%S");
+    EXPECT_EQ(detectFormat("2021-03-08T00:00:15Z").format(), "%Y-%m-%dT%H:%M:%S%z");
+    EXPECT_EQ(detectFormat("2021-03-08").format(), "%Y-%m-%d");
+    EXPECT_EQ(detectFormat("2021").format(), "%Y");
+    EXPECT_EQ(detectFormat("00:00:15 2021/03/08").format(), "%H:%M:%S %Y/%m/%d");
+    EXPECT_EQ(detectFormat("2021.03.08 00:00").format(), "%Y.%m.%d %H:%M");
+    EXPECT_EQ(detectFormat("08.03.2021 00:00:15").format(), "%d.%m.%Y %H:%M:%S");
+    EXPECT_EQ(detectFormat("03/13/2021").format(), "%m/%d/%Y");
+    EXPECT_EQ(detectFormat("13/03/2021").format(), "%d/%m/%Y");
+    EXPECT_EQ(detectFormat("12345/3/8 0:00:15").format(), "%Y/%m/%d %H:%M:%S");
+    EXPECT_EQ(detectFormat("Mon, 08 Mar 2021 00:00:15 +0900").format(), "%a, %d %b %Y %H:%M:%S %z");
+    EXPECT_EQ(detectFormat("Monday, 8 March 2021 00:00 GMT").format(), "%A, %d %B %Y %H:%M %z");
+    EXPECT_EQ(detectFormat("2021/03/08 00:00:15 UTC").format(), "%Y/%m/%d %H:%M:%S %z");
+    // UTC designators give the UTC instant, even when the time is parsed as local time.
+    const char *const utcSamples[] = {"2021-03-08T00:00:15Z", "2021/03/08 00:00:15 UTC", "Mon, 08 Mar 2021 00:00:15 GMT"};
+    for (const char *const &sample : utcSamples)
+    {
+        EXPECT_EQ(Datetime(sample, detectFormat(sample), false).unixTime(), 1615161615) << sample;
+        EXPECT_EQ(SniffingParser().parse(sample).unixTime(), 1615161615) << sample;
+    }
+    EXPECT_EQ(detectFormat("Mar 8, 2021").format(), "%b %d, %Y");
+    EXPECT_EQ(detectFormat("2021-03-08T00:00:15-05:00").format(), "%Y-%m-%dT%H:%M:%S%z");
+    EXPECT_EQ(detectFormat("1615161615").kind(), CompiledFormat::EPOCH_SECONDS);
+    EXPECT_EQ(detectFormat("1615161615123").kind(), CompiledFormat::EPOCH_MILLIS);
+
+    CompiledFormat format;
+    EXPECT_FALSE(detectFormat("", format));
+    EXPECT_FALSE(detectFormat("abc", format));
+    EXPECT_FALSE(detectFormat("3/8", format));
+    EXPECT_FALSE(detectFormat("2021/13/45", format));
+    EXPECT_FALSE(detectFormat("2021/3/8 25:00:00", format));
+    EXPECT_FALSE(detectFormat("0:00 2021/3/8 0:00", format));
+    EXPECT_FALSE(detectFormat("2021%m/3/8", format));
+    EXPECT_FALSE(detectFormat("Mar 2021 Apr", format));
+    EXPECT_FALSE(detectFormat("Tue, 08 Mar 2021", format));
+    EXPECT_FALSE(format.valid());
+    EXPECT_THROW(detectFormat("abc"), DatetimeException);
+
+    long long unixTime = 0;
+    EXPECT_TRUE(detectFormat("Mon, 08 Mar 2021 09:00:15 +0900").tryParse("Mon, 08 Mar 2021 09:00:15 +0900", false, unixTime));
+    EXPECT_EQ(unixTime, 1615161615);
+    EXPECT_TRUE(detectFormat("1615161615123").tryParse("1615161615123", true, unixTime));
+    EXPECT_EQ(unixTime, 1615161615);
+}
+
+TEST(TestFormat, SniffingParser)
+{
+    SniffingParser parser(true);
+    EXPECT_FALSE(parser.format().valid());
+    EXPECT_EQ(parser.parse("2021-03-08T00:00:15"), Datetime(2021, 3, 8, 0, 0, 15, true));
+    EXPECT_EQ(parser.parse("2021-03-08T00:00:16").unixTime(), 1615161616);
+    EXPECT_EQ(parser.format().format(), "%Y-%m-%dT%H:%M:%S");
+    EXPECT_EQ(parser.redetections(), 0);
+    EXPECT_TRUE(parser.parse("2021-03-08T00:00:15").isUTC());
+
+    // The format is switched when records do not match.
+    EXPECT_EQ(parser.parse("1615161615").unixTime(), 1615161615);
+    EXPECT_EQ(parser.format().kind(), CompiledFormat::EPOCH_SECONDS);
+    EXPECT_EQ(parser.redetections(), 1);
+
+    // Day-first is assumed until a record shows the month first.
+    SniffingParser ambiguous(true);
+    EXPECT_EQ(ambiguous.parse("03/08/2021"), Datetime(2021, 8, 3, 0, 0, 0, true));
+    EXPECT_EQ(ambiguous.parse("03/13/2021"), Datetime(2021, 3, 13, 0, 0, 0, true));
+    EXPECT_EQ(ambiguous.format().format(), "%m/%d/%Y");
+    EXPECT_EQ(ambiguous.redetections(), 1);
+    EXPECT_EQ(ambiguous.order(), SniffingParser::MONTH_FIRST);
+    EXPECT_EQ(ambiguous.ambiguousRecords(), 1);
+
+    // The decided order is kept when the format is detected again.
+    SniffingParser mixed(true);
+    EXPECT_EQ(mixed.parse("03/08/2021 10:00:00"), Datetime(2021, 8, 3, 10, 0, 0, true));
+    EXPECT_EQ(mixed.order(), SniffingParser::UNDECIDED);
+    EXPECT_EQ(mixed.ambiguousRecords(), 1);
+    EXPECT_EQ(mixed.parse("03/13/2021"), Datetime(2021, 3, 13, 0, 0, 0, true));
+    EXPECT_EQ(mixed.order(), SniffingParser::MONTH_FIRST);
+    EXPECT_EQ(mixed.parse("03/08/2021 10:00:00"), Datetime(2021, 3, 8, 10, 0, 0, true));
+    EXPECT_EQ(mixed.parse("03/08/2021"), Datetime(2021, 3, 8, 0, 0, 0, true));
+    EXPECT_EQ(mixed.ambiguousRecords(), 1);
+
+    // Sampling the first records decides the order before parsing.
+    const std::vector<std::string> lines = {"03/08/2021", "04/08/2021", "25/08/2021", "05/08/2021"};
+    SniffingParser sampled(true);
+    sampled.sample(lines.begin(), lines.end());
+    EXPECT_EQ(sampled.order(), SniffingParser::DAY_FIRST);
+    EXPECT_EQ(sampled.parse(lines[0]), Datetime(2021, 8, 3, 0, 0, 0, true));
+    EXPECT_EQ(sampled.parse("01/02/2021"), Datetime(2021, 2, 1, 0, 0, 0, true));
+    EXPECT_EQ(sampled.ambiguousRecords(), 0);
+
+    EXPECT_THROW(parser.parse("abc"), DatetimeException);
+    long long unixTime = 0;
+    EXPECT_FALSE(parser.tryParse("abc", unixTime));
+    EXPECT_EQ(parser.format().kind(), CompiledFormat::EPOCH_SECONDS);
+
+    SniffingParser local;
+    EXPECT_EQ(local.parse("2021/3/8 0:00:15"), Datetime(2021, 3, 8, 0, 0, 15));
+    EXPECT_FALSE(local.parse("2021/3/8 0:00:15").isUTC());
+}
+
+TEST(TestFormat, Metrics)
+{
+    auto format = CompiledFormat::compile("%Y/%m/%d");
+    auto before = Metrics::snapshot();
+    Datetime t("2021/3/8", format, true);
+    auto delta = Metrics::snapshot() - before;
+    EXPECT_EQ(delta[Metrics::PARSE_CALLS], 1);
+    EXPECT_EQ(delta[Metrics::PARSE_FAST_PATH], 1);
+    EXPECT_EQ(delta[Metrics::PARSE_SLOW_PATH], 0);
+}
@@ -0,0 +1,160 @@
+#pragma once
+#include <random>
+#include <set>
+#include <sstream>
+#include "gtest/gtest.h"
+#include "interval.h"
+
+using namespace EZ;
+
+namespace MyHelper
+{
+    // Doubled times covered by the intervals (for comparison with the set operations).
+    inline std::set<long long> coveredKeys(const std::vector<Interval> &intervals)
+    {
+        std::set<long long> keys;
+        for (const auto &interval : intervals)
+        {
+            for (long long key = interval.lowerKey(); key < interval.upperKey(); key++)
+            {
+                keys.insert(key);
+            }
+        }
+        return keys;
+    }
+
+    // Random intervals of short lengths with random bounds, sorted by their starts.
+    inline std::vector<Interval> makeIntervals(std::mt19937_64 &random, const size_t &count, const long long &span, const long long &maxLength)
+    {
+        const long long origin = Datetime(2021, 3, 8, 0, 0, 0, true).unixTime();
+        std::vector<Interval> intervals;
+        for (size_t i = 0; i < count; i++)
+        {
+            const long long start = origin + (long long)(random() % span);
+            const long long length = (long long)(random() % (maxLength + 1));
+            intervals.push_back(Interval(Datetime(time_t(start), true), Datetime(time_t(start + length), true), Interval::Bounds(random() % 4)));
+        }
+        std::stable_sort(intervals.begin(), intervals.end(), [](const Interval &a, const Interval &b) { return a.lowerKey() < b.lowerKey(); });
+        return intervals;
+    }
+}
+
+TEST(TestInterval, Interval)
+{
+    const Datetime nine(2021, 3, 8, 9, 0, 0, true);
+    const Datetime five(2021, 3, 8, 17, 0, 0, true);
+    const Interval shift(nine, five);
+    EXPECT_EQ(shift.duration(), TimeDelta(0, 8, 0, 0));
+    EXPECT_TRUE(shift.contains(nine));
+    EXPECT_FALSE(shift.contains(five));
+    EXPECT_TRUE(Interval(nine, five, Interval::CLOSED).contains(five));
+    EXPECT_FALSE(Interval(nine, five, Interval::OPEN).contains(nine));
+    EXPECT_FALSE(shift.empty());
+    EXPECT_TRUE(Interval(nine, nine).empty());
+    EXPECT_TRUE(Interval(nine, nine, Interval::OPEN).empty());
+    EXPECT_FALSE(Interval(nine, nine, Interval::CLOSED).empty());
+    EXPECT_THROW(Interval(five, nine), DatetimeException);
+
+    // Touching ends overlap only if both are closed.
+    const Interval night(five, five + 3600);
+    EXPECT_FALSE(shift.overlaps(night));
+    EXPECT_TRUE(Interval(nine, five, Interval::CLOSED).overlaps(night));
+    EXPECT_FALSE(Interval(nine, five, Interval::CLOSED).overlaps(Interval(five, five + 3600, Interval::OPEN)));
+    EXPECT_TRUE(shift.overlaps(Interval(nine + 60, nine + 120)));
+    EXPECT_FALSE(shift.overlaps(Interval(nine + 60, nine + 60)));
+
+    EXPECT_EQ(shift, Interval(Datetime(2021, 3, 8, 9, 0, 0, true), five));
+    EXPECT_NE(shift, Interval(nine, five, Interval::CLOSED));
+    std::ostringstream stream;
+    stream << Interval(nine, five, Interval::OPEN_CLOSED);
+    EXPECT_EQ(stream.str(), "(" + nine.str() + ", " + five.str() + "]");
+}
+
+TEST(TestInterval, SetOperations)
+{
+    const Datetime t(2021, 3, 8, 0, 0, 0, true);
+    const std::vector<Interval> a = {Interval(t + 3600, t + 7200), Interval(t + 5400, t + 10800), Interval(t + 10800, t + 14400, Interval::OPEN)};
+    const auto coalesced = coalesce(a);
+    ASSERT_EQ(coalesced.size(), 2u);
+    EXPECT_EQ(coalesced[0], Interval(t + 3600, t + 10800));
+    EXPECT_EQ(coalesced[1], Interval(t + 10800, t + 14400, Interval::OPEN));
+    // [1:00, 3:00) and [3:00, 4:00) touch.
+    EXPECT_EQ(coalesce({Interval(t + 3600, t + 10800), Interval(t + 10800, t + 14400)}).size(), 1u);
+    EXPECT_THROW(coalesce({Interval(t + 7200, t + 10800), Interval(t + 3600, t + 14400)}), DatetimeException);
+
+    const std::vector<Interval> b = {Interval(t, t + 4000, Interval::CLOSED), Interval(t + 10800, t + 10800, Interval::CLOSED)};
+    const auto united = unionOf(a, b);
+    ASSERT_EQ(united.size(), 1u);
+    EXPECT_EQ(united[0], Interval(t, t + 14400, Interval::CLOSED_OPEN));
+    const auto common = intersectionOf(a, b);
+    // 3:00 is not in a.
+    ASSERT_EQ(common.size(), 1u);
+    EXPECT_EQ(common[0], Interval(t + 3600, t + 4000, Interval::CLOSED));
+    EXPECT_TRUE(intersectionOf(a, {}).empty());
+
+    // Compare with the covered times.
+    std::mt19937_64 random(17);
+    for (int trial = 0; trial < 20; trial++)
+    {
+        const auto x = MyHelper::makeIntervals(random, 50, 2000, 60);
+        const auto y = MyHelper::makeIntervals(random, 50, 2000, 60);
+        const auto keysX = MyHelper::coveredKeys(x);
+        const auto keysY = MyHelper::coveredKeys(y);
+        std::set<long long> keysUnion = keysX, keysIntersection;
+        keysUnion.insert(keysY.begin(), keysY.end());
+        for (const auto &key : keysX)
+        {
+            if (keysY.count(key))
+            {
+                keysIntersection.insert(key);
+            }
+        }
+        EXPECT_EQ(MyHelper::coveredKeys(coalesce(x)), keysX);
+        EXPECT_EQ(MyHelper::coveredKeys(unionOf(x, y)), keysUnion);
+        EXPECT_EQ(MyHelper::coveredKeys(intersectionOf(x, y)), keysIntersection);
+        // Disjoint and not touching.
+        const auto united = unionOf(x, y);
+        for (size_t i = 1; i < united.size(); i++)
+        {
+            EXPECT_LT(united[i - 1].upperKey(), united[i].lowerKey());
+        }
+    }
+}
+
+TEST(TestInterval, IntervalTree)
+{
+    std::mt19937_64 random(23);
+    auto intervals = MyHelper::makeIntervals(random, 3000, 100000, 500);
+    std::shuffle(intervals.begin(), intervals.end(), random);
+    const IntervalTree tree(intervals);
+    EXPECT_EQ(tree.size(), intervals.size());
+    const auto queries = MyHelper::makeIntervals(random, 300, 100000, 1000);
+    for (const auto &query : queries)
+    {
+        std::set<size_t> expected;
+        for (size_t i = 0; i < intervals.size(); i++)
+        {
+            if (intervals[i].overlaps(query))
+            {
+                expected.insert(i);
+            }
+        }
+        const auto found = tree.overlapping(query);
+        EXPECT_EQ(std::set<size_t>(found.begin(), found.end()), expected) << query;
+        EXPECT_EQ(found.size(), expected.size());
+        EXPECT_EQ(tree.overlapsAny(query), !expected.empty()) << query;
+
+        std::set<size_t> containing;
+        for (size_t i = 0; i < intervals.size(); i++)
+        {
+            if (intervals[i].contains(query.start()))
+            {
+                containing.insert(i);
+            }
+        }
+        const auto stabbed = tree.stabbing(query.start());
+        EXPECT_EQ(std::set<size_t>(stabbed.begin(), stabbed.end()), containing);
+    }
+    EXPECT_EQ(tree[0], intervals[0]);
+    EXPECT_FALSE(IntervalTree({}).overlapsAny(queries[0]));
+}
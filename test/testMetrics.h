@@ -0,0 +1,83 @@
+#pragma once
+#include "gtest/gtest.h"
+#include "datetime.h"
+
+#include <thread>
+
+using namespace EZ;
+
+TEST(TestMetrics, Enabled)
+{
+    ASSERT_TRUE(Metrics::enabled());
+    EXPECT_STREQ(Metrics::name(Metrics::PARSE_CALLS), "parse_calls");
+    EXPECT_STREQ(Metrics::name(Metrics::EXCEPTIONS_THROWN), "exceptions_thrown");
+}
+
+TEST(TestMetrics, ParseAndFormat)
+{
+    auto before = Metrics::snapshot();
+    auto t = Datetime("2021/3/8 0:00:15", true);
+    t.str("%Y/%m/%d");
+    t.str(std::string(300, '_') + "%Y");
+    auto delta = Metrics::snapshot() - before;
+
+    EXPECT_EQ(delta[Metrics::PARSE_CALLS], 1);
+    EXPECT_EQ(delta[Metrics::PARSE_SLOW_PATH], 1);
+    EXPECT_EQ(delta[Metrics::FORMAT_CALLS], 2);
+    EXPECT_EQ(delta[Metrics::FORMAT_BUFFER_OVERFLOWS], 1);
+    EXPECT_EQ(delta[Metrics::ZONE_LOOKUPS], 0);
+    EXPECT_EQ(delta[Metrics::EXCEPTIONS_THROWN], 0);
+}
+
+TEST(TestMetrics, ParseFailures)
+{
+    auto before = Metrics::snapshot();
+    EXPECT_THROW(Datetime("2021-3-8 0:00:15"), DatetimeException);
+    EXPECT_THROW(Datetime("2021_3", "%Y_%K"), DatetimeException);
+    EXPECT_THROW(Datetime("2021_3", "%Y_%Y"), DatetimeException);
+    EXPECT_THROW(Datetime("3_8", "%m_%d"), DatetimeException);
+    EXPECT_THROW(Datetime("2021/13/8 0:00:15"), DatetimeException);
+    EXPECT_THROW(Datetime("99999999999/1/1 0:00:15"), DatetimeException);
+    auto delta = Metrics::snapshot() - before;
+
+    EXPECT_EQ(delta[Metrics::PARSE_CALLS], 6);
+    EXPECT_EQ(delta[Metrics::PARSE_FAILURE_MISMATCH], 1);
+    EXPECT_EQ(delta[Metrics::PARSE_FAILURE_INVALID_SPECIFIER], 1);
+    EXPECT_EQ(delta[Metrics::PARSE_FAILURE_DUPLICATED], 1);
+    EXPECT_EQ(delta[Metrics::PARSE_FAILURE_MISSING_YEAR], 1);
+    EXPECT_EQ(delta[Metrics::PARSE_FAILURE_OUT_OF_RANGE], 2);
+    EXPECT_GE(delta[Metrics::EXCEPTIONS_THROWN], 6);
+}
+
+TEST(TestMetrics, ZoneLookups)
+{
+    auto before = Metrics::snapshot();
+    auto t = Datetime(2021, 3, 8, 0, 0, 15, false);
+    t.hour();
+    auto delta = Metrics::snapshot() - before;
+    EXPECT_GE(delta[Metrics::ZONE_LOOKUPS], 2);
+}
+
+TEST(TestMetrics, SumOfThreads)
+{
+    const int numThreads = 4;
+    const int numParses = 100;
+    auto before = Metrics::snapshot();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < numThreads; i++)
+    {
+        threads.emplace_back([]() {
+            for (int j = 0; j < numParses; j++)
+            {
+                Datetime("2021/3/8 0:00:15", true);
+            }
+        });
+    }
+    for (auto &th : threads)
+    {
+        th.join();
+    }
+    // Counters of finished threads are kept.
+    auto delta = Metrics::snapshot() - before;
+    EXPECT_EQ(delta[Metrics::PARSE_CALLS], numThreads * numParses);
+}
@@ -0,0 +1,136 @@
+#pragma once
+#include <climits>
+#include <algorithm>
+#include <random>
+#include "gtest/gtest.h"
+#include "packed_times.h"
+
+using namespace EZ;
+
+TEST(TestPackedTimes, RoundTrip)
+{
+    std::mt19937_64 random(37);
+    const long long start = Datetime(2021, 1, 1, 0, 0, 0, true).unixTime();
+    // 33 * 128 covers blocks of every width from 0 to 32.
+    const size_t sizes[] = {0, 1, 2, 127, 128, 129, 1000, 33 * 128 + 1};
+    for (const size_t &size : sizes)
+    {
+        // Unsorted with jitter, every width from 0 to 32 (with the smallest and largest offsets), random and extreme times.
+        std::vector<std::vector<long long>> columns(4);
+        for (size_t i = 0; i < size; i++)
+        {
+            columns[0].push_back(start + (long long)i * 10 + (long long)(random() % 7));
+            const int width = int(i / 128 % 33);
+            const long long largest = (long long)((1ULL << width) - 1);
+            columns[1].push_back(start + (i % 128 == 0 ? 0 : (i % 128 == 1 ? largest : (long long)(random() & uint64_t(largest)))));
+            columns[2].push_back((long long)random());
+            columns[3].push_back(i % 3 == 0 ? LLONG_MIN : (i % 3 == 1 ? LLONG_MAX : 0));
+        }
+        if (size > 33 * 128)
+        {
+            const PackedTimes widths(columns[1]);
+            for (size_t block = 0; block < 33; block++)
+            {
+                EXPECT_EQ(widths.blockWidth(block), int(block));
+            }
+        }
+        for (const auto &column : columns)
+        {
+            PackedTimes packed(column);
+            ASSERT_EQ(packed.size(), column.size());
+            EXPECT_EQ(packed.numBlocks(), (size + 127) / 128);
+            EXPECT_EQ(packed.decode(), column) << size;
+            for (size_t i = 0; i < column.size(); i++)
+            {
+                ASSERT_EQ(packed.at(i), column[i]) << i;
+            }
+            // Ranges starting inside blocks and reaching past them (the span wraps in 32 bits for width 32).
+            for (size_t i = 0; i < column.size(); i += 61)
+            {
+                const long long from = column[i];
+                const long long to = (from == LLONG_MAX) ? LLONG_MAX : from + 1 + (long long)(random() % (1ULL << 33));
+                const long long ends[] = {to, LLONG_MAX};
+                for (const long long &end : ends)
+                {
+                    EXPECT_EQ(packed.count(from, end), size_t(std::count_if(column.begin(), column.end(), [&](const long long &t) { return from <= t && t < end; }))) << i;
+                }
+            }
+        }
+    }
+    PackedTimes empty;
+    EXPECT_TRUE(empty.decode().empty());
+    EXPECT_EQ(empty.count(LLONG_MIN, LLONG_MAX), 0u);
+    EXPECT_THROW(empty.at(0), DatetimeException);
+    EXPECT_THROW(PackedTimes(std::vector<long long>(10)).decodeBlock(1, nullptr), DatetimeException);
+}
+
+TEST(TestPackedTimes, Filter)
+{
+    std::mt19937_64 random(41);
+    const long long start = Datetime(2021, 1, 1, 0, 0, 0, true).unixTime();
+    std::vector<long long> times;
+    for (size_t i = 0; i < 3000; i++)
+    {
+        // Mostly increasing, with blocks of random and wide times.
+        if (i / 128 == 10)
+        {
+            times.push_back((long long)random());
+        }
+        else
+        {
+            times.push_back(start + (long long)i * 60 + (long long)(random() % 600) - 300);
+        }
+    }
+    const PackedTimes packed(times);
+    for (int trial = 0; trial < 300; trial++)
+    {
+        long long from = start + (long long)(random() % 200000) - 1000;
+        long long to = from + (long long)(random() % 20000);
+        if (trial % 50 == 0)
+        {
+            from = LLONG_MIN;
+            to = trial == 0 ? LLONG_MIN : LLONG_MAX;
+        }
+        std::vector<size_t> expected;
+        for (size_t i = 0; i < times.size(); i++)
+        {
+            if (times[i] >= from && times[i] < to)
+            {
+                expected.push_back(i);
+            }
+        }
+        EXPECT_EQ(packed.filter(from, to), expected) << from << " " << to;
+        EXPECT_EQ(packed.count(from, to), expected.size());
+    }
+    EXPECT_EQ(packed.count(start, start), 0u);
+    EXPECT_EQ(packed.count(start + 100, start), 0u);
+    EXPECT_EQ(packed.count(LLONG_MIN, LLONG_MAX), times.size() - 1 + (times.back() < LLONG_MAX ? 1 : 0));
+
+    // Datetime columns and queries.
+    std::vector<Datetime> datetimes;
+    for (long long i = 0; i < 1000; i++)
+    {
+        datetimes.push_back(Datetime(2021, 3, 8, 0, 0, 0, true) + i * 3600);
+    }
+    const PackedTimes column(datetimes);
+    const auto rows = column.filter(Datetime(2021, 3, 9, 0, 0, 0, true), Datetime(2021, 3, 10, 0, 0, 0, true));
+    ASSERT_EQ(rows.size(), 24u);
+    EXPECT_EQ(rows[0], 24u);
+    EXPECT_EQ(column.count(Datetime(2021, 3, 8, 0, 0, 0, true), Datetime(2021, 3, 8, 0, 0, 1, true)), 1u);
+}
+
+TEST(TestPackedTimes, Size)
+{
+    // Every second for a day: 7 bits each plus 32 bytes per block of 128.
+    std::vector<long long> regular;
+    for (long long i = 0; i < 86400; i++)
+    {
+        regular.push_back(1600000000 + i);
+    }
+    const PackedTimes packed(regular);
+    EXPECT_EQ(packed.blockWidth(0), 7);
+    EXPECT_LE(packed.bitsPerTime(), 9.0);
+    EXPECT_LT(packed.sizeInBytes(), regular.size() * sizeof(long long) / 6);
+    EXPECT_EQ(PackedTimes(std::vector<long long>(200, 5)).blockWidth(1), 0);
+    EXPECT_EQ(PackedTimes(std::vector<long long>{0, 1LL << 40}).blockWidth(0), 64);
+}
@@ -0,0 +1,139 @@
+#pragma once
+#include <algorithm>
+#include "gtest/gtest.h"
+#include "datetime_range.h"
+#include "alloc_counter.h"
+
+using namespace EZ;
+
+TEST(TestRange, FixedStride)
+{
+    const Datetime start(2021, 3, 8, 0, 0, 0, true);
+    auto minutes = range(start, Datetime(2021, 3, 8, 1, 0, 0, true), TimeDelta(0, 0, 1, 0));
+    EXPECT_TRUE(minutes.isFixedStride());
+    ASSERT_EQ(minutes.size(), 60u);
+    EXPECT_EQ(minutes[0], start);
+    EXPECT_EQ(minutes[59], Datetime(2021, 3, 8, 0, 59, 0, true));
+    EXPECT_EQ(minutes.back(), Datetime(2021, 3, 8, 0, 59, 0, true));
+    EXPECT_TRUE(minutes[1].isUTC());
+    EXPECT_THROW(minutes.at(60), DatetimeException);
+
+    long long expected = start.unixTime();
+    size_t count = 0;
+    for (const auto &t : minutes)
+    {
+        EXPECT_EQ(t.unixTime(), expected);
+        expected += 60;
+        count++;
+    }
+    EXPECT_EQ(count, 60u);
+
+    // The end is not included. A partial step is.
+    EXPECT_EQ(range(start, start + 61, TimeDelta(60)).size(), 2u);
+    EXPECT_EQ(range(start, start + 60, TimeDelta(60)).size(), 1u);
+    EXPECT_TRUE(range(start, start, TimeDelta(60)).empty());
+    EXPECT_TRUE(range(start, start - 60, TimeDelta(60)).empty());
+
+    auto backward = range(start, start - 10, TimeDelta(-3));
+    ASSERT_EQ(backward.size(), 4u);
+    EXPECT_EQ(backward[3].unixTime(), start.unixTime() - 9);
+    EXPECT_THROW(range(start, start + 10, TimeDelta(0)), DatetimeException);
+
+    // Iterators work with the standard algorithms.
+    EXPECT_EQ(std::distance(minutes.begin(), minutes.end()), 60);
+    auto found = std::lower_bound(minutes.begin(), minutes.end(), Datetime(2021, 3, 8, 0, 30, 30, true));
+    EXPECT_EQ(found - minutes.begin(), 31);
+    EXPECT_EQ(*(minutes.end() - 1), minutes.back());
+    EXPECT_EQ(minutes.begin()[10], minutes[10]);
+
+    // Whole range of Datetime.
+    auto years = range(Datetime::minimum(true), Datetime::maximum(true), TimeDelta(365, 0, 0, 0));
+    EXPECT_EQ(years.front(), Datetime::minimum(true));
+    EXPECT_LE(years.back(), Datetime::maximum(true));
+    EXPECT_GT(years.back().unixTime() + 365 * 86400, Datetime::maximum(true).unixTime());
+}
+
+TEST(TestRange, CalendarSteps)
+{
+    auto months = range(Datetime(2021, 1, 31, 12, 0, 0, true), Datetime(2022, 1, 1, 0, 0, 0, true), Calendar::MONTH);
+    EXPECT_FALSE(months.isFixedStride());
+    ASSERT_EQ(months.size(), 12u);
+    EXPECT_EQ(months[1], Datetime(2021, 2, 28, 12, 0, 0, true));
+    EXPECT_EQ(months[2], Datetime(2021, 3, 31, 12, 0, 0, true));
+    EXPECT_EQ(months[11], Datetime(2021, 12, 31, 12, 0, 0, true));
+
+    auto quarters = range(Datetime(2021, 1, 1, 0, 0, 0, true), Datetime(2031, 1, 1, 0, 0, 0, true), Calendar::MONTH, 3);
+    EXPECT_EQ(quarters.size(), 40u);
+    EXPECT_EQ(quarters[39], Datetime(2030, 10, 1, 0, 0, 0, true));
+    auto leapDays = range(Datetime(2020, 2, 29, 0, 0, 0, true), Datetime(2030, 1, 1, 0, 0, 0, true), Calendar::YEAR);
+    EXPECT_EQ(leapDays.size(), 10u);
+    EXPECT_EQ(leapDays[1], Datetime(2021, 2, 28, 0, 0, 0, true));
+    EXPECT_EQ(leapDays[4], Datetime(2024, 2, 29, 0, 0, 0, true));
+    EXPECT_EQ(range(Datetime(2021, 3, 8, 0, 0, 0, true), Datetime(2021, 3, 29, 0, 0, 0, true), Calendar::WEEK).size(), 3u);
+    EXPECT_EQ(range(Datetime(2021, 3, 8, 0, 0, 0, true), Datetime(2021, 3, 8, 0, 0, 0, true), Calendar::MONTH).size(), 0u);
+    EXPECT_THROW(range(Datetime(), Datetime(), Calendar::DAY, 0), DatetimeException);
+
+    // Local days keep the local time of day across summer time.
+    auto days = range(Datetime(2021, 3, 1, 12, 0, 0, false), Datetime(2021, 5, 1, 12, 0, 0, false), Calendar::DAY);
+    ASSERT_EQ(days.size(), 61u);
+    for (size_t i = 0; i < days.size(); i++)
+    {
+        EXPECT_EQ(days[i].hour(), 12) << i;
+        EXPECT_FALSE(days[i].isUTC());
+    }
+    EXPECT_EQ(days[60], Datetime(2021, 4, 30, 12, 0, 0, false));
+    EXPECT_EQ(Datetime(2021, 3, 27, 12, 0, 0, false).addDays(3), Datetime(2021, 3, 30, 12, 0, 0, false));
+    EXPECT_EQ(Datetime(2021, 3, 1, 0, 0, 0, true).addDays(-1), Datetime(2021, 2, 28, 0, 0, 0, true));
+    EXPECT_THROW(Datetime::maximum(true).addDays(1), DatetimeException);
+}
+
+TEST(TestRange, Chunks)
+{
+    const Datetime start(2021, 1, 1, 0, 0, 0, true);
+    auto seconds = range(start, start + 1003, TimeDelta(1));
+    for (const size_t numChunks : {1u, 3u, 7u, 2000u})
+    {
+        long long expected = start.unixTime();
+        for (size_t i = 0; i < numChunks; i++)
+        {
+            auto chunk = seconds.chunk(i, numChunks);
+            EXPECT_LE(chunk.size(), 1003 / numChunks + 1);
+            for (const auto &t : chunk)
+            {
+                EXPECT_EQ(t.unixTime(), expected);
+                expected++;
+            }
+        }
+        EXPECT_EQ(expected, start.unixTime() + 1003);
+    }
+    auto slice = seconds.slice(10, 20);
+    EXPECT_EQ(slice.size(), 10u);
+    EXPECT_EQ(slice[0].unixTime(), start.unixTime() + 10);
+    EXPECT_EQ(slice.slice(5, 10)[0].unixTime(), start.unixTime() + 15);
+    EXPECT_THROW(seconds.slice(10, 1004), DatetimeException);
+    EXPECT_THROW(seconds.chunk(3, 3), DatetimeException);
+
+    auto months = range(Datetime(2021, 1, 31, 0, 0, 0, true), Datetime(2022, 1, 1, 0, 0, 0, true), Calendar::MONTH);
+    EXPECT_EQ(months.chunk(1, 4)[0], Datetime(2021, 4, 30, 0, 0, 0, true));
+}
+
+TEST(TestRange, NoAllocation)
+{
+    // Ten years of minutes.
+    MyHelper::AllocationCounter counter;
+    auto minutes = range(Datetime(2020, 1, 1, 0, 0, 0, true), Datetime(2030, 1, 1, 0, 0, 0, true), TimeDelta(0, 0, 1, 0));
+    long long sum = 0;
+    for (const auto &t : minutes)
+    {
+        sum += t.minute();
+    }
+    auto days = range(Datetime(2020, 1, 1, 0, 0, 0, true), Datetime(2030, 1, 1, 0, 0, 0, true), Calendar::MONTH);
+    for (const auto &t : days)
+    {
+        sum += t.day();
+    }
+    long long n = counter.count();
+    EXPECT_EQ(n, 0);
+    EXPECT_EQ(minutes.size(), 5260320u);
+    EXPECT_EQ(sum, 5260320LL * 59 / 2 + 120);
+}
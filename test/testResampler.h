@@ -0,0 +1,108 @@
+#pragma once
+#include "gtest/gtest.h"
+#include "resampler.h"
+
+using namespace EZ;
+
+TEST(TestResampler, FixedBuckets)
+{
+    const long long base = Datetime(2021, 3, 8, 0, 0, 0, true).unixTime();
+    const std::vector<long long> times = {base + 5, base + 30, base + 59, base + 60, base + 200, base + 201, base + 3600};
+    const std::vector<double> prices = {10, 12, 11, 9, 20, 18, 7};
+    const std::vector<double> volumes = {1, 2, 3, 4, 5, 6, 7};
+
+    Resampler resampler(Calendar::MINUTE, 1, true);
+    auto result = resampler.resample(times, {prices, volumes});
+    ASSERT_EQ(result.size(), 4u);
+    EXPECT_EQ(result.starts, std::vector<long long>({base, base + 60, base + 180, base + 3600}));
+    EXPECT_EQ(result.counts, std::vector<long long>({3, 1, 2, 1}));
+    ASSERT_EQ(result.columns.size(), 2u);
+    EXPECT_EQ(result.columns[0].first, std::vector<double>({10, 9, 20, 7}));
+    EXPECT_EQ(result.columns[0].last, std::vector<double>({11, 9, 18, 7}));
+    EXPECT_EQ(result.columns[0].min, std::vector<double>({10, 9, 18, 7}));
+    EXPECT_EQ(result.columns[0].max, std::vector<double>({12, 9, 20, 7}));
+    EXPECT_EQ(result.columns[1].sum, std::vector<double>({6, 4, 11, 7}));
+
+    // Same buckets by TimeDelta.
+    auto byDelta = Resampler(TimeDelta(0, 0, 1, 0), true).resample(times, {volumes});
+    EXPECT_EQ(byDelta.starts, result.starts);
+    EXPECT_EQ(byDelta.counts, result.counts);
+
+    auto hourly = Resampler(Calendar::HOUR, 1, true).resample(times, {});
+    EXPECT_EQ(hourly.starts, std::vector<long long>({base, base + 3600}));
+    EXPECT_EQ(hourly.counts, std::vector<long long>({6, 1}));
+    EXPECT_TRUE(hourly.columns.empty());
+
+    auto monthly = Resampler(Calendar::MONTH, 1, true).resample(
+        {Datetime(2021, 1, 31, 23, 59, 59, true).unixTime(), Datetime(2021, 2, 1, 0, 0, 0, true).unixTime(), Datetime(2021, 2, 28, 0, 0, 0, true).unixTime()},
+        {{1, 2, 3}});
+    EXPECT_EQ(monthly.starts, std::vector<long long>({Datetime(2021, 1, 1, 0, 0, 0, true).unixTime(), Datetime(2021, 2, 1, 0, 0, 0, true).unixTime()}));
+    EXPECT_EQ(monthly.columns[0].sum, std::vector<double>({1, 5}));
+
+    EXPECT_EQ(resampler.resample(std::vector<long long>(), {}).size(), 0u);
+    EXPECT_THROW(resampler.resample({base + 10, base}, {}), DatetimeException);
+    EXPECT_THROW(resampler.resample({base, base + 10}, {{1}}), DatetimeException);
+    EXPECT_THROW(Resampler(Calendar::MINUTE, 0), DatetimeException);
+    EXPECT_THROW(Resampler(TimeDelta(-5)), DatetimeException);
+}
+
+TEST(TestResampler, LocalDays)
+{
+    std::vector<long long> times;
+    std::vector<double> values;
+    const long long base = Datetime(2021, 3, 1, 0, 0, 0, false).unixTime();
+    for (long long t = base; t < Datetime(2021, 4, 30, 0, 0, 0, false).unixTime(); t += 1800)
+    {
+        times.push_back(t);
+        values.push_back(1);
+    }
+    auto result = Resampler(Calendar::DAY).resample(times, {values});
+    ASSERT_EQ(result.size(), 60u);
+    long long total = 0;
+    for (size_t i = 0; i < result.size(); i++)
+    {
+        const Datetime start(time_t(result.starts[i]), false);
+        EXPECT_EQ(start.hour(), 0);
+        EXPECT_EQ(start.minute(), 0);
+        EXPECT_EQ(start, start.floor(Calendar::DAY));
+        EXPECT_EQ(result.counts[i], (long long)result.columns[0].sum[i]);
+        total += result.counts[i];
+    }
+    EXPECT_EQ(total, (long long)times.size());
+}
+
+TEST(TestResampler, Parallel)
+{
+    std::vector<long long> times;
+    std::vector<double> values;
+    long long t = Datetime(2021, 1, 1, 0, 0, 0, true).unixTime();
+    for (long long i = 0; i < 100000; i++)
+    {
+        t += (i * 7919) % 97;
+        times.push_back(t);
+        values.push_back(double((i * 104729) % 1000) - 500);
+    }
+    for (const bool &isUTC : {true, false})
+    {
+        for (const auto &unit : {Calendar::MINUTE, Calendar::HOUR, Calendar::DAY})
+        {
+            Resampler resampler(unit, 1, isUTC);
+            auto expected = resampler.resample(times, {values});
+            for (const size_t numThreads : {2u, 3u, 8u})
+            {
+                auto actual = resampler.resample(times, {values}, numThreads);
+                EXPECT_EQ(actual.starts, expected.starts);
+                EXPECT_EQ(actual.counts, expected.counts);
+                EXPECT_EQ(actual.columns[0].sum, expected.columns[0].sum);
+                EXPECT_EQ(actual.columns[0].min, expected.columns[0].min);
+                EXPECT_EQ(actual.columns[0].max, expected.columns[0].max);
+                EXPECT_EQ(actual.columns[0].first, expected.columns[0].first);
+                EXPECT_EQ(actual.columns[0].last, expected.columns[0].last);
+            }
+        }
+    }
+    // More threads than rows.
+    auto few = Resampler(Calendar::MINUTE, 1, true).resample({0, 1, 61}, {{1, 2, 3}}, 16);
+    EXPECT_EQ(few.counts, std::vector<long long>({2, 1}));
+    EXPECT_EQ(few.columns[0].last, std::vector<double>({2, 3}));
+}
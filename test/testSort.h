@@ -0,0 +1,127 @@
+#pragma once
+#include <climits>
+#include <random>
+#include "gtest/gtest.h"
+#include "datetime_sort.h"
+
+using namespace EZ;
+
+TEST(TestSort, RadixSort)
+{
+    std::mt19937_64 random(42);
+    // Within a year, whole range and sizes around the threshold of the comparison sort.
+    const long long start = Datetime(2021, 1, 1, 0, 0, 0, true).unixTime();
+    const size_t sizes[] = {0, 1, 2, 63, 64, 65, 1000, 300000};
+    for (const size_t &size : sizes)
+    {
+        std::vector<long long> year(size), whole(size);
+        for (size_t i = 0; i < size; i++)
+        {
+            year[i] = start + (long long)(random() % (365 * 86400ULL));
+            whole[i] = DatetimeConstants::MINIMUM_SEC + (long long)(random() % uint64_t(DatetimeConstants::MAXIMUM_SEC - DatetimeConstants::MINIMUM_SEC));
+        }
+        for (auto values : {year, whole})
+        {
+            auto expected = values;
+            std::sort(expected.begin(), expected.end());
+            auto parallel = values;
+            sort(values);
+            EXPECT_EQ(values, expected) << size;
+            parallelSort(parallel, 4);
+            EXPECT_EQ(parallel, expected) << size;
+        }
+    }
+    // Negative values, duplicates and extremes.
+    std::vector<long long> values = {3, -1, LLONG_MAX, 0, LLONG_MIN, -1, 3};
+    std::vector<long long> filled;
+    for (int i = 0; i < 30; i++)
+    {
+        filled.insert(filled.end(), values.begin(), values.end());
+    }
+    auto expected = filled;
+    std::sort(expected.begin(), expected.end());
+    sort(filled);
+    EXPECT_EQ(filled, expected);
+}
+
+TEST(TestSort, Datetimes)
+{
+    std::mt19937_64 random(7);
+    std::vector<Datetime> times;
+    for (int i = 0; i < 5000; i++)
+    {
+        // The same unix times in UTC and local time: the order of equal times is kept.
+        const long long t = Datetime(2021, 1, 1, 0, 0, 0, true).unixTime() + (long long)(random() % 1000);
+        times.push_back(Datetime(time_t(t), i % 2 == 0));
+    }
+    auto expected = times;
+    std::stable_sort(expected.begin(), expected.end());
+    auto parallel = times;
+    sort(times);
+    parallelSort(parallel, 3);
+    ASSERT_TRUE(isSorted(times));
+    for (size_t i = 0; i < times.size(); i++)
+    {
+        EXPECT_EQ(times[i].unixTime(), expected[i].unixTime());
+        EXPECT_EQ(times[i].isUTC(), expected[i].isUTC()) << i;
+        EXPECT_EQ(parallel[i].isUTC(), expected[i].isUTC()) << i;
+    }
+}
+
+TEST(TestSort, Runs)
+{
+    EXPECT_EQ(sortedRuns(std::vector<long long>{1, 2, 5, 3, 4, 0}), std::vector<size_t>({0, 3, 5}));
+    EXPECT_EQ(sortedRuns(std::vector<long long>{}), std::vector<size_t>());
+    EXPECT_EQ(sortedRuns(std::vector<long long>{1, 1, 1}), std::vector<size_t>({0}));
+    EXPECT_TRUE(isSorted(std::vector<long long>{1, 1, 2}));
+    EXPECT_FALSE(isSorted(std::vector<long long>{2, 1}));
+
+    // Concatenated sorted logs are merged.
+    std::vector<long long> logs;
+    for (int file = 0; file < 5; file++)
+    {
+        for (long long i = 0; i < 1000; i++)
+        {
+            logs.push_back(i * 5 + (file * 3) % 5);
+        }
+    }
+    EXPECT_EQ(sortedRuns(logs).size(), 5u);
+    auto expected = logs;
+    std::sort(expected.begin(), expected.end());
+    sort(logs);
+    EXPECT_EQ(logs, expected);
+
+    std::vector<Datetime> times = {Datetime(2021, 1, 2, 0, 0, 0, true), Datetime(2021, 1, 1, 0, 0, 0, false)};
+    EXPECT_EQ(sortedRuns(times).size(), 2u);
+    sort(times);
+    EXPECT_FALSE(times[0].isUTC());
+}
+
+TEST(TestSort, ByKey)
+{
+    std::vector<long long> keys = {3, 1, 3, 2};
+    std::vector<int> values = {0, 1, 2, 3};
+    EXPECT_EQ(sortedIndices(keys), std::vector<size_t>({1, 3, 0, 2}));
+    sortByKey(keys, values);
+    EXPECT_EQ(keys, std::vector<long long>({1, 2, 3, 3}));
+    EXPECT_EQ(values, std::vector<int>({1, 3, 0, 2}));
+    std::vector<int> shorter(3);
+    EXPECT_THROW(sortByKey(keys, shorter), DatetimeException);
+
+    // Stable for large arrays too.
+    std::mt19937_64 random(1);
+    std::vector<long long> many(200000);
+    for (auto &key : many)
+    {
+        key = (long long)(random() % 5000) - 2500;
+    }
+    const size_t threads[] = {1, 4};
+    for (const size_t &numThreads : threads)
+    {
+        const auto indices = sortedIndices(many, numThreads);
+        for (size_t i = 1; i < indices.size(); i++)
+        {
+            ASSERT_TRUE(many[indices[i - 1]] < many[indices[i]] || (many[indices[i - 1]] == many[indices[i]] && indices[i - 1] < indices[i])) << i;
+        }
+    }
+}
@@ -0,0 +1,165 @@
+#pragma once
+#include <random>
+#include <string>
+#include "gtest/gtest.h"
+#include "stream_merger.h"
+
+using namespace EZ;
+
+TEST(TestStreamMerger, Merge)
+{
+    std::mt19937_64 random(3);
+    const size_t counts[] = {0, 1, 2, 5, 64, 100};
+    for (const size_t &numSources : counts)
+    {
+        std::vector<std::vector<long long>> logs(numSources);
+        std::vector<long long> expected;
+        for (auto &log : logs)
+        {
+            long long t = Datetime(2021, 1, 1, 0, 0, 0, true).unixTime() + (long long)(random() % 100);
+            const size_t size = random() % 300;
+            for (size_t i = 0; i < size; i++)
+            {
+                t += (long long)(random() % 5);
+                log.push_back(t);
+            }
+            expected.insert(expected.end(), log.begin(), log.end());
+        }
+        std::sort(expected.begin(), expected.end());
+
+        std::vector<std::function<bool(long long &)>> sources;
+        for (const auto &log : logs)
+        {
+            sources.push_back(rangeSource(log.begin(), log.end()));
+        }
+        StreamMerger<long long> merger(sources);
+        EXPECT_EQ(merger.size(), numSources);
+        EXPECT_LE(merger.buffered(), numSources);
+        std::vector<long long> merged;
+        long long time;
+        while (merger.next(time))
+        {
+            merged.push_back(time);
+        }
+        EXPECT_EQ(merged, expected) << numSources;
+        EXPECT_FALSE(merger.next(time));
+        EXPECT_EQ(merger.buffered(), 0u);
+    }
+
+    // Datetimes keep their timezone settings.
+    const std::vector<Datetime> a = {Datetime(2021, 1, 1, 0, 0, 0, true), Datetime(2021, 1, 3, 0, 0, 0, true)};
+    const std::vector<Datetime> b = {Datetime(2021, 1, 2, 0, 0, 0, false)};
+    StreamMerger<Datetime> merger({rangeSource(a.begin(), a.end()), rangeSource(b.begin(), b.end())});
+    Datetime time;
+    ASSERT_TRUE(merger.next(time));
+    EXPECT_EQ(time, a[0]);
+    ASSERT_TRUE(merger.next(time));
+    EXPECT_FALSE(time.isUTC());
+    ASSERT_TRUE(merger.next(time));
+    EXPECT_EQ(time, a[1]);
+    EXPECT_FALSE(merger.next(time));
+}
+
+TEST(TestStreamMerger, Records)
+{
+    // Records of equal times: in the order of the sources, then in the order of each source.
+    struct Line
+    {
+        long long time;
+        std::string text;
+    };
+    const std::vector<Line> host0 = {{10, "a0"}, {20, "a1"}, {20, "a2"}};
+    const std::vector<Line> host1 = {{10, "b0"}, {20, "b1"}, {30, "b2"}};
+    StreamMerger<Line> merger({rangeSource(host1.begin(), host1.end()), rangeSource(host0.begin(), host0.end())},
+                              [](const Line &line) { return line.time; });
+    std::string texts;
+    Line line;
+    while (merger.next(line))
+    {
+        texts += line.text + " ";
+    }
+    EXPECT_EQ(texts, "b0 a0 b1 a1 a2 b2 ");
+}
+
+TEST(TestStreamMerger, ReorderWindow)
+{
+    std::mt19937_64 random(5);
+    const long long window = 60;
+    std::vector<std::vector<long long>> logs(8);
+    std::vector<long long> expected;
+    for (auto &log : logs)
+    {
+        // Records written up to window seconds late: ordered by the time of writing.
+        std::vector<std::pair<long long, long long>> written;
+        long long t = 0;
+        for (int i = 0; i < 2000; i++)
+        {
+            t += (long long)(random() % 10);
+            written.push_back({t + (long long)(random() % (window + 1)), t});
+        }
+        std::sort(written.begin(), written.end());
+        for (const auto &record : written)
+        {
+            log.push_back(record.second);
+        }
+        expected.insert(expected.end(), log.begin(), log.end());
+    }
+    std::sort(expected.begin(), expected.end());
+    std::vector<std::function<bool(long long &)>> sources;
+    for (const auto &log : logs)
+    {
+        sources.push_back(rangeSource(log.begin(), log.end()));
+    }
+    EXPECT_THROW(
+        {
+            StreamMerger<long long> strict(sources);
+            long long time;
+            while (strict.next(time))
+            {
+            }
+        },
+        DatetimeException);
+
+    StreamMerger<long long> merger(sources, window);
+    std::vector<long long> merged;
+    long long time;
+    size_t maxBuffered = 0;
+    while (merger.next(time))
+    {
+        merged.push_back(time);
+        maxBuffered = std::max(maxBuffered, merger.buffered());
+    }
+    EXPECT_EQ(merged, expected);
+    EXPECT_EQ(merger.numLate(), 0u);
+    // Bounded memory: records within the window of each source.
+    EXPECT_LE(maxBuffered, logs.size() * (window + 2));
+    EXPECT_THROW(StreamMerger<long long>(sources, -1), DatetimeException);
+}
+
+TEST(TestStreamMerger, LateRecords)
+{
+    const std::vector<long long> a = {10, 20, 100, 200, 30, 210};
+    const std::vector<long long> b = {15, 105};
+    auto merge = [&](const long long &window, const StreamMerger<long long>::LatePolicy &policy, size_t &numLate) {
+        StreamMerger<long long> merger({rangeSource(a.begin(), a.end()), rangeSource(b.begin(), b.end())}, window, policy);
+        std::vector<long long> merged;
+        long long time;
+        while (merger.next(time))
+        {
+            merged.push_back(time);
+        }
+        numLate = merger.numLate();
+        return merged;
+    };
+    size_t numLate = 0;
+    EXPECT_EQ(merge(0, StreamMerger<long long>::DROP, numLate), std::vector<long long>({10, 15, 20, 100, 105, 200, 210}));
+    EXPECT_EQ(numLate, 1u);
+    EXPECT_EQ(merge(0, StreamMerger<long long>::EMIT, numLate), std::vector<long long>({10, 15, 20, 100, 105, 200, 30, 210}));
+    EXPECT_EQ(numLate, 1u);
+    EXPECT_THROW(merge(0, StreamMerger<long long>::THROW, numLate), DatetimeException);
+    // 30 is 170 seconds later than 200.
+    EXPECT_EQ(merge(200, StreamMerger<long long>::THROW, numLate), std::vector<long long>({10, 15, 20, 30, 100, 105, 200, 210}));
+    EXPECT_EQ(numLate, 0u);
+    EXPECT_EQ(merge(50, StreamMerger<long long>::DROP, numLate), std::vector<long long>({10, 15, 20, 100, 105, 200, 210}));
+    EXPECT_EQ(numLate, 1u);
+}
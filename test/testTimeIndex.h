@@ -0,0 +1,89 @@
+#pragma once
+#include <climits>
+#include <random>
+#include "gtest/gtest.h"
+#include "time_index.h"
+
+using namespace EZ;
+
+TEST(TestTimeIndex, CompareWithBinarySearch)
+{
+    std::mt19937_64 random(11);
+    const long long start = Datetime(2021, 1, 1, 0, 0, 0, true).unixTime();
+    const size_t sizes[] = {0, 1, 2, 3, 10, 1000, 100000};
+    for (const size_t &size : sizes)
+    {
+        // Uniform, clustered (bursts of equal times) and extreme times.
+        std::vector<std::vector<long long>> columns(3);
+        long long t = start;
+        for (size_t i = 0; i < size; i++)
+        {
+            columns[0].push_back(start + (long long)(random() % (30 * 86400ULL)));
+            t += (i % 100 == 0) ? (long long)(random() % 1000000) : (long long)(random() % 2);
+            columns[1].push_back(t);
+            columns[2].push_back(i % 2 == 0 ? LLONG_MIN + (long long)i : LLONG_MAX - (long long)i);
+        }
+        for (auto &column : columns)
+        {
+            std::sort(column.begin(), column.end());
+            TimeIndex index(column);
+            ASSERT_EQ(index.size(), size);
+            for (int q = 0; q < 2000; q++)
+            {
+                long long query;
+                if (!column.empty() && q % 2 == 0)
+                {
+                    query = column[random() % column.size()] + (long long)(q % 3) - 1;
+                }
+                else
+                {
+                    query = (long long)random();
+                }
+                const size_t lower = size_t(std::lower_bound(column.begin(), column.end(), query) - column.begin());
+                const size_t upper = size_t(std::upper_bound(column.begin(), column.end(), query) - column.begin());
+                ASSERT_EQ(index.lowerBound(query), lower) << query;
+                ASSERT_EQ(index.upperBound(query), upper) << query;
+                ASSERT_EQ(index.asOf(query), upper == 0 ? NO_ROW : upper - 1) << query;
+            }
+        }
+    }
+}
+
+TEST(TestTimeIndex, Lookups)
+{
+    // 2021/01/01 00:00:00 ~ every 10 minutes, and a gap of a day.
+    std::vector<Datetime> times;
+    for (int i = 0; i < 100; i++)
+    {
+        times.push_back(Datetime(2021, 1, 1, 0, 0, 0, false) + TimeDelta(0, 0, 10 * i, 0));
+    }
+    times.push_back(times.back() + TimeDelta(1, 0, 0, 0));
+    TimeIndex index(times);
+    EXPECT_EQ(index.lowerBound(times[5]), 5u);
+    EXPECT_EQ(index.upperBound(times[5]), 6u);
+    EXPECT_EQ(index.asOf(times[5] + 599), 5u);
+    EXPECT_EQ(index.asOf(times[0] - 1), NO_ROW);
+    EXPECT_EQ(index.asOf(times.back() + 86400), 100u);
+    EXPECT_EQ(index.asOf(times[99] + 3600), 99u);
+    EXPECT_EQ(index.time(3), times[3].unixTime());
+    EXPECT_THROW(index.time(101), DatetimeException);
+
+    const auto rows = index.range(times[10], times[20]);
+    EXPECT_EQ(rows.first, 10u);
+    EXPECT_EQ(rows.second, 20u);
+    EXPECT_EQ(index.range(times[20], times[10]).second, 20u);
+    EXPECT_EQ(index.range(times[20], times[10]).first, 20u);
+
+    std::vector<long long> queries = {times[0].unixTime() - 1, times[1].unixTime(), times[1].unixTime() + 1};
+    std::vector<size_t> found(queries.size());
+    index.asOf(queries.data(), queries.size(), found.data());
+    EXPECT_EQ(found, std::vector<size_t>({NO_ROW, 1, 1}));
+
+    // Copies keep their own times.
+    TimeIndex copied = index;
+    index = TimeIndex(std::vector<Datetime>());
+    EXPECT_EQ(copied.asOf(times[5] + 1), 5u);
+    EXPECT_EQ(index.asOf(times[5]), NO_ROW);
+
+    EXPECT_THROW(TimeIndex(std::vector<long long>({2, 1})), DatetimeException);
+}
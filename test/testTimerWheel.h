@@ -0,0 +1,166 @@
+#pragma once
+#include <map>
+#include <random>
+#include <thread>
+#include "gtest/gtest.h"
+#include "timer_wheel.h"
+
+using namespace EZ;
+
+TEST(TestTimerWheel, Expire)
+{
+    const Datetime start(2021, 3, 8, 9, 0, 0, true);
+    TimerWheel<std::string> wheel(start);
+    EXPECT_EQ(wheel.now(), start.unixTime());
+    wheel.insert(start + 60, "minute");
+    wheel.insert(start + 1, "second");
+    wheel.insert(start + 86400 * 365, "year");
+    wheel.insertAfter(TimeDelta(0, 1, 0, 0), "hour");
+    wheel.insert(start - 10, "overdue");
+    EXPECT_EQ(wheel.size(), 5u);
+
+    std::vector<std::string> expired;
+    EXPECT_EQ(wheel.advance(start, expired), 1u);
+    EXPECT_EQ(expired, std::vector<std::string>({"overdue"}));
+    expired.clear();
+    EXPECT_EQ(wheel.advance(start + 59, expired), 1u);
+    EXPECT_EQ(wheel.advance(start + 3600, expired), 2u);
+    EXPECT_EQ(expired, std::vector<std::string>({"second", "minute", "hour"}));
+    EXPECT_EQ(wheel.now(), (start + 3600).unixTime());
+
+    // Batch callbacks, and time does not go back.
+    size_t calls = 0;
+    EXPECT_EQ(wheel.advance(start, [&](std::vector<std::string> &) { calls++; }), 0u);
+    EXPECT_EQ(wheel.now(), (start + 3600).unixTime());
+    EXPECT_EQ(wheel.advance(start + 86400 * 365, [&](std::vector<std::string> &batch) {
+        calls++;
+        EXPECT_EQ(batch, std::vector<std::string>({"year"}));
+    }),
+              1u);
+    EXPECT_EQ(calls, 1u);
+    EXPECT_TRUE(wheel.empty());
+}
+
+TEST(TestTimerWheel, Cancel)
+{
+    TimerWheel<int> wheel(1000);
+    const auto a = wheel.insert(2000, 1);
+    const auto b = wheel.insert(2000, 2);
+    const auto c = wheel.insert(500, 3);
+    EXPECT_TRUE(wheel.cancel(a));
+    EXPECT_FALSE(wheel.cancel(a));
+    EXPECT_TRUE(wheel.cancel(c));
+    // The node of a is reused, but the identifier of a stays invalid.
+    const auto d = wheel.insert(3000, 4);
+    EXPECT_NE(d, a);
+    EXPECT_FALSE(wheel.cancel(a));
+    std::vector<int> expired;
+    wheel.advance(5000, expired);
+    EXPECT_EQ(expired, std::vector<int>({2, 4}));
+    EXPECT_FALSE(wheel.cancel(b));
+    EXPECT_FALSE(wheel.cancel(TimerWheel<int>::Id(12345)));
+}
+
+TEST(TestTimerWheel, CompareWithMultimap)
+{
+    std::mt19937_64 random(43);
+    const long long starts[] = {0, -3000000000LL, Datetime(2021, 3, 8, 0, 0, 0, true).unixTime(), (1LL << 36) - 1000};
+    for (const auto &start : starts)
+    {
+        TimerWheel<size_t> wheel(start);
+        std::multimap<long long, size_t> expected;
+        std::vector<TimerWheel<size_t>::Id> ids;
+        std::vector<long long> deadlines;
+        long long now = start;
+        for (size_t i = 0; i < 20000; i++)
+        {
+            // Seconds, hours, years and more.
+            const long long scales[] = {100, 100000, 100000000, 1LL << 40};
+            const long long deadline = now + (long long)(random() % scales[random() % 4]) - 10;
+            ids.push_back(wheel.insert(deadline, i));
+            deadlines.push_back(deadline);
+            expected.insert({deadline, i});
+            if (random() % 4 == 0)
+            {
+                // Cancel a random timer.
+                const size_t victim = size_t(random() % ids.size());
+                auto range = expected.equal_range(deadlines[victim]);
+                bool pending = false;
+                for (auto it = range.first; it != range.second; ++it)
+                {
+                    if (it->second == victim)
+                    {
+                        expected.erase(it);
+                        pending = true;
+                        break;
+                    }
+                }
+                EXPECT_EQ(wheel.cancel(ids[victim]), pending);
+            }
+            if (random() % 16 == 0)
+            {
+                const long long previous = now;
+                now += (long long)(random() % (random() % 2 == 0 ? 1000 : 10000000));
+                std::vector<size_t> expired;
+                wheel.advance(now, expired);
+                // Overdue timers first, and then in the order of their deadlines.
+                std::vector<long long> expiredDeadlines;
+                long long last = LLONG_MIN;
+                for (const auto &index : expired)
+                {
+                    if (deadlines[index] > previous)
+                    {
+                        ASSERT_LE(last, deadlines[index]);
+                        last = deadlines[index];
+                    }
+                    expiredDeadlines.push_back(deadlines[index]);
+                }
+                std::sort(expiredDeadlines.begin(), expiredDeadlines.end());
+                std::vector<long long> expectedDeadlines;
+                while (!expected.empty() && expected.begin()->first <= now)
+                {
+                    expectedDeadlines.push_back(expected.begin()->first);
+                    expected.erase(expected.begin());
+                }
+                ASSERT_EQ(expiredDeadlines, expectedDeadlines) << start << " " << now;
+                ASSERT_EQ(wheel.size(), expected.size());
+            }
+        }
+        std::vector<size_t> expired;
+        wheel.advance(LLONG_MAX, expired);
+        EXPECT_EQ(expired.size(), expected.size());
+        EXPECT_TRUE(wheel.empty());
+    }
+}
+
+TEST(TestTimerWheel, Post)
+{
+    TimerWheel<int> wheel(0);
+    const int numThreads = 4;
+    const int perThread = 10000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < numThreads; t++)
+    {
+        threads.push_back(std::thread([&wheel, t]() {
+            for (int i = 0; i < perThread; i++)
+            {
+                wheel.post(1 + i % 100, t * perThread + i);
+            }
+        }));
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    std::vector<int> expired;
+    EXPECT_EQ(wheel.advance(50, expired), size_t(numThreads * perThread / 2));
+    EXPECT_EQ(wheel.advance(100, expired), size_t(numThreads * perThread / 2));
+    std::sort(expired.begin(), expired.end());
+    for (int i = 0; i < numThreads * perThread; i++)
+    {
+        ASSERT_EQ(expired[i], i);
+    }
+    // Posted timers not taken in are released.
+    TimerWheel<std::string> unused;
+    unused.post(10, "never");
+}